@@ -0,0 +1,28 @@
+#include "BufferFactory.h"
+#include <algorithm>
+#include <vector>
+
+void BufferDeleter::operator()(GpuBuffer* buffer) const noexcept
+{
+	factory->ReleaseBuffer(buffer);
+}
+
+UniqueBuffer BufferFactory::CreateStatic(const void* data, UINT byteWidth, UINT bindFlags)
+{
+	return UniqueBuffer(CreateStaticBuffer(data, byteWidth, bindFlags), BufferDeleter{ this });
+}
+
+UniqueBuffer BufferFactory::CreateCompactIndexBuffer(std::span<const UINT> indices, DXGI_FORMAT& format)
+{
+	const bool fits16 = std::all_of(indices.begin(), indices.end(), [](UINT i) { return i <= 0xFFFF; });
+
+	if (!fits16)
+	{
+		format = DXGI_FORMAT_R32_UINT;
+		return CreateIndexBuffer(indices);
+	}
+
+	format = DXGI_FORMAT_R16_UINT;
+	const std::vector<USHORT> narrow(indices.begin(), indices.end());
+	return CreateIndexBuffer(narrow);
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include "WinTypes.h"
+#include <iterator>
+#include <memory>
+#include <span>
+
+// A buffer made by a BufferFactory. The type is never defined: Graphics hands out ID3D11Buffers behind
+// it and the headless and software factories their own memory, so only the factory that made a buffer
+// knows what it points to.
+struct GpuBuffer;
+
+enum class BufferMap
+{
+	// the GPU may still read the old contents, so the driver hands out fresh memory
+	Discard,
+	// keeps the contents; the caller promises not to write bytes the GPU may still read
+	NoOverwrite
+};
+
+class BufferFactory;
+
+// Gives a buffer back to the factory that made it.
+struct BufferDeleter
+{
+	BufferFactory* factory = nullptr;
+
+	void operator()(GpuBuffer* buffer) const noexcept;
+};
+
+using UniqueBuffer = std::unique_ptr<GpuBuffer, BufferDeleter>;
+
+// Creates the GPU buffers a Mesh uploads into. Graphics implements it on top of
+// the D3D11 device; HeadlessBufferFactory stands in when there is no device.
+class BufferFactory
+{
+public:
+
+	virtual ~BufferFactory() = default;
+
+	// An immutable buffer holding byteWidth bytes of data, bound as bindFlags (D3D11_BIND_*).
+	[[nodiscard]] virtual GpuBuffer* CreateStaticBuffer(const void* data, UINT byteWidth, UINT bindFlags) = 0;
+
+	// Buffers that outlive their contents, for BufferPool. Pooled buffers are GPU-only copy destinations with no
+	// initial data; upload buffers are CPU-writable through Map.
+	// The calls below use the immediate context and belong on the render thread.
+	[[nodiscard]] virtual GpuBuffer* CreatePooledBuffer(UINT byteWidth, UINT bindFlags) = 0;
+	[[nodiscard]] virtual GpuBuffer* CreateUploadBuffer(UINT byteWidth) = 0;
+	// Every kind of buffer goes back through here; null is ignored.
+	virtual void ReleaseBuffer(GpuBuffer* buffer) = 0;
+	// Returns the start of the whole buffer, whatever part of it the caller means to write.
+	[[nodiscard]] virtual void* Map(GpuBuffer* buffer, BufferMap mode) = 0;
+	virtual void Unmap(GpuBuffer* buffer) = 0;
+	virtual void CopyBufferRegion(GpuBuffer* destination, UINT destinationOffset, GpuBuffer* source, UINT sourceOffset, UINT byteCount) = 0;
+
+	// Static buffers from any contiguous range, so callers can upload straight from memory they don't own,
+	// such as a mapped mesh cache.
+	template<class Range>
+	[[nodiscard]] UniqueBuffer CreateVertexBuffer(const Range& vertices)
+	{
+		return CreateStatic(std::data(vertices), UINT(std::size(vertices) * sizeof(*std::data(vertices))), D3D11_BIND_VERTEX_BUFFER);
+	}
+
+	template<class Range>
+	[[nodiscard]] UniqueBuffer CreateIndexBuffer(const Range& indices)
+	{
+		return CreateStatic(std::data(indices), UINT(std::size(indices) * sizeof(*std::data(indices))), D3D11_BIND_INDEX_BUFFER);
+	}
+
+	// Uploads 16-bit indices when every index fits, 32-bit otherwise, and reports which format was used.
+	[[nodiscard]] UniqueBuffer CreateCompactIndexBuffer(std::span<const UINT> indices, DXGI_FORMAT& format);
+
+private:
+
+	UniqueBuffer CreateStatic(const void* data, UINT byteWidth, UINT bindFlags);
+};
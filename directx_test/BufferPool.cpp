@@ -0,0 +1,140 @@
+#include "BufferPool.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+PooledBuffer& PooledBuffer::operator=(PooledBuffer&& other) noexcept
+{
+	if (this == &other)
+		return *this;
+
+	Return();
+
+	p_pool = std::exchange(other.p_pool, nullptr);
+	p_buffer = std::exchange(other.p_buffer, nullptr);
+	m_capacity = std::exchange(other.m_capacity, 0);
+	m_bindFlags = std::exchange(other.m_bindFlags, 0);
+
+	return *this;
+}
+
+void PooledBuffer::Return() noexcept
+{
+	if (p_pool && p_buffer)
+		p_pool->Return(p_buffer, m_capacity, m_bindFlags);
+
+	p_pool = nullptr;
+	p_buffer = nullptr;
+	m_capacity = 0;
+}
+
+BufferPool::BufferPool(BufferFactory* device, UINT ringBytes)
+	: p_device(device), m_ringSize(std::max(ringBytes, minimumCapacity)), m_ringHead(m_ringSize)
+{
+	p_ring = p_device->CreateUploadBuffer(m_ringSize);
+}
+
+BufferPool::~BufferPool()
+{
+	Trim();
+	p_device->ReleaseBuffer(p_ring);
+}
+
+UINT BufferPool::CapacityFor(UINT byteWidth) noexcept
+{
+	return std::bit_ceil(std::max(byteWidth, minimumCapacity));
+}
+
+PooledBuffer BufferPool::Acquire(UINT byteWidth, UINT bindFlags)
+{
+	PooledBuffer loan;
+	loan.p_pool = this;
+	loan.m_capacity = CapacityFor(byteWidth);
+	loan.m_bindFlags = bindFlags;
+
+	auto& idle = m_idle[{ loan.m_capacity, bindFlags }];
+
+	if (!idle.empty())
+	{
+		loan.p_buffer = idle.back();
+		idle.pop_back();
+		m_idleBytes -= loan.m_capacity;
+		m_stats.buffersReused++;
+
+		return loan;
+	}
+
+	loan.p_buffer = p_device->CreatePooledBuffer(loan.m_capacity, bindFlags);
+	m_stats.buffersCreated++;
+
+	return loan;
+}
+
+void BufferPool::Fit(PooledBuffer& buffer, UINT byteWidth, UINT bindFlags)
+{
+	if (byteWidth == 0)
+	{
+		buffer = {};
+		return;
+	}
+
+	if (buffer && buffer.m_bindFlags == bindFlags && buffer.Capacity() == CapacityFor(byteWidth))
+		return;
+
+	buffer = Acquire(byteWidth, bindFlags);
+}
+
+void BufferPool::Upload(const PooledBuffer& buffer, UINT byteOffset, const void* data, UINT byteCount)
+{
+	const auto* bytes = static_cast<const std::byte*>(data);
+
+	while (byteCount > 0)
+	{
+		const UINT piece = std::min(byteCount, m_ringSize);
+		auto mode = BufferMap::NoOverwrite;
+
+		// earlier pieces may still be waiting to be copied, so a full ring is renamed rather than reused
+		if (m_ringHead + piece > m_ringSize)
+		{
+			mode = BufferMap::Discard;
+			m_ringHead = 0;
+			m_stats.discards++;
+		}
+
+		auto* ring = static_cast<std::byte*>(p_device->Map(p_ring, mode));
+		std::memcpy(ring + m_ringHead, bytes, piece);
+		p_device->Unmap(p_ring);
+
+		p_device->CopyBufferRegion(buffer.Get(), byteOffset, p_ring, m_ringHead, piece);
+
+		// keep pieces 16-byte aligned in the ring
+		m_ringHead = std::min(m_ringSize, (m_ringHead + piece + 15) & ~15u);
+		bytes += piece;
+		byteOffset += piece;
+		byteCount -= piece;
+
+		m_stats.uploads++;
+		m_stats.bytesUploaded += piece;
+	}
+}
+
+void BufferPool::Trim(size_t keepBytes)
+{
+	for (auto it = m_idle.rbegin(); it != m_idle.rend() && m_idleBytes > keepBytes; ++it)
+	{
+		auto& idle = it->second;
+
+		while (!idle.empty() && m_idleBytes > keepBytes)
+		{
+			p_device->ReleaseBuffer(idle.back());
+			idle.pop_back();
+			m_idleBytes -= it->first.first;
+		}
+	}
+}
+
+void BufferPool::Return(GpuBuffer* buffer, UINT capacity, UINT bindFlags)
+{
+	m_idle[{ capacity, bindFlags }].push_back(buffer);
+	m_idleBytes += capacity;
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include "WinTypes.h"
+#include <map>
+#include <utility>
+#include <vector>
+#include "BufferFactory.h"
+
+class BufferPool;
+
+// A buffer on loan from a BufferPool. It goes back to the pool's free list when destroyed or
+// assigned over, so the pool has to outlive it.
+class PooledBuffer
+{
+public:
+
+	PooledBuffer() = default;
+	PooledBuffer(const PooledBuffer&) = delete;
+	PooledBuffer(PooledBuffer&& other) noexcept { *this = std::move(other); }
+	~PooledBuffer() { Return(); }
+
+	PooledBuffer& operator=(const PooledBuffer&) = delete;
+	PooledBuffer& operator=(PooledBuffer&& other) noexcept;
+
+	constexpr GpuBuffer* Get() const noexcept { return p_buffer; }
+	// bytes the buffer holds, at least what was asked for
+	constexpr UINT Capacity() const noexcept { return m_capacity; }
+	constexpr explicit operator bool() const noexcept { return p_buffer != nullptr; }
+
+private:
+
+	friend class BufferPool;
+
+	void Return() noexcept;
+
+	BufferPool* p_pool = nullptr;
+	GpuBuffer* p_buffer = nullptr;
+	UINT m_capacity = 0;
+	UINT m_bindFlags = 0;
+};
+
+struct BufferPoolStats
+{
+	size_t buffersCreated = 0;
+	// Acquire calls served from the free list
+	size_t buffersReused = 0;
+	// pieces written through the upload ring, and how many of them had to discard it
+	size_t uploads = 0;
+	size_t discards = 0;
+	size_t bytesUploaded = 0;
+};
+
+// Hands out GPU buffers in power of two size classes and takes them back for reuse, so geometry
+// that keeps changing size cycles through a few buffers instead of creating one per change.
+//
+// Contents reach pooled buffers through one CPU-writable ring: each upload is written to the
+// free part of the ring without overwriting, then copied on the GPU into place, so any subrange
+// of a buffer can be replaced without touching the rest. When the ring is full it is discarded
+// and writing starts over at its beginning. Render thread only.
+class BufferPool
+{
+public:
+
+	BufferPool(BufferFactory* device, UINT ringBytes = 4u << 20);
+	BufferPool(const BufferPool&) = delete;
+	BufferPool& operator=(const BufferPool&) = delete;
+	~BufferPool();
+
+	// A buffer of at least byteWidth bytes, from the free list when one of the right class is idle.
+	// Its contents are undefined.
+	PooledBuffer Acquire(UINT byteWidth, UINT bindFlags);
+	// Trades buffer for one of byteWidth's size class unless it already is one; the old one goes back
+	// to the pool. Contents do not carry over. An empty buffer is returned for zero bytes.
+	void Fit(PooledBuffer& buffer, UINT byteWidth, UINT bindFlags);
+	// Copies byteCount bytes into buffer at byteOffset. Pieces larger than the ring are split.
+	void Upload(const PooledBuffer& buffer, UINT byteOffset, const void* data, UINT byteCount);
+	// Frees idle buffers, largest first, until at most keepBytes are left idle.
+	void Trim(size_t keepBytes = 0);
+
+	constexpr const BufferPoolStats& Stats() const noexcept { return m_stats; }
+	constexpr size_t IdleBytes() const noexcept { return m_idleBytes; }
+
+	// the smallest class; smaller requests are rounded up to it
+	static constexpr UINT minimumCapacity = 4096;
+	static UINT CapacityFor(UINT byteWidth) noexcept;
+
+private:
+
+	friend class PooledBuffer;
+
+	void Return(GpuBuffer* buffer, UINT capacity, UINT bindFlags);
+
+	BufferFactory* p_device;
+
+	GpuBuffer* p_ring = nullptr;
+	UINT m_ringSize;
+	// where the next upload goes; starts at the end so the first one discards
+	UINT m_ringHead;
+
+	// idle buffers by capacity and bind flags
+	std::map<std::pair<UINT, UINT>, std::vector<GpuBuffer*>> m_idle;
+	size_t m_idleBytes = 0;
+	BufferPoolStats m_stats;
+};
@@ -1,5 +1,5 @@
 #pragma once
-#include "NormWin.h"
+#include "WinTypes.h"
 #include <DirectXMath.h>
 
 class Camera
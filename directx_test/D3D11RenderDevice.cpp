@@ -0,0 +1,151 @@
+#include "D3D11RenderDevice.h"
+#include <cstring>
+#include <string>
+#include <DirectXColors.h>
+
+D3D11RenderDevice::D3D11RenderDevice(ID3D11Device* device, ID3D11DeviceContext* context, ID3D11RenderTargetView* target, ID3D11DepthStencilView* depthStencil)
+	: p_context(context), p_target(target), p_depthStencil(depthStencil)
+{
+	m_font = std::make_unique<DirectX::SpriteFont>(device, L"myfile.spritefont");
+	m_spriteBatch = std::make_unique<DirectX::SpriteBatch>(context);
+
+	ID3D11DeviceContext1* context1 = nullptr;
+	if (SUCCEEDED(context->QueryInterface(__uuidof(ID3D11DeviceContext1), reinterpret_cast<void**>(&context1))))
+		p_context1.reset(context1);
+}
+
+void D3D11RenderDevice::ClearRenderTarget(const float color[4])
+{
+	p_context->ClearRenderTargetView(p_target, color);
+}
+
+void D3D11RenderDevice::ClearDepthStencil()
+{
+	p_context->ClearDepthStencilView(p_depthStencil, D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
+}
+
+void D3D11RenderDevice::SetViewport(const D3D11_VIEWPORT& viewport)
+{
+	p_context->RSSetViewports(1, &viewport);
+}
+
+void D3D11RenderDevice::SetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY topology)
+{
+	p_context->IASetPrimitiveTopology(topology);
+}
+
+void D3D11RenderDevice::SetInputLayout(ID3D11InputLayout* layout)
+{
+	p_context->IASetInputLayout(layout);
+}
+
+void D3D11RenderDevice::SetVertexBuffers(UINT count, GpuBuffer* const* buffers, const UINT* strides)
+{
+	const UINT offsets[D3D11_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT] = {};
+
+	p_context->IASetVertexBuffers(0, count, reinterpret_cast<ID3D11Buffer* const*>(buffers), strides, offsets);
+}
+
+void D3D11RenderDevice::SetIndexBuffer(GpuBuffer* buffer, DXGI_FORMAT format)
+{
+	p_context->IASetIndexBuffer(ToD3D11(buffer), format, 0);
+}
+
+void D3D11RenderDevice::SetVertexShader(ID3D11VertexShader* shader)
+{
+	p_context->VSSetShader(shader, NULL, 0);
+}
+
+void D3D11RenderDevice::SetPixelShader(ID3D11PixelShader* shader)
+{
+	p_context->PSSetShader(shader, NULL, 0);
+}
+
+void D3D11RenderDevice::SetVertexConstantBuffer(UINT slot, GpuBuffer* buffer)
+{
+	ID3D11Buffer* constants = ToD3D11(buffer);
+	p_context->VSSetConstantBuffers(slot, 1, &constants);
+}
+
+void D3D11RenderDevice::SetVertexConstantBufferRange(UINT slot, GpuBuffer* buffer, UINT offset, UINT byteCount)
+{
+	if (!p_context1)
+		exit(-3);
+
+	// counted in shader constants of 16 bytes
+	const UINT firstConstant = offset / 16;
+	const UINT constantCount = byteCount / 16;
+	ID3D11Buffer* constants = ToD3D11(buffer);
+	p_context1->VSSetConstantBuffers1(slot, 1, &constants, &firstConstant, &constantCount);
+}
+
+void D3D11RenderDevice::SetPixelConstantBuffer(UINT slot, GpuBuffer* buffer)
+{
+	ID3D11Buffer* constants = ToD3D11(buffer);
+	p_context->PSSetConstantBuffers(slot, 1, &constants);
+}
+
+void D3D11RenderDevice::SetPixelShaderResource(UINT slot, ID3D11ShaderResourceView* view)
+{
+	p_context->PSSetShaderResources(slot, 1, &view);
+}
+
+void D3D11RenderDevice::SetPixelSampler(UINT slot, ID3D11SamplerState* sampler)
+{
+	p_context->PSSetSamplers(slot, 1, &sampler);
+}
+
+void D3D11RenderDevice::SetDepthStencilState(ID3D11DepthStencilState* state)
+{
+	p_context->OMSetDepthStencilState(state, 0);
+}
+
+void D3D11RenderDevice::UpdateBuffer(GpuBuffer* buffer, const void* data, UINT byteCount)
+{
+	p_context->UpdateSubresource(ToD3D11(buffer), 0, NULL, data, 0, 0);
+}
+
+void D3D11RenderDevice::WriteBuffer(GpuBuffer* buffer, UINT offset, const void* data, UINT byteCount, BufferMap mode)
+{
+	D3D11_MAPPED_SUBRESOURCE mapped{};
+	HRESULT hr = p_context->Map(ToD3D11(buffer), 0, mode == BufferMap::Discard ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE, 0, &mapped);
+	if (FAILED(hr))
+		exit(-3);
+
+	std::memcpy(static_cast<std::byte*>(mapped.pData) + offset, data, byteCount);
+	p_context->Unmap(ToD3D11(buffer), 0);
+}
+
+void D3D11RenderDevice::DrawIndexed(UINT indexCount, UINT startIndex, INT baseVertex)
+{
+	p_context->DrawIndexed(indexCount, startIndex, baseVertex);
+}
+
+void D3D11RenderDevice::DrawIndexedInstanced(UINT indexCount, UINT instanceCount, UINT startIndex, INT baseVertex, UINT startInstance)
+{
+	p_context->DrawIndexedInstanced(indexCount, instanceCount, startIndex, baseVertex, startInstance);
+}
+
+void D3D11RenderDevice::DrawString(std::wstring_view text, DirectX::XMFLOAT2 position)
+{
+	ID3D11DepthStencilState* st = nullptr;
+	UINT sten = 0;
+	p_context->OMGetDepthStencilState(&st, &sten);
+
+	// SpriteFont wants a terminated string
+	const std::wstring output(text);
+
+	m_spriteBatch->Begin();
+
+	const auto origin = m_font->MeasureString(output.c_str());
+
+	m_font->DrawString(m_spriteBatch.get(), output.c_str(),
+		DirectX::XMLoadFloat2(&position), DirectX::Colors::White, 0.f, origin);
+
+	m_spriteBatch->End();
+
+	p_context->OMSetDepthStencilState(st, sten);
+
+	if (st)
+		st->Release();
+}
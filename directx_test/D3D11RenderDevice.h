@@ -0,0 +1,57 @@
+#pragma once
+#include "NormWin.h"
+#include <memory>
+#include <d3d11_1.h>
+#include <SpriteFont.h>
+#include "DXDeleter.h"
+#include "RenderDevice.h"
+
+// Every GpuBuffer Graphics hands out is an ID3D11Buffer; the handle is the interface pointer itself.
+inline ID3D11Buffer* ToD3D11(GpuBuffer* buffer) noexcept { return reinterpret_cast<ID3D11Buffer*>(buffer); }
+inline GpuBuffer* ToGpuBuffer(ID3D11Buffer* buffer) noexcept { return reinterpret_cast<GpuBuffer*>(buffer); }
+
+// RenderDevice on a D3D11 immediate context, drawing into one render target and depth buffer.
+// Graphics owns the device objects, which have to outlive it.
+class D3D11RenderDevice : public RenderDevice
+{
+public:
+
+	D3D11RenderDevice(ID3D11Device* device, ID3D11DeviceContext* context, ID3D11RenderTargetView* target, ID3D11DepthStencilView* depthStencil);
+	D3D11RenderDevice(const D3D11RenderDevice&) = delete;
+	D3D11RenderDevice& operator=(const D3D11RenderDevice&) = delete;
+
+	void ClearRenderTarget(const float color[4]) override;
+	void ClearDepthStencil() override;
+	void SetViewport(const D3D11_VIEWPORT& viewport) override;
+	void SetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY topology) override;
+
+	void SetInputLayout(ID3D11InputLayout* layout) override;
+	void SetVertexBuffers(UINT count, GpuBuffer* const* buffers, const UINT* strides) override;
+	void SetIndexBuffer(GpuBuffer* buffer, DXGI_FORMAT format) override;
+
+	void SetVertexShader(ID3D11VertexShader* shader) override;
+	void SetPixelShader(ID3D11PixelShader* shader) override;
+	void SetVertexConstantBuffer(UINT slot, GpuBuffer* buffer) override;
+	void SetVertexConstantBufferRange(UINT slot, GpuBuffer* buffer, UINT offset, UINT byteCount) override;
+	void SetPixelConstantBuffer(UINT slot, GpuBuffer* buffer) override;
+	void SetPixelShaderResource(UINT slot, ID3D11ShaderResourceView* view) override;
+	void SetPixelSampler(UINT slot, ID3D11SamplerState* sampler) override;
+	void SetDepthStencilState(ID3D11DepthStencilState* state) override;
+
+	void UpdateBuffer(GpuBuffer* buffer, const void* data, UINT byteCount) override;
+	void WriteBuffer(GpuBuffer* buffer, UINT offset, const void* data, UINT byteCount, BufferMap mode) override;
+	void DrawIndexed(UINT indexCount, UINT startIndex, INT baseVertex) override;
+	void DrawIndexedInstanced(UINT indexCount, UINT instanceCount, UINT startIndex, INT baseVertex, UINT startInstance) override;
+	void DrawString(std::wstring_view text, DirectX::XMFLOAT2 position) override;
+
+private:
+
+	ID3D11DeviceContext* p_context;
+	// null before D3D11.1
+	std::unique_ptr<ID3D11DeviceContext1, DXDeleter<ID3D11DeviceContext1>> p_context1 = nullptr;
+	ID3D11RenderTargetView* p_target;
+	ID3D11DepthStencilView* p_depthStencil;
+
+	std::unique_ptr<DirectX::SpriteFont> m_font = nullptr;
+	std::unique_ptr<DirectX::SpriteBatch> m_spriteBatch = nullptr;
+};
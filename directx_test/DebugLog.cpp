@@ -0,0 +1,22 @@
+#include "DebugLog.h"
+#include <cstdarg>
+#include <cstdio>
+#ifdef _WIN32
+#include "NormWin.h"
+#endif
+
+void DebugLog(const char* format, ...) noexcept
+{
+	char buffer[512];
+
+	va_list args;
+	va_start(args, format);
+	std::vsnprintf(buffer, sizeof(buffer), format, args);
+	va_end(args);
+
+#ifdef _WIN32
+	OutputDebugStringA(buffer);
+#else
+	std::fputs(buffer, stderr);
+#endif
+}
@@ -0,0 +1,4 @@
+#pragma once
+
+// printf into the debugger's output window, or to stderr where there is none
+void DebugLog(const char* format, ...) noexcept;
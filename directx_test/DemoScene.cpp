@@ -0,0 +1,124 @@
+#include "DemoScene.h"
+#include <algorithm>
+#include <DirectXColors.h>
+#include "BufferPool.h"
+#include "GeometryBuffer.h"
+#include "SceneRenderer.h"
+#include "Primitives.h"
+#include "CylinderMovement.h"
+#include "CubeMovementTop.h"
+#include "CubeMovementBottom.h"
+
+namespace
+{
+	const auto sphereColor = DirectX::Colors::PeachPuff;
+}
+
+DemoScene::DemoScene(BufferFactory* factory, BufferPool& pool, GeometryBuffer& geometry, const DemoShaders& shaders,
+	std::wstring_view modelFile)
+	: m_meshes(factory)
+{
+	m_meshes.SetGeometryBuffer(&geometry);
+
+	m_model = m_meshes.Load(modelFile, [](Mesh& mesh)
+		{
+			mesh.GenerateLods();
+			mesh.BuildMeshlets();
+		});
+
+	m_cylinder = m_meshes.Create();
+	auto cylinderMesh = m_meshes.Get(m_cylinder);
+	cylinderMesh->SetVertices(Primitives::Tube().vertices);
+	cylinderMesh->SetIndices(Primitives::Tube().indices);
+
+	// the skybox reads positions alone, so the cube keeps them in a stream of their own
+	m_cube = m_meshes.Create();
+	auto cubeMesh = m_meshes.Get(m_cube);
+	cubeMesh->SetVertexLayout(VertexLayout::Split);
+	cubeMesh->SetVertices(Primitives::Cube().vertices);
+	cubeMesh->SetIndices(Primitives::Cube().indices);
+
+	// same cube seen from inside: shares the cube's vertex buffer, only the winding differs
+	m_sky = m_meshes.Create();
+	auto skyMesh = m_meshes.Get(m_sky);
+	skyMesh->ShareVertices(*cubeMesh);
+	skyMesh->SetIndices(Primitives::CubeInside().indices);
+
+	m_sphere = m_meshes.Create();
+	auto sphereMesh = m_meshes.Get(m_sphere);
+	// retessellated from the mouse wheel, so its buffers cycle through the pool
+	sphereMesh->SetDynamic(&pool);
+	sphereMesh->MakeSphere(m_slices, m_stacks, sphereColor);
+
+	auto obj = m_scene.CreateObject();
+	obj->SetMesh(m_meshes, m_cylinder);
+	obj->GetMeshRenderer().SetPixelShader(shaders.texture);
+	obj->SetUpdateable<CylinderMovement>();
+
+	obj = m_scene.CreateObject();
+	obj->SetMesh(m_meshes, m_model);
+	obj->GetMeshRenderer().SetPixelShader(shaders.texture);
+	obj->GetTransform().scale = { 30.f, 30.f, 30.f };
+	obj->GetTransform().eulerRotation.x = -DirectX::XM_PIDIV2;
+	obj->GetTransform().position = {4.f, 4.f, 4.f};
+
+	obj = m_scene.CreateObject();
+	obj->SetMesh(m_meshes, m_cube);
+	obj->GetMeshRenderer().SetPixelShader(shaders.light);
+	obj->GetTransform().scale = {0.3f, 0.3f, 0.3f};
+	obj->SetUpdateable<CubeMovementTop>();
+
+	obj = m_scene.CreateObject();
+	obj->SetMesh(m_meshes, m_cube);
+	obj->GetMeshRenderer().SetPixelShader(shaders.light);
+	obj->GetTransform().scale = { 0.3f, 0.3f, 0.3f };
+	obj->SetUpdateable<CubeMovementBottom>();
+
+	obj = m_scene.CreateObject();
+	obj->SetMesh(m_meshes, m_sphere);
+	obj->GetMeshRenderer().SetPixelShader(shaders.custom);
+	obj->GetTransform().position = { -4.f, 4.f, 4.f };
+	//obj->SetUpdateable<Rotator>();
+
+	auto pObject = m_scene.CreateUIObject();
+	pObject->SetMesh(m_meshes, m_cube);
+	pObject->GetMeshRenderer().SetPixelShader(shaders.solidColor);
+	pObject->GetTransform().position = {5.f, -2.5f, 0.f};
+}
+
+void DemoScene::Frame(SceneRenderer& renderer, float t, float delta)
+{
+	m_meshes.Get(m_sphere)->PublishRebuild();
+
+	renderer.Render(t);
+
+	for (const auto& o : m_scene.Objects())
+	{
+		if (o->GetUpdateable() != nullptr)
+			o->GetUpdateable()->Update(delta);
+
+		renderer.Draw(*o, t);
+	}
+
+	for (const auto& o : m_scene.UIObjects())
+	{
+		if (o->GetUpdateable() != nullptr)
+			o->GetUpdateable()->Update(delta);
+
+		renderer.DrawUI(*o, t);
+	}
+
+	renderer.Submit();
+}
+
+void DemoScene::ChangeSphereDetail(int steps)
+{
+	m_slices = std::max(m_slices + steps, 3);
+	m_stacks = std::max(m_stacks + steps, 3);
+	m_meshes.Get(m_sphere)->MakeSphereAsync(m_slices, m_stacks, sphereColor);
+}
+
+std::array<const Mesh*, 5> DemoScene::Meshes() const noexcept
+{
+	return { m_meshes.Get(m_model), m_meshes.Get(m_cylinder), m_meshes.Get(m_cube), m_meshes.Get(m_sky), m_meshes.Get(m_sphere) };
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include "WinTypes.h"
+#include <array>
+#include <string_view>
+#include "MeshLibrary.h"
+#include "Scene.h"
+
+class BufferPool;
+class GeometryBuffer;
+class SceneRenderer;
+
+// The pixel shaders of Light.fx the demo draws with. Headless devices take any distinct values.
+struct DemoShaders
+{
+	// PS
+	ID3D11PixelShader* light = nullptr;
+	// PSSolid
+	ID3D11PixelShader* solidColor = nullptr;
+	// PSTexture
+	ID3D11PixelShader* texture = nullptr;
+	// PSCustom
+	ID3D11PixelShader* custom = nullptr;
+};
+
+// The scene WinMain shows: a loaded model, the cylinder, two cubes circling each other, a sphere that
+// is retessellated from the mouse wheel, a UI cube and the sky. Built here so the headless benchmarks
+// replay exactly what the window draws.
+class DemoScene
+{
+public:
+
+	// Static meshes go to geometry, the sphere's buffers cycle through pool; both have to outlive the scene.
+	DemoScene(BufferFactory* factory, BufferPool& pool, GeometryBuffer& geometry, const DemoShaders& shaders,
+		std::wstring_view modelFile = L"Padlock.obj");
+	DemoScene(const DemoScene&) = delete;
+	DemoScene& operator=(const DemoScene&) = delete;
+
+	// Publishes a finished sphere rebuild, starts a frame on renderer, moves every object by delta
+	// seconds and queues it, then submits. The text overlay and presenting are left to the caller.
+	void Frame(SceneRenderer& renderer, float t, float delta);
+	// Adds steps slices and stacks to the sphere, at least 3 of each, and rebuilds it on a worker thread.
+	void ChangeSphereDetail(int steps);
+
+	// the sky mesh for SceneRenderer::SetSky
+	const Mesh* Sky() const noexcept { return m_meshes.Get(m_sky); }
+	// the model, cylinder, cube, sky and sphere
+	std::array<const Mesh*, 5> Meshes() const noexcept;
+	constexpr Scene& GetScene() noexcept { return m_scene; }
+
+private:
+
+	// outlives the scene, whose objects hold references into it
+	MeshLibrary m_meshes;
+	Scene m_scene;
+
+	MeshHandle m_model;
+	MeshHandle m_cylinder;
+	MeshHandle m_cube;
+	MeshHandle m_sky;
+	MeshHandle m_sphere;
+
+	int m_slices = 10;
+	int m_stacks = 10;
+};
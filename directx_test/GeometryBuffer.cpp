@@ -0,0 +1,75 @@
+#include "GeometryBuffer.h"
+
+GeometryRange& GeometryRange::operator=(GeometryRange&& other) noexcept
+{
+	if (this == &other)
+		return *this;
+
+	Free();
+
+	p_owner = std::exchange(other.p_owner, nullptr);
+	m_allocation = std::exchange(other.m_allocation, {});
+	m_indices = other.m_indices;
+
+	return *this;
+}
+
+GpuBuffer* GeometryRange::Buffer() const noexcept
+{
+	if (!p_owner)
+		return nullptr;
+
+	return m_indices ? p_owner->IndexBuffer() : p_owner->VertexBuffer();
+}
+
+void GeometryRange::Free() noexcept
+{
+	if (p_owner)
+		p_owner->Free(*this);
+
+	p_owner = nullptr;
+	m_allocation = {};
+}
+
+GeometryBuffer::GeometryBuffer(BufferFactory* device, UINT vertexCapacity, UINT indexCapacity)
+	: m_uploads(device), m_vertexSpace(vertexCapacity), m_indexSpace(indexCapacity)
+{
+	m_vertexBuffer = m_uploads.Acquire(vertexCapacity * sizeof(SimpleVertex), D3D11_BIND_VERTEX_BUFFER);
+	m_indexBuffer = m_uploads.Acquire(indexCapacity * sizeof(UINT), D3D11_BIND_INDEX_BUFFER);
+}
+
+GeometryRange GeometryBuffer::AllocateVertices(std::span<const SimpleVertex> vertices)
+{
+	return Allocate(m_vertexSpace, m_vertexBuffer, vertices.data(), vertices.size(), sizeof(SimpleVertex));
+}
+
+GeometryRange GeometryBuffer::AllocateIndices(std::span<const UINT> indices)
+{
+	auto range = Allocate(m_indexSpace, m_indexBuffer, indices.data(), indices.size(), sizeof(UINT));
+	range.m_indices = true;
+
+	return range;
+}
+
+GeometryRange GeometryBuffer::Allocate(OffsetAllocator& space, const PooledBuffer& buffer, const void* data, size_t count, UINT stride)
+{
+	GeometryRange range;
+
+	if (count > space.Capacity())
+		return range;
+
+	range.m_allocation = space.Allocate(UINT(count));
+
+	if (!range.m_allocation)
+		return range;
+
+	range.p_owner = this;
+	m_uploads.Upload(buffer, range.First() * stride, data, range.Count() * stride);
+
+	return range;
+}
+
+void GeometryBuffer::Free(const GeometryRange& range) noexcept
+{
+	(range.m_indices ? m_indexSpace : m_vertexSpace).Free(range.m_allocation);
+}
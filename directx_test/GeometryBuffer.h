@@ -0,0 +1,84 @@
+#pragma once
+#include "WinTypes.h"
+#include <span>
+#include "SimpleVertex.h"
+#include "BufferFactory.h"
+#include "BufferPool.h"
+#include "OffsetAllocator.h"
+
+class GeometryBuffer;
+
+// Vertices or indices on loan from a GeometryBuffer. The range is freed when destroyed or assigned
+// over, so the GeometryBuffer has to outlive it.
+class GeometryRange
+{
+public:
+
+	GeometryRange() = default;
+	GeometryRange(const GeometryRange&) = delete;
+	GeometryRange(GeometryRange&& other) noexcept { *this = std::move(other); }
+	~GeometryRange() { Free(); }
+
+	GeometryRange& operator=(const GeometryRange&) = delete;
+	GeometryRange& operator=(GeometryRange&& other) noexcept;
+
+	// the base vertex or start index to draw with; 0 for the empty range
+	constexpr UINT First() const noexcept { return m_allocation.offset; }
+	constexpr UINT Count() const noexcept { return m_allocation.size; }
+	// the GeometryBuffer's vertex or index buffer
+	GpuBuffer* Buffer() const noexcept;
+	constexpr explicit operator bool() const noexcept { return p_owner != nullptr; }
+
+private:
+
+	friend class GeometryBuffer;
+
+	void Free() noexcept;
+
+	GeometryBuffer* p_owner = nullptr;
+	OffsetAllocation m_allocation;
+	bool m_indices = false;
+};
+
+struct GeometryBufferStats
+{
+	// counted in vertices and indices
+	OffsetAllocatorStats vertices;
+	OffsetAllocatorStats indices;
+};
+
+// One vertex buffer and one 32-bit index buffer that static meshes are sub-allocated from, so
+// draws of different meshes need no IA rebinding between them: a mesh becomes a base vertex and
+// a start index. Space is managed by an OffsetAllocator per buffer and filled through a
+// BufferPool's upload ring. Render thread only.
+class GeometryBuffer
+{
+public:
+
+	GeometryBuffer(BufferFactory* device, UINT vertexCapacity = 1u << 19, UINT indexCapacity = 1u << 21);
+	GeometryBuffer(const GeometryBuffer&) = delete;
+	GeometryBuffer& operator=(const GeometryBuffer&) = delete;
+
+	// Copies the vertices in. The empty range when they do not fit.
+	GeometryRange AllocateVertices(std::span<const SimpleVertex> vertices);
+	// Same for indices, which stay relative to their mesh's base vertex.
+	GeometryRange AllocateIndices(std::span<const UINT> indices);
+
+	GpuBuffer* VertexBuffer() const noexcept { return m_vertexBuffer.Get(); }
+	GpuBuffer* IndexBuffer() const noexcept { return m_indexBuffer.Get(); }
+	GeometryBufferStats Stats() const noexcept { return { m_vertexSpace.Stats(), m_indexSpace.Stats() }; }
+
+private:
+
+	friend class GeometryRange;
+
+	GeometryRange Allocate(OffsetAllocator& space, const PooledBuffer& buffer, const void* data, size_t count, UINT stride);
+	void Free(const GeometryRange& range) noexcept;
+
+	// declared first so the two buffers go back to it before it is destroyed
+	BufferPool m_uploads;
+	PooledBuffer m_vertexBuffer;
+	PooledBuffer m_indexBuffer;
+	OffsetAllocator m_vertexSpace;
+	OffsetAllocator m_indexSpace;
+};
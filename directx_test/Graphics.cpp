@@ -1,12 +1,10 @@
 #include "Graphics.h"
 #include <d3dcompiler.h>
 #include <array>
-#include <cmath>
+#include <cstddef>
 #include <D3DX11tex.h>
-#include <DirectXColors.h>
 
 Graphics::Graphics(HWND hWnd, int width, int height)
-	: camera(), uiCamera()
 {
 	CreateDeviceAndSwapChain(hWnd, width, height);
 	CreateRenderTargetView();
@@ -14,18 +12,14 @@ Graphics::Graphics(HWND hWnd, int width, int height)
 	CreateDepthStencilView(format);
 	auto tempTarget = pTarget.get();
 	pContext->OMSetRenderTargets(1, &tempTarget, pDepthStencilView.get());
-	InitializeViewport(width, height);
 	auto blob = CompileAndCreateVertexShader();
 	DefineAndCreateInputLayout(blob);
+	blob = CompileAndCreateInstancedVertexShader();
+	DefineAndCreateInstancedInputLayout(blob);
+	pInstanceBuffer.reset(ToD3D11(CreateUploadBuffer(InstanceCapacity * sizeof(DirectX::XMFLOAT4X4))));
 	CreateConstantBuffer();
-	InitializeMatrices(width, height);
 	CreateTexture();
 
-
-	m_font = std::make_unique<DirectX::SpriteFont>(pDevice.get(), L"myfile.spritefont");
-	m_fontPos = { 600.f, 600.f };
-	m_spriteBatch = std::make_unique<DirectX::SpriteBatch>(pContext.get());
-
 	// skybox
 
 	D3D11_DEPTH_STENCIL_DESC dssDesc;
@@ -37,6 +31,30 @@ Graphics::Graphics(HWND hWnd, int width, int height)
 	ID3D11DepthStencilState* ds = nullptr;
 	pDevice->CreateDepthStencilState(&dssDesc, &ds);
 	DSLessEqual.reset(ds);
+
+	RenderResources resources;
+	resources.vertexShader = pVertexShader;
+	resources.skyVertexShader = skyVS;
+	resources.positionVertexLayout = pPositionVertexLayout;
+	resources.vertexLayout = pVertexLayout;
+	resources.splitVertexLayout = pSplitVertexLayout;
+	resources.instancedVertexShader = pInstancedVertexShader;
+	resources.instancedVertexLayout = pInstancedVertexLayout;
+	resources.instancedSplitVertexLayout = pInstancedSplitVertexLayout;
+	resources.instanceBuffer = ToGpuBuffer(pInstanceBuffer.get());
+	resources.instanceCapacity = InstanceCapacity;
+	resources.frameConstants = ToGpuBuffer(pFrameConstantBuffer.get());
+	resources.objectConstants = ToGpuBuffer(pObjectConstantBuffer.get());
+	resources.pixelConstants = ToGpuBuffer(pPixelConstantBuffer.get());
+	resources.constantRing = ToGpuBuffer(pConstantRing.get());
+	resources.constantRingSize = pConstantRing ? ConstantRingSize : 0;
+	resources.texture = pTextureRV.get();
+	resources.skyTexture = pSkyView.get();
+	resources.sampler = pSamplerLinear.get();
+	resources.skyDepthState = DSLessEqual.get();
+
+	p_renderDevice = std::make_unique<D3D11RenderDevice>(pDevice.get(), pContext.get(), pTarget.get(), pDepthStencilView.get());
+	p_renderer = std::make_unique<SceneRenderer>(p_renderDevice.get(), resources, width, height);
 }
 
 void Graphics::CreateDeviceAndSwapChain(const HWND& hWnd, int width, int height)
@@ -195,17 +213,6 @@ void Graphics::CreateTexture()
 	pSkyView.reset(tempRV);
 }
 
-void Graphics::InitializeViewport(int width, int height)
-{
-	viewport.Width = (FLOAT)width;
-	viewport.Height = (FLOAT)height;
-	viewport.MinDepth = 0.0f;
-	viewport.MaxDepth = 1.0f;
-	viewport.TopLeftX = 0;
-	viewport.TopLeftY = 0;
-	pContext->RSSetViewports(1, &viewport);
-}
-
 ID3DBlob* Graphics::CompileAndCreateVertexShader()
 {
 	ID3DBlob* pVSBlob = nullptr;
@@ -246,6 +253,13 @@ ID3DBlob* Graphics::CompileAndCreateVertexShader()
 		exit(-2);
 	}
 
+	// positions at the start of each vertex, in a split mesh's position stream or an interleaved one's vertices
+	const D3D11_INPUT_ELEMENT_DESC positionLayout = { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 };
+	hr = pDevice->CreateInputLayout(&positionLayout, 1, bbb->GetBufferPointer(), bbb->GetBufferSize(), &pPositionVertexLayout);
+	bbb->Release();
+	if (FAILED(hr))
+		exit(-2);
+
 	return pVSBlob;
 }
 
@@ -256,16 +270,83 @@ void Graphics::DefineAndCreateInputLayout(ID3DBlob* pVSBlob)
 		D3D11_INPUT_ELEMENT_DESC{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
 		D3D11_INPUT_ELEMENT_DESC{ "COLOR", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, sizeof(SimpleVertex::position), D3D11_INPUT_PER_VERTEX_DATA, 0},
 		D3D11_INPUT_ELEMENT_DESC{ "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, sizeof(SimpleVertex::position) + sizeof(SimpleVertex::color), D3D11_INPUT_PER_VERTEX_DATA, 0},
-		D3D11_INPUT_ELEMENT_DESC{ "TEXCOORD", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, sizeof(SimpleVertex::position) + sizeof(SimpleVertex::color) + sizeof(SimpleVertex::normal), D3D11_INPUT_PER_VERTEX_DATA, 0}
+		D3D11_INPUT_ELEMENT_DESC{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, sizeof(SimpleVertex::position) + sizeof(SimpleVertex::color) + sizeof(SimpleVertex::normal), D3D11_INPUT_PER_VERTEX_DATA, 0}
+	};
+	
+	// same semantics fed from two slots: positions alone, then the rest packed as VertexAttributes
+	std::array splitLayout =
+	{
+		D3D11_INPUT_ELEMENT_DESC{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		D3D11_INPUT_ELEMENT_DESC{ "COLOR", 0, DXGI_FORMAT_R32G32B32_FLOAT, 1, offsetof(VertexAttributes, color), D3D11_INPUT_PER_VERTEX_DATA, 0},
+		D3D11_INPUT_ELEMENT_DESC{ "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 1, offsetof(VertexAttributes, normal), D3D11_INPUT_PER_VERTEX_DATA, 0},
+		D3D11_INPUT_ELEMENT_DESC{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 1, offsetof(VertexAttributes, texCoord), D3D11_INPUT_PER_VERTEX_DATA, 0}
 	};
 	
 	HRESULT hr = pDevice->CreateInputLayout(layout.data(), layout.size(), pVSBlob->GetBufferPointer(), pVSBlob->GetBufferSize(), &pVertexLayout);
+	if (SUCCEEDED(hr))
+		hr = pDevice->CreateInputLayout(splitLayout.data(), splitLayout.size(), pVSBlob->GetBufferPointer(), pVSBlob->GetBufferSize(), &pSplitVertexLayout);
 	pVSBlob->Release();
 	if (FAILED(hr))
 		exit(-2);
 
 }
 
+ID3DBlob* Graphics::CompileAndCreateInstancedVertexShader()
+{
+	ID3DBlob* pVSBlob = nullptr;
+	HRESULT hr = CompileShaderFromFile(L"Light.fx", "VSInstanced", "vs_5_0", &pVSBlob);
+	if (FAILED(hr))
+	{
+		MessageBox(NULL,
+			L"The FX file cannot be compiled.  Please run this executable from the directory that contains the FX file.", L"Error", MB_OK);
+
+		exit(-1);
+	}
+
+	hr = pDevice->CreateVertexShader(pVSBlob->GetBufferPointer(), pVSBlob->GetBufferSize(), NULL, &pInstancedVertexShader);
+	if (FAILED(hr))
+	{
+		pVSBlob->Release();
+		exit(-2);
+	}
+
+	return pVSBlob;
+}
+
+void Graphics::DefineAndCreateInstancedInputLayout(ID3DBlob* pVSBlob)
+{
+	// the world matrix of each instance, a row per element, follows the mesh streams in slot 2
+	const auto instanceElement = [](UINT row)
+	{
+		return D3D11_INPUT_ELEMENT_DESC{ "WORLD", row, DXGI_FORMAT_R32G32B32A32_FLOAT, 2, row * sizeof(DirectX::XMFLOAT4), D3D11_INPUT_PER_INSTANCE_DATA, 1 };
+	};
+
+	std::array layout =
+	{
+		D3D11_INPUT_ELEMENT_DESC{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		D3D11_INPUT_ELEMENT_DESC{ "COLOR", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, sizeof(SimpleVertex::position), D3D11_INPUT_PER_VERTEX_DATA, 0},
+		D3D11_INPUT_ELEMENT_DESC{ "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, sizeof(SimpleVertex::position) + sizeof(SimpleVertex::color), D3D11_INPUT_PER_VERTEX_DATA, 0},
+		D3D11_INPUT_ELEMENT_DESC{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, sizeof(SimpleVertex::position) + sizeof(SimpleVertex::color) + sizeof(SimpleVertex::normal), D3D11_INPUT_PER_VERTEX_DATA, 0},
+		instanceElement(0), instanceElement(1), instanceElement(2), instanceElement(3)
+	};
+
+	std::array splitLayout =
+	{
+		D3D11_INPUT_ELEMENT_DESC{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		D3D11_INPUT_ELEMENT_DESC{ "COLOR", 0, DXGI_FORMAT_R32G32B32_FLOAT, 1, offsetof(VertexAttributes, color), D3D11_INPUT_PER_VERTEX_DATA, 0},
+		D3D11_INPUT_ELEMENT_DESC{ "NORMAL", 0, DXGI_FORMAT_R32G32B32_FLOAT, 1, offsetof(VertexAttributes, normal), D3D11_INPUT_PER_VERTEX_DATA, 0},
+		D3D11_INPUT_ELEMENT_DESC{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 1, offsetof(VertexAttributes, texCoord), D3D11_INPUT_PER_VERTEX_DATA, 0},
+		instanceElement(0), instanceElement(1), instanceElement(2), instanceElement(3)
+	};
+
+	HRESULT hr = pDevice->CreateInputLayout(layout.data(), layout.size(), pVSBlob->GetBufferPointer(), pVSBlob->GetBufferSize(), &pInstancedVertexLayout);
+	if (SUCCEEDED(hr))
+		hr = pDevice->CreateInputLayout(splitLayout.data(), splitLayout.size(), pVSBlob->GetBufferPointer(), pVSBlob->GetBufferSize(), &pInstancedSplitVertexLayout);
+	pVSBlob->Release();
+	if (FAILED(hr))
+		exit(-2);
+}
+
 ID3D11PixelShader* Graphics::CompileAndCreatePixelShader(std::wstring_view fileName, std::string_view shaderName, std::string_view shaderVersion)
 {
 	// Compile the pixel shader
@@ -289,60 +370,88 @@ ID3D11PixelShader* Graphics::CompileAndCreatePixelShader(std::wstring_view fileN
 	return pixelShader;
 }
 
-ID3D11Buffer* Graphics::CreateVertexBuffer(const std::vector<SimpleVertex>& vertices)
-{	
+GpuBuffer* Graphics::CreateStaticBuffer(const void* data, UINT byteWidth, UINT bindFlags)
+{
 	D3D11_BUFFER_DESC bd{};
 	bd.Usage = D3D11_USAGE_DEFAULT;
-	bd.ByteWidth = sizeof(SimpleVertex) * vertices.size();
-	bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+	bd.ByteWidth = byteWidth;
+	bd.BindFlags = bindFlags;
 	bd.CPUAccessFlags = 0;
-	bd.MiscFlags = 0;
 
 	D3D11_SUBRESOURCE_DATA InitData{};
-	InitData.pSysMem = vertices.data();
-	ID3D11Buffer* pVertexBuffer = nullptr;
-	HRESULT hr = pDevice->CreateBuffer(&bd, &InitData, &pVertexBuffer);
+	InitData.pSysMem = data;
+	ID3D11Buffer* pBuffer = nullptr;
+	HRESULT hr = pDevice->CreateBuffer(&bd, &InitData, &pBuffer);
 	if (FAILED(hr))
 		exit(-3);
 
-	return pVertexBuffer;
+	return ToGpuBuffer(pBuffer);
 }
 
-ID3D11Buffer* Graphics::CreateIndexBuffer(const std::vector<UINT>& indices)
+GpuBuffer* Graphics::CreatePooledBuffer(UINT byteWidth, UINT bindFlags)
 {
 	D3D11_BUFFER_DESC bd{};
 	bd.Usage = D3D11_USAGE_DEFAULT;
-	bd.ByteWidth = sizeof(UINT) * indices.size();
-	bd.BindFlags = D3D11_BIND_INDEX_BUFFER;
-	bd.CPUAccessFlags = 0;
+	bd.ByteWidth = byteWidth;
+	bd.BindFlags = bindFlags;
 
-	D3D11_SUBRESOURCE_DATA InitData{};
-	InitData.pSysMem = indices.data();
-	ID3D11Buffer* pIndexBuffer = nullptr;
-	HRESULT hr = pDevice->CreateBuffer(&bd, &InitData, &pIndexBuffer);
+	ID3D11Buffer* pBuffer = nullptr;
+	HRESULT hr = pDevice->CreateBuffer(&bd, nullptr, &pBuffer);
+	if (FAILED(hr))
+		exit(-3);
+
+	return ToGpuBuffer(pBuffer);
+}
+
+GpuBuffer* Graphics::CreateUploadBuffer(UINT byteWidth)
+{
+	// no-overwrite maps are only allowed on vertex and index buffers, so the ring is declared as one
+	D3D11_BUFFER_DESC bd{};
+	bd.Usage = D3D11_USAGE_DYNAMIC;
+	bd.ByteWidth = byteWidth;
+	bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+	bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+	ID3D11Buffer* pBuffer = nullptr;
+	HRESULT hr = pDevice->CreateBuffer(&bd, nullptr, &pBuffer);
 	if (FAILED(hr))
 		exit(-3);
-	
-	return pIndexBuffer;
 
+	return ToGpuBuffer(pBuffer);
+}
+
+void Graphics::ReleaseBuffer(GpuBuffer* buffer)
+{
+	if (buffer)
+		ToD3D11(buffer)->Release();
 }
 
+void* Graphics::Map(GpuBuffer* buffer, BufferMap mode)
+{
+	D3D11_MAPPED_SUBRESOURCE mapped{};
+	HRESULT hr = pContext->Map(ToD3D11(buffer), 0, mode == BufferMap::Discard ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE, 0, &mapped);
+	if (FAILED(hr))
+		exit(-3);
 
-void Graphics::Draw(const SceneObject& obj, float t)
+	return mapped.pData;
+}
+
+void Graphics::Unmap(GpuBuffer* buffer)
 {
-	DrawOld(obj, view, projection, t);
+	pContext->Unmap(ToD3D11(buffer), 0);
 }
 
-void Graphics::DrawUI(const SceneObject& obj, float t)
+void Graphics::CopyBufferRegion(GpuBuffer* destination, UINT destinationOffset, GpuBuffer* source, UINT sourceOffset, UINT byteCount)
 {
-	DrawOld(obj, uiView, uiProjection, t);
+	const D3D11_BOX box{ sourceOffset, 0, 0, sourceOffset + byteCount, 1, 1 };
+	pContext->CopySubresourceRegion(ToD3D11(destination), 0, destinationOffset, 0, 0, ToD3D11(source), 0, &box);
 }
 
 void Graphics::CreateConstantBuffer()
 {
 	D3D11_BUFFER_DESC bd{};
 	bd.Usage = D3D11_USAGE_DEFAULT;
-	bd.ByteWidth = sizeof(VertexConstantBuffer);
+	bd.ByteWidth = sizeof(FrameConstantBuffer);
 	bd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
 	bd.CPUAccessFlags = 0;
 	ID3D11Buffer* tempcb = nullptr;
@@ -350,7 +459,16 @@ void Graphics::CreateConstantBuffer()
 	if (FAILED(hr))
 		exit(-3);
 
-	pVertexConstantBuffer.reset(tempcb);
+	pFrameConstantBuffer.reset(tempcb);
+
+	tempcb = nullptr;
+	bd.ByteWidth = sizeof(ObjectConstantBuffer);
+
+	hr = pDevice->CreateBuffer(&bd, NULL, &tempcb);
+	if (FAILED(hr))
+		exit(-3);
+
+	pObjectConstantBuffer.reset(tempcb);
 
 	tempcb = nullptr;
 	bd.ByteWidth = sizeof(PixelConstantBuffer);
@@ -360,18 +478,23 @@ void Graphics::CreateConstantBuffer()
 		exit(-3);
 
 	pPixelConstantBuffer.reset(tempcb);
-}
 
-void Graphics::InitializeMatrices(int width, int height)
-{
-	camera.SetRotation(0, 0, 0);
-	camera.SetPosition(0, 0, -5);
-	uiCamera.SetRotation(0, 0, 0);
-	uiCamera.SetPosition(0, 0, -5);
-
-	// Initialize the projection matrix
-	projection = DirectX::XMMatrixPerspectiveFovLH(DirectX::XM_PIDIV2, width / (FLOAT)height, 0.01f, 1000.0f);
-	uiProjection = DirectX::XMMatrixOrthographicLH(width / 100, height / 100, 0.01f, 100.0f);
+	// the per-object ring needs offset binds and no-overwrite maps of constant buffers, both D3D11.1
+	D3D11_FEATURE_DATA_D3D11_OPTIONS options{};
+	if (FAILED(pDevice->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options)))
+		|| !options.ConstantBufferOffsetting || !options.MapNoOverwriteOnDynamicConstantBuffer)
+		return;
+
+	tempcb = nullptr;
+	bd.Usage = D3D11_USAGE_DYNAMIC;
+	bd.ByteWidth = ConstantRingSize;
+	bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+
+	hr = pDevice->CreateBuffer(&bd, NULL, &tempcb);
+	if (FAILED(hr))
+		exit(-3);
+
+	pConstantRing.reset(tempcb);
 }
 
 HRESULT Graphics::CompileShaderFromFile(const WCHAR* szFileName, LPCSTR szEntryPoint, LPCSTR szShaderModel, ID3DBlob** ppBlobOut)
@@ -412,128 +535,3 @@ void Graphics::EndFrame()
 	pSwap->Present(1u, 0u);
 }
 
-void Graphics::ClearBuffer(float red, float green, float blue) noexcept
-{
-	const float color[] = {red, green, blue, 1.f};
-	pContext->ClearRenderTargetView(pTarget.get(), color);
-}
-
-void Graphics::Render(float t)
-{
-	//static float t = 0.0f;
-	//t += timer.Mark();
-	//
-	//const auto spin0 = XMMatrixRotationZ(std::sin(t - XM_PI));
-	//const auto translation0 = XMMatrixTranslation(0.f, 2 * std::sin(t - XM_PIDIV4), 0.f);
-    //objects[0].world = spin0 * translation0;
-	//
-	//const auto spin = XMMatrixRotationZ(-t);
-	//const auto translation1 = XMMatrixTranslation(5 * std::cos(t) - 5.f, 5.f * std::abs(std::sin(t)), 5.f * std::sin(t));
-	//const auto scale = XMMatrixScaling(0.3f, 0.3f, 0.3f);
-	//objects[1].world = scale * spin * translation1;
-	//
-	//const auto translation2 = XMMatrixTranslation(5 * std::cos(t) + 5.f, -5.f * std::abs(std::sin(t)), -5.f * std::sin(t));
-	//objects[2].world = scale * spin * translation2;
-	//
-	//uiObjects[0].world = XMMatrixRotationRollPitchYaw(XM_PIDIV2, 0, 0) * XMMatrixTranslation(6, -3, 0);
-	//
-	//
-	currentLightDir.x = std::sin(t);
-	currentLightDir.y = -1.f;
-	currentLightDir.z = std::cos(t);
-
-	ClearBuffer(0.5, 0.5, 0.5);
-	pContext->ClearDepthStencilView(pDepthStencilView.get(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
-
-	auto tempcb = pVertexConstantBuffer.get();
-	pContext->VSSetConstantBuffers(1, 1, &tempcb);
-
-	tempcb = pPixelConstantBuffer.get();
-	pContext->PSSetConstantBuffers(0, 1, &tempcb);
-
-	pContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-	pContext->IASetInputLayout(pVertexLayout);
-	pContext->RSSetViewports(1, &viewport);
-
-	auto tempRV = pTextureRV.get();
-	auto tempSky = pSkyView.get();
-	auto tempSampler = pSamplerLinear.get();
-	pContext->PSSetShaderResources(0, 1, &tempRV);
-	pContext->PSSetShaderResources(1, 1, &tempSky);
-	pContext->PSSetSamplers(0, 1, &tempSampler);
-
-	uiView = DirectX::XMMatrixLookAtLH(uiCamera.Position(), uiCamera.LookAt(), uiCamera.UpVector());
-	view = DirectX::XMMatrixLookAtLH(camera.Position(), camera.LookAt(), camera.UpVector());
-
-	// skybox
-	UINT stride = sizeof(SimpleVertex);
-	UINT offset = 0;
-	auto vb = skyMesh->VertexBuffer();
-	pContext->IASetVertexBuffers(0, 1, &vb, &stride, &offset);
-	pContext->IASetIndexBuffer(skyMesh->IndexBuffer(), DXGI_FORMAT_R32_UINT, 0);
-	VertexConstantBuffer vcb{};
-	vcb.world = DirectX::XMMatrixTranspose(DirectX::XMMatrixScaling(10, 10, 10) * DirectX::XMMatrixTranslationFromVector(camera.Position()));
-	vcb.view = DirectX::XMMatrixTranspose(view);
-	vcb.projection = DirectX::XMMatrixTranspose(projection);
-	pContext->UpdateSubresource(pVertexConstantBuffer.get(), 0, NULL, &vcb, 0, 0);
-	pContext->VSSetShader(skyVS, NULL, 0);
-	pContext->PSSetShader(skyPS, NULL, 0);
-	pContext->OMSetDepthStencilState(DSLessEqual.get(), 0);
-	pContext->DrawIndexed(skyMesh->Indices().size(), 0, 0);
-
-	pContext->VSSetShader(pVertexShader, NULL, 0);
-	pContext->OMSetDepthStencilState(NULL, 0);
-}
-
-void Graphics::DrawText()
-{
-	ID3D11DepthStencilState* st = nullptr;
-	UINT sten = 0;
-	pContext->OMGetDepthStencilState(&st, &sten);
-
-	m_spriteBatch->Begin();
-
-	const auto output = L"Sample Text";
-
-	const auto origin = m_font->MeasureString(output);
-	
-	m_font->DrawString(m_spriteBatch.get(), output,
-		m_fontPos, DirectX::Colors::White, 0.f, origin);
-
-	m_spriteBatch->End();
-
-	pContext->OMSetDepthStencilState(st, sten);
-}
-
-void Graphics::DrawOld(const SceneObject& o, DirectX::XMMATRIX v, DirectX::XMMATRIX proj, float t)
-{
-	UINT stride = sizeof(SimpleVertex);
-	UINT offset = 0;
-	auto vb = o.GetMesh()->VertexBuffer();
-	pContext->IASetVertexBuffers(0, 1, &vb, &stride, &offset);
-	pContext->IASetIndexBuffer(o.GetMesh()->IndexBuffer(), DXGI_FORMAT_R32_UINT, 0);
-
-	const auto pos = o.GetTransform().position;
-	const auto rot = o.GetTransform().eulerRotation;
-	const auto sc = o.GetTransform().scale;
-
-	const auto world = DirectX::XMMatrixScaling(sc.x, sc.y, sc.z) * DirectX::XMMatrixRotationRollPitchYaw(rot.x, rot.y, rot.z) *
-		DirectX::XMMatrixTranslation(pos.x, pos.y, pos.z);
-
-	VertexConstantBuffer vcb{};
-	vcb.world = DirectX::XMMatrixTranspose(world);
-	vcb.view = DirectX::XMMatrixTranspose(v);
-	vcb.projection = DirectX::XMMatrixTranspose(proj);
-	pContext->UpdateSubresource(pVertexConstantBuffer.get(), 0, NULL, &vcb, 0, 0);
-
-	PixelConstantBuffer pcb{};
-	const auto al = .2f;
-	pcb.ambientlLight = { al, al, al, 1.f };
-	pcb.directionalLight = { 1.f, 1.f, 1.f, 1.f };
-	pcb.lightDirection = currentLightDir;
-	pContext->UpdateSubresource(pPixelConstantBuffer.get(), 0, NULL, &pcb, 0, 0);
-
-	pContext->PSSetShader(o.GetMeshRenderer().PixelShader(), NULL, 0);
-	pContext->DrawIndexed(o.GetMesh()->Indices().size(), 0, 0);
-}
-
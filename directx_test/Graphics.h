@@ -1,29 +1,16 @@
 #pragma once
 #include "NormWin.h"
 #include <vector>
-#include "Camera.h"
+#include <memory>
 #include "SimpleVertex.h"
 #include "SceneObject.h"
 #include "DXDeleter.h"
+#include "BufferFactory.h"
 #include "Timer.h"
-#include <SpriteFont.h>
+#include "D3D11RenderDevice.h"
+#include "SceneRenderer.h"
 
-struct VertexConstantBuffer
-{
-	DirectX::XMMATRIX world;
-	DirectX::XMMATRIX view;
-	DirectX::XMMATRIX projection;
-};
-
-struct PixelConstantBuffer
-{
-	DirectX::XMFLOAT4 ambientlLight;
-	DirectX::XMFLOAT4 directionalLight;
-	DirectX::XMFLOAT4 lightDirection;
-	//float sine = 0.f;
-};
-
-class Graphics
+class Graphics : public BufferFactory
 {
 
 public:
@@ -33,15 +20,25 @@ public:
 
 	void SetFullscreenState(bool state);
 	void EndFrame();
-	void ClearBuffer(float red, float green, float blue) noexcept;
-	void Render(float t);
-	void DrawText();
-	[[nodiscard]] ID3D11Buffer* CreateVertexBuffer(const std::vector<SimpleVertex>& newVertices);
-	[[nodiscard]] ID3D11Buffer* CreateIndexBuffer(const std::vector<UINT>& newIndices);
-	void Draw(const SceneObject& obj, float t);
-	void DrawUI(const SceneObject& obj, float t);
+	void ClearBuffer(float red, float green, float blue) noexcept { p_renderer->ClearBuffer(red, green, blue); }
+	void Render(float t) { p_renderer->Render(t); }
+	void DrawText() { p_renderer->DrawText(); }
+	[[nodiscard]] GpuBuffer* CreateStaticBuffer(const void* data, UINT byteWidth, UINT bindFlags) override;
+	[[nodiscard]] GpuBuffer* CreatePooledBuffer(UINT byteWidth, UINT bindFlags) override;
+	[[nodiscard]] GpuBuffer* CreateUploadBuffer(UINT byteWidth) override;
+	void ReleaseBuffer(GpuBuffer* buffer) override;
+	[[nodiscard]] void* Map(GpuBuffer* buffer, BufferMap mode) override;
+	void Unmap(GpuBuffer* buffer) override;
+	void CopyBufferRegion(GpuBuffer* destination, UINT destinationOffset, GpuBuffer* source, UINT sourceOffset, UINT byteCount) override;
+	void Draw(const SceneObject& obj, float t) { p_renderer->Draw(obj, t); }
+	void DrawUI(const SceneObject& obj, float t) { p_renderer->DrawUI(obj, t); }
+	void Submit() { p_renderer->Submit(); }
 	
-	constexpr Camera& GetCamera() noexcept {return camera;}
+	// submits frames through the D3D11 context; the same class runs headless on a RecordingRenderDevice
+	SceneRenderer& GetRenderer() noexcept {return *p_renderer;}
+	Camera& GetCamera() noexcept {return p_renderer->GetCamera();}
+	// counts for the frame started by the last Render call
+	const FrameStats& GetFrameStats() const noexcept {return p_renderer->GetFrameStats();}
 
 	static HRESULT CompileShaderFromFile(const WCHAR* szFileName, LPCSTR szEntryPoint, LPCSTR szShaderModel, ID3DBlob** ppBlobOut);
 	ID3D11PixelShader* CompileAndCreatePixelShader(std::wstring_view fileName, std::string_view shaderName, std::string_view shaderVersion);
@@ -52,46 +49,46 @@ private:
 	[[nodiscard]] DXGI_FORMAT CreateDepthStencilTexture(int width, int height);
 	void CreateDepthStencilView(DXGI_FORMAT format);
 	void CreateTexture();
-	void InitializeViewport(int width, int height);
 	[[nodiscard]] ID3DBlob* CompileAndCreateVertexShader();
 	void DefineAndCreateInputLayout(ID3DBlob* pVSBlob);
+	[[nodiscard]] ID3DBlob* CompileAndCreateInstancedVertexShader();
+	void DefineAndCreateInstancedInputLayout(ID3DBlob* pVSBlob);
 	void CreateConstantBuffer();
-	void InitializeMatrices(int width, int height);
-	void DrawOld(const SceneObject& o, DirectX::XMMATRIX v, DirectX::XMMATRIX proj, float t);
 
 	std::unique_ptr<ID3D11Device, DXDeleter<ID3D11Device>> pDevice = nullptr;
 	std::unique_ptr<IDXGISwapChain, DXDeleter<IDXGISwapChain>> pSwap = nullptr;
 	std::unique_ptr<ID3D11DeviceContext, DXDeleter<ID3D11DeviceContext>> pContext = nullptr;
 	std::unique_ptr<ID3D11RenderTargetView, DXDeleter<ID3D11RenderTargetView>> pTarget = nullptr;
-	std::unique_ptr<ID3D11Buffer, DXDeleter<ID3D11Buffer>> pVertexConstantBuffer = nullptr;
+	std::unique_ptr<ID3D11Buffer, DXDeleter<ID3D11Buffer>> pFrameConstantBuffer = nullptr;
+	std::unique_ptr<ID3D11Buffer, DXDeleter<ID3D11Buffer>> pObjectConstantBuffer = nullptr;
 	std::unique_ptr<ID3D11Buffer, DXDeleter<ID3D11Buffer>> pPixelConstantBuffer = nullptr;
+	// null when the device can't bind constant buffers by offset
+	std::unique_ptr<ID3D11Buffer, DXDeleter<ID3D11Buffer>> pConstantRing = nullptr;
 	std::unique_ptr<ID3D11Texture2D, DXDeleter<ID3D11Texture2D>> pDepthStencil = nullptr;
 	std::unique_ptr<ID3D11DepthStencilView, DXDeleter<ID3D11DepthStencilView>> pDepthStencilView = nullptr;
 	std::unique_ptr<ID3D11ShaderResourceView, DXDeleter<ID3D11ShaderResourceView>> pTextureRV = nullptr;
 	std::unique_ptr<ID3D11SamplerState, DXDeleter<ID3D11SamplerState>> pSamplerLinear = nullptr;
 	std::unique_ptr<ID3D11ShaderResourceView, DXDeleter<ID3D11ShaderResourceView>> pSkyView = nullptr;
 	std::unique_ptr<ID3D11DepthStencilState, DXDeleter<ID3D11DepthStencilState>> DSLessEqual = nullptr;
+	// world matrices of instanced draws, written as a ring by SceneRenderer
+	std::unique_ptr<ID3D11Buffer, DXDeleter<ID3D11Buffer>> pInstanceBuffer = nullptr;
 	ID3D11VertexShader* pVertexShader = nullptr;
 	ID3D11VertexShader* skyVS = nullptr;
+	// POSITION alone in slot 0, for the sky
+	ID3D11InputLayout* pPositionVertexLayout = nullptr;
 	ID3D11InputLayout* pVertexLayout = nullptr;
+	// positions in slot 0, VertexAttributes in slot 1
+	ID3D11InputLayout* pSplitVertexLayout = nullptr;
+	ID3D11VertexShader* pInstancedVertexShader = nullptr;
+	// the two layouts above with a world matrix per instance in slot 2
+	ID3D11InputLayout* pInstancedVertexLayout = nullptr;
+	ID3D11InputLayout* pInstancedSplitVertexLayout = nullptr;
 
-	DirectX::XMMATRIX view;
-	DirectX::XMMATRIX uiView;
-	DirectX::XMMATRIX projection;
-	DirectX::XMMATRIX uiProjection;
-
-	Camera camera;
-	Camera uiCamera;
-
-	DirectX::XMFLOAT4 currentLightDir;
+	static constexpr UINT InstanceCapacity = 4096;
+	// 4096 objects of 256 bytes
+	static constexpr UINT ConstantRingSize = 1 << 20;
 
-	std::unique_ptr<DirectX::SpriteFont> m_font = nullptr;
-	DirectX::XMVECTOR m_fontPos;
-	std::unique_ptr<DirectX::SpriteBatch> m_spriteBatch;
-	D3D11_VIEWPORT viewport;
-
-public:
-	Mesh* skyMesh = nullptr;
-	ID3D11PixelShader* skyPS = nullptr;
+	std::unique_ptr<D3D11RenderDevice> p_renderDevice = nullptr;
+	std::unique_ptr<SceneRenderer> p_renderer = nullptr;
 };
 
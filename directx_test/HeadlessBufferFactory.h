@@ -0,0 +1,123 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <span>
+#include <unordered_map>
+#include <vector>
+#include "BufferFactory.h"
+
+// Hands out no GPU objects for static geometry, only counts what would have been uploaded, so
+// mesh code can run without a device. Safe to call from worker threads.
+//
+// Pooled and upload buffers are faked in memory instead, so BufferPool and dynamic meshes can be
+// checked byte for byte. Their handles only mean something to this factory.
+class HeadlessBufferFactory : public BufferFactory
+{
+public:
+
+	[[nodiscard]] GpuBuffer* CreateStaticBuffer(const void* data, UINT byteWidth, UINT bindFlags) override
+	{
+		m_buffersCreated++;
+		m_bytesUploaded += byteWidth;
+
+		return nullptr;
+	}
+
+	[[nodiscard]] GpuBuffer* CreatePooledBuffer(UINT byteWidth, UINT bindFlags) override
+	{
+		return CreateFake(byteWidth);
+	}
+
+	[[nodiscard]] GpuBuffer* CreateUploadBuffer(UINT byteWidth) override
+	{
+		return CreateFake(byteWidth);
+	}
+
+	void ReleaseBuffer(GpuBuffer* buffer) override
+	{
+		std::lock_guard lock(m_mutex);
+		m_fakes.erase(buffer);
+	}
+
+	[[nodiscard]] void* Map(GpuBuffer* buffer, BufferMap mode) override
+	{
+		auto& bytes = Fake(buffer);
+
+		// a discarded buffer comes back with garbage, as it may on a real device
+		if (mode == BufferMap::Discard)
+		{
+			std::fill(bytes.begin(), bytes.end(), std::byte{ 0xCD });
+			m_discardMaps++;
+		}
+		else
+		{
+			m_noOverwriteMaps++;
+		}
+
+		return bytes.data();
+	}
+
+	void Unmap(GpuBuffer* buffer) override
+	{
+	}
+
+	void CopyBufferRegion(GpuBuffer* destination, UINT destinationOffset, GpuBuffer* source, UINT sourceOffset, UINT byteCount) override
+	{
+		auto& to = Fake(destination);
+		const auto& from = Fake(source);
+
+		if (size_t(destinationOffset) + byteCount > to.size() || size_t(sourceOffset) + byteCount > from.size())
+			throw std::runtime_error("buffer copy out of range");
+
+		std::copy_n(from.begin() + sourceOffset, byteCount, to.begin() + destinationOffset);
+		m_bytesUploaded += byteCount;
+	}
+
+	// the current bytes of a pooled or upload buffer
+	std::span<const std::byte> Contents(GpuBuffer* buffer) { return Fake(buffer); }
+
+	size_t BuffersCreated() const noexcept { return m_buffersCreated; }
+	size_t BytesUploaded() const noexcept { return m_bytesUploaded; }
+	// pooled and upload buffers not yet released
+	size_t LiveFakeBuffers() const { std::lock_guard lock(m_mutex); return m_fakes.size(); }
+	size_t DiscardMaps() const noexcept { return m_discardMaps; }
+	size_t NoOverwriteMaps() const noexcept { return m_noOverwriteMaps; }
+
+private:
+
+	GpuBuffer* CreateFake(UINT byteWidth)
+	{
+		auto bytes = std::make_unique<std::vector<std::byte>>(byteWidth);
+		// the vector's address is only a name for the buffer; nothing dereferences it as one
+		auto* handle = reinterpret_cast<GpuBuffer*>(bytes.get());
+
+		std::lock_guard lock(m_mutex);
+		m_fakes.emplace(handle, std::move(bytes));
+		m_buffersCreated++;
+
+		return handle;
+	}
+
+	std::vector<std::byte>& Fake(GpuBuffer* buffer)
+	{
+		std::lock_guard lock(m_mutex);
+		const auto found = m_fakes.find(buffer);
+
+		if (found == m_fakes.end())
+			throw std::runtime_error("not a live pooled or upload buffer");
+
+		return *found->second;
+	}
+
+	std::atomic<size_t> m_buffersCreated = 0;
+	std::atomic<size_t> m_bytesUploaded = 0;
+	std::atomic<size_t> m_discardMaps = 0;
+	std::atomic<size_t> m_noOverwriteMaps = 0;
+
+	mutable std::mutex m_mutex;
+	std::unordered_map<GpuBuffer*, std::unique_ptr<std::vector<std::byte>>> m_fakes;
+};
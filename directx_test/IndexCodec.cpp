@@ -0,0 +1,293 @@
+#include "IndexCodec.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace
+{
+	constexpr uint32_t magic = 0x43584449; // "IDXC"
+	constexpr uint8_t version = 1;
+
+	constexpr int edgeSlots = 15;
+	constexpr int vertexSlots = 14;
+
+	constexpr uint8_t noEdge = 0xF;
+	constexpr uint8_t nextVertex = 0;
+	constexpr uint8_t explicitVertex = 0xF;
+
+	struct Edge
+	{
+		UINT a, b;
+	};
+
+	// Ring of the 16 most recent entries; codes only address the first edgeSlots / vertexSlots of them.
+	template<class T>
+	class Fifo
+	{
+	public:
+
+		void Push(T value)
+		{
+			m_items[m_head & 15] = value;
+			m_head++;
+		}
+
+		// slot 0 is the newest entry
+		const T& operator[](int slot) const { return m_items[(m_head - 1 - slot) & 15]; }
+		int Count() const { return m_head < 16 ? int(m_head) : 16; }
+
+	private:
+
+		T m_items[16]{};
+		size_t m_head = 0;
+	};
+
+	void WriteVarint(std::vector<uint8_t>& out, uint32_t value)
+	{
+		while (value >= 0x80)
+		{
+			out.push_back(uint8_t(value | 0x80));
+			value >>= 7;
+		}
+
+		out.push_back(uint8_t(value));
+	}
+
+	bool ReadVarint(const uint8_t*& cursor, const uint8_t* end, uint32_t& value)
+	{
+		value = 0;
+
+		for (int shift = 0; shift < 35; shift += 7)
+		{
+			if (cursor == end)
+				return false;
+
+			const uint8_t byte = *cursor++;
+			value |= uint32_t(byte & 0x7F) << shift;
+
+			if (!(byte & 0x80))
+				return true;
+		}
+
+		return false;
+	}
+
+	uint32_t ZigZag(int32_t v) { return (uint32_t(v) << 1) ^ uint32_t(v >> 31); }
+	int32_t UnZigZag(uint32_t v) { return int32_t(v >> 1) ^ -int32_t(v & 1); }
+
+	// Shared encoder/decoder state; both sides update it identically after every vertex and triangle.
+	struct State
+	{
+		Fifo<Edge> edges;
+		Fifo<UINT> vertices;
+		UINT next = 0;
+		UINT last = 0;
+
+		void PushTriangle(UINT a, UINT b, UINT c)
+		{
+			edges.Push({ a, b });
+			edges.Push({ b, c });
+			edges.Push({ c, a });
+		}
+
+		void Accept(UINT v, uint8_t code)
+		{
+			if (code == nextVertex)
+				next++;
+
+			if (code == nextVertex || code == explicitVertex)
+				vertices.Push(v);
+
+			last = v;
+		}
+	};
+
+	uint8_t VertexCode(const State& state, UINT v)
+	{
+		if (v == state.next)
+			return nextVertex;
+
+		for (int slot = 0; slot < std::min(state.vertices.Count(), vertexSlots); slot++)
+			if (state.vertices[slot] == v)
+				return uint8_t(slot + 1);
+
+		return explicitVertex;
+	}
+
+	void EncodeVertex(State& state, UINT v, uint8_t code, std::vector<uint8_t>& tail)
+	{
+		if (code == explicitVertex)
+			WriteVarint(tail, ZigZag(int32_t(v - state.last)));
+
+		state.Accept(v, code);
+	}
+
+	bool DecodeVertex(State& state, uint8_t code, const uint8_t*& cursor, const uint8_t* end, UINT& v)
+	{
+		if (code == nextVertex)
+		{
+			v = state.next;
+		}
+		else if (code == explicitVertex)
+		{
+			uint32_t delta;
+			if (!ReadVarint(cursor, end, delta))
+				return false;
+
+			v = state.last + UINT(UnZigZag(delta));
+		}
+		else
+		{
+			if (code - 1 >= state.vertices.Count())
+				return false;
+
+			v = state.vertices[code - 1];
+		}
+
+		state.Accept(v, code);
+
+		return true;
+	}
+}
+
+std::vector<uint8_t> IndexCodec::Encode(const std::vector<UINT>& indices)
+{
+	// Decode only accepts whole triangles, so a stray index would make a stream nothing can read back
+	if (indices.size() % 3 != 0)
+		throw std::runtime_error("index count is not a multiple of 3");
+
+	std::vector<uint8_t> out;
+	out.reserve(indices.size() + 16);
+
+	const uint32_t count = uint32_t(indices.size());
+	out.resize(sizeof(magic) + 1 + sizeof(count));
+	std::memcpy(out.data(), &magic, sizeof(magic));
+	out[sizeof(magic)] = version;
+	std::memcpy(out.data() + sizeof(magic) + 1, &count, sizeof(count));
+
+	State state;
+	std::vector<uint8_t> tail;
+
+	for (size_t t = 0; t + 2 < indices.size(); t += 3)
+	{
+		const UINT tri[3] = { indices[t], indices[t + 1], indices[t + 2] };
+
+		// a neighbour that shares edge (a, b) stored it as (b, a)
+		int edgeSlot = -1, rotation = 0;
+
+		for (int slot = 0; slot < std::min(state.edges.Count(), edgeSlots) && edgeSlot < 0; slot++)
+		{
+			for (int r = 0; r < 3; r++)
+			{
+				if (state.edges[slot].a == tri[(r + 1) % 3] && state.edges[slot].b == tri[r])
+				{
+					edgeSlot = slot;
+					rotation = r;
+					break;
+				}
+			}
+		}
+
+		tail.clear();
+
+		if (edgeSlot >= 0)
+		{
+			const UINT a = tri[rotation], b = tri[(rotation + 1) % 3], c = tri[(rotation + 2) % 3];
+			const uint8_t code = VertexCode(state, c);
+
+			out.push_back(uint8_t(edgeSlot << 4 | code));
+			EncodeVertex(state, c, code, tail);
+			state.PushTriangle(a, b, c);
+		}
+		else
+		{
+			const uint8_t codeA = VertexCode(state, tri[0]);
+			EncodeVertex(state, tri[0], codeA, tail);
+			const uint8_t codeB = VertexCode(state, tri[1]);
+			EncodeVertex(state, tri[1], codeB, tail);
+			const uint8_t codeC = VertexCode(state, tri[2]);
+			EncodeVertex(state, tri[2], codeC, tail);
+
+			out.push_back(uint8_t(noEdge << 4 | codeA));
+			out.push_back(uint8_t(codeB << 4 | codeC));
+			state.PushTriangle(tri[0], tri[1], tri[2]);
+		}
+
+		out.insert(out.end(), tail.begin(), tail.end());
+	}
+
+	return out;
+}
+
+bool IndexCodec::Decode(const uint8_t* data, size_t size, std::vector<UINT>& indices)
+{
+	constexpr size_t headerSize = sizeof(magic) + 1 + sizeof(uint32_t);
+
+	if (size < headerSize)
+		return false;
+
+	uint32_t fileMagic, count;
+	std::memcpy(&fileMagic, data, sizeof(fileMagic));
+	std::memcpy(&count, data + sizeof(magic) + 1, sizeof(count));
+
+	if (fileMagic != magic || data[sizeof(magic)] != version || count % 3 != 0)
+		return false;
+
+	// every triangle takes at least its code byte, so a count the data cannot hold is rejected before allocating
+	if (count / 3 > size - headerSize)
+		return false;
+
+	indices.resize(count);
+
+	const uint8_t* cursor = data + headerSize;
+	const uint8_t* end = data + size;
+
+	State state;
+	UINT* out = indices.data();
+
+	for (uint32_t t = 0; t < count; t += 3)
+	{
+		if (cursor == end)
+			return false;
+
+		const uint8_t code = *cursor++;
+		const uint8_t edgeSlot = code >> 4;
+
+		if (edgeSlot != noEdge)
+		{
+			if (edgeSlot >= state.edges.Count())
+				return false;
+
+			const Edge shared = state.edges[edgeSlot];
+			UINT c;
+
+			if (!DecodeVertex(state, code & 0xF, cursor, end, c))
+				return false;
+
+			*out++ = shared.b;
+			*out++ = shared.a;
+			*out++ = c;
+			state.PushTriangle(shared.b, shared.a, c);
+		}
+		else
+		{
+			if (cursor == end)
+				return false;
+
+			const uint8_t codes = *cursor++;
+			UINT a, b, c;
+
+			if (!DecodeVertex(state, code & 0xF, cursor, end, a) ||
+				!DecodeVertex(state, codes >> 4, cursor, end, b) ||
+				!DecodeVertex(state, codes & 0xF, cursor, end, c))
+				return false;
+
+			*out++ = a;
+			*out++ = b;
+			*out++ = c;
+			state.PushTriangle(a, b, c);
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,21 @@
+#pragma once
+#include "WinTypes.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Compact on-disk encoding for triangle list indices.
+//
+// Each triangle costs one code byte, plus one more byte if it shares no edge with a recent triangle
+// and a varint for every vertex that is neither new nor recently used. Triangles may come back
+// rotated (b, c, a instead of a, b, c); winding and the set of triangles are preserved exactly.
+// Works best on indices that went through IndexOptimizer, where vertices are in first-use order.
+class IndexCodec
+{
+public:
+
+	// Throws std::runtime_error unless the count is a multiple of 3.
+	static std::vector<uint8_t> Encode(const std::vector<UINT>& indices);
+	// Returns false if data is truncated or not an encoded index stream.
+	static bool Decode(const uint8_t* data, size_t size, std::vector<UINT>& indices);
+};
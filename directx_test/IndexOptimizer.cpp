@@ -0,0 +1,445 @@
+#include "IndexOptimizer.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+using namespace DirectX;
+
+namespace
+{
+	constexpr int scoringCacheSize = 32;
+	constexpr float cacheDecayPower = 1.5f;
+	constexpr float lastTriangleScore = 0.75f;
+	constexpr float valenceBoostScale = 2.f;
+	constexpr float valenceBoostPower = 0.5f;
+
+	// the cache a cluster is judged against when looking for overdraw split points
+	constexpr unsigned clusterCacheSize = 16;
+
+	float VertexScore(int cachePosition, UINT remainingValence)
+	{
+		if (remainingValence == 0)
+			return -1.f;
+
+		float score = 0.f;
+
+		if (cachePosition >= 0)
+		{
+			if (cachePosition < 3)
+			{
+				score = lastTriangleScore;
+			}
+			else
+			{
+				const float scaler = 1.f / (scoringCacheSize - 3);
+				score = std::pow(1.f - (cachePosition - 3) * scaler, cacheDecayPower);
+			}
+		}
+
+		return score + valenceBoostScale * std::pow(float(remainingValence), -valenceBoostPower);
+	}
+
+	// Simulated FIFO cache that remembers when each vertex entered it.
+	class FifoCache
+	{
+	public:
+
+		FifoCache(size_t vertexCount, unsigned size) : m_stamps(vertexCount, 0), m_size(size) {}
+
+		bool Touch(UINT v)
+		{
+			if (m_time - m_stamps[v] < m_size && m_stamps[v] != 0)
+				return true;
+
+			m_stamps[v] = ++m_time;
+			return false;
+		}
+
+		void Reset() { m_time += m_size + 1; }
+
+	private:
+
+		std::vector<size_t> m_stamps;
+		size_t m_time = 0;
+		unsigned m_size;
+	};
+}
+
+void IndexOptimizer::OptimizeVertexCache(std::vector<UINT>& indices, size_t vertexCount)
+{
+	const size_t triangleCount = indices.size() / 3;
+
+	if (triangleCount == 0)
+		return;
+
+	// vertex -> adjacent triangles, stored as one flat list with offsets
+	std::vector<UINT> valence(vertexCount, 0);
+	for (const auto i : indices)
+		valence[i]++;
+
+	std::vector<UINT> offsets(vertexCount + 1, 0);
+	std::partial_sum(valence.begin(), valence.end(), offsets.begin() + 1);
+
+	std::vector<UINT> adjacency(indices.size());
+	{
+		auto cursor = offsets;
+		for (size_t t = 0; t < triangleCount; t++)
+			for (int k = 0; k < 3; k++)
+				adjacency[cursor[indices[t * 3 + k]]++] = UINT(t);
+	}
+
+	std::vector<int> cachePosition(vertexCount, -1);
+	std::vector<float> vertexScore(vertexCount);
+	for (size_t v = 0; v < vertexCount; v++)
+		vertexScore[v] = VertexScore(-1, valence[v]);
+
+	std::vector<float> triangleScore(triangleCount);
+	for (size_t t = 0; t < triangleCount; t++)
+		triangleScore[t] = vertexScore[indices[t * 3]] + vertexScore[indices[t * 3 + 1]] + vertexScore[indices[t * 3 + 2]];
+
+	std::vector<bool> emitted(triangleCount, false);
+	std::vector<UINT> output;
+	output.reserve(indices.size());
+
+	std::vector<UINT> cache, nextCache;
+	cache.reserve(scoringCacheSize + 3);
+	nextCache.reserve(scoringCacheSize + 3);
+
+	size_t fallbackCursor = 0;
+	long long best = -1;
+
+	for (size_t emittedCount = 0; emittedCount < triangleCount; emittedCount++)
+	{
+		if (best < 0)
+		{
+			// nothing adjacent to the cache is left, continue with the next untouched triangle
+			while (emitted[fallbackCursor])
+				fallbackCursor++;
+
+			best = static_cast<long long>(fallbackCursor);
+		}
+
+		const size_t t = size_t(best);
+		emitted[t] = true;
+
+		nextCache.clear();
+
+		for (int k = 0; k < 3; k++)
+		{
+			const UINT v = indices[t * 3 + k];
+			output.push_back(v);
+			nextCache.push_back(v);
+
+			// drop the triangle from the vertex's live adjacency
+			auto* first = adjacency.data() + offsets[v];
+			auto* last = first + valence[v];
+			std::iter_swap(std::find(first, last, UINT(t)), last - 1);
+			valence[v]--;
+		}
+
+		for (const auto v : cache)
+			if (std::find(nextCache.begin(), nextCache.end(), v) == nextCache.end())
+				nextCache.push_back(v);
+
+		// vertices pushed out of the cache lose their positional score
+		for (size_t c = scoringCacheSize; c < nextCache.size(); c++)
+			cachePosition[nextCache[c]] = -1;
+
+		if (nextCache.size() > scoringCacheSize)
+			nextCache.resize(scoringCacheSize);
+
+		std::swap(cache, nextCache);
+
+		for (size_t c = 0; c < cache.size(); c++)
+			cachePosition[cache[c]] = int(c);
+
+		// rescore everything that touched the cache and pick the best live triangle among them
+		best = -1;
+		float bestScore = -1.f;
+
+		for (const auto v : nextCache)
+		{
+			if (cachePosition[v] == -1)
+			{
+				const float score = VertexScore(-1, valence[v]);
+				const float delta = score - vertexScore[v];
+				vertexScore[v] = score;
+
+				for (UINT a = offsets[v]; a < offsets[v] + valence[v]; a++)
+					triangleScore[adjacency[a]] += delta;
+			}
+		}
+
+		for (const auto v : cache)
+		{
+			const float score = VertexScore(cachePosition[v], valence[v]);
+			const float delta = score - vertexScore[v];
+			vertexScore[v] = score;
+
+			for (UINT a = offsets[v]; a < offsets[v] + valence[v]; a++)
+			{
+				const UINT adjacent = adjacency[a];
+				triangleScore[adjacent] += delta;
+
+				if (triangleScore[adjacent] > bestScore)
+				{
+					bestScore = triangleScore[adjacent];
+					best = adjacent;
+				}
+			}
+		}
+	}
+
+	indices.swap(output);
+}
+
+void IndexOptimizer::OptimizeOverdraw(std::vector<UINT>& indices, const std::vector<SimpleVertex>& vertices, float threshold)
+{
+	const size_t triangleCount = indices.size() / 3;
+
+	if (triangleCount == 0)
+		return;
+
+	// hard boundaries: triangles where the whole cache missed, i.e. the optimizer restarted somewhere else
+	std::vector<size_t> hard;
+	{
+		FifoCache cache(vertices.size(), clusterCacheSize);
+
+		for (size_t t = 0; t < triangleCount; t++)
+		{
+			int misses = 0;
+			for (int k = 0; k < 3; k++)
+				misses += cache.Touch(indices[t * 3 + k]) ? 0 : 1;
+
+			if (t == 0 || misses == 3)
+				hard.push_back(t);
+		}
+	}
+	hard.push_back(triangleCount);
+
+	// soft boundaries: split hard clusters wherever the running ACMR is already within threshold of the cluster's
+	std::vector<size_t> clusters;
+	for (size_t h = 0; h + 1 < hard.size(); h++)
+	{
+		const size_t begin = hard[h], end = hard[h + 1];
+
+		FifoCache cache(vertices.size(), clusterCacheSize);
+		size_t clusterMisses = 0;
+		for (size_t t = begin; t < end; t++)
+			for (int k = 0; k < 3; k++)
+				clusterMisses += cache.Touch(indices[t * 3 + k]) ? 0 : 1;
+
+		const float clusterAcmr = float(clusterMisses) / (end - begin);
+
+		cache.Reset();
+		clusters.push_back(begin);
+
+		size_t start = begin, misses = 0;
+		for (size_t t = begin; t < end; t++)
+		{
+			for (int k = 0; k < 3; k++)
+				misses += cache.Touch(indices[t * 3 + k]) ? 0 : 1;
+
+			const size_t count = t - start + 1;
+
+			if (t + 1 < end && count >= clusterCacheSize && float(misses) / count <= clusterAcmr * threshold)
+			{
+				clusters.push_back(t + 1);
+				cache.Reset();
+				start = t + 1;
+				misses = 0;
+			}
+		}
+	}
+	clusters.push_back(triangleCount);
+
+	XMVECTOR meshCentroid = XMVectorZero();
+	for (const auto& v : vertices)
+		meshCentroid = XMVectorAdd(meshCentroid, XMLoadFloat3(&v.position));
+	meshCentroid = XMVectorScale(meshCentroid, 1.f / std::max<size_t>(1, vertices.size()));
+
+	// clusters facing away from the mesh centre are likely to occlude the rest, so they go first
+	const size_t clusterCount = clusters.size() - 1;
+	std::vector<float> sortKey(clusterCount);
+
+	for (size_t c = 0; c < clusterCount; c++)
+	{
+		XMVECTOR normal = XMVectorZero(), centroid = XMVectorZero();
+		float area = 0.f;
+
+		for (size_t t = clusters[c]; t < clusters[c + 1]; t++)
+		{
+			const auto a = XMLoadFloat3(&vertices[indices[t * 3]].position);
+			const auto b = XMLoadFloat3(&vertices[indices[t * 3 + 1]].position);
+			const auto d = XMLoadFloat3(&vertices[indices[t * 3 + 2]].position);
+
+			const auto n = XMVector3Cross(XMVectorSubtract(b, a), XMVectorSubtract(d, a));
+			const float w = XMVectorGetX(XMVector3Length(n));
+
+			normal = XMVectorAdd(normal, n);
+			centroid = XMVectorAdd(centroid, XMVectorScale(XMVectorAdd(XMVectorAdd(a, b), d), w / 3.f));
+			area += w;
+		}
+
+		if (area > 0.f)
+			centroid = XMVectorScale(centroid, 1.f / area);
+
+		sortKey[c] = XMVectorGetX(XMVector3Dot(XMVectorSubtract(centroid, meshCentroid), XMVector3Normalize(normal)));
+	}
+
+	std::vector<size_t> order(clusterCount);
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return sortKey[a] > sortKey[b]; });
+
+	std::vector<UINT> output;
+	output.reserve(indices.size());
+
+	for (const auto c : order)
+		output.insert(output.end(), indices.begin() + clusters[c] * 3, indices.begin() + clusters[c + 1] * 3);
+
+	indices.swap(output);
+}
+
+CacheStats IndexOptimizer::AnalyzeVertexCache(const std::vector<UINT>& indices, size_t vertexCount, unsigned cacheSize, CacheModel model)
+{
+	CacheStats stats{};
+	stats.triangles = indices.size() / 3;
+
+	std::vector<bool> seen(vertexCount, false);
+
+	if (model == CacheModel::Fifo)
+	{
+		FifoCache cache(vertexCount, cacheSize);
+
+		for (const auto i : indices)
+			stats.transforms += cache.Touch(i) ? 0 : 1;
+	}
+	else
+	{
+		std::vector<UINT> cache;
+		cache.reserve(cacheSize + 1);
+
+		for (const auto i : indices)
+		{
+			const auto it = std::find(cache.begin(), cache.end(), i);
+
+			if (it != cache.end())
+			{
+				std::rotate(cache.begin(), it, it + 1);
+				continue;
+			}
+
+			stats.transforms++;
+			cache.insert(cache.begin(), i);
+
+			if (cache.size() > cacheSize)
+				cache.pop_back();
+		}
+	}
+
+	for (const auto i : indices)
+	{
+		if (!seen[i])
+		{
+			seen[i] = true;
+			stats.uniqueVertices++;
+		}
+	}
+
+	return stats;
+}
+
+void IndexOptimizer::OptimizeVertexFetch(std::vector<SimpleVertex>& vertices, std::vector<UINT>& indices)
+{
+	constexpr UINT unassigned = ~0u;
+
+	std::vector<UINT> remap(vertices.size(), unassigned);
+	std::vector<SimpleVertex> output;
+	output.reserve(vertices.size());
+
+	for (auto& i : indices)
+	{
+		if (remap[i] == unassigned)
+		{
+			remap[i] = UINT(output.size());
+			output.push_back(vertices[i]);
+		}
+
+		i = remap[i];
+	}
+
+	vertices.swap(output);
+}
+
+FetchStats IndexOptimizer::AnalyzeVertexFetch(const std::vector<UINT>& indices, size_t vertexCount, size_t vertexSize,
+	unsigned lineSize, unsigned lineCount)
+{
+	FetchStats stats{};
+
+	if (vertexCount == 0 || vertexSize == 0)
+		return stats;
+
+	FifoCache transformCache(vertexCount, 16);
+	FifoCache lineCache((vertexCount * vertexSize + lineSize - 1) / lineSize, lineCount);
+
+	for (const auto i : indices)
+	{
+		if (transformCache.Touch(i))
+			continue;
+
+		const size_t first = i * vertexSize / lineSize;
+		const size_t last = ((i + 1) * vertexSize - 1) / lineSize;
+
+		for (size_t line = first; line <= last; line++)
+		{
+			stats.lineRequests++;
+
+			if (!lineCache.Touch(UINT(line)))
+			{
+				stats.lineFetches++;
+				stats.bytesFetched += lineSize;
+			}
+		}
+	}
+
+	stats.overfetch = float(stats.bytesFetched) / (vertexCount * vertexSize);
+
+	return stats;
+}
+
+OptimizeResult IndexOptimizer::Optimize(std::vector<SimpleVertex>& vertices, std::vector<UINT>& indices)
+{
+	OptimizeResult result;
+	result.cacheBefore = result.cacheAfter = AnalyzeVertexCache(indices, vertices.size());
+	result.fetchBefore = result.fetchAfter = AnalyzeVertexFetch(indices, vertices.size(), sizeof(SimpleVertex));
+
+	for (const auto passes : { OptimizePasses::All, OptimizePasses::CacheAndFetch, OptimizePasses::VertexFetch })
+	{
+		auto candidateVertices = vertices;
+		auto candidateIndices = indices;
+
+		if (passes != OptimizePasses::VertexFetch)
+			OptimizeVertexCache(candidateIndices, candidateVertices.size());
+
+		if (passes == OptimizePasses::All)
+			OptimizeOverdraw(candidateIndices, candidateVertices);
+
+		OptimizeVertexFetch(candidateVertices, candidateIndices);
+
+		const auto cache = AnalyzeVertexCache(candidateIndices, candidateVertices.size());
+		const auto fetch = AnalyzeVertexFetch(candidateIndices, candidateVertices.size(), sizeof(SimpleVertex));
+
+		if (cache.transforms <= result.cacheBefore.transforms && fetch.overfetch <= result.fetchBefore.overfetch)
+		{
+			vertices.swap(candidateVertices);
+			indices.swap(candidateIndices);
+
+			result.kept = passes;
+			result.cacheAfter = cache;
+			result.fetchAfter = fetch;
+			break;
+		}
+	}
+
+	return result;
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include "WinTypes.h"
+#include <vector>
+#include "SimpleVertex.h"
+
+enum class CacheModel
+{
+	// classic post-transform cache: hits do not refresh an entry
+	Fifo,
+	// hits move the vertex back to the front
+	Lru
+};
+
+struct CacheStats
+{
+	size_t triangles = 0;
+	size_t transforms = 0;
+	size_t uniqueVertices = 0;
+
+	// average cache miss ratio: transforms per triangle, 0.5 is the practical optimum for large grids
+	constexpr float Acmr() const noexcept { return triangles ? float(transforms) / triangles : 0.f; }
+	// average transform to vertex ratio: 1.0 means every vertex is shaded exactly once
+	constexpr float Atvr() const noexcept { return uniqueVertices ? float(transforms) / uniqueVertices : 0.f; }
+};
+
+struct FetchStats
+{
+	size_t bytesFetched = 0;
+	size_t lineFetches = 0;
+	size_t lineRequests = 0;
+
+	// fetched bytes relative to the size of the vertex buffer, 1.0 means each byte is read once
+	float overfetch = 0.f;
+
+	constexpr float MissRate() const noexcept { return lineRequests ? float(lineFetches) / lineRequests : 0.f; }
+};
+
+// The passes IndexOptimizer::Optimize kept, from most to fewest
+enum class OptimizePasses
+{
+	// cache, overdraw and fetch
+	All,
+	// cache and fetch, without the overdraw clusters
+	CacheAndFetch,
+	// vertices into first-use order only; the triangles stay as they were
+	VertexFetch,
+	// every order made the mesh worse, so it is unchanged
+	None
+};
+
+struct OptimizeResult
+{
+	OptimizePasses kept = OptimizePasses::None;
+	CacheStats cacheBefore;
+	CacheStats cacheAfter;
+	FetchStats fetchBefore;
+	FetchStats fetchAfter;
+};
+
+class IndexOptimizer
+{
+public:
+
+	// Runs the cache, overdraw and fetch passes and keeps their order only if neither ACMR nor overfetch
+	// got worse. Otherwise it drops the overdraw pass, then the cache pass, and leaves the mesh as it was
+	// when even the fetch order alone is worse. An already linear grid is one mesh the reorder can hurt.
+	static OptimizeResult Optimize(std::vector<SimpleVertex>& vertices, std::vector<UINT>& indices);
+
+	// Reorders triangles for post-transform cache locality (Forsyth, "Linear-Speed Vertex Cache Optimisation").
+	static void OptimizeVertexCache(std::vector<UINT>& indices, size_t vertexCount);
+
+	// Splits cache-optimized indices into clusters and draws outward-facing clusters first to cut overdraw.
+	// threshold bounds how much ACMR may be given up to get smaller, better sortable clusters.
+	static void OptimizeOverdraw(std::vector<UINT>& indices, const std::vector<SimpleVertex>& vertices, float threshold = 1.05f);
+
+	// Moves vertices into the order the index buffer first references them and rewrites the indices,
+	// so vertex fetch streams through memory. Unreferenced vertices are dropped.
+	static void OptimizeVertexFetch(std::vector<SimpleVertex>& vertices, std::vector<UINT>& indices);
+
+	// Simulates a post-transform cache on the CPU.
+	static CacheStats AnalyzeVertexCache(const std::vector<UINT>& indices, size_t vertexCount,
+		unsigned cacheSize = 16, CacheModel model = CacheModel::Fifo);
+
+	// Simulates vertex fetch through a 16 entry post-transform cache followed by a FIFO cache of memory lines.
+	static FetchStats AnalyzeVertexFetch(const std::vector<UINT>& indices, size_t vertexCount, size_t vertexSize,
+		unsigned lineSize = 64, unsigned lineCount = 256);
+};
@@ -11,6 +11,16 @@ struct VertexShaderInput
 	float2 texCoord : TEXCOORD;
 };
 
+// Per-instance data input to VSInstanced, from vertex buffer slot 2
+struct InstanceInput
+{
+	// rows of the model matrix, untransposed
+	float4 model0 : WORLD0;
+	float4 model1 : WORLD1;
+	float4 model2 : WORLD2;
+	float4 model3 : WORLD3;
+};
+
 // Per-vertex data output from the vertex shader
 struct VertexShaderOutput
 {
@@ -21,14 +31,19 @@ struct VertexShaderOutput
 	float2 texCoord : TEXCOORD;
 };
 
-// Constant buffer provided by effect
-cbuffer VertexShaderConstantBuffer : register(b1)
+// Set once per pass
+cbuffer FrameConstantBuffer : register(b0)
 {
-	matrix modelMatrix;
 	matrix viewMatrix;
 	matrix projectionMatrix;
 };
 
+// Set for each object, usually as a range of a larger buffer
+cbuffer ObjectConstantBuffer : register(b1)
+{
+	matrix modelMatrix;
+};
+
 // Constant buffer provided by effect
 cbuffer PixelShaderConstantBuffer : register(b0)
 {
@@ -38,8 +53,7 @@ cbuffer PixelShaderConstantBuffer : register(b0)
 	//float sine;
 };
 
-// Called for each vertex
-VertexShaderOutput VS(VertexShaderInput input)
+VertexShaderOutput TransformVertex(VertexShaderInput input, matrix model)
 {
 	// Output structure
 	VertexShaderOutput output;
@@ -47,7 +61,7 @@ VertexShaderOutput VS(VertexShaderInput input)
 	// Get the input vertex, and include a W coordinate
 	float4 pos = float4(input.position.xyz, 1.0f);
 	// Apply transforms to that vertex
-	pos = mul(pos, modelMatrix);
+	pos = mul(pos, model);
 	pos = mul(pos, viewMatrix);
 	pos = mul(pos, projectionMatrix);
 	// The result is clip space output
@@ -55,7 +69,7 @@ VertexShaderOutput VS(VertexShaderInput input)
 
 	// Apply model transform to normal
 	float4 normal = float4(input.normal, 0);
-	normal = normalize(mul(normal, modelMatrix));
+	normal = normalize(mul(normal, model));
 	output.normalModel = normal.xyz;
 
 	// Transfer colors
@@ -66,6 +80,18 @@ VertexShaderOutput VS(VertexShaderInput input)
 	return output;
 }
 
+// Called for each vertex
+VertexShaderOutput VS(VertexShaderInput input)
+{
+	return TransformVertex(input, modelMatrix);
+}
+
+// Called for each vertex of each instance; modelMatrix is not used
+VertexShaderOutput VSInstanced(VertexShaderInput input, InstanceInput instance)
+{
+	return TransformVertex(input, matrix(instance.model0, instance.model1, instance.model2, instance.model3));
+}
+
 // Called for each pixel
 float4 PS(VertexShaderOutput input) : SV_TARGET
 {
@@ -107,7 +133,13 @@ struct SKYMAP_VS_OUTPUT    //output structure for skymap vertex shader
     float3 texCoord : TEXCOORD;
 };
 
-SKYMAP_VS_OUTPUT SKYMAP_VS(VertexShaderOutput input)
+// The sky reads positions alone, from slot 0 of either vertex layout
+struct SkyVertexShaderInput
+{
+	float3 position : POSITION;
+};
+
+SKYMAP_VS_OUTPUT SKYMAP_VS(SkyVertexShaderInput input)
 {
     SKYMAP_VS_OUTPUT output = (SKYMAP_VS_OUTPUT)0;
 	float4 pos = float4(input.position.xyz, 1.0f);
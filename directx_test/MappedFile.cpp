@@ -0,0 +1,97 @@
+#include "MappedFile.h"
+
+#ifndef _WIN32
+#include <filesystem>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::Open(const std::wstring& path)
+{
+	Close();
+
+	m_file = CreateFile(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (m_file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size{};
+
+	if (GetFileSizeEx(m_file, &size) && size.QuadPart > 0)
+		m_mapping = CreateFileMapping(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+	if (m_mapping)
+		p_view = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+
+	if (!p_view)
+	{
+		Close();
+		return false;
+	}
+
+	m_size = uint64_t(size.QuadPart);
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (p_view)
+		UnmapViewOfFile(p_view);
+	if (m_mapping)
+		CloseHandle(m_mapping);
+	if (m_file != INVALID_HANDLE_VALUE)
+		CloseHandle(m_file);
+
+	m_file = INVALID_HANDLE_VALUE;
+	m_mapping = nullptr;
+	p_view = nullptr;
+	m_size = 0;
+}
+
+#else
+
+bool MappedFile::Open(const std::wstring& path)
+{
+	Close();
+
+	const int file = open(std::filesystem::path(path).c_str(), O_RDONLY);
+
+	if (file < 0)
+		return false;
+
+	struct stat status{};
+	void* view = MAP_FAILED;
+
+	if (fstat(file, &status) == 0 && status.st_size > 0)
+		view = mmap(nullptr, size_t(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+
+	// the mapping keeps the file alive on its own
+	close(file);
+
+	if (view == MAP_FAILED)
+		return false;
+
+	p_view = static_cast<const uint8_t*>(view);
+	m_size = uint64_t(status.st_size);
+	return true;
+}
+
+void MappedFile::Close()
+{
+	if (p_view)
+		munmap(const_cast<uint8_t*>(p_view), size_t(m_size));
+
+	p_view = nullptr;
+	m_size = 0;
+}
+
+#endif
@@ -0,0 +1,31 @@
+#pragma once
+#include "WinTypes.h"
+#include <cstdint>
+#include <string>
+
+// Read-only mapping of a whole file. Empty files cannot be mapped and fail to open.
+class MappedFile
+{
+public:
+
+	MappedFile() = default;
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+	~MappedFile();
+
+	bool Open(const std::wstring& path);
+	void Close();
+
+	bool IsOpen() const noexcept { return p_view != nullptr; }
+	const uint8_t* Data() const noexcept { return p_view; }
+	uint64_t Size() const noexcept { return m_size; }
+
+private:
+
+#ifdef _WIN32
+	HANDLE m_file = INVALID_HANDLE_VALUE;
+	HANDLE m_mapping = nullptr;
+#endif
+	const uint8_t* p_view = nullptr;
+	uint64_t m_size = 0;
+};
@@ -1,11 +1,23 @@
 #include "Mesh.h"
-#include "Graphics.h"
-#include <WaveFrontReader.h>
+#include "MeshCache.h"
+#include "Timer.h"
+#include "ObjParser.h"
+#include "MeshSimplifier.h"
+#include "Parallel.h"
+#include "MeshBuilder.h"
+#include "DebugLog.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <stdexcept>
 
 Mesh::Mesh(const Mesh& other)
 {
     p_gfx = other.p_gfx;
-    SetVertices(other.m_vertices);
+    p_pool = other.p_pool;
+    p_geometry = other.p_geometry;
+    p_vertices = other.p_vertices;
+    m_vertexLayout = other.m_vertexLayout;
     SetIndices(other.m_indices);
 }
 
@@ -13,30 +25,213 @@ Mesh::~Mesh()
 {
 }
 
-void Mesh::SetVertices(const std::vector<SimpleVertex>& vertices)
+void Mesh::SetVertices(std::span<const SimpleVertex> vertices)
 {
-    m_vertices.clear();
-    std::copy(vertices.begin(), vertices.end(), std::back_inserter(m_vertices));
+    p_vertices = std::make_shared<VertexStore>();
+    p_vertices->vertices.assign(vertices.begin(), vertices.end());
 
     RecreateVertexBuffer();
 }
 
+GpuBuffer* Mesh::IndexBuffer() const noexcept
+{
+    if (p_indexBuffer)
+        return p_indexBuffer.get();
+
+    return m_pooledIndices ? m_pooledIndices.Get() : m_sharedIndices.Buffer();
+}
+
+size_t Mesh::GpuMemory() const noexcept
+{
+    const auto indexBytes = [](DXGI_FORMAT format, size_t count)
+    {
+        return count * (format == DXGI_FORMAT_R16_UINT ? sizeof(USHORT) : sizeof(UINT));
+    };
+
+    size_t bytes = Vertices().size() * sizeof(SimpleVertex) + indexBytes(m_indexFormat, m_indices.size());
+
+    for (const auto& lod : m_lods)
+        bytes += indexBytes(lod.indexFormat, lod.indexCount);
+
+    return bytes;
+}
+
+void Mesh::SetVertexLayout(VertexLayout layout)
+{
+    m_vertexLayout = layout;
+
+    // dynamic meshes stay interleaved and take the layout once they are static again
+    if (!p_vertices || p_pool || p_vertices->layout == layout)
+        return;
+
+    // only the vertex streams change, so LODs and meshlets stay valid
+    EditVertices();
+    UploadVertices();
+}
+
+void Mesh::ShareVertices(const Mesh& other)
+{
+    p_vertices = other.p_vertices;
+    m_vertexLayout = other.m_vertexLayout;
+    m_lods.clear();
+    m_meshlets.clear();
+}
+
+std::vector<SimpleVertex>& Mesh::EditVertices()
+{
+    if (!p_vertices)
+        p_vertices = std::make_shared<VertexStore>();
+    else if (SharesVertices())
+        p_vertices = p_vertices->CopyForEdit();
+
+    return p_vertices->vertices;
+}
+
 void Mesh::RecreateVertexBuffer()
 {
-    p_vertexBuffer.reset(p_gfx->CreateVertexBuffer(m_vertices));
+    m_lods.clear();
+    m_meshlets.clear();
+
+    if (!p_vertices)
+        return;
+
+    // a shared store cannot have changed since it was uploaded
+    if (SharesVertices() && p_vertices->VertexBuffer())
+        return;
+
+    UploadVertices();
 }
 
-void Mesh::SetIndices(const std::vector<UINT>& indices)
+void Mesh::UploadVertices()
 {
-    m_indices.clear();
-    std::copy(indices.begin(), indices.end(), std::back_inserter(m_indices));
+    if (p_pool)
+        p_vertices->Upload(*p_pool);
+    else if (p_geometry && m_vertexLayout == VertexLayout::Interleaved)
+        p_vertices->Upload(*p_geometry, p_gfx);
+    else
+        p_vertices->Upload(p_gfx, m_vertexLayout);
+}
+
+void Mesh::SetIndices(std::span<const UINT> indices)
+{
+    m_indices.assign(indices.begin(), indices.end());
 
     RecreateIndexBuffer();
 }
 
 void Mesh::RecreateIndexBuffer()
 {
-    p_indexBuffer.reset(p_gfx->CreateIndexBuffer(m_indices));
+    m_lods.clear();
+    m_meshlets.clear();
+
+    if (!p_pool)
+    {
+        m_pooledIndices = {};
+        // freed first, so indices that changed count can take their old space back
+        m_sharedIndices = {};
+        p_indexBuffer.reset();
+
+        if (p_geometry && !m_indices.empty())
+            m_sharedIndices = p_geometry->AllocateIndices(m_indices);
+
+        if (m_sharedIndices)
+            m_indexFormat = DXGI_FORMAT_R32_UINT;
+        else
+            p_indexBuffer = p_gfx->CreateCompactIndexBuffer(m_indices, m_indexFormat);
+
+        return;
+    }
+
+    // 32-bit throughout, so no update ever has to change the format
+    const auto bytes = UINT(m_indices.size() * sizeof(UINT));
+    p_indexBuffer.reset();
+    m_sharedIndices = {};
+    m_indexFormat = DXGI_FORMAT_R32_UINT;
+    p_pool->Fit(m_pooledIndices, bytes, D3D11_BIND_INDEX_BUFFER);
+
+    if (bytes > 0)
+        p_pool->Upload(m_pooledIndices, 0, m_indices.data(), bytes);
+}
+
+void Mesh::SetDynamic(BufferPool* pool)
+{
+    if (pool == p_pool)
+        return;
+
+    // a build in flight was made for the other kind of buffer
+    p_rebuilder.reset();
+    p_pool = pool;
+
+    // nothing to upload yet; the first geometry set goes to the right buffers anyway
+    if (Vertices().empty() && m_indices.empty())
+        return;
+
+    // the buffers change kind, which meshes sharing the store must not see
+    EditVertices();
+
+    Rebuild();
+}
+
+void Mesh::SetGeometryBuffer(GeometryBuffer* geometry)
+{
+    if (geometry == p_geometry)
+        return;
+
+    // a build in flight was uploaded for the other kind of buffer
+    p_rebuilder.reset();
+    p_geometry = geometry;
+
+    // an empty mesh moves in with its first upload
+    if (Vertices().empty() && m_indices.empty())
+        return;
+
+    // the vertices move, which meshes sharing the store must not see
+    EditVertices();
+
+    Rebuild();
+}
+
+void Mesh::UpdateVertices(size_t first, std::span<const SimpleVertex> vertices)
+{
+    if (first + vertices.size() > Vertices().size())
+        throw std::runtime_error("vertex update out of range");
+
+    auto& target = EditVertices();
+    std::copy(vertices.begin(), vertices.end(), target.begin() + first);
+
+    // a static mesh, or a store just copied away from its sharers, has nothing to update in place
+    if (!p_pool || !p_vertices->pooledBuffer)
+    {
+        RecreateVertexBuffer();
+        return;
+    }
+
+    m_lods.clear();
+    m_meshlets.clear();
+
+    for (const auto& v : vertices)
+        p_vertices->bounds.Grow(DirectX::XMLoadFloat3(&v.position));
+
+    p_pool->Upload(p_vertices->pooledBuffer, UINT(first * sizeof(SimpleVertex)), vertices.data(), UINT(vertices.size_bytes()));
+}
+
+void Mesh::UpdateIndices(size_t first, std::span<const UINT> indices)
+{
+    if (first + indices.size() > m_indices.size())
+        throw std::runtime_error("index update out of range");
+
+    std::copy(indices.begin(), indices.end(), m_indices.begin() + first);
+
+    if (!p_pool || !m_pooledIndices)
+    {
+        RecreateIndexBuffer();
+        return;
+    }
+
+    m_lods.clear();
+    m_meshlets.clear();
+
+    p_pool->Upload(m_pooledIndices, UINT(first * sizeof(UINT)), indices.data(), UINT(indices.size_bytes()));
 }
 
 void Mesh::Rebuild()
@@ -47,232 +242,335 @@ void Mesh::Rebuild()
 
 void Mesh::Clear()
 {
-    m_vertices.clear();
+    p_vertices.reset();
     m_indices.clear();
-    p_vertexBuffer.reset();
     p_indexBuffer.reset();
+    m_pooledIndices = {};
+    m_sharedIndices = {};
+    m_lods.clear();
+    m_meshlets.clear();
 }
 
-void Mesh::MakeSphere(int slices, int stacks, DirectX::XMVECTORF32 color)
+void Mesh::SetGeometry(std::vector<SimpleVertex>&& vertices, std::vector<UINT>&& indices)
 {
-    Clear();
+    // a new store, so meshes sharing the old one keep their vertices
+    p_vertices = std::make_shared<VertexStore>();
+    p_vertices->vertices = std::move(vertices);
+    m_indices = std::move(indices);
+
+    Rebuild();
+}
+
+void Mesh::Reserve(size_t vertexCount, size_t indexCount)
+{
+    auto& vertices = EditVertices();
+    vertices.reserve(vertices.size() + vertexCount);
+    m_indices.reserve(m_indices.size() + indexCount);
+}
+
+void Mesh::MakeSphere(int slices, int stacks, DirectX::XMVECTORF32 color, SphereNormals normals)
+{
+    MeshBuilder builder;
+    SphereGenerator::Generate(slices, stacks, color, normals, builder);
 
-    std::vector<DirectX::XMVECTOR> positions;
-    positions.reserve((stacks - 1) * slices);
+    DebugLog("%zu\n", size_t(builder.VertexCount()));
+    builder.Finish(*this);
+}
 
-    for (int i = 1; i < stacks; i++)
+void Mesh::MakeSphereAsync(int slices, int stacks, DirectX::XMVECTORF32 color, SphereNormals normals)
+{
+    RebuildAsync([=](std::vector<SimpleVertex>& vertices, std::vector<UINT>& indices)
     {
-        const auto phi = DirectX::XM_PI * i / stacks;
+        SphereGenerator::Generate(slices, stacks, color, normals, vertices, indices);
+    });
+}
 
-        for (int j = 0; j < slices; j++)
-        {
-            float dist = 1.f;
+void Mesh::RebuildAsync(MeshRebuilder::Generator generator)
+{
+    if (!p_rebuilder)
+        p_rebuilder = std::make_unique<MeshRebuilder>(UploadsOnRenderThread() ? nullptr : p_gfx);
 
-            if (i - 1 == (stacks - 1) / 2)
-                dist = 0.2f;
+    p_rebuilder->Request(std::move(generator), m_vertexLayout);
+}
 
-            const auto theta = DirectX::XM_2PI * j / slices;
-            const auto sinphi = std::sin(phi);
+bool Mesh::PublishRebuild()
+{
+    if (!p_rebuilder)
+        return false;
 
-            const auto x = sinphi * std::cos(theta) * dist;
-            const auto y = std::cos(phi);
-            const auto z = sinphi * std::sin(theta) * dist;
+    auto finished = p_rebuilder->TakeFinished();
 
-            positions.push_back(DirectX::XMVectorSet(x, y, z, 0.f));
-        }
+    if (!finished)
+        return false;
+
+    p_vertices = std::make_shared<VertexStore>(std::move(finished->vertices));
+    m_indices.swap(finished->indices);
+
+    // built without uploading, so the geometry goes into the shared or pooled buffers here
+    if (UploadsOnRenderThread())
+    {
+        Rebuild();
+        return true;
     }
 
-    const auto topPosition = DirectX::XMVECTOR{ 0.f, 1.f, 0.f };
-    const auto bottomPosition = DirectX::XMVECTOR{ 0.f, -1.f, 0.f };
+    p_indexBuffer.swap(finished->indexBuffer);
+    m_indexFormat = finished->indexFormat;
+    m_lods.clear();
+    m_meshlets.clear();
 
-    SimpleVertex vertex{};
-    DirectX::XMStoreFloat3(&vertex.color, color);
-    DirectX::XMStoreFloat3(&vertex.position, topPosition);
+    return true;
+}
 
-    // top vertex
-    for (int j = 0; j < slices; j++)
-    {
-        const auto up = DirectX::XMVectorSubtract(topPosition, positions[j]);
-        const auto right = DirectX::XMVectorSubtract(positions[(j + 1) % slices], positions[j]);
+int Mesh::AddVertex(SimpleVertex d)
+{
+    auto& vertices = EditVertices();
+    vertices.push_back(d);
 
-        DirectX::XMStoreFloat3(&vertex.normal, DirectX::XMVector3Cross(up, right));
+    // keeps Bounds() right before the next Rebuild uploads the vertices
+    if (vertices.size() == 1)
+        p_vertices->bounds = MeshBounds::Compute(vertices);
+    else
+        p_vertices->bounds.Grow(DirectX::XMLoadFloat3(&d.position));
 
-        AddVertex(vertex);
+    return vertices.size() - 1;
+}
 
-    }
+void Mesh::AddTriangle(UINT i0, UINT i1, UINT i2)
+{
+    m_indices.insert(m_indices.end(), { i0, i1, i2 });
+}
 
-    // next to top vertices
-    for (int j = 0; j < slices; j++)
-    {
-        DirectX::XMStoreFloat3(&vertex.position, positions[j]);
+void Mesh::AddQuad(UINT i0, UINT i1, UINT i2, UINT i3)
+{
+    m_indices.insert(m_indices.end(), { i0, i1, i2, i0, i2, i3 });
+}
 
-        const auto up = DirectX::XMVectorSubtract(topPosition, positions[j]);
-        const auto right = DirectX::XMVectorSubtract(positions[(j + 1) % slices], positions[j]);
-        const auto down = DirectX::XMVectorSubtract(positions[j + slices], positions[j]);
-        const auto left = DirectX::XMVectorSubtract(positions[(j - 1 + slices) % slices], positions[j]);
+Mesh& Mesh::operator=(const Mesh& other)
+{
+    if (this == &other)
+        return *this;
 
-        DirectX::XMStoreFloat3(&vertex.normal, DirectX::XMVector3Cross(up, right));
-        AddVertex(vertex);
+    p_gfx = other.p_gfx;
+    p_pool = other.p_pool;
+    p_geometry = other.p_geometry;
+    ShareVertices(other);
+    SetIndices(other.m_indices);
 
-        DirectX::XMStoreFloat3(&vertex.normal, DirectX::XMVector3Cross(left, up));
-        AddVertex(vertex);
+    return *this;
+}
 
-        DirectX::XMStoreFloat3(&vertex.normal, DirectX::XMVector3Cross(down, left));
-        AddVertex(vertex);
+void Mesh::LoadFromFile(std::wstring_view fileName)
+{
+    Clear();
 
-        DirectX::XMStoreFloat3(&vertex.normal, DirectX::XMVector3Cross(right, down));
-        AddVertex(vertex);
-    }
+    Timer timer;
+    const bool cached = LoadFromCache(fileName);
 
-    // middle vertices
-    for (int i = 1; i < stacks - 2; i++)
+    if (!cached)
     {
-        for (int j = 0; j < slices; j++)
-        {
-            DirectX::XMStoreFloat3(&vertex.position, positions[j + i * slices]);
+        LoadFromSource(fileName);
 
-            const auto up = DirectX::XMVectorSubtract(positions[j + (i - 1) * slices], positions[j + i * slices]);
-            const auto right = DirectX::XMVectorSubtract(positions[(j + 1) % slices + i * slices], positions[j + i * slices]);
-            const auto down = DirectX::XMVectorSubtract(positions[j + (i + 1)*slices], positions[j + i * slices]);
-            const auto left = DirectX::XMVectorSubtract(positions[(j - 1 + slices) % slices + i * slices], positions[j + i * slices]);
+        if (!MeshCache::Write(fileName, Vertices(), m_indices))
+            DebugLog("failed to write mesh cache\n");
+    }
 
-            DirectX::XMStoreFloat3(&vertex.normal, DirectX::XMVector3Cross(up, right));
-            AddVertex(vertex);
+    DebugLog("%s load took %.2f ms\n", cached ? "cached" : "source", timer.Mark() * 1000.f);
+}
 
-            DirectX::XMStoreFloat3(&vertex.normal, DirectX::XMVector3Cross(left, up));
-            AddVertex(vertex);
+bool Mesh::LoadFromCache(std::wstring_view fileName)
+{
+    MeshCache cache(fileName);
 
-            DirectX::XMStoreFloat3(&vertex.normal, DirectX::XMVector3Cross(down, left));
-            AddVertex(vertex);
+    if (!cache.Open() || !cache.ReadIndices(m_indices))
+        return false;
 
-            DirectX::XMStoreFloat3(&vertex.normal, DirectX::XMVector3Cross(right, down));
-            AddVertex(vertex);
-        }
-    }
+    // vertex buffers are filled straight from the mapping; the vector only backs Vertices()
+    const auto vertices = cache.Vertices();
+    p_vertices = std::make_shared<VertexStore>();
+    p_vertices->vertices.assign(vertices.begin(), vertices.end());
 
-    // before bottom vertices
-    for (int j = 0; j < slices; j++)
+    if (m_vertexLayout == VertexLayout::Interleaved && !UploadsOnRenderThread())
     {
-        DirectX::XMStoreFloat3(&vertex.position, positions[j + (stacks - 2) * slices]);
-
-        const auto up = DirectX::XMVectorSubtract(positions[j + (stacks - 3) * slices], positions[j + (stacks - 2) * slices]);
-        const auto right = DirectX::XMVectorSubtract(positions[(j + 1) % slices + (stacks - 2) * slices], positions[j + (stacks - 2) * slices]);
-        const auto down = DirectX::XMVectorSubtract(bottomPosition, positions[j + (stacks - 2) * slices]);
-        const auto left = DirectX::XMVectorSubtract(positions[(j - 1 + slices) % slices + (stacks - 2) * slices], positions[j + (stacks - 2) * slices]);
+        p_vertices->vertexBuffer = p_gfx->CreateVertexBuffer(vertices);
+        p_vertices->bounds = cache.Bounds();
+    }
+    else
+    {
+        RecreateVertexBuffer();
+    }
 
-        DirectX::XMStoreFloat3(&vertex.normal, DirectX::XMVector3Cross(up, right));
-        AddVertex(vertex);
+    RecreateIndexBuffer();
 
-        DirectX::XMStoreFloat3(&vertex.normal, DirectX::XMVector3Cross(left, up));
-        AddVertex(vertex);
+    return true;
+}
 
-        DirectX::XMStoreFloat3(&vertex.normal, DirectX::XMVector3Cross(down, left));
-        AddVertex(vertex);
+void Mesh::LoadFromSource(std::wstring_view fileName)
+{
+    auto& vertices = EditVertices();
 
-        DirectX::XMStoreFloat3(&vertex.normal, DirectX::XMVector3Cross(right, down));
-        AddVertex(vertex);
-    }
+    Timer timer;
+    ObjParser::Load(fileName, vertices, m_indices);
+    const float parseTime = timer.Mark();
 
-    DirectX::XMStoreFloat3(&vertex.position, bottomPosition);
+    if (vertices.empty())
+        throw std::runtime_error("asds");
 
-    // bottom vertex
-    for (int j = 0; j < slices; j++)
-    {
-        const auto up = DirectX::XMVectorSubtract(positions[j + (stacks - 2) * slices], bottomPosition);
-        const auto right = DirectX::XMVectorSubtract(positions[(j + 1) % slices + (stacks - 2) * slices], bottomPosition);
+    DebugLog("parsed %zu vertices, %zu indices in %.2f ms\n", vertices.size(), m_indices.size(), parseTime * 1000.f);
 
-        DirectX::XMStoreFloat3(&vertex.normal, DirectX::XMVector3Cross(up, right));
+    const auto stats = MeshWelder::Weld(vertices, m_indices);
 
-        AddVertex(vertex);
-    }    
+    DebugLog("welded %zu -> %zu vertices, %zu bytes saved\n", stats.verticesBefore, stats.verticesAfter, stats.BytesSaved());
 
+    // files without vn statements leave every normal zero
+    const bool hasNormals = std::any_of(vertices.begin(), vertices.end(), [](const SimpleVertex& v)
+    {
+        return v.normal.x != 0.f || v.normal.y != 0.f || v.normal.z != 0.f;
+    });
 
-    for (int i = 0; i < slices; i++)
+    if (!hasNormals)
     {
-        AddTriangle(
-            i,
-            4 * ((i + 1) % slices) + slices + 1,
-            4 * i + slices
-        );
-        
-        const UINT b = m_vertices.size() - slices;
-        AddTriangle(
-            b + i,
-            b - slices*4 + i * 4 + 3,
-            b - slices * 4 + ((i + 1) % slices) * 4 + 2
-        );
+        const auto normalStats = NormalGenerator::GenerateNormals(vertices, m_indices, loadNormalSettings);
+        DebugLog("generated normals, %zu vertices split along creases\n", normalStats.VerticesAdded());
     }
 
+    const auto optimized = Optimize();
+    constexpr const char* orders[] = { "cache, overdraw and fetch", "cache and fetch", "fetch", "source" };
 
-    for (int i = 0; i < stacks - 2; i++)
-    {
-        for (int j = 0; j < slices; j++)
-        {
-            AddQuad(
-                slices + 4*slices*i     + 4*j                + 3,
-                slices + 4*slices*i     + 4*((j + 1)%slices) + 2,
-                slices + 4*slices*(i+1) + 4 * ((j + 1) % slices) + 1,
-                slices + 4*slices*(i+1) + 4 * j
-            );
-        }
-    }
+    DebugLog("kept the %s order\n", orders[int(optimized.kept)]);
+    DebugLog("ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n", optimized.cacheBefore.Acmr(), optimized.cacheAfter.Acmr(),
+        optimized.cacheBefore.Atvr(), optimized.cacheAfter.Atvr());
+    DebugLog("fetch miss rate %.3f -> %.3f, overfetch %.3f -> %.3f\n", optimized.fetchBefore.MissRate(), optimized.fetchAfter.MissRate(),
+        optimized.fetchBefore.overfetch, optimized.fetchAfter.overfetch);
 
-    wchar_t buf[16];
-    _itow_s(m_vertices.size(), buf, 10);
-    OutputDebugString(lstrcat(buf, L"\n"));
     Rebuild();
 }
 
-int Mesh::AddVertex(SimpleVertex d)
+OptimizeResult Mesh::Optimize()
 {
-    m_vertices.push_back(d);
-
-    return m_vertices.size() - 1;
+    return IndexOptimizer::Optimize(EditVertices(), m_indices);
 }
 
-void Mesh::AddTriangle(UINT i0, UINT i1, UINT i2)
+WeldStats Mesh::Weld(const WeldSettings& settings)
 {
-    m_indices.push_back(i0);
-    m_indices.push_back(i1);
-    m_indices.push_back(i2);
+    const auto stats = MeshWelder::Weld(EditVertices(), m_indices, settings);
+
+    if (stats.VerticesRemoved() > 0)
+        Rebuild();
+
+    return stats;
 }
 
-void Mesh::AddQuad(UINT i0, UINT i1, UINT i2, UINT i3)
+NormalStats Mesh::GenerateNormals(const NormalSettings& settings)
 {
-    AddTriangle(i0, i1, i2);
-    AddTriangle(i0, i2, i3);
+    Timer timer;
+    const auto stats = NormalGenerator::GenerateNormals(EditVertices(), m_indices, settings);
+    const float time = timer.Mark();
+
+    DebugLog("normals for %zu triangles in %.2f ms, %zu vertices added\n", m_indices.size() / 3, time * 1000.f, stats.VerticesAdded());
+
+    Rebuild();
+
+    return stats;
 }
 
-Mesh& Mesh::operator=(const Mesh& other)
+std::vector<DirectX::XMFLOAT4> Mesh::ComputeTangents() const
 {
-    m_vertices = other.m_vertices;
-    m_indices = other.m_indices;
+    std::vector<DirectX::XMFLOAT4> tangents;
+    NormalGenerator::GenerateTangents(Vertices(), m_indices, tangents);
 
-    return *this;
+    return tangents;
 }
 
-void Mesh::LoadFromFile(std::wstring_view fileName)
+void Mesh::GenerateLods(size_t levels, float reduction)
 {
-    Clear();
+    m_lods.clear();
 
-    WaveFrontReader<UINT> d;
-    d.Load(fileName.data());
+    std::vector<std::vector<UINT>> lodIndices(levels, m_indices);
+    std::vector<float> errors(levels);
 
-    if (d.vertices.empty())
-        throw std::exception("asds");
+    ParallelFor(levels, 1, [&](size_t begin, size_t end)
+    {
+        for (size_t level = begin; level < end; level++)
+        {
+            const auto target = size_t(m_indices.size() * std::pow(reduction, float(level + 1))) / 3 * 3;
+
+            errors[level] = MeshSimplifier::Simplify(Vertices(), lodIndices[level], target);
+            IndexOptimizer::OptimizeVertexCache(lodIndices[level], Vertices().size());
+        }
+    });
 
-    m_vertices.reserve(d.vertices.size());
-        
-    for (const auto& v : d.vertices)
+    size_t previous = m_indices.size();
+
+    for (size_t level = 0; level < levels; level++)
     {
-        m_vertices.emplace_back(
-            DirectX::XMFLOAT3{ v.position.x, v.position.y, v.position.z },
-            DirectX::XMFLOAT3{ 1.f, 1.f, 1.f },
-            DirectX::XMFLOAT3{ v.normal.x, v.normal.y, v.normal.z },
-            DirectX::XMFLOAT2{ v.textureCoordinate.x, v.textureCoordinate.y }
-        );
+        const auto& indices = lodIndices[level];
+
+        // locked seams and borders can stop simplification early; identical levels are not worth a buffer
+        if (indices.empty() || indices.size() >= previous)
+            break;
+
+        MeshLod lod;
+
+        if (p_geometry)
+            lod.sharedIndices = p_geometry->AllocateIndices(indices);
+
+        // a full GeometryBuffer leaves the level a buffer of its own
+        if (lod.sharedIndices)
+            lod.indexFormat = DXGI_FORMAT_R32_UINT;
+        else
+            lod.indexBuffer = p_gfx->CreateCompactIndexBuffer(indices, lod.indexFormat);
+
+        lod.indexCount = UINT(indices.size());
+        lod.error = errors[level];
+        m_lods.push_back(std::move(lod));
+
+        DebugLog("LOD %zu: %zu triangles, error %g\n", level + 1, indices.size() / 3, errors[level]);
+
+        previous = indices.size();
     }
+}
 
-    RecreateVertexBuffer();
-    SetIndices(d.indices);
+bool Mesh::Raycast(DirectX::FXMVECTOR origin, DirectX::FXMVECTOR direction, float& distance) const
+{
+    float sphereDistance;
+    if (m_indices.empty() || !Bounds().sphere.Intersects(origin, direction, sphereDistance))
+        return false;
+
+    const auto nearest = [&](const auto& position)
+    {
+        bool hit = false;
+        distance = FLT_MAX;
+
+        for (size_t i = 0; i + 2 < m_indices.size(); i += 3)
+        {
+            float d;
+            const auto a = DirectX::XMLoadFloat3(&position(m_indices[i]));
+            const auto b = DirectX::XMLoadFloat3(&position(m_indices[i + 1]));
+            const auto c = DirectX::XMLoadFloat3(&position(m_indices[i + 2]));
+
+            if (DirectX::TriangleTests::Intersects(origin, direction, a, b, c, d) && d < distance)
+            {
+                distance = d;
+                hit = true;
+            }
+        }
+
+        return hit;
+    };
+
+    // the tight stream touches a quarter of the memory for the same corners; it lags behind AddVertex until the next upload
+    const auto positions = Positions();
+    const auto& vertices = Vertices();
+
+    if (positions.size() == vertices.size())
+        return nearest([&](UINT v) -> const DirectX::XMFLOAT3& { return positions[v]; });
+
+    return nearest([&](UINT v) -> const DirectX::XMFLOAT3& { return vertices[v].position; });
+}
+
+void Mesh::BuildMeshlets(const MeshletSettings& settings)
+{
+    m_meshlets = MeshletBuilder::Build(Vertices(), m_indices, settings);
+
+    DebugLog("%zu meshlets for %zu triangles\n", m_meshlets.size(), m_indices.size() / 3);
 }
@@ -1,48 +1,174 @@
 #pragma once
-#include "NormWin.h"
+#include "WinTypes.h"
 #include <vector>
 #include <memory>
+#include <span>
 #include <string_view>
 #include "SimpleVertex.h"
-#include "DXDeleter.h"
-#include <DirectXHelpers.h>
+#include "SphereGenerator.h"
+#include "MeshWelder.h"
+#include "NormalGenerator.h"
+#include "IndexOptimizer.h"
+#include "VertexStore.h"
+#include "BufferFactory.h"
+#include "MeshRebuilder.h"
+#include "Meshlet.h"
+
+// A simplified index buffer over the owning mesh's vertex buffer.
+struct MeshLod
+{
+	UniqueBuffer indexBuffer = nullptr;
+	// the indices in the mesh's GeometryBuffer, in place of indexBuffer
+	GeometryRange sharedIndices;
+	DXGI_FORMAT indexFormat = DXGI_FORMAT_R32_UINT;
+	UINT indexCount = 0;
+	// how far the simplified surface strays from the full mesh, in model units
+	float error = 0.f;
+
+	GpuBuffer* IndexBuffer() const noexcept { return indexBuffer ? indexBuffer.get() : sharedIndices.Buffer(); }
+};
 
 class Mesh
 {
 public:
 
-	constexpr Mesh(class Graphics* gfx) : m_vertices(), m_indices(), p_gfx(gfx) {}
+	constexpr Mesh(BufferFactory* gfx) : p_gfx(gfx), p_vertices(), m_indices() {}
+	// Copies share the vertex store and get their own copy of the indices.
 	Mesh(const Mesh& other);
+	Mesh(Mesh&& other) noexcept = default;
 	~Mesh();
 
-	constexpr const std::vector<SimpleVertex>& Vertices() const noexcept { return m_vertices; }
+	const std::vector<SimpleVertex>& Vertices() const noexcept { return p_vertices ? p_vertices->vertices : noVertices; }
 	constexpr const std::vector<UINT>& Indices() const noexcept { return m_indices; }
-	constexpr ID3D11Buffer* VertexBuffer() const noexcept { return p_vertexBuffer.get(); }
-	constexpr ID3D11Buffer* IndexBuffer() const noexcept { return p_indexBuffer.get(); }
+	// whole vertices, or only positions when the layout is Split
+	GpuBuffer* VertexBuffer() const noexcept { return p_vertices ? p_vertices->VertexBuffer() : nullptr; }
+	// the VertexAttributes stream of the Split layout, nullptr otherwise
+	GpuBuffer* AttributeBuffer() const noexcept { return p_vertices ? p_vertices->attributeBuffer.get() : nullptr; }
+	VertexLayout GetVertexLayout() const noexcept { return p_vertices ? p_vertices->layout : m_vertexLayout; }
+	// Tight positions for CPU passes that need nothing else, as of the last upload. Empty unless the layout is Split.
+	std::span<const DirectX::XMFLOAT3> Positions() const noexcept { return p_vertices ? std::span<const DirectX::XMFLOAT3>(p_vertices->positions) : std::span<const DirectX::XMFLOAT3>(); }
+	GpuBuffer* IndexBuffer() const noexcept;
+	// R16_UINT whenever all indices fit, so small meshes upload half the index memory; always R32_UINT for
+	// dynamic meshes and indices in a GeometryBuffer
+	constexpr DXGI_FORMAT IndexFormat() const noexcept { return m_indexFormat; }
+
+	// Level 0 is the mesh itself; higher levels exist after GenerateLods and get coarser.
+	constexpr size_t LodCount() const noexcept { return m_lods.size() + 1; }
+	GpuBuffer* IndexBuffer(size_t lod) const noexcept { return lod ? m_lods[lod - 1].IndexBuffer() : IndexBuffer(); }
+	constexpr DXGI_FORMAT IndexFormat(size_t lod) const noexcept { return lod ? m_lods[lod - 1].indexFormat : IndexFormat(); }
+	constexpr UINT IndexCount(size_t lod) const noexcept { return lod ? m_lods[lod - 1].indexCount : UINT(m_indices.size()); }
+	constexpr float LodError(size_t lod) const noexcept { return lod ? m_lods[lod - 1].error : 0.f; }
+	// where the mesh starts in a GeometryBuffer it is drawn from; 0 for buffers of its own
+	UINT BaseVertex() const noexcept { return p_vertices ? p_vertices->sharedVertices.First() : 0; }
+	UINT StartIndex(size_t lod = 0) const noexcept { return lod ? m_lods[lod - 1].sharedIndices.First() : m_sharedIndices.First(); }
+	// model space, kept up to date with the vertices
+	const MeshBounds& Bounds() const noexcept { return p_vertices ? p_vertices->bounds : noBounds; }
+	// bytes of the vertex and index buffers this mesh draws from, LODs and shared vertices included
+	size_t GpuMemory() const noexcept;
+	// clusters over the LOD 0 index buffer, empty until BuildMeshlets
+	constexpr const std::vector<Meshlet>& Meshlets() const noexcept { return m_meshlets; }
 
-	void SetVertices(const std::vector<SimpleVertex>& vertices);
+	void SetVertices(std::span<const SimpleVertex> vertices);
+	// Dynamic meshes borrow their buffers from pool and change them in place: updates are copied into the
+	// existing buffers, and a buffer is only traded in when the geometry outgrows its size class.
+	// Dynamic vertices are always interleaved. nullptr goes back to static buffers.
+	void SetDynamic(BufferPool* pool);
+	constexpr bool IsDynamic() const noexcept { return p_pool != nullptr; }
+	// Overwrites vertices first to first + vertices.size() and uploads only those. Bounds grow to include
+	// the new positions but only shrink on the next full upload. Drops LODs and meshlets.
+	void UpdateVertices(size_t first, std::span<const SimpleVertex> vertices);
+	// Same for indices.
+	void UpdateIndices(size_t first, std::span<const UINT> indices);
+	// Static interleaved meshes then keep their vertices, indices and LODs in geometry instead of buffers
+	// of their own, so draws of different meshes can share one binding. Split and dynamic meshes keep their
+	// own buffers, as does anything that does not fit. nullptr goes back to own buffers. Drops LODs and meshlets.
+	void SetGeometryBuffer(GeometryBuffer* geometry);
+	// Re-uploads the vertices in the new layout; later uploads keep it. Meshes sharing the vertices keep theirs.
+	void SetVertexLayout(VertexLayout layout);
+	// Draws other's vertices from now on without copying them or their buffer.
+	void ShareVertices(const Mesh& other);
+	// true while another mesh holds the same vertex store
+	bool SharesVertices() const noexcept { return p_vertices.use_count() > 1; }
 	void RecreateVertexBuffer();
-	void SetIndices(const std::vector<UINT>& indices);
+	void SetIndices(std::span<const UINT> indices);
+	// Takes both vectors over without copying, in a vertex store of its own, and uploads them.
+	void SetGeometry(std::vector<SimpleVertex>&& vertices, std::vector<UINT>&& indices);
+	// Room for this many more vertices and indices, so a run of AddVertex and AddTriangle calls does not reallocate.
+	void Reserve(size_t vertexCount, size_t indexCount);
 	void RecreateIndexBuffer();
 	void Rebuild();
 	void Clear();
-	void MakeSphere(int slices, int stacks, DirectX::XMVECTORF32 color);
+	void MakeSphere(int slices, int stacks, DirectX::XMVECTORF32 color, SphereNormals normals = SphereNormals::Faceted);
+	void MakeSphereAsync(int slices, int stacks, DirectX::XMVECTORF32 color, SphereNormals normals = SphereNormals::Faceted);
+	// Builds on a worker thread; the current geometry stays in use until PublishRebuild swaps the result in.
+	void RebuildAsync(MeshRebuilder::Generator generator);
+	// Call once per frame before drawing. Returns true if new geometry was swapped in.
+	bool PublishRebuild();
 	int AddVertex(SimpleVertex d);
 	void AddTriangle(UINT i0, UINT i1, UINT i2);
 	void AddQuad(UINT i0, UINT i1, UINT i2, UINT i3);
 
 	Mesh& operator=(const Mesh& other);
+	Mesh& operator=(Mesh&& other) noexcept = default;
 
+	// Loads from "<fileName>.meshcache" when it is up to date; otherwise parses, welds and
+	// optimizes the OBJ and writes the cache for next time. Files without normals get them from
+	// loadNormalSettings.
 	void LoadFromFile(std::wstring_view fileName);
+	// Merges duplicate vertices and re-uploads if anything changed.
+	WeldStats Weld(const WeldSettings& settings = {});
+	// what LoadFromFile generates normals with: smooth, but hard past 60 degrees
+	static constexpr NormalSettings loadNormalSettings = { NormalWeighting::Angle, DirectX::XM_PI / 3.f, true };
+	// Recomputes normals from the faces, splitting vertices along creases, and re-uploads. Drops LODs and meshlets.
+	NormalStats GenerateNormals(const NormalSettings& settings = {});
+	// Per-vertex tangent frames for normal mapping, computed from the current normals and UVs on every call.
+	std::vector<DirectX::XMFLOAT4> ComputeTangents() const;
+	// Reorders triangles for the post-transform cache and overdraw, then vertices into first-use order,
+	// as far as that does not make ACMR or overfetch worse. Call Rebuild afterwards.
+	OptimizeResult Optimize();
+	// Builds up to levels simplified index buffers, each with about reduction times the triangles of the
+	// one before. Levels are simplified in parallel from the full mesh. Any geometry change drops them.
+	void GenerateLods(size_t levels = 4, float reduction = 0.5f);
+	// Nearest intersection of a model space ray with the triangles. direction must be normalized.
+	bool Raycast(DirectX::FXMVECTOR origin, DirectX::FXMVECTOR direction, float& distance) const;
+	// Splits the index buffer into meshlets for per-frame cluster culling. Any geometry change drops them.
+	void BuildMeshlets(const MeshletSettings& settings = {});
 
 private:
 
-	Graphics* p_gfx;
+	// The vertices to write to, copied first if the store is shared.
+	std::vector<SimpleVertex>& EditVertices();
+	// Uploads the store wherever this mesh keeps its vertices.
+	void UploadVertices();
+	// dynamic meshes and meshes in a GeometryBuffer upload on the render thread, from the CPU copies
+	constexpr bool UploadsOnRenderThread() const noexcept { return p_pool || p_geometry; }
+	bool LoadFromCache(std::wstring_view fileName);
+	void LoadFromSource(std::wstring_view fileName);
+
+	BufferFactory* p_gfx;
 
-	std::vector<SimpleVertex> m_vertices;
+	std::shared_ptr<VertexStore> p_vertices;
+	// what new vertex stores are uploaded as
+	VertexLayout m_vertexLayout = VertexLayout::Interleaved;
 	std::vector<UINT> m_indices;
 
-	std::unique_ptr<ID3D11Buffer, DXDeleter<ID3D11Buffer>> p_vertexBuffer = nullptr;
-	std::unique_ptr<ID3D11Buffer, DXDeleter<ID3D11Buffer>> p_indexBuffer = nullptr;
+	UniqueBuffer p_indexBuffer = nullptr;
+	DXGI_FORMAT m_indexFormat = DXGI_FORMAT_R32_UINT;
+
+	// set for dynamic meshes, whose indices live in m_pooledIndices instead of p_indexBuffer
+	BufferPool* p_pool = nullptr;
+	PooledBuffer m_pooledIndices;
+
+	// set for meshes sub-allocated from a GeometryBuffer, whose indices live in m_sharedIndices
+	GeometryBuffer* p_geometry = nullptr;
+	GeometryRange m_sharedIndices;
+
+	std::vector<MeshLod> m_lods;
+	std::vector<Meshlet> m_meshlets;
+
+	std::unique_ptr<MeshRebuilder> p_rebuilder = nullptr;
+
+	inline static const std::vector<SimpleVertex> noVertices;
+	inline static const MeshBounds noBounds;
 };
 
@@ -0,0 +1,114 @@
+#include "MeshBounds.h"
+#include <cmath>
+
+using namespace DirectX;
+
+namespace
+{
+	const XMFLOAT3& PositionOf(const SimpleVertex& vertex) noexcept { return vertex.position; }
+	const XMFLOAT3& PositionOf(const XMFLOAT3& position) noexcept { return position; }
+
+	template<class T>
+	MeshBounds ComputeBounds(std::span<const T> vertices)
+	{
+		MeshBounds bounds;
+
+		if (vertices.empty())
+			return bounds;
+
+		auto lo = XMLoadFloat3(&PositionOf(vertices[0]));
+		auto hi = lo;
+		// the vertex holding the minimum and maximum on each axis
+		XMVECTOR minPoints[3] = { lo, lo, lo };
+		XMVECTOR maxPoints[3] = { lo, lo, lo };
+
+		for (const auto& v : vertices)
+		{
+			const auto p = XMLoadFloat3(&PositionOf(v));
+			const auto below = XMVectorLess(p, lo);
+			const auto above = XMVectorGreater(p, hi);
+
+			minPoints[0] = XMVectorSelect(minPoints[0], p, XMVectorSplatX(below));
+			minPoints[1] = XMVectorSelect(minPoints[1], p, XMVectorSplatY(below));
+			minPoints[2] = XMVectorSelect(minPoints[2], p, XMVectorSplatZ(below));
+			maxPoints[0] = XMVectorSelect(maxPoints[0], p, XMVectorSplatX(above));
+			maxPoints[1] = XMVectorSelect(maxPoints[1], p, XMVectorSplatY(above));
+			maxPoints[2] = XMVectorSelect(maxPoints[2], p, XMVectorSplatZ(above));
+
+			lo = XMVectorMin(lo, p);
+			hi = XMVectorMax(hi, p);
+		}
+
+		XMStoreFloat3(&bounds.box.Center, XMVectorScale(XMVectorAdd(lo, hi), 0.5f));
+		XMStoreFloat3(&bounds.box.Extents, XMVectorScale(XMVectorSubtract(hi, lo), 0.5f));
+
+		// initial sphere on the most distant pair of extreme points
+		int axis = 0;
+		float longest = -1.f;
+
+		for (int a = 0; a < 3; a++)
+		{
+			const float length = XMVectorGetX(XMVector3LengthSq(XMVectorSubtract(maxPoints[a], minPoints[a])));
+
+			if (length > longest)
+			{
+				longest = length;
+				axis = a;
+			}
+		}
+
+		XMStoreFloat3(&bounds.sphere.Center, XMVectorScale(XMVectorAdd(minPoints[axis], maxPoints[axis]), 0.5f));
+		bounds.sphere.Radius = std::sqrt(longest) * 0.5f;
+
+		for (const auto& v : vertices)
+		{
+			const auto p = XMLoadFloat3(&PositionOf(v));
+			const auto center = XMLoadFloat3(&bounds.sphere.Center);
+			const float distanceSq = XMVectorGetX(XMVector3LengthSq(XMVectorSubtract(p, center)));
+
+			if (distanceSq <= bounds.sphere.Radius * bounds.sphere.Radius)
+				continue;
+
+			// move the center toward p just far enough that the far side of the old sphere stays inside
+			const float distance = std::sqrt(distanceSq);
+			const float radius = (bounds.sphere.Radius + distance) * 0.5f;
+
+			XMStoreFloat3(&bounds.sphere.Center, XMVectorLerp(center, p, (radius - bounds.sphere.Radius) / distance));
+			bounds.sphere.Radius = radius;
+		}
+
+		return bounds;
+	}
+}
+
+MeshBounds MeshBounds::Compute(std::span<const SimpleVertex> vertices)
+{
+	return ComputeBounds(vertices);
+}
+
+MeshBounds MeshBounds::Compute(std::span<const XMFLOAT3> positions)
+{
+	return ComputeBounds(positions);
+}
+
+void XM_CALLCONV MeshBounds::Grow(FXMVECTOR point) noexcept
+{
+	const auto center = XMLoadFloat3(&box.Center);
+	const auto extents = XMLoadFloat3(&box.Extents);
+	const auto lo = XMVectorMin(XMVectorSubtract(center, extents), point);
+	const auto hi = XMVectorMax(XMVectorAdd(center, extents), point);
+
+	XMStoreFloat3(&box.Center, XMVectorScale(XMVectorAdd(lo, hi), 0.5f));
+	XMStoreFloat3(&box.Extents, XMVectorScale(XMVectorSubtract(hi, lo), 0.5f));
+
+	const auto sphereCenter = XMLoadFloat3(&sphere.Center);
+	const float distance = XMVectorGetX(XMVector3Length(XMVectorSubtract(point, sphereCenter)));
+
+	if (distance <= sphere.Radius)
+		return;
+
+	const float radius = (sphere.Radius + distance) * 0.5f;
+
+	XMStoreFloat3(&sphere.Center, XMVectorLerp(sphereCenter, point, (radius - sphere.Radius) / distance));
+	sphere.Radius = radius;
+}
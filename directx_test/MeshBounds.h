@@ -0,0 +1,23 @@
+#pragma once
+#include <span>
+#include <DirectXMath.h>
+#include <DirectXCollision.h>
+#include "SimpleVertex.h"
+
+// Model space bounding volumes of a vertex set. Both are empty, at the origin, for no vertices.
+struct MeshBounds
+{
+	// tight around the positions
+	DirectX::BoundingBox box = { { 0.f, 0.f, 0.f }, { 0.f, 0.f, 0.f } };
+	// close to minimal, usually a few percent larger than the optimum
+	DirectX::BoundingSphere sphere = { { 0.f, 0.f, 0.f }, 0.f };
+
+	// One SIMD min/max pass finds the box along with the extreme point on each axis (EPOS-6); the sphere
+	// starts on the most distant pair of those and a second pass grows it over the rest (Ritter).
+	static MeshBounds Compute(std::span<const SimpleVertex> vertices);
+	// Same over a tight position stream, which reads a quarter of the memory.
+	static MeshBounds Compute(std::span<const DirectX::XMFLOAT3> positions);
+
+	// Grows both volumes just enough to take in one more point.
+	void XM_CALLCONV Grow(DirectX::FXMVECTOR point) noexcept;
+};
@@ -0,0 +1,102 @@
+#include "MeshBuilder.h"
+#include "Mesh.h"
+#include <algorithm>
+
+template<class T>
+void MeshBuilder::Fit(std::vector<T>& v, size_t extra)
+{
+	if (v.size() + extra <= v.capacity())
+		return;
+
+	// a missed reservation still grows geometrically so appends stay amortized O(1)
+	m_reallocations++;
+	v.reserve(std::max(v.size() + extra, v.capacity() * 2));
+}
+
+void MeshBuilder::Reserve(size_t vertexCount, size_t indexCount)
+{
+	m_vertices.reserve(m_vertices.size() + vertexCount);
+	m_indices.reserve(m_indices.size() + indexCount);
+}
+
+UINT MeshBuilder::AddVertex(const SimpleVertex& vertex)
+{
+	Fit(m_vertices, 1);
+	m_vertices.push_back(vertex);
+
+	return UINT(m_vertices.size() - 1);
+}
+
+void MeshBuilder::AddTriangle(UINT i0, UINT i1, UINT i2)
+{
+	Fit(m_indices, 3);
+	m_indices.insert(m_indices.end(), { i0, i1, i2 });
+}
+
+void MeshBuilder::AddQuad(UINT i0, UINT i1, UINT i2, UINT i3)
+{
+	Fit(m_indices, 6);
+	m_indices.insert(m_indices.end(), { i0, i1, i2, i0, i2, i3 });
+}
+
+UINT MeshBuilder::AppendVertices(std::span<const SimpleVertex> vertices)
+{
+	const UINT first = UINT(m_vertices.size());
+
+	Fit(m_vertices, vertices.size());
+	m_vertices.insert(m_vertices.end(), vertices.begin(), vertices.end());
+
+	return first;
+}
+
+void MeshBuilder::AppendIndices(std::span<const UINT> indices, UINT baseVertex)
+{
+	Fit(m_indices, indices.size());
+
+	if (baseVertex == 0)
+	{
+		m_indices.insert(m_indices.end(), indices.begin(), indices.end());
+		return;
+	}
+
+	const size_t first = m_indices.size();
+	m_indices.resize(first + indices.size());
+	std::transform(indices.begin(), indices.end(), m_indices.begin() + first, [baseVertex](UINT i) { return i + baseVertex; });
+}
+
+std::span<SimpleVertex> MeshBuilder::WriteVertices(size_t count)
+{
+	const size_t first = m_vertices.size();
+
+	Fit(m_vertices, count);
+	m_vertices.resize(first + count);
+
+	return std::span(m_vertices).subspan(first);
+}
+
+std::span<UINT> MeshBuilder::WriteIndices(size_t count)
+{
+	const size_t first = m_indices.size();
+
+	Fit(m_indices, count);
+	m_indices.resize(first + count);
+
+	return std::span(m_indices).subspan(first);
+}
+
+void MeshBuilder::Finish(Mesh& mesh)
+{
+	mesh.SetGeometry(std::move(m_vertices), std::move(m_indices));
+
+	m_vertices = {};
+	m_indices = {};
+}
+
+void MeshBuilder::Finish(std::vector<SimpleVertex>& vertices, std::vector<UINT>& indices)
+{
+	vertices = std::move(m_vertices);
+	indices = std::move(m_indices);
+
+	m_vertices = {};
+	m_indices = {};
+}
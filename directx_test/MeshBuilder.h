@@ -0,0 +1,53 @@
+#pragma once
+#include "WinTypes.h"
+#include <span>
+#include <vector>
+#include "SimpleVertex.h"
+
+class Mesh;
+
+// Collects geometry for a Mesh. After a Reserve with the right counts nothing it does reallocates:
+// whole ranges can be appended at once, and generators can claim a range with WriteVertices and
+// WriteIndices and fill it in place. Finish moves the storage into the mesh instead of copying it.
+class MeshBuilder
+{
+public:
+
+	MeshBuilder() = default;
+	MeshBuilder(size_t vertexCount, size_t indexCount) { Reserve(vertexCount, indexCount); }
+
+	// Makes room for exactly this many more vertices and indices.
+	void Reserve(size_t vertexCount, size_t indexCount);
+
+	size_t VertexCount() const noexcept { return m_vertices.size(); }
+	size_t IndexCount() const noexcept { return m_indices.size(); }
+	// times an append outgrew the reserved capacity; zero when the reservation was right
+	constexpr size_t Reallocations() const noexcept { return m_reallocations; }
+
+	UINT AddVertex(const SimpleVertex& vertex);
+	void AddTriangle(UINT i0, UINT i1, UINT i2);
+	void AddQuad(UINT i0, UINT i1, UINT i2, UINT i3);
+
+	// Returns the index of the first appended vertex.
+	UINT AppendVertices(std::span<const SimpleVertex> vertices);
+	// Appends indices shifted by baseVertex, e.g. what AppendVertices returned for their vertices.
+	void AppendIndices(std::span<const UINT> indices, UINT baseVertex = 0);
+
+	// Grows by count and returns the new elements for the caller to overwrite. The span stays valid until the next append.
+	std::span<SimpleVertex> WriteVertices(size_t count);
+	std::span<UINT> WriteIndices(size_t count);
+
+	// Hands the geometry to mesh, which uploads it. The builder is empty afterwards but keeps counting reallocations.
+	void Finish(Mesh& mesh);
+	// Same for code that fills plain vectors, such as MeshRebuilder generators.
+	void Finish(std::vector<SimpleVertex>& vertices, std::vector<UINT>& indices);
+
+private:
+
+	template<class T>
+	void Fit(std::vector<T>& v, size_t extra);
+
+	std::vector<SimpleVertex> m_vertices;
+	std::vector<UINT> m_indices;
+	size_t m_reallocations = 0;
+};
@@ -0,0 +1,202 @@
+#include "MeshCache.h"
+#include "IndexCodec.h"
+#include <cstddef>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+
+namespace
+{
+	constexpr uint64_t AlignUp(uint64_t offset) noexcept
+	{
+		return (offset + MeshCacheHeader::alignment - 1) & ~(MeshCacheHeader::alignment - 1);
+	}
+
+	// FNV-1a, 64 bit
+	uint64_t Hash(const uint8_t* data, uint64_t size) noexcept
+	{
+		uint64_t hash = 14695981039346656037ull;
+
+		for (uint64_t i = 0; i < size; i++)
+		{
+			hash ^= data[i];
+			hash *= 1099511628211ull;
+		}
+
+		return hash;
+	}
+
+	bool WriteBytes(std::ofstream& file, const void* data, uint64_t size)
+	{
+		return size <= uint64_t(std::numeric_limits<std::streamsize>::max())
+			&& file.write(static_cast<const char*>(data), std::streamsize(size)).good();
+	}
+
+	bool PadTo(std::ofstream& file, uint64_t& offset, uint64_t target)
+	{
+		static constexpr uint8_t zeros[MeshCacheHeader::alignment] = {};
+
+		const auto padding = target - offset;
+		offset = target;
+
+		return padding == 0 || WriteBytes(file, zeros, padding);
+	}
+}
+
+MeshCache::MeshCache(std::wstring_view sourceFile)
+	: m_sourceFile(sourceFile)
+{
+}
+
+bool MeshCache::Open()
+{
+	const auto path = CachePath(m_sourceFile);
+	SourceStamp stamp;
+	auto freshness = m_view.Open(path) ? Check(stamp) : Freshness::Stale;
+
+	if (freshness == Freshness::Touched)
+	{
+		// store the new write time so the next open can skip hashing; Windows will not write to a mapped file
+		m_view.Close();
+		WriteStamp(path, stamp);
+		freshness = m_view.Open(path) ? Check(stamp) : Freshness::Stale;
+	}
+
+	if (freshness != Freshness::Stale)
+		return true;
+
+	m_view.Close();
+	return false;
+}
+
+std::span<const SimpleVertex> MeshCache::Vertices() const noexcept
+{
+	const auto& header = Header();
+	return { reinterpret_cast<const SimpleVertex*>(m_view.Data() + header.vertexOffset), size_t(header.vertexCount) };
+}
+
+bool MeshCache::ReadIndices(std::vector<UINT>& indices) const
+{
+	const auto& header = Header();
+	return IndexCodec::Decode(m_view.Data() + header.indexOffset, size_t(header.indexBytes), indices);
+}
+
+bool MeshCache::Write(std::wstring_view sourceFile, const std::vector<SimpleVertex>& vertices, const std::vector<UINT>& indices)
+{
+	const std::wstring source(sourceFile);
+
+	SourceStamp stamp;
+	MeshCacheHeader header{};
+
+	if (indices.size() % 3 != 0 || !ReadStamp(source, stamp) || !HashFile(source, header.sourceHash))
+		return false;
+
+	header.magic = MeshCacheHeader::expectedMagic;
+	header.version = MeshCacheHeader::expectedVersion;
+	header.sourceSize = stamp.size;
+	header.sourceWriteTime = stamp.writeTime;
+
+	header.bounds = MeshBounds::Compute(vertices);
+
+	const auto encodedIndices = IndexCodec::Encode(indices);
+
+	header.vertexStride = sizeof(SimpleVertex);
+	header.vertexCount = vertices.size();
+	header.indexBytes = encodedIndices.size();
+	header.vertexOffset = AlignUp(sizeof(MeshCacheHeader));
+	header.indexOffset = AlignUp(header.vertexOffset + header.vertexCount * header.vertexStride);
+
+	std::ofstream file(std::filesystem::path(CachePath(sourceFile)), std::ios::binary | std::ios::trunc);
+
+	if (!file)
+		return false;
+
+	uint64_t offset = sizeof(MeshCacheHeader);
+	bool ok = WriteBytes(file, &header, sizeof(header));
+
+	ok = ok && PadTo(file, offset, header.vertexOffset);
+	ok = ok && WriteBytes(file, vertices.data(), header.vertexCount * header.vertexStride);
+	offset += header.vertexCount * header.vertexStride;
+	ok = ok && PadTo(file, offset, header.indexOffset);
+
+	ok = ok && WriteBytes(file, encodedIndices.data(), encodedIndices.size());
+
+	file.close();
+
+	return ok && file.good();
+}
+
+std::wstring MeshCache::CachePath(std::wstring_view sourceFile)
+{
+	return std::wstring(sourceFile) + L".meshcache";
+}
+
+bool MeshCache::ReadStamp(const std::wstring& file, SourceStamp& stamp)
+{
+	const std::filesystem::path path(file);
+	std::error_code error;
+
+	const auto size = std::filesystem::file_size(path, error);
+	if (error)
+		return false;
+
+	const auto writeTime = std::filesystem::last_write_time(path, error);
+	if (error)
+		return false;
+
+	stamp.size = uint64_t(size);
+	stamp.writeTime = uint64_t(writeTime.time_since_epoch().count());
+
+	return true;
+}
+
+bool MeshCache::WriteStamp(const std::wstring& cacheFile, const SourceStamp& stamp)
+{
+	std::fstream file(std::filesystem::path(cacheFile), std::ios::binary | std::ios::in | std::ios::out);
+
+	file.seekp(offsetof(MeshCacheHeader, sourceWriteTime));
+	file.write(reinterpret_cast<const char*>(&stamp.writeTime), sizeof(stamp.writeTime));
+
+	return file.good();
+}
+
+bool MeshCache::HashFile(const std::wstring& file, uint64_t& hash)
+{
+	MappedFile source;
+
+	if (!source.Open(file))
+		return false;
+
+	hash = Hash(source.Data(), source.Size());
+	return true;
+}
+
+MeshCache::Freshness MeshCache::Check(SourceStamp& stamp) const
+{
+	const auto size = m_view.Size();
+
+	if (size < sizeof(MeshCacheHeader))
+		return Freshness::Stale;
+
+	const auto& header = Header();
+
+	if (header.magic != MeshCacheHeader::expectedMagic || header.version != MeshCacheHeader::expectedVersion
+		|| header.vertexStride != sizeof(SimpleVertex))
+		return Freshness::Stale;
+
+	// a write that was cut short leaves blobs running past the end of the file
+	if (header.vertexOffset % MeshCacheHeader::alignment != 0 || header.indexOffset % MeshCacheHeader::alignment != 0
+		|| header.vertexOffset > size || header.vertexCount > (size - header.vertexOffset) / header.vertexStride
+		|| header.indexOffset > size || header.indexBytes > size - header.indexOffset)
+		return Freshness::Stale;
+
+	if (!ReadStamp(m_sourceFile, stamp) || stamp.size != header.sourceSize)
+		return Freshness::Stale;
+
+	if (stamp.writeTime == header.sourceWriteTime)
+		return Freshness::Current;
+
+	// touched but possibly unchanged, e.g. after a checkout
+	uint64_t hash = 0;
+	return HashFile(m_sourceFile, hash) && hash == header.sourceHash ? Freshness::Touched : Freshness::Stale;
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include "WinTypes.h"
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "SimpleVertex.h"
+#include "MeshBounds.h"
+#include "MappedFile.h"
+
+// On-disk layout of a mesh cache file: this header, then the vertex blob and the IndexCodec encoded
+// index blob, each starting on an alignment boundary. Vertices can be read in place from a mapping.
+struct MeshCacheHeader
+{
+	static constexpr uint32_t expectedMagic = 0x4348534D; // "MSHC"
+	// Bump whenever SimpleVertex, this layout or the processing applied before writing changes.
+	// 2: the bounds block holds the MeshBounds box and sphere
+	// 3: the index blob is IndexCodec data
+	// 4: sources without normals are written with generated ones
+	static constexpr uint32_t expectedVersion = 4;
+	static constexpr uint64_t alignment = 16;
+
+	uint32_t magic;
+	uint32_t version;
+
+	// identifies the source the cache was built from
+	uint64_t sourceSize;
+	uint64_t sourceWriteTime;
+	uint64_t sourceHash;
+
+	// model space bounds of the vertex blob, so a cached load does not have to pass over it again
+	MeshBounds bounds;
+
+	uint32_t vertexStride;
+	uint64_t vertexOffset;
+	uint64_t vertexCount;
+	uint64_t indexOffset;
+	uint64_t indexBytes;
+};
+
+// Read-only view of the cache that belongs to a source mesh file. The cache lives next to the
+// source as "<source>.meshcache" and is used only while the source's size and write time match,
+// or, if the write time moved, while its contents still hash the same.
+class MeshCache
+{
+public:
+
+	explicit MeshCache(std::wstring_view sourceFile);
+	MeshCache(const MeshCache&) = delete;
+	MeshCache& operator=(const MeshCache&) = delete;
+
+	// Maps the cache file. Returns false if it is missing, damaged or stale.
+	bool Open();
+
+	const MeshCacheHeader& Header() const noexcept { return *reinterpret_cast<const MeshCacheHeader*>(m_view.Data()); }
+	const MeshBounds& Bounds() const noexcept { return Header().bounds; }
+	std::span<const SimpleVertex> Vertices() const noexcept;
+	// Decodes the index blob. Returns false if it is damaged.
+	bool ReadIndices(std::vector<UINT>& indices) const;
+
+	// Writes the cache for sourceFile, unless indices are not whole triangles.
+	// A failed write only means the next load parses the source again.
+	static bool Write(std::wstring_view sourceFile, const std::vector<SimpleVertex>& vertices, const std::vector<UINT>& indices);
+
+	// The same content hash the header stores as sourceHash.
+	static bool HashFile(const std::wstring& file, uint64_t& hash);
+
+private:
+
+	struct SourceStamp
+	{
+		uint64_t size = 0;
+		uint64_t writeTime = 0;
+	};
+
+	enum class Freshness
+	{
+		Stale,
+		Current,
+		// the source's write time moved but its contents hash the same
+		Touched
+	};
+
+	static std::wstring CachePath(std::wstring_view sourceFile);
+	static bool ReadStamp(const std::wstring& file, SourceStamp& stamp);
+	static bool WriteStamp(const std::wstring& cacheFile, const SourceStamp& stamp);
+	Freshness Check(SourceStamp& stamp) const;
+
+	std::wstring m_sourceFile;
+	MappedFile m_view;
+};
@@ -0,0 +1,235 @@
+#include "MeshLibrary.h"
+#include "MeshCache.h"
+#include "DebugLog.h"
+#ifndef _WIN32
+#include <filesystem>
+#endif
+
+MeshHandle MeshLibrary::Load(std::wstring_view fileName, const Prepare& prepare)
+{
+	const auto path = NormalizePath(fileName);
+
+	if (const auto found = m_byPath.find(path); found != m_byPath.end())
+		return Acquire(found->second);
+
+	uint64_t hash = 0;
+	bool hashed = false;
+
+	{
+		// a valid cache already knows the hash, which saves reading the whole source
+		MeshCache cache(fileName);
+
+		if (cache.Open())
+		{
+			hash = cache.Header().sourceHash;
+			hashed = true;
+		}
+		else
+		{
+			hashed = MeshCache::HashFile(std::wstring(fileName), hash);
+		}
+	}
+
+	if (hashed)
+	{
+		if (const auto found = m_byContent.find(hash); found != m_byContent.end())
+		{
+			m_byPath.emplace(path, found->second);
+			return Acquire(found->second);
+		}
+	}
+
+	auto mesh = std::make_unique<Mesh>(p_gfx);
+	mesh->SetGeometryBuffer(p_geometry);
+	mesh->LoadFromFile(fileName);
+
+	if (prepare)
+		prepare(*mesh);
+
+	const auto handle = Allocate(std::move(mesh));
+	auto& slot = m_slots[handle.index];
+
+	slot.path = path;
+	m_byPath.emplace(path, handle.index);
+
+	if (hashed)
+	{
+		slot.contentHash = hash;
+		m_byContent.emplace(hash, handle.index);
+	}
+
+	Trim();
+
+	return handle;
+}
+
+MeshHandle MeshLibrary::Add(std::unique_ptr<Mesh> mesh)
+{
+	return Allocate(std::move(mesh));
+}
+
+MeshHandle MeshLibrary::Create()
+{
+	auto mesh = std::make_unique<Mesh>(p_gfx);
+	mesh->SetGeometryBuffer(p_geometry);
+
+	return Add(std::move(mesh));
+}
+
+void MeshLibrary::AddRef(MeshHandle handle)
+{
+	if (!IsLive(handle))
+		return;
+
+	Acquire(handle.index);
+}
+
+void MeshLibrary::Release(MeshHandle handle)
+{
+	if (!IsLive(handle))
+		return;
+
+	auto& slot = m_slots[handle.index];
+
+	if (slot.references == 0 || --slot.references > 0)
+		return;
+
+	if (slot.path.empty())
+	{
+		Free(handle.index);
+		return;
+	}
+
+	slot.unused = m_unused.insert(m_unused.end(), handle.index);
+	Trim();
+}
+
+Mesh* MeshLibrary::Get(MeshHandle handle) const noexcept
+{
+	return IsLive(handle) ? m_slots[handle.index].mesh.get() : nullptr;
+}
+
+void MeshLibrary::SetMemoryBudget(size_t bytes)
+{
+	m_memoryBudget = bytes;
+	Trim();
+}
+
+size_t MeshLibrary::MemoryUsed() const noexcept
+{
+	size_t bytes = 0;
+
+	for (const auto& slot : m_slots)
+		if (slot.mesh)
+			bytes += slot.mesh->GpuMemory();
+
+	return bytes;
+}
+
+void MeshLibrary::Trim()
+{
+	if (m_unused.empty())
+		return;
+
+	size_t used = MemoryUsed();
+
+	while (used > m_memoryBudget && !m_unused.empty())
+	{
+		const auto index = m_unused.front();
+		m_unused.pop_front();
+
+		const auto bytes = m_slots[index].mesh->GpuMemory();
+		used -= bytes;
+
+		DebugLog("evicted mesh, %zu bytes\n", bytes);
+
+		Free(index);
+	}
+}
+
+std::wstring MeshLibrary::NormalizePath(std::wstring_view fileName)
+{
+	std::wstring path(fileName);
+
+#ifdef _WIN32
+	wchar_t full[MAX_PATH];
+	const DWORD length = GetFullPathNameW(path.c_str(), MAX_PATH, full, nullptr);
+
+	if (length > 0 && length < MAX_PATH)
+		path.assign(full, length);
+
+	// Windows paths are case-insensitive
+	CharLowerBuffW(path.data(), DWORD(path.size()));
+#else
+	std::error_code error;
+	const auto full = std::filesystem::absolute(path, error);
+
+	if (!error)
+		path = full.lexically_normal().wstring();
+#endif
+
+	return path;
+}
+
+bool MeshLibrary::IsLive(MeshHandle handle) const noexcept
+{
+	return handle.index < m_slots.size() && m_slots[handle.index].generation == handle.generation && m_slots[handle.index].mesh;
+}
+
+MeshHandle MeshLibrary::Allocate(std::unique_ptr<Mesh> mesh)
+{
+	uint32_t index;
+
+	if (m_freeSlots.empty())
+	{
+		index = uint32_t(m_slots.size());
+		m_slots.emplace_back();
+	}
+	else
+	{
+		index = m_freeSlots.back();
+		m_freeSlots.pop_back();
+	}
+
+	auto& slot = m_slots[index];
+	slot.mesh = std::move(mesh);
+	slot.references = 1;
+
+	return { index, slot.generation };
+}
+
+MeshHandle MeshLibrary::Acquire(uint32_t index)
+{
+	auto& slot = m_slots[index];
+
+	if (slot.references++ == 0)
+		m_unused.erase(slot.unused);
+
+	return { index, slot.generation };
+}
+
+void MeshLibrary::Free(uint32_t index)
+{
+	auto& slot = m_slots[index];
+
+	std::erase_if(m_byPath, [index](const auto& entry) { return entry.second == index; });
+
+	if (!slot.path.empty())
+	{
+		const auto found = m_byContent.find(slot.contentHash);
+
+		if (found != m_byContent.end() && found->second == index)
+			m_byContent.erase(found);
+	}
+
+	slot.mesh.reset();
+	slot.references = 0;
+	slot.path.clear();
+	slot.contentHash = 0;
+
+	// zero is the null handle's generation
+	if (++slot.generation == 0)
+		slot.generation = 1;
+
+	m_freeSlots.push_back(index);
+}
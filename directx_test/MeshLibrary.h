@@ -0,0 +1,101 @@
+#pragma once
+#include "WinTypes.h"
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "Mesh.h"
+#include "BufferFactory.h"
+
+// Names a mesh in a MeshLibrary. A handle goes stale when its mesh is freed, and a stale
+// handle never resolves to whatever mesh reuses the slot later.
+struct MeshHandle
+{
+	uint32_t index = 0;
+	// zero for the null handle
+	uint32_t generation = 0;
+
+	constexpr explicit operator bool() const noexcept { return generation != 0; }
+	constexpr bool operator==(const MeshHandle&) const noexcept = default;
+};
+
+// Owns meshes and hands them out by handle. Files are loaded once: a second Load of the same
+// path, or of another file with identical contents, returns the mesh already in memory.
+//
+// Every handle returned by Load and Add holds one reference. A loaded mesh whose references
+// are all released stays resident, so loading it again is free, until the library needs the
+// memory: unreferenced meshes are freed least recently released first while the buffers of
+// all meshes add up to more than the budget. Meshes made with Add cannot be looked up again
+// and are freed with their last reference.
+class MeshLibrary
+{
+public:
+
+	// Runs once on a freshly loaded mesh, e.g. to generate LODs. Not called for meshes found in the library.
+	using Prepare = std::function<void(Mesh&)>;
+
+	MeshLibrary(BufferFactory* gfx, size_t memoryBudget = SIZE_MAX) : p_gfx(gfx), m_memoryBudget(memoryBudget) {}
+	MeshLibrary(const MeshLibrary&) = delete;
+	MeshLibrary& operator=(const MeshLibrary&) = delete;
+
+	MeshHandle Load(std::wstring_view fileName, const Prepare& prepare = nullptr);
+	// Takes a mesh built in code.
+	MeshHandle Add(std::unique_ptr<Mesh> mesh);
+	// Shorthand for Add with an empty mesh on this library's device.
+	MeshHandle Create();
+	// Meshes loaded or created from now on are sub-allocated from geometry; see Mesh::SetGeometryBuffer.
+	// It has to outlive the library.
+	void SetGeometryBuffer(GeometryBuffer* geometry) noexcept { p_geometry = geometry; }
+
+	void AddRef(MeshHandle handle);
+	void Release(MeshHandle handle);
+
+	// nullptr for stale and null handles. The pointer stays valid while the handle holds a reference.
+	Mesh* Get(MeshHandle handle) const noexcept;
+	bool IsValid(MeshHandle handle) const noexcept { return IsLive(handle); }
+
+	constexpr size_t MemoryBudget() const noexcept { return m_memoryBudget; }
+	void SetMemoryBudget(size_t bytes);
+	// vertex and index buffer bytes of every resident mesh, recounted on each call; shared vertex stores count once per mesh
+	size_t MemoryUsed() const noexcept;
+	size_t ResidentCount() const noexcept { return m_slots.size() - m_freeSlots.size(); }
+
+	// Frees unreferenced meshes until the library fits its budget. Called by Load, Release and SetMemoryBudget.
+	void Trim();
+
+private:
+
+	struct Slot
+	{
+		std::unique_ptr<Mesh> mesh = nullptr;
+		uint32_t generation = 1;
+		uint32_t references = 0;
+		// empty for meshes made with Add
+		std::wstring path;
+		uint64_t contentHash = 0;
+		// position in m_unused while references is zero
+		std::list<uint32_t>::iterator unused;
+	};
+
+	static std::wstring NormalizePath(std::wstring_view fileName);
+	bool IsLive(MeshHandle handle) const noexcept;
+	MeshHandle Allocate(std::unique_ptr<Mesh> mesh);
+	MeshHandle Acquire(uint32_t index);
+	void Free(uint32_t index);
+
+	BufferFactory* p_gfx;
+	GeometryBuffer* p_geometry = nullptr;
+	size_t m_memoryBudget;
+
+	// slots are only ever appended, so indices stay put; freed ones are reused
+	std::vector<Slot> m_slots;
+	std::vector<uint32_t> m_freeSlots;
+	std::unordered_map<std::wstring, uint32_t> m_byPath;
+	std::unordered_map<uint64_t, uint32_t> m_byContent;
+	// unreferenced loaded meshes, least recently released first
+	std::list<uint32_t> m_unused;
+};
@@ -0,0 +1,73 @@
+#include "MeshRebuilder.h"
+
+MeshRebuilder::MeshRebuilder(BufferFactory* factory)
+	: p_factory(factory), m_worker([this](std::stop_token stop) { Run(stop); })
+{
+}
+
+void MeshRebuilder::Request(Generator generator, VertexLayout layout)
+{
+	{
+		std::lock_guard lock(m_mutex);
+		m_pending = std::move(generator);
+		m_pendingLayout = layout;
+	}
+
+	m_wake.notify_one();
+}
+
+std::optional<MeshRebuilder::Result> MeshRebuilder::TakeFinished()
+{
+	std::lock_guard lock(m_mutex);
+
+	auto finished = std::move(m_finished);
+	m_finished.reset();
+
+	return finished;
+}
+
+bool MeshRebuilder::Busy() const
+{
+	std::lock_guard lock(m_mutex);
+
+	return m_building || m_pending;
+}
+
+void MeshRebuilder::Run(std::stop_token stop)
+{
+	while (true)
+	{
+		Generator generator;
+		VertexLayout layout;
+
+		{
+			std::unique_lock lock(m_mutex);
+
+			if (!m_wake.wait(lock, stop, [this]() { return static_cast<bool>(m_pending); }))
+				return;
+
+			generator = std::move(m_pending);
+			layout = m_pendingLayout;
+			m_pending = nullptr;
+			m_building = true;
+		}
+
+		Result result;
+		generator(result.vertices.vertices, result.indices);
+
+		// D3D11 devices are free-threaded, so the upload happens here rather than on the frame
+		if (p_factory)
+		{
+			result.vertices.Upload(p_factory, layout);
+			result.indexBuffer = p_factory->CreateCompactIndexBuffer(result.indices, result.indexFormat);
+		}
+		else
+		{
+			result.vertices.bounds = MeshBounds::Compute(result.vertices.vertices);
+		}
+
+		std::lock_guard lock(m_mutex);
+		m_finished = std::move(result);
+		m_building = false;
+	}
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include "WinTypes.h"
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+#include "SimpleVertex.h"
+#include "BufferFactory.h"
+#include "VertexStore.h"
+
+// Builds mesh geometry and its GPU buffers on a worker thread. Requests that
+// arrive while a build is running replace each other, so only the latest one
+// is built next. Finished results wait in a back slot until the owner takes them.
+// Without a factory nothing is uploaded; results only get their bounds.
+class MeshRebuilder
+{
+public:
+
+	using Generator = std::function<void(std::vector<SimpleVertex>& vertices, std::vector<UINT>& indices)>;
+
+	struct Result
+	{
+		// uploaded when there is a factory; bounds are always computed
+		VertexStore vertices;
+		std::vector<UINT> indices;
+		UniqueBuffer indexBuffer = nullptr;
+		DXGI_FORMAT indexFormat = DXGI_FORMAT_R32_UINT;
+	};
+
+	MeshRebuilder(BufferFactory* factory);
+	MeshRebuilder(const MeshRebuilder&) = delete;
+	MeshRebuilder& operator=(const MeshRebuilder&) = delete;
+
+	void Request(Generator generator, VertexLayout layout = VertexLayout::Interleaved);
+	// Returns the newest finished build, if any, and empties the back slot.
+	std::optional<Result> TakeFinished();
+	bool Busy() const;
+
+private:
+
+	void Run(std::stop_token stop);
+
+	BufferFactory* p_factory;
+
+	mutable std::mutex m_mutex;
+	std::condition_variable_any m_wake;
+	Generator m_pending;
+	VertexLayout m_pendingLayout = VertexLayout::Interleaved;
+	std::optional<Result> m_finished;
+	bool m_building = false;
+
+	// declared last so it is joined before the state it reads is destroyed
+	std::jthread m_worker;
+};
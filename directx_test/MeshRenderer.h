@@ -1,6 +1,5 @@
 #pragma once
-#include "NormWin.h"
-#include <DirectXHelpers.h>
+#include "WinTypes.h"
 
 class MeshRenderer
 {
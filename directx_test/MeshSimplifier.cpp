@@ -0,0 +1,247 @@
+#include "MeshSimplifier.h"
+#include "MeshWelder.h"
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <unordered_map>
+
+using namespace DirectX;
+
+namespace
+{
+	// gives up on meshes that stop shrinking long before reaching the target
+	constexpr int maxPasses = 100;
+
+	// Sum of squared distances to a set of planes, weighted by triangle area.
+	struct Quadric
+	{
+		float a00 = 0.f, a01 = 0.f, a02 = 0.f, a11 = 0.f, a12 = 0.f, a22 = 0.f;
+		float b0 = 0.f, b1 = 0.f, b2 = 0.f;
+		float c = 0.f;
+		float weight = 0.f;
+
+		void AddPlane(const XMFLOAT3& n, float d, float w) noexcept
+		{
+			a00 += w * n.x * n.x; a01 += w * n.x * n.y; a02 += w * n.x * n.z;
+			a11 += w * n.y * n.y; a12 += w * n.y * n.z; a22 += w * n.z * n.z;
+			b0 += w * n.x * d; b1 += w * n.y * d; b2 += w * n.z * d;
+			c += w * d * d;
+			weight += w;
+		}
+
+		void Add(const Quadric& q) noexcept
+		{
+			a00 += q.a00; a01 += q.a01; a02 += q.a02;
+			a11 += q.a11; a12 += q.a12; a22 += q.a22;
+			b0 += q.b0; b1 += q.b1; b2 += q.b2;
+			c += q.c;
+			weight += q.weight;
+		}
+
+		// mean squared distance of p to the planes
+		float Error(const XMFLOAT3& p) const noexcept
+		{
+			const float e = a00 * p.x * p.x + a11 * p.y * p.y + a22 * p.z * p.z
+				+ 2.f * (a01 * p.x * p.y + a02 * p.x * p.z + a12 * p.y * p.z)
+				+ 2.f * (b0 * p.x + b1 * p.y + b2 * p.z) + c;
+
+			return weight > 0.f ? std::max(e, 0.f) / weight : 0.f;
+		}
+	};
+
+	struct Collapse
+	{
+		UINT from;
+		UINT to;
+		float cost;
+	};
+
+	XMVECTOR TriangleNormal(XMVECTOR a, XMVECTOR b, XMVECTOR c)
+	{
+		return XMVector3Cross(XMVectorSubtract(b, a), XMVectorSubtract(c, a));
+	}
+}
+
+float MeshSimplifier::Simplify(const std::vector<SimpleVertex>& vertices, std::vector<UINT>& indices,
+	size_t targetIndexCount, float maxError)
+{
+	const size_t vertexCount = vertices.size();
+
+	std::vector<UINT> groupSizes;
+	const auto group = MeshWelder::GroupByPosition(vertices, groupSizes);
+
+	// seams: more than one vertex at a position
+	std::vector<bool> locked(vertexCount);
+	for (size_t v = 0; v < vertexCount; v++)
+		locked[v] = groupSizes[group[v]] > 1;
+
+	// borders: edges between position groups that are not matched by exactly one opposite edge
+	std::unordered_map<uint64_t, int> edgeCounts;
+	edgeCounts.reserve(indices.size());
+
+	const auto edgeKey = [&](UINT a, UINT b) { return (uint64_t(group[a]) << 32) | group[b]; };
+
+	for (size_t i = 0; i < indices.size(); i += 3)
+		for (int e = 0; e < 3; e++)
+			edgeCounts[edgeKey(indices[i + e], indices[i + (e + 1) % 3])]++;
+
+	for (size_t i = 0; i < indices.size(); i += 3)
+	{
+		for (int e = 0; e < 3; e++)
+		{
+			const UINT a = indices[i + e], b = indices[i + (e + 1) % 3];
+			const auto reverse = edgeCounts.find(edgeKey(b, a));
+
+			if (edgeCounts[edgeKey(a, b)] != 1 || reverse == edgeCounts.end() || reverse->second != 1)
+				locked[a] = locked[b] = true;
+		}
+	}
+
+	std::vector<Quadric> quadrics(groupSizes.size());
+
+	for (size_t i = 0; i < indices.size(); i += 3)
+	{
+		const auto p0 = XMLoadFloat3(&vertices[indices[i]].position);
+		const auto normal = TriangleNormal(p0, XMLoadFloat3(&vertices[indices[i + 1]].position), XMLoadFloat3(&vertices[indices[i + 2]].position));
+		const float area = XMVectorGetX(XMVector3Length(normal)) * 0.5f;
+
+		if (area <= 0.f)
+			continue;
+
+		XMFLOAT3 n;
+		XMStoreFloat3(&n, XMVector3Normalize(normal));
+		const float d = -XMVectorGetX(XMVector3Dot(XMLoadFloat3(&n), p0));
+
+		for (int k = 0; k < 3; k++)
+			quadrics[group[indices[i + k]]].AddPlane(n, d, area);
+	}
+
+	const float maxCost = maxError < std::sqrt(FLT_MAX) ? maxError * maxError : FLT_MAX;
+	float error = 0.f;
+
+	std::vector<UINT> triangleOffsets(vertexCount + 1), triangleList, remap(vertexCount);
+	std::vector<Collapse> collapses;
+	std::vector<bool> touched(groupSizes.size());
+
+	for (int pass = 0; pass < maxPasses && indices.size() > targetIndexCount; pass++)
+	{
+		// vertex -> triangles
+		std::fill(triangleOffsets.begin(), triangleOffsets.end(), 0u);
+		for (UINT v : indices)
+			triangleOffsets[v + 1]++;
+		std::partial_sum(triangleOffsets.begin(), triangleOffsets.end(), triangleOffsets.begin());
+
+		triangleList.resize(indices.size());
+		std::vector<UINT> fill(triangleOffsets.begin(), triangleOffsets.end() - 1);
+		for (size_t i = 0; i < indices.size(); i++)
+			triangleList[fill[indices[i]]++] = UINT(i / 3);
+
+		collapses.clear();
+
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			for (int e = 0; e < 3; e++)
+			{
+				const UINT from = indices[i + e], to = indices[i + (e + 1) % 3];
+
+				if (locked[from])
+					continue;
+
+				Quadric q = quadrics[group[from]];
+				q.Add(quadrics[group[to]]);
+				collapses.push_back({ from, to, q.Error(vertices[to].position) });
+			}
+		}
+
+		std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) { return a.cost < b.cost; });
+
+		const size_t wanted = (indices.size() - targetIndexCount) / 3;
+		size_t removed = 0;
+
+		// Only the cheapest candidates are eligible each pass. Without this bound a pass fills its
+		// budget with expensive collapses once the cheap ones around it are blocked.
+		const float passCost = collapses.empty() ? 0.f : std::min(maxCost, collapses[std::min(collapses.size() - 1, wanted)].cost);
+
+		std::iota(remap.begin(), remap.end(), 0u);
+		std::fill(touched.begin(), touched.end(), false);
+
+		for (const auto& collapse : collapses)
+		{
+			if (collapse.cost > passCost || removed >= wanted)
+				break;
+
+			const UINT from = collapse.from, to = collapse.to;
+
+			if (touched[group[from]] || touched[group[to]])
+				continue;
+
+			const auto target = XMLoadFloat3(&vertices[to].position);
+			bool valid = true;
+			size_t degenerate = 0;
+
+			for (UINT t = triangleOffsets[from]; t < triangleOffsets[from + 1] && valid; t++)
+			{
+				const UINT* tri = &indices[size_t(triangleList[t]) * 3];
+
+				if (tri[0] == to || tri[1] == to || tri[2] == to)
+				{
+					degenerate++;
+					continue;
+				}
+
+				XMVECTOR before[3], after[3];
+
+				for (int k = 0; k < 3; k++)
+				{
+					// another vertex of the target's seam would leave a zero-area triangle with mismatched attributes
+					if (tri[k] != from && group[tri[k]] == group[to])
+						valid = false;
+
+					before[k] = XMLoadFloat3(&vertices[tri[k]].position);
+					after[k] = tri[k] == from ? target : before[k];
+				}
+
+				// reject collapses that fold a triangle over
+				const auto n0 = TriangleNormal(before[0], before[1], before[2]);
+				const auto n1 = TriangleNormal(after[0], after[1], after[2]);
+
+				if (XMVectorGetX(XMVector3Dot(n0, n1)) <= 0.f)
+					valid = false;
+			}
+
+			if (!valid)
+				continue;
+
+			remap[from] = to;
+			quadrics[group[to]].Add(quadrics[group[from]]);
+			error = std::max(error, collapse.cost);
+			removed += degenerate;
+
+			// the neighbourhood changed, so later collapses this pass would be judged on stale triangles
+			for (UINT t = triangleOffsets[from]; t < triangleOffsets[from + 1]; t++)
+				for (int k = 0; k < 3; k++)
+					touched[group[indices[size_t(triangleList[t]) * 3 + k]]] = true;
+		}
+
+		if (removed == 0)
+			break;
+
+		size_t write = 0;
+
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			const UINT a = remap[indices[i]], b = remap[indices[i + 1]], c = remap[indices[i + 2]];
+
+			if (a == b || b == c || a == c)
+				continue;
+
+			indices[write++] = a;
+			indices[write++] = b;
+			indices[write++] = c;
+		}
+
+		indices.resize(write);
+	}
+
+	return std::sqrt(error);
+}
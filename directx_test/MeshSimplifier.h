@@ -0,0 +1,22 @@
+#pragma once
+#include "WinTypes.h"
+#include <cfloat>
+#include <vector>
+#include "SimpleVertex.h"
+
+// Quadric error metric edge collapse (Garland & Heckbert, "Surface Simplification Using Quadric Error Metrics").
+//
+// Vertices are never moved, only collapsed onto a neighbour, so every level of detail keeps indexing the
+// original vertex array. Vertices on open borders and on attribute seams (several vertices sharing one
+// position with different normals or texture coordinates) stay locked, which keeps UV and normal seams
+// and silhouettes of open meshes intact.
+class MeshSimplifier
+{
+public:
+
+	// Collapses edges until indices holds at most targetIndexCount entries, no collapse is left, or the
+	// next one would move the surface further than maxError. Returns the error reached, as a distance
+	// in model units.
+	static float Simplify(const std::vector<SimpleVertex>& vertices, std::vector<UINT>& indices,
+		size_t targetIndexCount, float maxError = FLT_MAX);
+};
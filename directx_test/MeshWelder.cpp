@@ -0,0 +1,204 @@
+#include "MeshWelder.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <numeric>
+#include <tuple>
+
+namespace
+{
+	constexpr size_t verticesPerChunk = 16384;
+	constexpr UINT emptySlot = ~0u;
+
+	using Key = std::array<int64_t, 11>;
+
+	int64_t Quantize(float value, float inverseCell)
+	{
+		int32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+
+		if (inverseCell == 0.f)
+			return bits;
+
+		// the cell index overflows int32 past ~21k units at the default epsilon, so it is kept in 64 bits;
+		// values too large for even that, and NaNs, fall back to an exact match on their bits
+		const double cell = std::floor(double(value) * inverseCell);
+
+		if (!(std::abs(cell) < 0x1p62))
+			return (int64_t(1) << 62) ^ bits;
+
+		return static_cast<int64_t>(cell);
+	}
+
+	Key MakeKey(const SimpleVertex& v, const WeldSettings& s)
+	{
+		const auto inverse = [](float e) { return e > 0.f ? 1.f / e : 0.f; };
+		const float p = inverse(s.positionEpsilon), c = inverse(s.colorEpsilon), n = inverse(s.normalEpsilon), t = inverse(s.texCoordEpsilon);
+
+		return {
+			Quantize(v.position.x, p), Quantize(v.position.y, p), Quantize(v.position.z, p),
+			Quantize(v.color.x, c), Quantize(v.color.y, c), Quantize(v.color.z, c),
+			Quantize(v.normal.x, n), Quantize(v.normal.y, n), Quantize(v.normal.z, n),
+			Quantize(v.texCoord.x, t), Quantize(v.texCoord.y, t)
+		};
+	}
+
+	uint64_t Hash(const Key& key)
+	{
+		uint64_t h = 0x9E3779B97F4A7C15ull;
+
+		for (const auto k : key)
+		{
+			h ^= static_cast<uint64_t>(k);
+			h *= 0xFF51AFD7ED558CCDull;
+			h ^= h >> 32;
+		}
+
+		return h;
+	}
+}
+
+WeldStats MeshWelder::Weld(std::vector<SimpleVertex>& vertices, std::vector<UINT>& indices, const WeldSettings& settings)
+{
+	WeldStats stats{};
+	stats.verticesBefore = vertices.size();
+
+	const size_t count = vertices.size();
+
+	if (count == 0)
+		return stats;
+
+	std::vector<Key> keys(count);
+	std::vector<uint64_t> hashes(count);
+
+	ParallelFor(count, verticesPerChunk, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+		{
+			keys[i] = MakeKey(vertices[i], settings);
+			hashes[i] = Hash(keys[i]);
+		}
+	});
+
+	// bucket vertices by the top hash bits so each partition can be deduplicated on its own thread
+	const size_t partitions = std::bit_ceil(std::max<size_t>(1, count / verticesPerChunk));
+	const int partitionShift = 64 - std::countr_zero(partitions);
+	const auto partitionOf = [&](size_t i) { return partitions == 1 ? 0 : size_t(hashes[i] >> partitionShift); };
+
+	std::vector<UINT> partitionStart(partitions + 1, 0);
+	for (size_t i = 0; i < count; i++)
+		partitionStart[partitionOf(i) + 1]++;
+	for (size_t p = 0; p < partitions; p++)
+		partitionStart[p + 1] += partitionStart[p];
+
+	std::vector<UINT> order(count);
+	{
+		auto cursor = partitionStart;
+		for (size_t i = 0; i < count; i++)
+			order[cursor[partitionOf(i)]++] = UINT(i);
+	}
+
+	// representative[i] is the first vertex with the same key as vertex i
+	std::vector<UINT> representative(count);
+
+	ParallelFor(partitions, 1, [&](size_t begin, size_t end)
+	{
+		std::vector<UINT> table;
+
+		for (size_t p = begin; p < end; p++)
+		{
+			const UINT first = partitionStart[p], last = partitionStart[p + 1];
+			const size_t capacity = std::bit_ceil(std::max<size_t>(16, size_t(last - first) * 2));
+			const size_t mask = capacity - 1;
+
+			table.assign(capacity, emptySlot);
+
+			for (UINT o = first; o < last; o++)
+			{
+				const UINT i = order[o];
+				size_t slot = size_t(hashes[i]) & mask;
+
+				while (true)
+				{
+					const UINT candidate = table[slot];
+
+					if (candidate == emptySlot)
+					{
+						table[slot] = i;
+						representative[i] = i;
+						break;
+					}
+
+					if (hashes[candidate] == hashes[i] && keys[candidate] == keys[i])
+					{
+						representative[i] = candidate;
+						break;
+					}
+
+					slot = (slot + 1) & mask;
+				}
+			}
+		}
+	});
+
+	// order within a partition follows the original order, so representatives always precede their duplicates
+	std::vector<UINT> remap(count);
+	size_t written = 0;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		if (representative[i] == i)
+		{
+			remap[i] = UINT(written);
+			vertices[written++] = vertices[i];
+		}
+		else
+		{
+			remap[i] = remap[representative[i]];
+		}
+	}
+
+	vertices.resize(written);
+
+	ParallelFor(indices.size(), verticesPerChunk, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+			indices[i] = remap[indices[i]];
+	});
+
+	stats.verticesAfter = written;
+
+	return stats;
+}
+
+std::vector<UINT> MeshWelder::GroupByPosition(const std::vector<SimpleVertex>& vertices, std::vector<UINT>& groupSizes)
+{
+	std::vector<UINT> order(vertices.size());
+	std::iota(order.begin(), order.end(), 0u);
+
+	const auto key = [&](UINT v)
+	{
+		const auto& p = vertices[v].position;
+		return std::make_tuple(std::bit_cast<uint32_t>(p.x), std::bit_cast<uint32_t>(p.y), std::bit_cast<uint32_t>(p.z));
+	};
+
+	std::sort(order.begin(), order.end(), [&](UINT a, UINT b) { return key(a) < key(b); });
+
+	std::vector<UINT> group(vertices.size());
+	groupSizes.clear();
+
+	for (size_t i = 0; i < order.size(); i++)
+	{
+		if (i == 0 || key(order[i]) != key(order[i - 1]))
+			groupSizes.push_back(0);
+
+		group[order[i]] = UINT(groupSizes.size() - 1);
+		groupSizes.back()++;
+	}
+
+	return group;
+}
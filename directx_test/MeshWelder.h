@@ -0,0 +1,36 @@
+#pragma once
+#include "WinTypes.h"
+#include <vector>
+#include "SimpleVertex.h"
+
+struct WeldSettings
+{
+	// Attributes are snapped to a grid of this cell size before comparing. Zero means exact bitwise match.
+	float positionEpsilon = 1e-5f;
+	float colorEpsilon = 1e-3f;
+	float normalEpsilon = 1e-3f;
+	float texCoordEpsilon = 1e-5f;
+};
+
+struct WeldStats
+{
+	size_t verticesBefore = 0;
+	size_t verticesAfter = 0;
+
+	constexpr size_t VerticesRemoved() const noexcept { return verticesBefore - verticesAfter; }
+	constexpr size_t BytesSaved() const noexcept { return VerticesRemoved() * sizeof(SimpleVertex); }
+};
+
+class MeshWelder
+{
+public:
+
+	// Merges vertices whose quantized attributes match and rewrites indices to the survivors.
+	// Surviving vertices keep their first-seen order. Vertices that fall on opposite sides of a
+	// grid cell boundary are not merged, so the epsilons should sit well below real feature sizes.
+	static WeldStats Weld(std::vector<SimpleVertex>& vertices, std::vector<UINT>& indices, const WeldSettings& settings = {});
+
+	// Numbers the distinct positions, which is what welding by position alone would keep. Returns each
+	// vertex's group; groupSizes gets the vertex count of every group. Positions must match bitwise.
+	static std::vector<UINT> GroupByPosition(const std::vector<SimpleVertex>& vertices, std::vector<UINT>& groupSizes);
+};
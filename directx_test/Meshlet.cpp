@@ -0,0 +1,210 @@
+#include "Meshlet.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace DirectX;
+
+namespace
+{
+	// cones wider than this are useless for culling and get disabled
+	constexpr float minConeDot = 0.1f;
+
+	void ComputeBounds(const std::vector<SimpleVertex>& vertices, const std::vector<UINT>& indices, Meshlet& meshlet)
+	{
+		const UINT first = meshlet.indexOffset;
+		const UINT last = meshlet.indexOffset + meshlet.indexCount;
+
+		// sphere around the box center, radius to the farthest corner vertex
+		auto minimum = XMLoadFloat3(&vertices[indices[first]].position);
+		auto maximum = minimum;
+
+		for (UINT i = first; i < last; i++)
+		{
+			const auto p = XMLoadFloat3(&vertices[indices[i]].position);
+			minimum = XMVectorMin(minimum, p);
+			maximum = XMVectorMax(maximum, p);
+		}
+
+		const auto center = XMVectorScale(XMVectorAdd(minimum, maximum), 0.5f);
+		auto radius = XMVectorZero();
+
+		for (UINT i = first; i < last; i++)
+			radius = XMVectorMax(radius, XMVector3LengthSq(XMVectorSubtract(XMLoadFloat3(&vertices[indices[i]].position), center)));
+
+		XMStoreFloat3(&meshlet.center, center);
+		meshlet.radius = std::sqrt(XMVectorGetX(radius));
+
+		// normal cone from the geometric normals, which is what the rasterizer culls on
+		auto axis = XMVectorZero();
+
+		for (UINT i = first; i < last; i += 3)
+		{
+			const auto p0 = XMLoadFloat3(&vertices[indices[i]].position);
+			const auto p1 = XMLoadFloat3(&vertices[indices[i + 1]].position);
+			const auto p2 = XMLoadFloat3(&vertices[indices[i + 2]].position);
+			axis = XMVectorAdd(axis, XMVector3Normalize(XMVector3Cross(XMVectorSubtract(p1, p0), XMVectorSubtract(p2, p0))));
+		}
+
+		axis = XMVector3Normalize(axis);
+
+		float minDot = 1.f;
+
+		for (UINT i = first; i < last && minDot > minConeDot; i += 3)
+		{
+			const auto p0 = XMLoadFloat3(&vertices[indices[i]].position);
+			const auto p1 = XMLoadFloat3(&vertices[indices[i + 1]].position);
+			const auto p2 = XMLoadFloat3(&vertices[indices[i + 2]].position);
+			const auto normal = XMVector3Normalize(XMVector3Cross(XMVectorSubtract(p1, p0), XMVectorSubtract(p2, p0)));
+
+			minDot = std::min(minDot, XMVectorGetX(XMVector3Dot(normal, axis)));
+		}
+
+		if (minDot <= minConeDot || XMVector3Equal(axis, XMVectorZero()))
+		{
+			meshlet.coneApex = meshlet.center;
+			meshlet.coneAxis = { 0.f, 0.f, 0.f };
+			meshlet.coneCutoff = 1.f;
+			return;
+		}
+
+		// push the apex back along the axis until it is behind every triangle's plane
+		float maxT = 0.f;
+
+		for (UINT i = first; i < last; i += 3)
+		{
+			const auto p0 = XMLoadFloat3(&vertices[indices[i]].position);
+			const auto p1 = XMLoadFloat3(&vertices[indices[i + 1]].position);
+			const auto p2 = XMLoadFloat3(&vertices[indices[i + 2]].position);
+			const auto normal = XMVector3Normalize(XMVector3Cross(XMVectorSubtract(p1, p0), XMVectorSubtract(p2, p0)));
+
+			const float dc = XMVectorGetX(XMVector3Dot(XMVectorSubtract(center, p0), normal));
+			const float dn = XMVectorGetX(XMVector3Dot(axis, normal));
+
+			maxT = std::max(maxT, dc / dn);
+		}
+
+		XMStoreFloat3(&meshlet.coneApex, XMVectorSubtract(center, XMVectorScale(axis, maxT)));
+		XMStoreFloat3(&meshlet.coneAxis, axis);
+		// the view direction has to fall inside the cone widened by 90 degrees: sin of the half angle
+		meshlet.coneCutoff = std::sqrt(1.f - minDot * minDot);
+	}
+}
+
+std::vector<Meshlet> MeshletBuilder::Build(const std::vector<SimpleVertex>& vertices, const std::vector<UINT>& indices,
+	const MeshletSettings& settings)
+{
+	std::vector<Meshlet> meshlets;
+
+	// which meshlet last used each vertex, offset by one so zero means none
+	std::vector<UINT> owner(vertices.size(), 0);
+
+	Meshlet current;
+
+	const auto finish = [&]()
+	{
+		if (current.indexCount == 0)
+			return;
+
+		ComputeBounds(vertices, indices, current);
+		meshlets.push_back(current);
+
+		current = {};
+		current.indexOffset = UINT(meshlets.back().indexOffset + meshlets.back().indexCount);
+	};
+
+	for (size_t i = 0; i + 2 < indices.size(); i += 3)
+	{
+		const UINT id = UINT(meshlets.size() + 1);
+		UINT added = 0;
+
+		for (int k = 0; k < 3; k++)
+			if (owner[indices[i + k]] != id)
+				added++;
+
+		// duplicated corners of a degenerate triangle are counted twice, which only makes the limit stricter
+		if (current.vertexCount + added > settings.maxVertices || current.indexCount / 3 + 1 > settings.maxTriangles)
+			finish();
+
+		const UINT owned = UINT(meshlets.size() + 1);
+
+		for (int k = 0; k < 3; k++)
+		{
+			if (owner[indices[i + k]] != owned)
+			{
+				owner[indices[i + k]] = owned;
+				current.vertexCount++;
+			}
+		}
+
+		current.indexCount += 3;
+	}
+
+	finish();
+
+	return meshlets;
+}
+
+ClusterCullStats MeshletBuilder::Cull(const std::vector<Meshlet>& meshlets, FXMMATRIX worldViewProjection,
+	FXMVECTOR cameraPosition, bool backfaceCulling, std::vector<IndexRange>& ranges)
+{
+	ClusterCullStats stats;
+	stats.meshlets = meshlets.size();
+
+	ranges.clear();
+
+	// model space frustum planes straight from the combined matrix, D3D clip space (0 <= z <= w)
+	const auto m = XMMatrixTranspose(worldViewProjection);
+	const XMVECTOR planes[6] =
+	{
+		XMPlaneNormalize(XMVectorAdd(m.r[3], m.r[0])),
+		XMPlaneNormalize(XMVectorSubtract(m.r[3], m.r[0])),
+		XMPlaneNormalize(XMVectorAdd(m.r[3], m.r[1])),
+		XMPlaneNormalize(XMVectorSubtract(m.r[3], m.r[1])),
+		XMPlaneNormalize(m.r[2]),
+		XMPlaneNormalize(XMVectorSubtract(m.r[3], m.r[2])),
+	};
+
+	for (const auto& meshlet : meshlets)
+	{
+		stats.triangles += meshlet.indexCount / 3;
+
+		const auto center = XMLoadFloat3(&meshlet.center);
+		bool outside = false;
+
+		for (const auto& plane : planes)
+		{
+			if (XMVectorGetX(XMPlaneDotCoord(plane, center)) < -meshlet.radius)
+			{
+				outside = true;
+				break;
+			}
+		}
+
+		if (outside)
+		{
+			stats.frustumCulled++;
+			continue;
+		}
+
+		if (backfaceCulling && meshlet.coneCutoff < 1.f)
+		{
+			const auto view = XMVector3Normalize(XMVectorSubtract(XMLoadFloat3(&meshlet.coneApex), cameraPosition));
+
+			if (XMVectorGetX(XMVector3Dot(view, XMLoadFloat3(&meshlet.coneAxis))) >= meshlet.coneCutoff)
+			{
+				stats.backfaceCulled++;
+				continue;
+			}
+		}
+
+		stats.visibleMeshlets++;
+		stats.visibleTriangles += meshlet.indexCount / 3;
+
+		if (!ranges.empty() && ranges.back().start + ranges.back().count == meshlet.indexOffset)
+			ranges.back().count += meshlet.indexCount;
+		else
+			ranges.push_back({ meshlet.indexOffset, meshlet.indexCount });
+	}
+
+	return stats;
+}
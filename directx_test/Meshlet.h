@@ -0,0 +1,61 @@
+#pragma once
+#include "WinTypes.h"
+#include <vector>
+#include <DirectXMath.h>
+#include "SimpleVertex.h"
+
+// A run of consecutive triangles in a mesh's index buffer, small enough to be culled as a unit.
+struct Meshlet
+{
+	UINT indexOffset = 0;
+	UINT indexCount = 0;
+	UINT vertexCount = 0;
+
+	// bounding sphere, model space
+	DirectX::XMFLOAT3 center;
+	float radius = 0.f;
+
+	// Normal cone of the triangles. The meshlet faces away from a camera at c when
+	// dot(normalize(coneApex - c), coneAxis) >= coneCutoff. A cutoff of 1 disables the test.
+	DirectX::XMFLOAT3 coneApex;
+	DirectX::XMFLOAT3 coneAxis;
+	float coneCutoff = 1.f;
+};
+
+struct MeshletSettings
+{
+	UINT maxVertices = 64;
+	UINT maxTriangles = 124;
+};
+
+struct IndexRange
+{
+	UINT start = 0;
+	UINT count = 0;
+};
+
+struct ClusterCullStats
+{
+	size_t meshlets = 0;
+	size_t visibleMeshlets = 0;
+	size_t frustumCulled = 0;
+	size_t backfaceCulled = 0;
+	size_t triangles = 0;
+	size_t visibleTriangles = 0;
+};
+
+class MeshletBuilder
+{
+public:
+
+	// Splits indices into meshlets in their current order, so run IndexOptimizer first to get tight clusters.
+	// Triangles are not reordered; each meshlet is a contiguous index range.
+	static std::vector<Meshlet> Build(const std::vector<SimpleVertex>& vertices, const std::vector<UINT>& indices,
+		const MeshletSettings& settings = {});
+
+	// Tests every meshlet against the frustum of worldViewProjection and, when backfaceCulling is set, against
+	// its normal cone as seen from cameraPosition (model space). Visible ranges that touch are merged and
+	// written to ranges, replacing its contents. Cone tests assume uniform scale; pass false otherwise.
+	static ClusterCullStats Cull(const std::vector<Meshlet>& meshlets, DirectX::FXMMATRIX worldViewProjection,
+		DirectX::FXMVECTOR cameraPosition, bool backfaceCulling, std::vector<IndexRange>& ranges);
+};
@@ -0,0 +1,315 @@
+#include "NormalGenerator.h"
+#include "MeshWelder.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+#include <numeric>
+
+using namespace DirectX;
+
+namespace
+{
+	constexpr size_t trianglesPerChunk = 16384;
+	constexpr size_t verticesPerChunk = 16384;
+	constexpr UINT noVertex = ~0u;
+	// corners whose normals are within about a degree of each other share a vertex when splitting along creases
+	constexpr float sameNormalCos = 0.9998f;
+
+	// Lists the corners (positions in the index buffer) around every key: the corners of key k are
+	// corners[offsets[k]] to corners[offsets[k + 1]], in increasing order. Threads claim slots with
+	// atomic increments, so no corner waits on a lock.
+	void BuildCornerLists(const std::vector<UINT>& indices, const std::vector<UINT>& keyOf, size_t keyCount,
+		std::vector<UINT>& offsets, std::vector<UINT>& corners)
+	{
+		offsets.assign(keyCount + 1, 0);
+
+		ParallelFor(indices.size(), trianglesPerChunk * 3, [&](size_t begin, size_t end)
+		{
+			for (size_t c = begin; c < end; c++)
+				std::atomic_ref(offsets[keyOf[indices[c]] + 1]).fetch_add(1, std::memory_order_relaxed);
+		});
+
+		for (size_t k = 0; k < keyCount; k++)
+			offsets[k + 1] += offsets[k];
+
+		std::vector<UINT> cursor(offsets.begin(), offsets.end() - 1);
+		corners.resize(indices.size());
+
+		ParallelFor(indices.size(), trianglesPerChunk * 3, [&](size_t begin, size_t end)
+		{
+			for (size_t c = begin; c < end; c++)
+				corners[std::atomic_ref(cursor[keyOf[indices[c]]]).fetch_add(1, std::memory_order_relaxed)] = UINT(c);
+		});
+
+		// slots went to whichever thread got there first; sorted lists make the sums independent of scheduling
+		ParallelFor(keyCount, verticesPerChunk, [&](size_t begin, size_t end)
+		{
+			for (size_t k = begin; k < end; k++)
+				std::sort(corners.begin() + offsets[k], corners.begin() + offsets[k + 1]);
+		});
+	}
+
+	XMVECTOR XM_CALLCONV AnyPerpendicular(FXMVECTOR n)
+	{
+		const XMVECTOR axis = std::abs(XMVectorGetX(n)) < 0.9f ? XMVectorSet(1.f, 0.f, 0.f, 0.f) : XMVectorSet(0.f, 1.f, 0.f, 0.f);
+		return XMVector3Normalize(XMVector3Cross(n, axis));
+	}
+}
+
+NormalStats NormalGenerator::GenerateNormals(std::vector<SimpleVertex>& vertices, std::vector<UINT>& indices, const NormalSettings& settings)
+{
+	NormalStats stats{};
+	stats.verticesBefore = vertices.size();
+
+	const size_t triangleCount = indices.size() / 3;
+
+	// unit face normals, zero for degenerate faces, and the weight each face has at each of its corners
+	std::vector<XMFLOAT3> faceNormals(triangleCount);
+	std::vector<float> cornerWeights(triangleCount * 3);
+	std::atomic<size_t> degenerate = 0;
+
+	ParallelFor(triangleCount, trianglesPerChunk, [&](size_t begin, size_t end)
+	{
+		size_t chunkDegenerate = 0;
+
+		for (size_t t = begin; t < end; t++)
+		{
+			const XMVECTOR p[3] = {
+				XMLoadFloat3(&vertices[indices[t * 3]].position),
+				XMLoadFloat3(&vertices[indices[t * 3 + 1]].position),
+				XMLoadFloat3(&vertices[indices[t * 3 + 2]].position)
+			};
+
+			const XMVECTOR cross = XMVector3Cross(p[1] - p[0], p[2] - p[0]);
+			const float doubleArea = XMVectorGetX(XMVector3Length(cross));
+
+			if (!(doubleArea > FLT_MIN))
+			{
+				faceNormals[t] = { 0.f, 0.f, 0.f };
+				std::fill_n(cornerWeights.begin() + t * 3, 3, 0.f);
+				chunkDegenerate++;
+				continue;
+			}
+
+			XMStoreFloat3(&faceNormals[t], cross * (1.f / doubleArea));
+
+			for (size_t corner = 0; corner < 3; corner++)
+			{
+				float weight = 1.f;
+
+				if (settings.weighting == NormalWeighting::Area)
+				{
+					weight = doubleArea;
+				}
+				else if (settings.weighting == NormalWeighting::Angle)
+				{
+					const XMVECTOR toNext = XMVector3Normalize(p[(corner + 1) % 3] - p[corner]);
+					const XMVECTOR toPrevious = XMVector3Normalize(p[(corner + 2) % 3] - p[corner]);
+					weight = XMVectorGetX(XMVector3AngleBetweenNormals(toNext, toPrevious));
+				}
+
+				cornerWeights[t * 3 + corner] = weight;
+			}
+		}
+
+		degenerate += chunkDegenerate;
+	});
+
+	stats.degenerateTriangles = degenerate;
+
+	std::vector<UINT> keyOf;
+	size_t keyCount;
+
+	if (settings.smoothAcrossSeams)
+	{
+		std::vector<UINT> groupSizes;
+		keyOf = MeshWelder::GroupByPosition(vertices, groupSizes);
+		keyCount = groupSizes.size();
+	}
+	else
+	{
+		keyOf.resize(vertices.size());
+		std::iota(keyOf.begin(), keyOf.end(), 0u);
+		keyCount = vertices.size();
+	}
+
+	std::vector<UINT> offsets, corners;
+	BuildCornerLists(indices, keyOf, keyCount, offsets, corners);
+
+	// weighted sum of the faces around key whose normals are at most acos(minCos) away from reference
+	const auto gather = [&](UINT key, FXMVECTOR reference, float minCos)
+	{
+		XMVECTOR sum = XMVectorZero();
+
+		for (UINT o = offsets[key]; o < offsets[key + 1]; o++)
+		{
+			const UINT c = corners[o];
+			const XMVECTOR face = XMLoadFloat3(&faceNormals[c / 3]);
+
+			if (XMVectorGetX(XMVector3Dot(face, reference)) >= minCos)
+				sum = XMVectorMultiplyAdd(face, XMVectorReplicate(cornerWeights[c]), sum);
+		}
+
+		return sum;
+	};
+
+	if (settings.creaseAngle >= XM_PI)
+	{
+		// one normal per key; vertices sharing a key sum the same list in the same order and agree bitwise
+		ParallelFor(vertices.size(), verticesPerChunk, [&](size_t begin, size_t end)
+		{
+			for (size_t v = begin; v < end; v++)
+			{
+				const XMVECTOR sum = gather(keyOf[v], XMVectorZero(), -FLT_MAX);
+
+				if (XMVectorGetX(XMVector3LengthSq(sum)) > 0.f)
+					XMStoreFloat3(&vertices[v].normal, XMVector3Normalize(sum));
+			}
+		});
+
+		stats.verticesAfter = vertices.size();
+		return stats;
+	}
+
+	// each corner only sees the faces within the crease angle of its own face
+	const float minCos = std::cos(settings.creaseAngle);
+	std::vector<XMFLOAT3> cornerNormals(indices.size());
+
+	ParallelFor(triangleCount, trianglesPerChunk, [&](size_t begin, size_t end)
+	{
+		for (size_t t = begin; t < end; t++)
+		{
+			const XMVECTOR face = XMLoadFloat3(&faceNormals[t]);
+			// a degenerate face has no direction to compare against and takes the smooth normal
+			const bool flat = XMVector3Equal(face, XMVectorZero());
+
+			for (size_t c = t * 3; c < t * 3 + 3; c++)
+			{
+				const XMVECTOR sum = gather(keyOf[indices[c]], face, flat ? -FLT_MAX : minCos);
+
+				if (XMVectorGetX(XMVector3LengthSq(sum)) > 0.f)
+					XMStoreFloat3(&cornerNormals[c], XMVector3Normalize(sum));
+				else if (!flat)
+					cornerNormals[c] = faceNormals[t];
+				else
+					cornerNormals[c] = vertices[indices[c]].normal;
+			}
+		}
+	});
+
+	// Corners that ended up with different normals cannot share a vertex. The first corner keeps the
+	// original; each further normal gets a copy, chained through nextVariant so later corners find it.
+	std::vector<UINT> nextVariant(vertices.size(), noVertex);
+	std::vector<bool> assigned(vertices.size(), false);
+
+	for (size_t c = 0; c < indices.size(); c++)
+	{
+		const UINT v = indices[c];
+
+		if (!assigned[v])
+		{
+			vertices[v].normal = cornerNormals[c];
+			assigned[v] = true;
+			continue;
+		}
+
+		const XMVECTOR normal = XMLoadFloat3(&cornerNormals[c]);
+		UINT u = v;
+
+		while (XMVectorGetX(XMVector3Dot(XMLoadFloat3(&vertices[u].normal), normal)) < sameNormalCos)
+		{
+			if (nextVariant[u] == noVertex)
+			{
+				SimpleVertex copy = vertices[v];
+				copy.normal = cornerNormals[c];
+
+				nextVariant[u] = UINT(vertices.size());
+				nextVariant.push_back(noVertex);
+				vertices.push_back(copy);
+			}
+
+			u = nextVariant[u];
+		}
+
+		indices[c] = u;
+	}
+
+	stats.verticesAfter = vertices.size();
+	return stats;
+}
+
+void NormalGenerator::GenerateTangents(const std::vector<SimpleVertex>& vertices, const std::vector<UINT>& indices, std::vector<XMFLOAT4>& tangents)
+{
+	const size_t triangleCount = indices.size() / 3;
+
+	// per-face directions of increasing u and v, scaled by the face's area so large faces dominate
+	std::vector<XMFLOAT3> faceTangents(triangleCount), faceBitangents(triangleCount);
+
+	ParallelFor(triangleCount, trianglesPerChunk, [&](size_t begin, size_t end)
+	{
+		for (size_t t = begin; t < end; t++)
+		{
+			const SimpleVertex& a = vertices[indices[t * 3]];
+			const SimpleVertex& b = vertices[indices[t * 3 + 1]];
+			const SimpleVertex& c = vertices[indices[t * 3 + 2]];
+
+			const XMVECTOR e1 = XMLoadFloat3(&b.position) - XMLoadFloat3(&a.position);
+			const XMVECTOR e2 = XMLoadFloat3(&c.position) - XMLoadFloat3(&a.position);
+			const float du1 = b.texCoord.x - a.texCoord.x, dv1 = b.texCoord.y - a.texCoord.y;
+			const float du2 = c.texCoord.x - a.texCoord.x, dv2 = c.texCoord.y - a.texCoord.y;
+			const float determinant = du1 * dv2 - du2 * dv1;
+			const float doubleArea = XMVectorGetX(XMVector3Length(XMVector3Cross(e1, e2)));
+
+			if (!(std::abs(determinant) > FLT_MIN) || !(doubleArea > FLT_MIN))
+			{
+				faceTangents[t] = faceBitangents[t] = { 0.f, 0.f, 0.f };
+				continue;
+			}
+
+			const XMVECTOR tangent = (e1 * dv2 - e2 * dv1) * (1.f / determinant);
+			const XMVECTOR bitangent = (e2 * du1 - e1 * du2) * (1.f / determinant);
+
+			XMStoreFloat3(&faceTangents[t], XMVector3Normalize(tangent) * doubleArea);
+			XMStoreFloat3(&faceBitangents[t], XMVector3Normalize(bitangent) * doubleArea);
+		}
+	});
+
+	// tangents follow the UVs, so unlike normals they are never shared across seams
+	std::vector<UINT> keyOf(vertices.size());
+	std::iota(keyOf.begin(), keyOf.end(), 0u);
+
+	std::vector<UINT> offsets, corners;
+	BuildCornerLists(indices, keyOf, vertices.size(), offsets, corners);
+
+	tangents.resize(vertices.size());
+
+	ParallelFor(vertices.size(), verticesPerChunk, [&](size_t begin, size_t end)
+	{
+		for (size_t v = begin; v < end; v++)
+		{
+			XMVECTOR tangent = XMVectorZero(), bitangent = XMVectorZero();
+
+			for (UINT o = offsets[v]; o < offsets[v + 1]; o++)
+			{
+				tangent = tangent + XMLoadFloat3(&faceTangents[corners[o] / 3]);
+				bitangent = bitangent + XMLoadFloat3(&faceBitangents[corners[o] / 3]);
+			}
+
+			const XMVECTOR normal = XMVector3Normalize(XMLoadFloat3(&vertices[v].normal));
+
+			// Gram-Schmidt against the vertex normal
+			tangent = tangent - normal * XMVectorGetX(XMVector3Dot(normal, tangent));
+
+			if (XMVectorGetX(XMVector3LengthSq(tangent)) > FLT_MIN)
+				tangent = XMVector3Normalize(tangent);
+			else
+				tangent = AnyPerpendicular(normal);
+
+			const float handedness = XMVectorGetX(XMVector3Dot(XMVector3Cross(normal, tangent), bitangent)) < 0.f ? -1.f : 1.f;
+
+			XMStoreFloat4(&tangents[v], XMVectorSetW(tangent, handedness));
+		}
+	});
+}
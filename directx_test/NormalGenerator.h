@@ -0,0 +1,51 @@
+#pragma once
+#include "WinTypes.h"
+#include <vector>
+#include <DirectXMath.h>
+#include "SimpleVertex.h"
+
+enum class NormalWeighting
+{
+	// every face counts the same, so dense patches pull the normal toward themselves
+	Uniform,
+	// faces count by their area
+	Area,
+	// faces count by their corner angle at the vertex, which does not depend on how a flat region is triangulated
+	Angle
+};
+
+struct NormalSettings
+{
+	NormalWeighting weighting = NormalWeighting::Angle;
+	// Faces whose normals differ by more than this stay hard edged; vertices on such edges are split.
+	// Pi smooths everything and never adds vertices.
+	float creaseAngle = DirectX::XM_PI;
+	// Averages over all vertices at the same position, not just the same vertex, so UV and color
+	// seams do not show up in the shading.
+	bool smoothAcrossSeams = true;
+};
+
+struct NormalStats
+{
+	size_t verticesBefore = 0;
+	size_t verticesAfter = 0;
+	// zero-area triangles; they keep the normals their vertices get from other faces
+	size_t degenerateTriangles = 0;
+
+	constexpr size_t VerticesAdded() const noexcept { return verticesAfter - verticesBefore; }
+};
+
+class NormalGenerator
+{
+public:
+
+	// Replaces every referenced vertex's normal with a weighted average of the face normals around it.
+	// Faces are scattered to their vertices in parallel without locks, and the result does not depend
+	// on the thread count. Vertices that no triangle uses keep their normal.
+	static NormalStats GenerateNormals(std::vector<SimpleVertex>& vertices, std::vector<UINT>& indices, const NormalSettings& settings = {});
+
+	// Per-vertex tangents along increasing u, orthogonal to the vertex normal. w is the handedness:
+	// bitangent = cross(normal, tangent.xyz) * w. Vertices without usable UVs get some tangent
+	// orthogonal to their normal.
+	static void GenerateTangents(const std::vector<SimpleVertex>& vertices, const std::vector<UINT>& indices, std::vector<DirectX::XMFLOAT4>& tangents);
+};
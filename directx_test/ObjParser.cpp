@@ -0,0 +1,446 @@
+#include "ObjParser.h"
+#include "MappedFile.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+using namespace DirectX;
+
+namespace
+{
+	// below this, splitting the file costs more than it saves
+	constexpr size_t minChunkBytes = size_t(1) << 20;
+
+	constexpr int32_t missing = -1;
+
+	enum RelativeFlags : uint8_t
+	{
+		RelativePosition = 1,
+		RelativeTexCoord = 2,
+		RelativeNormal = 4
+	};
+
+	// One triangle corner. Indices are 0-based. While a chunk is being parsed, negative OBJ indices
+	// can only be resolved against the chunk's own element counts, so they are flagged and the
+	// chunk's base is added once every chunk's counts are known.
+	struct Corner
+	{
+		int32_t position = missing;
+		int32_t texCoord = missing;
+		int32_t normal = missing;
+		uint8_t relative = 0;
+	};
+
+	struct Chunk
+	{
+		const char* begin;
+		const char* end;
+
+		std::vector<XMFLOAT3> positions;
+		std::vector<XMFLOAT2> texCoords;
+		std::vector<XMFLOAT3> normals;
+		// three per triangle
+		std::vector<Corner> corners;
+
+		size_t positionBase = 0;
+		size_t texCoordBase = 0;
+		size_t normalBase = 0;
+
+		bool malformed = false;
+	};
+
+	void SkipSpaces(const char*& p, const char* end) noexcept
+	{
+		while (p < end && (*p == ' ' || *p == '\t' || *p == '\r'))
+			p++;
+	}
+
+	bool ParseFloat(const char*& p, const char* end, float& value) noexcept
+	{
+		SkipSpaces(p, end);
+
+		// from_chars does not accept an explicit plus sign
+		if (p < end && *p == '+')
+			p++;
+
+		const auto [next, ec] = std::from_chars(p, end, value);
+		p = next;
+
+		return ec == std::errc();
+	}
+
+	bool ParseIndex(const char*& p, const char* end, int32_t& value) noexcept
+	{
+		const auto [next, ec] = std::from_chars(p, end, value);
+		p = next;
+
+		return ec == std::errc() && value != 0;
+	}
+
+	// Converts a 1-based or negative OBJ index into a 0-based one, flagging negative ones as relative.
+	void Resolve(int32_t index, size_t count, int32_t& out, uint8_t& relative, uint8_t flag) noexcept
+	{
+		if (index > 0)
+		{
+			out = index - 1;
+			return;
+		}
+
+		out = int32_t(count) + index;
+		relative |= flag;
+	}
+
+	bool ParseFace(const char* p, const char* end, Chunk& chunk, std::vector<Corner>& polygon)
+	{
+		polygon.clear();
+
+		for (;;)
+		{
+			SkipSpaces(p, end);
+
+			if (p >= end)
+				break;
+
+			Corner corner;
+			int32_t index = 0;
+
+			if (!ParseIndex(p, end, index))
+				return false;
+
+			Resolve(index, chunk.positions.size(), corner.position, corner.relative, RelativePosition);
+
+			if (p < end && *p == '/')
+			{
+				p++;
+
+				if (p < end && *p != '/')
+				{
+					if (!ParseIndex(p, end, index))
+						return false;
+
+					Resolve(index, chunk.texCoords.size(), corner.texCoord, corner.relative, RelativeTexCoord);
+				}
+
+				if (p < end && *p == '/')
+				{
+					p++;
+
+					if (!ParseIndex(p, end, index))
+						return false;
+
+					Resolve(index, chunk.normals.size(), corner.normal, corner.relative, RelativeNormal);
+				}
+			}
+
+			polygon.push_back(corner);
+		}
+
+		if (polygon.size() < 3)
+			return false;
+
+		// fan around the first corner, keeping the file's winding
+		for (size_t i = 2; i < polygon.size(); i++)
+		{
+			chunk.corners.push_back(polygon[0]);
+			chunk.corners.push_back(polygon[i - 1]);
+			chunk.corners.push_back(polygon[i]);
+		}
+
+		return true;
+	}
+
+	void ParseChunk(Chunk& chunk)
+	{
+		std::vector<Corner> polygon;
+
+		for (const char* line = chunk.begin; line < chunk.end;)
+		{
+			const char* newline = static_cast<const char*>(std::memchr(line, '\n', chunk.end - line));
+			const char* end = newline ? newline : chunk.end;
+			const char* p = line;
+
+			line = end + 1;
+
+			SkipSpaces(p, end);
+
+			if (end - p < 2)
+				continue;
+
+			bool ok = true;
+
+			if (p[0] == 'v' && (p[1] == ' ' || p[1] == '\t'))
+			{
+				XMFLOAT3 v;
+				p++;
+				ok = ParseFloat(p, end, v.x) && ParseFloat(p, end, v.y) && ParseFloat(p, end, v.z);
+				chunk.positions.push_back(v);
+			}
+			else if (p[0] == 'v' && p[1] == 'n')
+			{
+				XMFLOAT3 n;
+				p += 2;
+				ok = ParseFloat(p, end, n.x) && ParseFloat(p, end, n.y) && ParseFloat(p, end, n.z);
+				chunk.normals.push_back(n);
+			}
+			else if (p[0] == 'v' && p[1] == 't')
+			{
+				XMFLOAT2 t{};
+				p += 2;
+				ok = ParseFloat(p, end, t.x);
+
+				// the v coordinate is optional
+				const char* save = p;
+				if (!ParseFloat(p, end, t.y))
+				{
+					p = save;
+					t.y = 0.f;
+				}
+
+				t.y = 1.f - t.y;
+				chunk.texCoords.push_back(t);
+			}
+			else if (p[0] == 'f' && (p[1] == ' ' || p[1] == '\t'))
+			{
+				ok = ParseFace(p + 1, end, chunk, polygon);
+			}
+
+			if (!ok)
+				chunk.malformed = true;
+		}
+	}
+
+	// Adds the chunk bases to relative indices and checks every index against the merged pools.
+	bool ResolveChunk(Chunk& chunk, size_t positionCount, size_t texCoordCount, size_t normalCount) noexcept
+	{
+		bool valid = true;
+
+		const auto check = [&](int32_t& index, bool relative, size_t base, size_t count)
+		{
+			if (index == missing && !relative)
+				return;
+
+			const int64_t absolute = relative ? int64_t(base) + index : index;
+
+			if (absolute < 0 || absolute >= int64_t(count))
+				valid = false;
+
+			index = int32_t(absolute);
+		};
+
+		for (auto& c : chunk.corners)
+		{
+			check(c.position, c.relative & RelativePosition, chunk.positionBase, positionCount);
+			check(c.texCoord, c.relative & RelativeTexCoord, chunk.texCoordBase, texCoordCount);
+			check(c.normal, c.relative & RelativeNormal, chunk.normalBase, normalCount);
+			c.relative = 0;
+		}
+
+		return valid;
+	}
+
+	// Open addressing map from a position/texcoord/normal triple to its vertex index.
+	class CornerTable
+	{
+	public:
+
+		explicit CornerTable(size_t expected)
+		{
+			size_t capacity = 64;
+			while (capacity < expected * 2)
+				capacity *= 2;
+
+			m_entries.resize(capacity);
+		}
+
+		// Returns the vertex index for the triple, or inserts next and returns it.
+		UINT FindOrInsert(const Corner& corner, UINT next)
+		{
+			if ((m_count + 1) * 2 > m_entries.size())
+				Grow();
+
+			const size_t mask = m_entries.size() - 1;
+
+			for (size_t slot = Hash(corner) & mask;; slot = (slot + 1) & mask)
+			{
+				auto& entry = m_entries[slot];
+
+				if (entry.vertex == empty)
+				{
+					entry = { corner.position, corner.texCoord, corner.normal, next };
+					m_count++;
+					return next;
+				}
+
+				if (entry.position == corner.position && entry.texCoord == corner.texCoord && entry.normal == corner.normal)
+					return entry.vertex;
+			}
+		}
+
+	private:
+
+		static constexpr UINT empty = ~0u;
+
+		struct Entry
+		{
+			int32_t position = missing;
+			int32_t texCoord = missing;
+			int32_t normal = missing;
+			UINT vertex = empty;
+		};
+
+		static size_t Hash(const Corner& c) noexcept
+		{
+			const uint64_t h = uint64_t(uint32_t(c.position)) * 0x9E3779B97F4A7C15ull
+				^ uint64_t(uint32_t(c.texCoord)) * 0xC2B2AE3D27D4EB4Full
+				^ uint64_t(uint32_t(c.normal)) * 0x165667B19E3779F9ull;
+
+			return size_t(h ^ (h >> 29));
+		}
+
+		void Grow()
+		{
+			std::vector<Entry> old(m_entries.size() * 2);
+			old.swap(m_entries);
+
+			const size_t mask = m_entries.size() - 1;
+
+			for (const auto& entry : old)
+			{
+				if (entry.vertex == empty)
+					continue;
+
+				Corner c;
+				c.position = entry.position;
+				c.texCoord = entry.texCoord;
+				c.normal = entry.normal;
+
+				size_t slot = Hash(c) & mask;
+				while (m_entries[slot].vertex != empty)
+					slot = (slot + 1) & mask;
+
+				m_entries[slot] = entry;
+			}
+		}
+
+		std::vector<Entry> m_entries;
+		size_t m_count = 0;
+	};
+}
+
+void ObjParser::Load(std::wstring_view fileName, std::vector<SimpleVertex>& vertices, std::vector<UINT>& indices)
+{
+	MappedFile file;
+
+	if (!file.Open(std::wstring(fileName)))
+		throw std::runtime_error("failed to open OBJ file");
+
+	Parse(reinterpret_cast<const char*>(file.Data()), size_t(file.Size()), vertices, indices);
+}
+
+void ObjParser::Parse(const char* data, size_t size, std::vector<SimpleVertex>& vertices, std::vector<UINT>& indices)
+{
+	vertices.clear();
+	indices.clear();
+
+	// split on line boundaries
+	const size_t chunkCount = std::clamp<size_t>(size / minChunkBytes, 1, ParallelThreadCount());
+
+	std::vector<Chunk> chunks(chunkCount);
+	const char* const end = data + size;
+	const char* begin = data;
+
+	for (size_t i = 0; i < chunkCount; i++)
+	{
+		const char* split = i + 1 == chunkCount ? end : data + size / chunkCount * (i + 1);
+
+		if (split < begin)
+			split = begin;
+
+		if (split < end)
+		{
+			const char* newline = static_cast<const char*>(std::memchr(split, '\n', end - split));
+			split = newline ? newline + 1 : end;
+		}
+
+		chunks[i].begin = begin;
+		chunks[i].end = split;
+		begin = split;
+	}
+
+	ParallelFor(chunks.size(), 1, [&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+			ParseChunk(chunks[i]);
+	});
+
+	// merge the per-chunk pools
+	size_t positionCount = 0, texCoordCount = 0, normalCount = 0, cornerCount = 0;
+
+	for (auto& chunk : chunks)
+	{
+		if (chunk.malformed)
+			throw std::runtime_error("malformed OBJ statement");
+
+		chunk.positionBase = positionCount;
+		chunk.texCoordBase = texCoordCount;
+		chunk.normalBase = normalCount;
+
+		positionCount += chunk.positions.size();
+		texCoordCount += chunk.texCoords.size();
+		normalCount += chunk.normals.size();
+		cornerCount += chunk.corners.size();
+	}
+
+	std::vector<XMFLOAT3> positions(positionCount);
+	std::vector<XMFLOAT2> texCoords(texCoordCount);
+	std::vector<XMFLOAT3> normals(normalCount);
+	std::atomic<bool> valid = true;
+
+	ParallelFor(chunks.size(), 1, [&](size_t first, size_t last)
+	{
+		for (size_t i = first; i < last; i++)
+		{
+			auto& chunk = chunks[i];
+
+			std::copy(chunk.positions.begin(), chunk.positions.end(), positions.begin() + chunk.positionBase);
+			std::copy(chunk.texCoords.begin(), chunk.texCoords.end(), texCoords.begin() + chunk.texCoordBase);
+			std::copy(chunk.normals.begin(), chunk.normals.end(), normals.begin() + chunk.normalBase);
+
+			if (!ResolveChunk(chunk, positionCount, texCoordCount, normalCount))
+				valid = false;
+		}
+	});
+
+	if (!valid)
+		throw std::runtime_error("OBJ face index out of range");
+
+	// one vertex per distinct corner, in first-use order
+	CornerTable table(positionCount);
+	indices.reserve(cornerCount);
+	vertices.reserve(positionCount);
+
+	for (const auto& chunk : chunks)
+	{
+		for (const auto& c : chunk.corners)
+		{
+			const UINT next = UINT(vertices.size());
+			const UINT index = table.FindOrInsert(c, next);
+
+			if (index == next)
+			{
+				vertices.emplace_back(
+					positions[c.position],
+					XMFLOAT3{ 1.f, 1.f, 1.f },
+					c.normal == missing ? XMFLOAT3{ 0.f, 0.f, 0.f } : normals[c.normal],
+					c.texCoord == missing ? XMFLOAT2{ 0.f, 0.f } : texCoords[c.texCoord]
+				);
+			}
+
+			indices.push_back(index);
+		}
+	}
+}
@@ -0,0 +1,20 @@
+#pragma once
+#include "WinTypes.h"
+#include <string_view>
+#include <vector>
+#include "SimpleVertex.h"
+
+// Wavefront OBJ reader for v, vt, vn and f statements; everything else is skipped.
+//
+// The file is mapped and split into line-aligned chunks that are parsed in parallel. Polygons are
+// fanned into triangles and negative (relative) indices are supported. Each distinct
+// position/texcoord/normal triple becomes one SimpleVertex, numbered in first-use order.
+// Like WaveFrontReader, texture v is flipped to 1 - v and faces keep their winding.
+class ObjParser
+{
+public:
+
+	// Throws std::exception if the file cannot be read or a face refers to a missing element.
+	static void Load(std::wstring_view fileName, std::vector<SimpleVertex>& vertices, std::vector<UINT>& indices);
+	static void Parse(const char* data, size_t size, std::vector<SimpleVertex>& vertices, std::vector<UINT>& indices);
+};
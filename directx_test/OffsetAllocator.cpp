@@ -0,0 +1,236 @@
+#include "OffsetAllocator.h"
+#include <algorithm>
+#include <bit>
+
+OffsetAllocator::OffsetAllocator(uint32_t capacity)
+	: m_capacity(capacity)
+{
+	m_binHeads.fill(OffsetAllocation::none);
+
+	if (capacity == 0)
+		return;
+
+	const uint32_t region = NewRegion();
+	m_regions[region].size = capacity;
+	InsertFree(region);
+}
+
+uint32_t OffsetAllocator::BinOf(uint32_t size) noexcept
+{
+	// sizes below one level's worth of bins get a bin each
+	if (size < binsPerLevel)
+		return size;
+
+	const uint32_t top = uint32_t(std::bit_width(size)) - 1;
+	const uint32_t level = top - 2;
+	const uint32_t bin = (size >> (top - 3)) & (binsPerLevel - 1);
+
+	return level * binsPerLevel + bin;
+}
+
+uint32_t OffsetAllocator::BinMinimum(uint32_t bin) noexcept
+{
+	const uint32_t level = bin / binsPerLevel;
+	const uint32_t step = bin % binsPerLevel;
+
+	return level == 0 ? step : (binsPerLevel + step) << (level - 1);
+}
+
+uint32_t OffsetAllocator::BinFitting(uint32_t size) noexcept
+{
+	const uint32_t bin = BinOf(size);
+
+	return BinMinimum(bin) == size ? bin : bin + 1;
+}
+
+uint32_t OffsetAllocator::FirstFreeBin(uint32_t fromBin) const noexcept
+{
+	uint32_t level = fromBin / binsPerLevel;
+	uint32_t bins = m_usedBins[level] & (0xFFu << (fromBin % binsPerLevel));
+
+	if (bins == 0)
+	{
+		const uint32_t levels = level + 1 < 32 ? m_usedLevels & (~0u << (level + 1)) : 0;
+
+		if (levels == 0)
+			return OffsetAllocation::none;
+
+		level = uint32_t(std::countr_zero(levels));
+		bins = m_usedBins[level];
+	}
+
+	return level * binsPerLevel + uint32_t(std::countr_zero(bins));
+}
+
+uint32_t OffsetAllocator::FindInBin(uint32_t bin, uint32_t size) const noexcept
+{
+	for (uint32_t region = m_binHeads[bin]; region != OffsetAllocation::none; region = m_regions[region].nextFree)
+	{
+		if (m_regions[region].size >= size)
+			return region;
+	}
+
+	return OffsetAllocation::none;
+}
+
+OffsetAllocation OffsetAllocator::Allocate(uint32_t size)
+{
+	if (size == 0)
+		return {};
+
+	const uint32_t fitting = BinFitting(size);
+	const uint32_t bin = fitting < binCount ? FirstFreeBin(fitting) : OffsetAllocation::none;
+	const uint32_t region = bin != OffsetAllocation::none ? m_binHeads[bin] : FindInBin(BinOf(size), size);
+
+	if (region == OffsetAllocation::none)
+		return {};
+
+	RemoveFree(region);
+
+	// the tail goes back as a free region of its own
+	if (m_regions[region].size > size)
+	{
+		const uint32_t rest = NewRegion();
+		auto& taken = m_regions[region];
+		auto& tail = m_regions[rest];
+
+		tail.offset = taken.offset + size;
+		tail.size = taken.size - size;
+		tail.previous = region;
+		tail.next = taken.next;
+
+		if (taken.next != OffsetAllocation::none)
+			m_regions[taken.next].previous = rest;
+
+		taken.next = rest;
+		taken.size = size;
+		InsertFree(rest);
+	}
+
+	m_used += size;
+	m_allocations++;
+
+	return { m_regions[region].offset, size, region };
+}
+
+void OffsetAllocator::Free(const OffsetAllocation& allocation)
+{
+	if (!allocation)
+		return;
+
+	uint32_t region = allocation.region;
+	m_used -= m_regions[region].size;
+	m_allocations--;
+
+	// merge with free neighbours so the space comes back in one piece
+	if (const uint32_t previous = m_regions[region].previous; previous != OffsetAllocation::none && m_regions[previous].free)
+	{
+		RemoveFree(previous);
+		m_regions[previous].size += m_regions[region].size;
+		m_regions[previous].next = m_regions[region].next;
+
+		if (m_regions[region].next != OffsetAllocation::none)
+			m_regions[m_regions[region].next].previous = previous;
+
+		ReleaseRegion(region);
+		region = previous;
+	}
+
+	if (const uint32_t next = m_regions[region].next; next != OffsetAllocation::none && m_regions[next].free)
+	{
+		RemoveFree(next);
+		m_regions[region].size += m_regions[next].size;
+		m_regions[region].next = m_regions[next].next;
+
+		if (m_regions[next].next != OffsetAllocation::none)
+			m_regions[m_regions[next].next].previous = region;
+
+		ReleaseRegion(next);
+	}
+
+	InsertFree(region);
+}
+
+OffsetAllocatorStats OffsetAllocator::Stats() const noexcept
+{
+	OffsetAllocatorStats stats;
+	stats.capacity = m_capacity;
+	stats.used = m_used;
+	stats.allocations = m_allocations;
+	stats.freeRegions = m_freeRegions;
+
+	if (m_usedLevels == 0)
+		return stats;
+
+	// the highest bin holds the largest region, but bins span a range of sizes
+	const uint32_t level = uint32_t(std::bit_width(m_usedLevels)) - 1;
+	const uint32_t bin = level * binsPerLevel + uint32_t(std::bit_width(uint32_t(m_usedBins[level]))) - 1;
+
+	for (uint32_t region = m_binHeads[bin]; region != OffsetAllocation::none; region = m_regions[region].nextFree)
+		stats.largestFreeRegion = std::max(stats.largestFreeRegion, m_regions[region].size);
+
+	return stats;
+}
+
+uint32_t OffsetAllocator::NewRegion()
+{
+	if (m_spareRegions.empty())
+	{
+		m_regions.emplace_back();
+		return uint32_t(m_regions.size() - 1);
+	}
+
+	const uint32_t region = m_spareRegions.back();
+	m_spareRegions.pop_back();
+	m_regions[region] = {};
+
+	return region;
+}
+
+void OffsetAllocator::ReleaseRegion(uint32_t region)
+{
+	m_spareRegions.push_back(region);
+}
+
+void OffsetAllocator::InsertFree(uint32_t region)
+{
+	auto& r = m_regions[region];
+	const uint32_t bin = BinOf(r.size);
+
+	r.free = true;
+	r.previousFree = OffsetAllocation::none;
+	r.nextFree = m_binHeads[bin];
+
+	if (r.nextFree != OffsetAllocation::none)
+		m_regions[r.nextFree].previousFree = region;
+
+	m_binHeads[bin] = region;
+	m_usedBins[bin / binsPerLevel] |= uint8_t(1u << (bin % binsPerLevel));
+	m_usedLevels |= 1u << (bin / binsPerLevel);
+	m_freeRegions++;
+}
+
+void OffsetAllocator::RemoveFree(uint32_t region)
+{
+	auto& r = m_regions[region];
+	const uint32_t bin = BinOf(r.size);
+
+	if (r.previousFree != OffsetAllocation::none)
+		m_regions[r.previousFree].nextFree = r.nextFree;
+	else
+		m_binHeads[bin] = r.nextFree;
+
+	if (r.nextFree != OffsetAllocation::none)
+		m_regions[r.nextFree].previousFree = r.previousFree;
+
+	r.free = false;
+	m_freeRegions--;
+
+	if (m_binHeads[bin] != OffsetAllocation::none)
+		return;
+
+	m_usedBins[bin / binsPerLevel] &= uint8_t(~(1u << (bin % binsPerLevel)));
+
+	if (m_usedBins[bin / binsPerLevel] == 0)
+		m_usedLevels &= ~(1u << (bin / binsPerLevel));
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// A run of elements handed out by an OffsetAllocator.
+struct OffsetAllocation
+{
+	static constexpr uint32_t none = UINT32_MAX;
+
+	uint32_t offset = 0;
+	uint32_t size = 0;
+	// the allocator's bookkeeping for the run; none for the empty allocation
+	uint32_t region = none;
+
+	constexpr explicit operator bool() const noexcept { return region != none; }
+};
+
+struct OffsetAllocatorStats
+{
+	uint32_t capacity = 0;
+	uint32_t used = 0;
+	uint32_t allocations = 0;
+	uint32_t freeRegions = 0;
+	uint32_t largestFreeRegion = 0;
+
+	constexpr uint32_t Free() const noexcept { return capacity - used; }
+	// 0 while the free space is one piece, approaching 1 as it splinters into pieces too small to use
+	constexpr float Fragmentation() const noexcept { return Free() ? 1.f - float(largestFreeRegion) / float(Free()) : 0.f; }
+};
+
+// Hands out ranges of [0, capacity) for a buffer someone else owns, as a two-level segregated fit
+// (TLSF) allocator. Free regions are kept in bins by size, 8 per power of two, with a bitmap over
+// the bins, so both Allocate and Free take constant time. A freed range merges with free
+// neighbours straight away. Requests are served exactly, from the first bin whose regions are all
+// big enough, so a region that would just have fit can be passed over for a larger one; only when
+// there is none is the request's own bin searched, so the last piece of space can still be used.
+class OffsetAllocator
+{
+public:
+
+	explicit OffsetAllocator(uint32_t capacity);
+
+	// The empty allocation when no free region is big enough, or for a size of zero.
+	OffsetAllocation Allocate(uint32_t size);
+	void Free(const OffsetAllocation& allocation);
+
+	constexpr uint32_t Capacity() const noexcept { return m_capacity; }
+	// the largest free region is found by a scan of its bin
+	OffsetAllocatorStats Stats() const noexcept;
+
+private:
+
+	struct Region
+	{
+		uint32_t offset = 0;
+		uint32_t size = 0;
+		bool free = false;
+		// neighbours in address order
+		uint32_t previous = OffsetAllocation::none;
+		uint32_t next = OffsetAllocation::none;
+		// neighbours in the bin's free list
+		uint32_t previousFree = OffsetAllocation::none;
+		uint32_t nextFree = OffsetAllocation::none;
+	};
+
+	static constexpr uint32_t binsPerLevel = 8;
+	static constexpr uint32_t binCount = 32 * binsPerLevel;
+
+	// the bin a region of size is kept in
+	static uint32_t BinOf(uint32_t size) noexcept;
+	// the first bin whose regions all hold at least size
+	static uint32_t BinFitting(uint32_t size) noexcept;
+	static uint32_t BinMinimum(uint32_t bin) noexcept;
+	uint32_t FirstFreeBin(uint32_t fromBin) const noexcept;
+	// a free region of bin holding at least size, by a walk of the bin's list
+	uint32_t FindInBin(uint32_t bin, uint32_t size) const noexcept;
+
+	uint32_t NewRegion();
+	void ReleaseRegion(uint32_t region);
+	void InsertFree(uint32_t region);
+	void RemoveFree(uint32_t region);
+
+	uint32_t m_capacity;
+	uint32_t m_used = 0;
+	uint32_t m_allocations = 0;
+	uint32_t m_freeRegions = 0;
+
+	std::vector<Region> m_regions;
+	// indices of unused entries in m_regions
+	std::vector<uint32_t> m_spareRegions;
+
+	std::array<uint32_t, binCount> m_binHeads;
+	// bit n set when any bin of level n holds a region
+	uint32_t m_usedLevels = 0;
+	std::array<uint8_t, 32> m_usedBins = {};
+};
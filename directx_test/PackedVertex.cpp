@@ -0,0 +1,156 @@
+#include "PackedVertex.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+using namespace DirectX;
+using namespace DirectX::PackedVector;
+
+namespace
+{
+	constexpr size_t verticesPerChunk = 16384;
+}
+
+PackedBounds VertexPacker::ComputeBounds(const std::vector<SimpleVertex>& vertices)
+{
+	XMVECTOR lo = XMVectorReplicate(FLT_MAX);
+	XMVECTOR hi = XMVectorReplicate(-FLT_MAX);
+
+	for (const auto& v : vertices)
+	{
+		const auto p = XMLoadFloat3(&v.position);
+		lo = XMVectorMin(lo, p);
+		hi = XMVectorMax(hi, p);
+	}
+
+	if (vertices.empty())
+		lo = hi = XMVectorZero();
+
+	PackedBounds bounds{};
+	XMStoreFloat4(&bounds.minimum, XMVectorSetW(lo, 0.f));
+	XMStoreFloat4(&bounds.extent, XMVectorSetW(XMVectorSubtract(hi, lo), 0.f));
+
+	return bounds;
+}
+
+XMVECTOR XM_CALLCONV VertexPacker::EncodeOctahedral(FXMVECTOR normal)
+{
+	const auto absolute = XMVectorAbs(normal);
+	const float sum = XMVectorGetX(absolute) + XMVectorGetY(absolute) + XMVectorGetZ(absolute);
+
+	if (sum == 0.f)
+		return XMVectorZero();
+
+	auto n = XMVectorScale(normal, 1.f / sum);
+
+	if (XMVectorGetZ(n) < 0.f)
+	{
+		// fold the lower hemisphere over the diagonals
+		const float x = XMVectorGetX(n), y = XMVectorGetY(n);
+		n = XMVectorSet((1.f - std::abs(y)) * (x >= 0.f ? 1.f : -1.f), (1.f - std::abs(x)) * (y >= 0.f ? 1.f : -1.f), 0.f, 0.f);
+	}
+
+	return XMVectorSet(XMVectorGetX(n), XMVectorGetY(n), 0.f, 0.f);
+}
+
+XMVECTOR XM_CALLCONV VertexPacker::DecodeOctahedral(FXMVECTOR encoded)
+{
+	float x = XMVectorGetX(encoded), y = XMVectorGetY(encoded);
+	const float z = 1.f - std::abs(x) - std::abs(y);
+
+	if (z < 0.f)
+	{
+		const float fx = (1.f - std::abs(y)) * (x >= 0.f ? 1.f : -1.f);
+		const float fy = (1.f - std::abs(x)) * (y >= 0.f ? 1.f : -1.f);
+		x = fx;
+		y = fy;
+	}
+
+	return XMVector3Normalize(XMVectorSet(x, y, z, 0.f));
+}
+
+PackedVertex VertexPacker::Encode(const SimpleVertex& vertex, const PackedBounds& bounds)
+{
+	const auto minimum = XMLoadFloat4(&bounds.minimum);
+	const auto extent = XMLoadFloat4(&bounds.extent);
+
+	// flat axes have no extent; anything stored on them decodes back to the minimum
+	const auto safeExtent = XMVectorSelect(extent, XMVectorSplatOne(), XMVectorLess(extent, XMVectorReplicate(FLT_MIN)));
+
+	PackedVertex packed{};
+	XMStoreUShortN4(&packed.position, XMVectorDivide(XMVectorSubtract(XMLoadFloat3(&vertex.position), minimum), safeExtent));
+	XMStoreShortN2(&packed.normal, EncodeOctahedral(XMLoadFloat3(&vertex.normal)));
+	XMStoreUByteN4(&packed.color, XMVectorSetW(XMLoadFloat3(&vertex.color), 1.f));
+	XMStoreHalf2(&packed.texCoord, XMLoadFloat2(&vertex.texCoord));
+
+	return packed;
+}
+
+SimpleVertex VertexPacker::Decode(const PackedVertex& packed, const PackedBounds& bounds)
+{
+	SimpleVertex vertex{};
+
+	XMStoreFloat3(&vertex.position, XMVectorMultiplyAdd(XMLoadUShortN4(&packed.position), XMLoadFloat4(&bounds.extent), XMLoadFloat4(&bounds.minimum)));
+	XMStoreFloat3(&vertex.normal, DecodeOctahedral(XMLoadShortN2(&packed.normal)));
+	XMStoreFloat3(&vertex.color, XMLoadUByteN4(&packed.color));
+	XMStoreFloat2(&vertex.texCoord, XMLoadHalf2(&packed.texCoord));
+
+	return vertex;
+}
+
+void VertexPacker::Encode(const std::vector<SimpleVertex>& vertices, const PackedBounds& bounds, std::vector<PackedVertex>& packed)
+{
+	packed.resize(vertices.size());
+
+	ParallelFor(vertices.size(), verticesPerChunk, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+			packed[i] = Encode(vertices[i], bounds);
+	});
+}
+
+void VertexPacker::Decode(const std::vector<PackedVertex>& packed, const PackedBounds& bounds, std::vector<SimpleVertex>& vertices)
+{
+	vertices.resize(packed.size());
+
+	ParallelFor(packed.size(), verticesPerChunk, [&](size_t begin, size_t end)
+	{
+		for (size_t i = begin; i < end; i++)
+			vertices[i] = Decode(packed[i], bounds);
+	});
+}
+
+PackingReport VertexPacker::Analyze(const std::vector<SimpleVertex>& vertices)
+{
+	PackingReport report{};
+	report.fullBytes = vertices.size() * sizeof(SimpleVertex);
+	report.packedBytes = vertices.size() * sizeof(PackedVertex);
+
+	const auto bounds = ComputeBounds(vertices);
+
+	for (const auto& original : vertices)
+	{
+		const auto decoded = Decode(Encode(original, bounds), bounds);
+
+		const auto maxComponent = [](FXMVECTOR a, FXMVECTOR b)
+		{
+			const auto d = XMVectorAbs(XMVectorSubtract(a, b));
+			return std::max({ XMVectorGetX(d), XMVectorGetY(d), XMVectorGetZ(d) });
+		};
+
+		report.positionError = std::max(report.positionError, maxComponent(XMLoadFloat3(&original.position), XMLoadFloat3(&decoded.position)));
+		report.colorError = std::max(report.colorError, maxComponent(XMLoadFloat3(&original.color), XMLoadFloat3(&decoded.color)));
+		report.texCoordError = std::max(report.texCoordError, maxComponent(XMLoadFloat2(&original.texCoord), XMLoadFloat2(&decoded.texCoord)));
+
+		const auto normal = XMLoadFloat3(&original.normal);
+
+		if (XMVectorGetX(XMVector3LengthSq(normal)) > 0.f)
+		{
+			const float cosine = std::clamp(XMVectorGetX(XMVector3Dot(XMVector3Normalize(normal), XMLoadFloat3(&decoded.normal))), -1.f, 1.f);
+			report.normalError = std::max(report.normalError, std::acos(cosine));
+		}
+	}
+
+	return report;
+}
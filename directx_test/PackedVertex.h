@@ -0,0 +1,66 @@
+#pragma once
+#include "WinTypes.h"
+#include <array>
+#include <vector>
+#include <DirectXPackedVector.h>
+#include "SimpleVertex.h"
+
+// Position range of a mesh; packed positions are stored as fractions of it.
+struct PackedBounds
+{
+	DirectX::XMFLOAT4 minimum;
+	DirectX::XMFLOAT4 extent;
+};
+
+// 20 byte alternative to the 44 byte SimpleVertex:
+// position UNORM16 inside PackedBounds, octahedral SNORM16 normal, RGBA8 color, half float UV.
+struct PackedVertex
+{
+	DirectX::PackedVector::XMUSHORTN4 position;
+	DirectX::PackedVector::XMSHORTN2 normal;
+	DirectX::PackedVector::XMUBYTEN4 color;
+	DirectX::PackedVector::XMHALF2 texCoord;
+
+	// how a buffer of PackedVertex is described to D3D11; no shader in Light.fx reads one yet
+	static constexpr std::array<D3D11_INPUT_ELEMENT_DESC, 4> InputLayout =
+	{
+		D3D11_INPUT_ELEMENT_DESC{ "POSITION", 0, DXGI_FORMAT_R16G16B16A16_UNORM, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		D3D11_INPUT_ELEMENT_DESC{ "NORMAL", 0, DXGI_FORMAT_R16G16_SNORM, 0, 8, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		D3D11_INPUT_ELEMENT_DESC{ "COLOR", 0, DXGI_FORMAT_R8G8B8A8_UNORM, 0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+		D3D11_INPUT_ELEMENT_DESC{ "TEXCOORD", 0, DXGI_FORMAT_R16G16_FLOAT, 0, 16, D3D11_INPUT_PER_VERTEX_DATA, 0 }
+	};
+};
+
+static_assert(sizeof(PackedVertex) == 20, "PackedVertex layout must match PackedVertex::InputLayout");
+
+// Largest decode error seen over a set of vertices, plus the memory both formats need.
+struct PackingReport
+{
+	float positionError = 0.f;
+	// in radians
+	float normalError = 0.f;
+	float colorError = 0.f;
+	float texCoordError = 0.f;
+
+	size_t fullBytes = 0;
+	size_t packedBytes = 0;
+};
+
+class VertexPacker
+{
+public:
+
+	static PackedBounds ComputeBounds(const std::vector<SimpleVertex>& vertices);
+
+	static PackedVertex Encode(const SimpleVertex& vertex, const PackedBounds& bounds);
+	static SimpleVertex Decode(const PackedVertex& vertex, const PackedBounds& bounds);
+
+	static void Encode(const std::vector<SimpleVertex>& vertices, const PackedBounds& bounds, std::vector<PackedVertex>& packed);
+	static void Decode(const std::vector<PackedVertex>& packed, const PackedBounds& bounds, std::vector<SimpleVertex>& vertices);
+
+	// Round-trips every vertex and records the worst error per attribute.
+	static PackingReport Analyze(const std::vector<SimpleVertex>& vertices);
+
+	static DirectX::XMVECTOR XM_CALLCONV EncodeOctahedral(DirectX::FXMVECTOR normal);
+	static DirectX::XMVECTOR XM_CALLCONV DecodeOctahedral(DirectX::FXMVECTOR encoded);
+};
@@ -0,0 +1,60 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+namespace ParallelDetail
+{
+	inline std::atomic<size_t> threadLimit = 0;
+}
+
+// Caps the threads ParallelFor spreads over, so benchmarks can measure how work scales; 0 lifts the cap.
+inline void SetParallelThreadLimit(size_t threads) noexcept
+{
+	ParallelDetail::threadLimit = threads;
+}
+
+// one per hardware thread unless capped by SetParallelThreadLimit
+inline size_t ParallelThreadCount() noexcept
+{
+	const size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+	const size_t limit = ParallelDetail::threadLimit;
+
+	return limit ? std::min(limit, hardware) : hardware;
+}
+
+// Splits [0, count) into contiguous chunks of at least minChunk elements and
+// runs body(begin, end) for each chunk on its own thread. The calling thread
+// takes the first chunk, so small inputs never leave the current thread.
+template<class F>
+void ParallelFor(size_t count, size_t minChunk, F&& body)
+{
+	if (count == 0)
+		return;
+
+	const size_t chunks = std::min(ParallelThreadCount(), (count + minChunk - 1) / std::max<size_t>(minChunk, 1));
+
+	if (chunks <= 1)
+	{
+		body(size_t(0), count);
+		return;
+	}
+
+	const size_t chunkSize = (count + chunks - 1) / chunks;
+
+	std::vector<std::jthread> workers;
+	workers.reserve(chunks - 1);
+
+	for (size_t c = 1; c < chunks; c++)
+	{
+		const size_t begin = c * chunkSize;
+		const size_t end = std::min(count, begin + chunkSize);
+
+		if (begin < end)
+			workers.emplace_back([&body, begin, end]() { body(begin, end); });
+	}
+
+	body(size_t(0), std::min(count, chunkSize));
+}
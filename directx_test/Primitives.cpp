@@ -0,0 +1,43 @@
+#include "Primitives.h"
+
+namespace
+{
+	constexpr CubeShape cubeShape{};
+	constexpr CylinderShape tubeShape{ 8, 1.f, 0.5f, 1.f };
+	constexpr CylinderShape cylinderShape{};
+	constexpr ConeShape coneShape{};
+	constexpr TorusShape torusShape{};
+	constexpr PlaneShape planeShape{ 8 };
+	constexpr IcosphereShape icosphereShape{};
+
+	constexpr auto cube = MakePrimitiveTable<cubeShape>();
+	constexpr auto tube = MakePrimitiveTable<tubeShape>();
+	constexpr auto cylinder = MakePrimitiveTable<cylinderShape>();
+	constexpr auto cone = MakePrimitiveTable<coneShape>();
+	constexpr auto torus = MakePrimitiveTable<torusShape>();
+	constexpr auto plane = MakePrimitiveTable<planeShape>();
+	constexpr auto icosphere = MakePrimitiveTable<icosphereShape>();
+
+	constexpr auto cubeInside = []()
+	{
+		auto indices = cube.indices;
+
+		for (size_t i = 0; i < indices.size(); i += 3)
+		{
+			const auto swap = indices[i + 1];
+			indices[i + 1] = indices[i + 2];
+			indices[i + 2] = swap;
+		}
+
+		return indices;
+	}();
+}
+
+PrimitiveData Primitives::Cube() noexcept { return cube.Data(); }
+PrimitiveData Primitives::CubeInside() noexcept { return { cube.vertices, cubeInside }; }
+PrimitiveData Primitives::Tube() noexcept { return tube.Data(); }
+PrimitiveData Primitives::Cylinder() noexcept { return cylinder.Data(); }
+PrimitiveData Primitives::Cone() noexcept { return cone.Data(); }
+PrimitiveData Primitives::Torus() noexcept { return torus.Data(); }
+PrimitiveData Primitives::Plane() noexcept { return plane.Data(); }
+PrimitiveData Primitives::Icosphere() noexcept { return icosphere.Data(); }
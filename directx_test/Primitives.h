@@ -0,0 +1,609 @@
+#pragma once
+#include "WinTypes.h"
+#include <array>
+#include <cmath>
+#include <span>
+#include <type_traits>
+#include <vector>
+#include "SimpleVertex.h"
+
+// Shapes centred on the origin with y up. Each one can write itself into spans of exactly VertexCount()
+// vertices and IndexCount() indices, either at compile time into the fixed tables of Primitives or at
+// run time through Primitives::Generate. Front faces wind the way the rest of the scene does, i.e.
+// cross(b - a, c - a) points out of the surface.
+
+namespace PrimitiveMath
+{
+	constexpr double pi = 3.14159265358979323846;
+
+	// Taylor series after reducing to [-pi, pi]; std::sin and std::cos are not constexpr
+	constexpr float Sin(double x) noexcept
+	{
+		if (!std::is_constant_evaluated())
+			return float(std::sin(x));
+
+		const double turns = x / (2.0 * pi);
+		x -= 2.0 * pi * double(turns < 0.0 ? (long long)(turns - 0.5) : (long long)(turns + 0.5));
+
+		double term = x, sum = x;
+
+		for (int n = 1; n < 12; n++)
+		{
+			term *= -x * x / double((2 * n) * (2 * n + 1));
+			sum += term;
+		}
+
+		return float(sum);
+	}
+
+	constexpr float Cos(double x) noexcept
+	{
+		if (!std::is_constant_evaluated())
+			return float(std::cos(x));
+
+		return Sin(x + pi / 2.0);
+	}
+
+	constexpr float Sqrt(float x) noexcept
+	{
+		if (!std::is_constant_evaluated())
+			return std::sqrt(x);
+
+		if (x <= 0.f)
+			return 0.f;
+
+		double root = x > 1.f ? x : 1.0;
+
+		for (int i = 0; i < 64; i++)
+		{
+			const double next = 0.5 * (root + x / root);
+
+			if (next == root)
+				break;
+
+			root = next;
+		}
+
+		return float(root);
+	}
+
+	constexpr DirectX::XMFLOAT3 Add(DirectX::XMFLOAT3 a, DirectX::XMFLOAT3 b) noexcept { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+	constexpr DirectX::XMFLOAT3 Subtract(DirectX::XMFLOAT3 a, DirectX::XMFLOAT3 b) noexcept { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+	constexpr DirectX::XMFLOAT3 Scale(DirectX::XMFLOAT3 a, float s) noexcept { return { a.x * s, a.y * s, a.z * s }; }
+	constexpr float Dot(DirectX::XMFLOAT3 a, DirectX::XMFLOAT3 b) noexcept { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+	constexpr DirectX::XMFLOAT3 Cross(DirectX::XMFLOAT3 a, DirectX::XMFLOAT3 b) noexcept
+	{
+		return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+	}
+
+	constexpr DirectX::XMFLOAT3 Normalize(DirectX::XMFLOAT3 a) noexcept
+	{
+		const float length = Sqrt(Dot(a, a));
+
+		return length > 0.f ? Scale(a, 1.f / length) : a;
+	}
+}
+
+// Writes quad a, b, c, d as two triangles; pass the corners so that cross(b - a, c - a) faces outward.
+constexpr UINT* WriteQuad(UINT* out, UINT a, UINT b, UINT c, UINT d) noexcept
+{
+	out[0] = a; out[1] = b; out[2] = c;
+	out[3] = a; out[4] = c; out[5] = d;
+
+	return out + 6;
+}
+
+// Each face tinted by its axis (+y red, -y green, -x blue, +x magenta, -z yellow, +z cyan), so its orientation
+// shows under the solid color shaders. Four vertices per face for hard edges.
+struct CubeShape
+{
+	float halfSize = 1.f;
+
+	constexpr size_t VertexCount() const noexcept { return 24; }
+	constexpr size_t IndexCount() const noexcept { return 36; }
+
+	constexpr void Write(std::span<SimpleVertex> vertices, std::span<UINT> indices) const noexcept
+	{
+		using namespace PrimitiveMath;
+
+		struct Face
+		{
+			DirectX::XMFLOAT3 normal;
+			DirectX::XMFLOAT3 tangent;
+			DirectX::XMFLOAT3 color;
+		};
+
+		constexpr Face faces[6] =
+		{
+			{ { 0.f, 1.f, 0.f },  { 1.f, 0.f, 0.f }, { 1.f, 0.f, 0.f } },
+			{ { 0.f, -1.f, 0.f }, { 1.f, 0.f, 0.f }, { 0.f, 1.f, 0.f } },
+			{ { -1.f, 0.f, 0.f }, { 0.f, 0.f, 1.f }, { 0.f, 0.f, 1.f } },
+			{ { 1.f, 0.f, 0.f },  { 0.f, 0.f, -1.f }, { 1.f, 0.f, 1.f } },
+			{ { 0.f, 0.f, -1.f }, { -1.f, 0.f, 0.f }, { 1.f, 1.f, 0.f } },
+			{ { 0.f, 0.f, 1.f },  { 1.f, 0.f, 0.f }, { 0.f, 1.f, 1.f } },
+		};
+
+		constexpr float corners[4][2] = { { -1.f, -1.f }, { 1.f, -1.f }, { 1.f, 1.f }, { -1.f, 1.f } };
+
+		UINT* index = indices.data();
+
+		for (UINT f = 0; f < 6; f++)
+		{
+			const auto& face = faces[f];
+			// cross(tangent, bitangent) == normal, so corners in this order wind outward
+			const auto bitangent = Cross(face.normal, face.tangent);
+
+			for (UINT c = 0; c < 4; c++)
+			{
+				const auto offset = Add(Scale(face.tangent, corners[c][0]), Scale(bitangent, corners[c][1]));
+
+				vertices[f * 4 + c] = SimpleVertex(Scale(Add(face.normal, offset), halfSize), face.color, face.normal,
+					{ (corners[c][0] + 1.f) * 0.5f, (1.f - corners[c][1]) * 0.5f });
+			}
+
+			index = WriteQuad(index, f * 4, f * 4 + 1, f * 4 + 2, f * 4 + 3);
+		}
+	}
+};
+
+// Smooth walls with a duplicated seam column for texturing; u runs around, v from bottom (0) to top (1).
+// An innerRadius above zero makes a tube with an inner wall and ring-shaped caps. Caps are mapped from above.
+struct CylinderShape
+{
+	UINT segments = 16;
+	float radius = 1.f;
+	float innerRadius = 0.f;
+	float halfHeight = 1.f;
+	DirectX::XMFLOAT3 color = { 1.f, 1.f, 1.f };
+
+	constexpr bool IsTube() const noexcept { return innerRadius > 0.f; }
+
+	constexpr size_t VertexCount() const noexcept
+	{
+		const size_t wall = 2 * size_t(segments + 1);
+		const size_t caps = IsTube() ? 4 * size_t(segments) : 2 * size_t(segments + 1);
+
+		return (IsTube() ? 2 * wall : wall) + caps;
+	}
+
+	constexpr size_t IndexCount() const noexcept
+	{
+		return IsTube() ? 24 * size_t(segments) : 12 * size_t(segments);
+	}
+
+	constexpr void Write(std::span<SimpleVertex> vertices, std::span<UINT> indices) const noexcept
+	{
+		using namespace PrimitiveMath;
+
+		SimpleVertex* vertex = vertices.data();
+		UINT* index = indices.data();
+
+		const auto capVertex = [&](float x, float y, float z, float normalY)
+		{
+			return SimpleVertex({ x, y, z }, color, { 0.f, normalY, 0.f }, { x / (2.f * radius) + 0.5f, 0.5f - z / (2.f * radius) });
+		};
+
+		// walls: bottom, top pairs around the circle
+		const auto writeWall = [&](float wallRadius, float facing)
+		{
+			const UINT base = UINT(vertex - vertices.data());
+
+			for (UINT k = 0; k <= segments; k++)
+			{
+				const double angle = 2.0 * pi * k / segments;
+				const float c = Cos(angle), s = Sin(angle);
+				const DirectX::XMFLOAT3 normal = { c * facing, 0.f, s * facing };
+				const float u = float(k) / segments;
+
+				*vertex++ = SimpleVertex({ c * wallRadius, -halfHeight, s * wallRadius }, color, normal, { u, 0.f });
+				*vertex++ = SimpleVertex({ c * wallRadius, halfHeight, s * wallRadius }, color, normal, { u, 1.f });
+			}
+
+			for (UINT k = 0; k < segments; k++)
+			{
+				const UINT bottom = base + 2 * k, top = bottom + 1, nextBottom = bottom + 2, nextTop = bottom + 3;
+
+				index = facing > 0.f
+					? WriteQuad(index, bottom, top, nextTop, nextBottom)
+					: WriteQuad(index, bottom, nextBottom, nextTop, top);
+			}
+		};
+
+		writeWall(radius, 1.f);
+
+		if (IsTube())
+		{
+			writeWall(innerRadius, -1.f);
+
+			for (int side = 0; side < 2; side++)
+			{
+				const float y = side ? halfHeight : -halfHeight;
+				const UINT base = UINT(vertex - vertices.data());
+
+				// inner, outer pairs
+				for (UINT k = 0; k < segments; k++)
+				{
+					const double angle = 2.0 * pi * k / segments;
+					const float c = Cos(angle), s = Sin(angle);
+
+					*vertex++ = capVertex(c * innerRadius, y, s * innerRadius, side ? 1.f : -1.f);
+					*vertex++ = capVertex(c * radius, y, s * radius, side ? 1.f : -1.f);
+				}
+
+				for (UINT k = 0; k < segments; k++)
+				{
+					const UINT inner = base + 2 * k, outer = inner + 1;
+					const UINT nextInner = base + 2 * ((k + 1) % segments), nextOuter = nextInner + 1;
+
+					index = side
+						? WriteQuad(index, inner, nextInner, nextOuter, outer)
+						: WriteQuad(index, inner, outer, nextOuter, nextInner);
+				}
+			}
+		}
+		else
+		{
+			for (int side = 0; side < 2; side++)
+			{
+				const float y = side ? halfHeight : -halfHeight;
+				const UINT center = UINT(vertex - vertices.data());
+
+				*vertex++ = capVertex(0.f, y, 0.f, side ? 1.f : -1.f);
+
+				for (UINT k = 0; k < segments; k++)
+				{
+					const double angle = 2.0 * pi * k / segments;
+					*vertex++ = capVertex(Cos(angle) * radius, y, Sin(angle) * radius, side ? 1.f : -1.f);
+				}
+
+				for (UINT k = 0; k < segments; k++)
+				{
+					const UINT current = center + 1 + k, next = center + 1 + (k + 1) % segments;
+
+					*index++ = center;
+					*index++ = side ? next : current;
+					*index++ = side ? current : next;
+				}
+			}
+		}
+	}
+};
+
+// Apex at +halfHeight, base at -halfHeight. The apex is split per segment so each side triangle gets
+// the normal of its own slope direction.
+struct ConeShape
+{
+	UINT segments = 16;
+	float radius = 1.f;
+	float halfHeight = 1.f;
+	DirectX::XMFLOAT3 color = { 1.f, 1.f, 1.f };
+
+	constexpr size_t VertexCount() const noexcept { return size_t(segments) + size_t(segments + 1) + 1 + size_t(segments); }
+	constexpr size_t IndexCount() const noexcept { return 6 * size_t(segments); }
+
+	constexpr void Write(std::span<SimpleVertex> vertices, std::span<UINT> indices) const noexcept
+	{
+		using namespace PrimitiveMath;
+
+		SimpleVertex* vertex = vertices.data();
+		UINT* index = indices.data();
+
+		const auto slopeNormal = [&](double angle)
+		{
+			return Normalize({ Cos(angle) * 2.f * halfHeight, radius, Sin(angle) * 2.f * halfHeight });
+		};
+
+		// apexes, then the base ring with its seam column
+		for (UINT k = 0; k < segments; k++)
+		{
+			const double angle = 2.0 * pi * (k + 0.5) / segments;
+			*vertex++ = SimpleVertex({ 0.f, halfHeight, 0.f }, color, slopeNormal(angle), { (k + 0.5f) / segments, 1.f });
+		}
+
+		const UINT ring = segments;
+
+		for (UINT k = 0; k <= segments; k++)
+		{
+			const double angle = 2.0 * pi * k / segments;
+			*vertex++ = SimpleVertex({ Cos(angle) * radius, -halfHeight, Sin(angle) * radius }, color, slopeNormal(angle), { float(k) / segments, 0.f });
+		}
+
+		for (UINT k = 0; k < segments; k++)
+		{
+			*index++ = ring + k;
+			*index++ = k;
+			*index++ = ring + k + 1;
+		}
+
+		const UINT center = UINT(vertex - vertices.data());
+		*vertex++ = SimpleVertex({ 0.f, -halfHeight, 0.f }, color, { 0.f, -1.f, 0.f }, { 0.5f, 0.5f });
+
+		for (UINT k = 0; k < segments; k++)
+		{
+			const double angle = 2.0 * pi * k / segments;
+			const float c = Cos(angle), s = Sin(angle);
+			*vertex++ = SimpleVertex({ c * radius, -halfHeight, s * radius }, color, { 0.f, -1.f, 0.f }, { c * 0.5f + 0.5f, 0.5f - s * 0.5f });
+		}
+
+		for (UINT k = 0; k < segments; k++)
+		{
+			*index++ = center;
+			*index++ = center + 1 + k;
+			*index++ = center + 1 + (k + 1) % segments;
+		}
+	}
+};
+
+// Ring of radius around y, tube of tubeRadius around the ring. Both seams are duplicated for texturing.
+struct TorusShape
+{
+	UINT rings = 24;
+	UINT sides = 12;
+	float radius = 1.f;
+	float tubeRadius = 0.25f;
+	DirectX::XMFLOAT3 color = { 1.f, 1.f, 1.f };
+
+	constexpr size_t VertexCount() const noexcept { return size_t(rings + 1) * (sides + 1); }
+	constexpr size_t IndexCount() const noexcept { return 6 * size_t(rings) * sides; }
+
+	constexpr void Write(std::span<SimpleVertex> vertices, std::span<UINT> indices) const noexcept
+	{
+		using namespace PrimitiveMath;
+
+		for (UINT i = 0; i <= rings; i++)
+		{
+			const double theta = 2.0 * pi * i / rings;
+			const float ct = Cos(theta), st = Sin(theta);
+
+			for (UINT j = 0; j <= sides; j++)
+			{
+				const double phi = 2.0 * pi * j / sides;
+				const float cp = Cos(phi), sp = Sin(phi);
+				const DirectX::XMFLOAT3 normal = { cp * ct, sp, cp * st };
+
+				vertices[size_t(i) * (sides + 1) + j] = SimpleVertex(
+					Add({ ct * radius, 0.f, st * radius }, Scale(normal, tubeRadius)), color, normal,
+					{ float(i) / rings, float(j) / sides });
+			}
+		}
+
+		UINT* index = indices.data();
+
+		for (UINT i = 0; i < rings; i++)
+		{
+			for (UINT j = 0; j < sides; j++)
+			{
+				const UINT a = i * (sides + 1) + j, b = a + sides + 1;
+				index = WriteQuad(index, a, a + 1, b + 1, b);
+			}
+		}
+	}
+};
+
+// Square in the xz plane facing +y, split into divisions x divisions quads.
+struct PlaneShape
+{
+	UINT divisions = 1;
+	float halfSize = 1.f;
+	DirectX::XMFLOAT3 color = { 1.f, 1.f, 1.f };
+
+	constexpr size_t VertexCount() const noexcept { return size_t(divisions + 1) * (divisions + 1); }
+	constexpr size_t IndexCount() const noexcept { return 6 * size_t(divisions) * divisions; }
+
+	constexpr void Write(std::span<SimpleVertex> vertices, std::span<UINT> indices) const noexcept
+	{
+		for (UINT j = 0; j <= divisions; j++)
+		{
+			for (UINT i = 0; i <= divisions; i++)
+			{
+				const float u = float(i) / divisions, v = float(j) / divisions;
+
+				vertices[size_t(j) * (divisions + 1) + i] = SimpleVertex(
+					{ (u * 2.f - 1.f) * halfSize, 0.f, (v * 2.f - 1.f) * halfSize }, color, { 0.f, 1.f, 0.f }, { u, 1.f - v });
+			}
+		}
+
+		UINT* index = indices.data();
+
+		for (UINT j = 0; j < divisions; j++)
+		{
+			for (UINT i = 0; i < divisions; i++)
+			{
+				const UINT a = j * (divisions + 1) + i, d = a + divisions + 1;
+				index = WriteQuad(index, a, d, d + 1, a + 1);
+			}
+		}
+	}
+};
+
+// Icosahedron with every edge split into frequency parts, pushed out onto the sphere. Vertices on shared
+// edges are shared, so it is smooth and evenly tessellated, but it has no UV seam and so no texture
+// coordinates; SphereGenerator makes the textured sphere.
+struct IcosphereShape
+{
+	UINT frequency = 4;
+	float radius = 1.f;
+	DirectX::XMFLOAT3 color = { 1.f, 1.f, 1.f };
+
+	constexpr size_t VertexCount() const noexcept { return 10 * size_t(frequency) * frequency + 2; }
+	constexpr size_t IndexCount() const noexcept { return 60 * size_t(frequency) * frequency; }
+
+	constexpr void Write(std::span<SimpleVertex> vertices, std::span<UINT> indices) const noexcept
+	{
+		using namespace PrimitiveMath;
+
+		const float t = (1.f + Sqrt(5.f)) * 0.5f;
+
+		const DirectX::XMFLOAT3 corners[12] =
+		{
+			{ -1.f, t, 0.f }, { 1.f, t, 0.f }, { -1.f, -t, 0.f }, { 1.f, -t, 0.f },
+			{ 0.f, -1.f, t }, { 0.f, 1.f, t }, { 0.f, -1.f, -t }, { 0.f, 1.f, -t },
+			{ t, 0.f, -1.f }, { t, 0.f, 1.f }, { -t, 0.f, -1.f }, { -t, 0.f, 1.f },
+		};
+
+		UINT faces[20][3] =
+		{
+			{ 0, 11, 5 }, { 0, 5, 1 }, { 0, 1, 7 }, { 0, 7, 10 }, { 0, 10, 11 },
+			{ 1, 5, 9 }, { 5, 11, 4 }, { 11, 10, 2 }, { 10, 7, 6 }, { 7, 1, 8 },
+			{ 3, 9, 4 }, { 3, 4, 2 }, { 3, 2, 6 }, { 3, 6, 8 }, { 3, 8, 9 },
+			{ 4, 9, 5 }, { 2, 4, 11 }, { 6, 2, 10 }, { 8, 6, 7 }, { 9, 8, 1 },
+		};
+
+		// wind every face outward, whatever the table's handedness
+		for (auto& face : faces)
+		{
+			const auto a = corners[face[0]], b = corners[face[1]], c = corners[face[2]];
+
+			if (Dot(Cross(Subtract(b, a), Subtract(c, a)), Add(Add(a, b), c)) < 0.f)
+			{
+				const UINT swap = face[1];
+				face[1] = face[2];
+				face[2] = swap;
+			}
+		}
+
+		UINT edges[30][2] = {};
+		UINT edgeCount = 0;
+
+		const auto edgeOf = [&](UINT a, UINT b)
+		{
+			const UINT lo = a < b ? a : b, hi = a < b ? b : a;
+
+			for (UINT e = 0; e < edgeCount; e++)
+				if (edges[e][0] == lo && edges[e][1] == hi)
+					return e;
+
+			edges[edgeCount][0] = lo;
+			edges[edgeCount][1] = hi;
+
+			return edgeCount++;
+		};
+
+		const UINT n = frequency;
+		const UINT edgeBase = 12, faceBase = edgeBase + 30 * (n - 1);
+
+		// index of the point t steps from a toward b
+		const auto edgeVertex = [&](UINT a, UINT b, UINT step)
+		{
+			const UINT e = edgeOf(a, b);
+
+			return edgeBase + e * (n - 1) + (a < b ? step : n - step) - 1;
+		};
+
+		UINT* index = indices.data();
+
+		for (UINT f = 0; f < 20; f++)
+		{
+			const UINT a = faces[f][0], b = faces[f][1], c = faces[f][2];
+			const UINT interior = faceBase + f * (n - 1) * (n - 2) / 2;
+
+			// grid point i steps toward b and j steps toward c
+			const auto pointIndex = [&](UINT i, UINT j)
+			{
+				if (i == 0 && j == 0)
+					return a;
+				if (i == n)
+					return b;
+				if (j == n)
+					return c;
+				if (j == 0)
+					return edgeVertex(a, b, i);
+				if (i == 0)
+					return edgeVertex(a, c, j);
+				if (i + j == n)
+					return edgeVertex(b, c, j);
+
+				return interior + (i - 1) * (n - 1) - (i - 1) * i / 2 + (j - 1);
+			};
+
+			for (UINT i = 0; i <= n; i++)
+			{
+				for (UINT j = 0; i + j <= n; j++)
+				{
+					const float wa = float(n - i - j) / n, wb = float(i) / n, wc = float(j) / n;
+					const auto normal = Normalize(Add(Add(Scale(corners[a], wa), Scale(corners[b], wb)), Scale(corners[c], wc)));
+
+					vertices[pointIndex(i, j)] = SimpleVertex(Scale(normal, radius), color, normal, { 0.f, 0.f });
+				}
+			}
+
+			for (UINT i = 0; i < n; i++)
+			{
+				for (UINT j = 0; i + j < n; j++)
+				{
+					*index++ = pointIndex(i, j);
+					*index++ = pointIndex(i + 1, j);
+					*index++ = pointIndex(i, j + 1);
+
+					if (i + j + 1 < n)
+					{
+						*index++ = pointIndex(i + 1, j);
+						*index++ = pointIndex(i + 1, j + 1);
+						*index++ = pointIndex(i, j + 1);
+					}
+				}
+			}
+		}
+	}
+};
+
+template<class T>
+concept PrimitiveShape = requires(const T shape, std::span<SimpleVertex> vertices, std::span<UINT> indices)
+{
+	{ shape.VertexCount() } -> std::convertible_to<size_t>;
+	{ shape.IndexCount() } -> std::convertible_to<size_t>;
+	shape.Write(vertices, indices);
+};
+
+// Geometry that lives in static read-only tables.
+struct PrimitiveData
+{
+	std::span<const SimpleVertex> vertices;
+	std::span<const UINT> indices;
+};
+
+template<size_t VertexCount, size_t IndexCount>
+struct PrimitiveTable
+{
+	std::array<SimpleVertex, VertexCount> vertices;
+	std::array<UINT, IndexCount> indices;
+
+	constexpr PrimitiveData Data() const noexcept { return { vertices, indices }; }
+};
+
+// Builds the table for shape at compile time; shape must be a constexpr object with static storage.
+template<const auto& shape>
+consteval auto MakePrimitiveTable()
+{
+	PrimitiveTable<shape.VertexCount(), shape.IndexCount()> table{};
+	shape.Write(table.vertices, table.indices);
+
+	return table;
+}
+
+class Primitives
+{
+public:
+
+	// The fixed resolution shapes, generated at compile time.
+	static PrimitiveData Cube() noexcept;
+	// Cube() wound inside out, for skyboxes; draw it with Cube()'s vertices.
+	static PrimitiveData CubeInside() noexcept;
+	// the hollow cylinder of the demo scene: 8 segments, radii 0.5 and 1, height 2
+	static PrimitiveData Tube() noexcept;
+	static PrimitiveData Cylinder() noexcept;
+	static PrimitiveData Cone() noexcept;
+	static PrimitiveData Torus() noexcept;
+	static PrimitiveData Plane() noexcept;
+	static PrimitiveData Icosphere() noexcept;
+
+	// Any resolution at run time, resizing both vectors exactly once.
+	template<PrimitiveShape Shape>
+	static void Generate(const Shape& shape, std::vector<SimpleVertex>& vertices, std::vector<UINT>& indices)
+	{
+		vertices.resize(shape.VertexCount());
+		indices.resize(shape.IndexCount());
+		shape.Write(vertices, indices);
+	}
+};
@@ -0,0 +1,216 @@
+#include "RecordingRenderDevice.h"
+#include <cstring>
+
+namespace
+{
+	uint64_t Mix(uint64_t hash, uint64_t value) noexcept
+	{
+		return (hash ^ value) * 0x100000001B3ull;
+	}
+
+	uint64_t Value(const void* object) noexcept
+	{
+		return uint64_t(reinterpret_cast<uintptr_t>(object));
+	}
+}
+
+void RecordingRenderDevice::ClearRenderTarget(const float color[4])
+{
+	Record({ RenderOp::ClearRenderTarget, 0, Store(color, 4 * sizeof(float)) });
+}
+
+void RecordingRenderDevice::ClearDepthStencil()
+{
+	Record({ RenderOp::ClearDepthStencil });
+}
+
+void RecordingRenderDevice::SetViewport(const D3D11_VIEWPORT& viewport)
+{
+	uint64_t hash = 0xCBF29CE484222325ull;
+
+	for (const float f : { viewport.TopLeftX, viewport.TopLeftY, viewport.Width, viewport.Height, viewport.MinDepth, viewport.MaxDepth })
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &f, sizeof(bits));
+		hash = Mix(hash, bits);
+	}
+
+	Bind(RenderOp::SetViewport, 0, hash);
+	Record({ RenderOp::SetViewport, 0, Store(&viewport, sizeof(viewport)) });
+}
+
+void RecordingRenderDevice::SetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY topology)
+{
+	Bind(RenderOp::SetPrimitiveTopology, 0, topology);
+	Record({ RenderOp::SetPrimitiveTopology, UINT(topology) });
+}
+
+void RecordingRenderDevice::SetInputLayout(ID3D11InputLayout* layout)
+{
+	Bind(RenderOp::SetInputLayout, 0, Value(layout));
+	Record({ RenderOp::SetInputLayout, 0, 0, 0, layout });
+}
+
+void RecordingRenderDevice::SetVertexBuffers(UINT count, GpuBuffer* const* buffers, const UINT* strides)
+{
+	uint64_t hash = Mix(0xCBF29CE484222325ull, count);
+
+	for (UINT i = 0; i < count; i++)
+		hash = Mix(Mix(hash, Value(buffers[i])), strides[i]);
+
+	Bind(RenderOp::SetVertexBuffers, 0, hash);
+	Record({ RenderOp::SetVertexBuffers, count, count ? strides[0] : 0, 0, count ? buffers[0] : nullptr });
+}
+
+void RecordingRenderDevice::SetIndexBuffer(GpuBuffer* buffer, DXGI_FORMAT format)
+{
+	Bind(RenderOp::SetIndexBuffer, 0, Mix(Value(buffer), format));
+	Record({ RenderOp::SetIndexBuffer, UINT(format), 0, 0, buffer });
+}
+
+void RecordingRenderDevice::SetVertexShader(ID3D11VertexShader* shader)
+{
+	Bind(RenderOp::SetVertexShader, 0, Value(shader));
+	Record({ RenderOp::SetVertexShader, 0, 0, 0, shader });
+}
+
+void RecordingRenderDevice::SetPixelShader(ID3D11PixelShader* shader)
+{
+	Bind(RenderOp::SetPixelShader, 0, Value(shader));
+	Record({ RenderOp::SetPixelShader, 0, 0, 0, shader });
+}
+
+void RecordingRenderDevice::SetVertexConstantBuffer(UINT slot, GpuBuffer* buffer)
+{
+	Bind(RenderOp::SetVertexConstantBuffer, slot, Value(buffer));
+	Record({ RenderOp::SetVertexConstantBuffer, slot, 0, 0, buffer });
+}
+
+void RecordingRenderDevice::SetVertexConstantBufferRange(UINT slot, GpuBuffer* buffer, UINT offset, UINT byteCount)
+{
+	// the same slots SetVertexConstantBuffer binds
+	Bind(RenderOp::SetVertexConstantBuffer, slot, Mix(Mix(Value(buffer), offset), byteCount));
+	Record({ RenderOp::SetVertexConstantBufferRange, slot, offset, INT(byteCount), buffer });
+}
+
+void RecordingRenderDevice::SetPixelConstantBuffer(UINT slot, GpuBuffer* buffer)
+{
+	Bind(RenderOp::SetPixelConstantBuffer, slot, Value(buffer));
+	Record({ RenderOp::SetPixelConstantBuffer, slot, 0, 0, buffer });
+}
+
+void RecordingRenderDevice::SetPixelShaderResource(UINT slot, ID3D11ShaderResourceView* view)
+{
+	Bind(RenderOp::SetPixelShaderResource, slot, Value(view));
+	Record({ RenderOp::SetPixelShaderResource, slot, 0, 0, view });
+}
+
+void RecordingRenderDevice::SetPixelSampler(UINT slot, ID3D11SamplerState* sampler)
+{
+	Bind(RenderOp::SetPixelSampler, slot, Value(sampler));
+	Record({ RenderOp::SetPixelSampler, slot, 0, 0, sampler });
+}
+
+void RecordingRenderDevice::SetDepthStencilState(ID3D11DepthStencilState* state)
+{
+	Bind(RenderOp::SetDepthStencilState, 0, Value(state));
+	Record({ RenderOp::SetDepthStencilState, 0, 0, 0, state });
+}
+
+void RecordingRenderDevice::UpdateBuffer(GpuBuffer* buffer, const void* data, UINT byteCount)
+{
+	m_stats.bufferUpdates++;
+	m_stats.bytesUploaded += byteCount;
+	Record({ RenderOp::UpdateBuffer, byteCount, Store(data, byteCount), 0, buffer });
+}
+
+void RecordingRenderDevice::WriteBuffer(GpuBuffer* buffer, UINT offset, const void* data, UINT byteCount, BufferMap mode)
+{
+	m_stats.bufferUpdates++;
+	m_stats.bytesUploaded += byteCount;
+	Record({ RenderOp::WriteBuffer, byteCount, Store(data, byteCount), INT(offset), buffer });
+}
+
+void RecordingRenderDevice::DrawIndexed(UINT indexCount, UINT startIndex, INT baseVertex)
+{
+	m_stats.drawCalls++;
+	m_stats.indicesDrawn += indexCount;
+	Record({ RenderOp::DrawIndexed, indexCount, startIndex, baseVertex });
+}
+
+void RecordingRenderDevice::DrawIndexedInstanced(UINT indexCount, UINT instanceCount, UINT startIndex, INT baseVertex, UINT startInstance)
+{
+	m_stats.drawCalls++;
+	m_stats.indicesDrawn += size_t(indexCount) * instanceCount;
+	m_stats.instancesDrawn += instanceCount;
+
+	const UINT arguments[] = { instanceCount, startIndex, startInstance };
+	Record({ RenderOp::DrawIndexedInstanced, indexCount, Store(arguments, sizeof(arguments)), baseVertex });
+}
+
+void RecordingRenderDevice::DrawString(std::wstring_view text, DirectX::XMFLOAT2 position)
+{
+	m_stats.drawCalls++;
+	Record({ RenderOp::DrawString, UINT(text.size()), Store(text.data(), text.size() * sizeof(wchar_t)) });
+
+	// the sprite batch it stands in for rebinds most of the pipeline
+	m_bound.clear();
+}
+
+std::span<const std::byte> RecordingRenderDevice::Payload(const RenderCommand& command) const noexcept
+{
+	switch (command.op)
+	{
+	case RenderOp::UpdateBuffer:
+	case RenderOp::WriteBuffer:
+		return std::span(m_payload).subspan(command.b, command.a);
+	case RenderOp::DrawIndexedInstanced:
+		return std::span(m_payload).subspan(command.b, 3 * sizeof(UINT));
+	case RenderOp::DrawString:
+		return std::span(m_payload).subspan(command.b, command.a * sizeof(wchar_t));
+	case RenderOp::SetViewport:
+		return std::span(m_payload).subspan(command.b, sizeof(D3D11_VIEWPORT));
+	case RenderOp::ClearRenderTarget:
+		return std::span(m_payload).subspan(command.b, 4 * sizeof(float));
+	default:
+		return {};
+	}
+}
+
+void RecordingRenderDevice::Clear() noexcept
+{
+	m_commands.clear();
+	m_payload.clear();
+	m_stats = {};
+}
+
+void RecordingRenderDevice::Record(const RenderCommand& command)
+{
+	m_commands.push_back(command);
+	m_stats.commands++;
+}
+
+UINT RecordingRenderDevice::Store(const void* data, size_t byteCount)
+{
+	const auto offset = UINT(m_payload.size());
+	const auto* bytes = static_cast<const std::byte*>(data);
+
+	m_payload.insert(m_payload.end(), bytes, bytes + byteCount);
+
+	return offset;
+}
+
+void RecordingRenderDevice::Bind(RenderOp op, UINT slot, uint64_t value)
+{
+	m_stats.stateChanges++;
+
+	const auto [bound, first] = m_bound.try_emplace(uint32_t(op) << 16 | slot, value);
+
+	if (first)
+		return;
+
+	if (bound->second == value)
+		m_stats.redundantStateChanges++;
+
+	bound->second = value;
+}
@@ -0,0 +1,125 @@
+#pragma once
+#include "WinTypes.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+#include "RenderDevice.h"
+
+enum class RenderOp : uint8_t
+{
+	ClearRenderTarget,
+	ClearDepthStencil,
+	SetViewport,
+	SetPrimitiveTopology,
+	SetInputLayout,
+	SetVertexBuffers,
+	SetIndexBuffer,
+	SetVertexShader,
+	SetPixelShader,
+	SetVertexConstantBuffer,
+	SetVertexConstantBufferRange,
+	SetPixelConstantBuffer,
+	SetPixelShaderResource,
+	SetPixelSampler,
+	SetDepthStencilState,
+	UpdateBuffer,
+	WriteBuffer,
+	DrawIndexed,
+	DrawIndexedInstanced,
+	DrawString
+};
+
+// One recorded call in 24 bytes. object is the resource the call names: the first vertex buffer
+// for SetVertexBuffers, the buffer for UpdateBuffer. The arguments by op:
+//   SetVertexBuffers      a = stream count, b = first stride
+//   SetIndexBuffer        a = DXGI_FORMAT
+//   SetPrimitiveTopology  a = topology
+//   Set*ConstantBuffer, SetPixelShaderResource, SetPixelSampler   a = slot
+//   SetVertexConstantBufferRange  a = slot, b = buffer offset, c = byte count
+//   UpdateBuffer          a = byte count, b = payload offset
+//   WriteBuffer           a = byte count, b = payload offset, c = buffer offset
+//   DrawIndexed           a = index count, b = start index, c = base vertex
+//   DrawIndexedInstanced  a = index count, b = payload offset, c = base vertex; the payload holds
+//                         the instance count, start index and start instance as UINTs
+//   DrawString            a = character count, b = payload offset
+//   SetViewport, ClearRenderTarget   b = payload offset
+struct RenderCommand
+{
+	RenderOp op;
+	UINT a = 0;
+	UINT b = 0;
+	INT c = 0;
+	const void* object = nullptr;
+};
+
+struct RecordingStats
+{
+	size_t commands = 0;
+	size_t drawCalls = 0;
+	// instanced draws count each instance's indices
+	size_t indicesDrawn = 0;
+	size_t instancesDrawn = 0;
+	// Set* calls, clears excluded
+	size_t stateChanges = 0;
+	// Set* calls that bound what was bound already
+	size_t redundantStateChanges = 0;
+	// UpdateBuffer and WriteBuffer calls
+	size_t bufferUpdates = 0;
+	size_t bytesUploaded = 0;
+};
+
+// A RenderDevice without a GPU: every call is appended to a command log, with the bytes of buffer
+// updates, viewports and text kept in a payload arena beside it. Bound state is tracked across
+// Clear the way a context keeps it across frames, so redundant binds are counted per frame too.
+class RecordingRenderDevice : public RenderDevice
+{
+public:
+
+	void ClearRenderTarget(const float color[4]) override;
+	void ClearDepthStencil() override;
+	void SetViewport(const D3D11_VIEWPORT& viewport) override;
+	void SetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY topology) override;
+
+	void SetInputLayout(ID3D11InputLayout* layout) override;
+	void SetVertexBuffers(UINT count, GpuBuffer* const* buffers, const UINT* strides) override;
+	void SetIndexBuffer(GpuBuffer* buffer, DXGI_FORMAT format) override;
+
+	void SetVertexShader(ID3D11VertexShader* shader) override;
+	void SetPixelShader(ID3D11PixelShader* shader) override;
+	void SetVertexConstantBuffer(UINT slot, GpuBuffer* buffer) override;
+	void SetVertexConstantBufferRange(UINT slot, GpuBuffer* buffer, UINT offset, UINT byteCount) override;
+	void SetPixelConstantBuffer(UINT slot, GpuBuffer* buffer) override;
+	void SetPixelShaderResource(UINT slot, ID3D11ShaderResourceView* view) override;
+	void SetPixelSampler(UINT slot, ID3D11SamplerState* sampler) override;
+	void SetDepthStencilState(ID3D11DepthStencilState* state) override;
+
+	void UpdateBuffer(GpuBuffer* buffer, const void* data, UINT byteCount) override;
+	void WriteBuffer(GpuBuffer* buffer, UINT offset, const void* data, UINT byteCount, BufferMap mode) override;
+	void DrawIndexed(UINT indexCount, UINT startIndex, INT baseVertex) override;
+	void DrawIndexedInstanced(UINT indexCount, UINT instanceCount, UINT startIndex, INT baseVertex, UINT startInstance) override;
+	void DrawString(std::wstring_view text, DirectX::XMFLOAT2 position) override;
+
+	std::span<const RenderCommand> Commands() const noexcept { return m_commands; }
+	// the bytes a command stored, empty for commands without any
+	std::span<const std::byte> Payload(const RenderCommand& command) const noexcept;
+	constexpr const RecordingStats& Stats() const noexcept { return m_stats; }
+
+	// Drops the log and the stats, e.g. between frames. Keeps the bound state and the arena's memory.
+	void Clear() noexcept;
+
+private:
+
+	void Record(const RenderCommand& command);
+	UINT Store(const void* data, size_t byteCount);
+	// Counts a bind of value to the state named by op and slot, and whether it was bound already.
+	void Bind(RenderOp op, UINT slot, uint64_t value);
+
+	std::vector<RenderCommand> m_commands;
+	std::vector<std::byte> m_payload;
+	RecordingStats m_stats;
+
+	// what each op and slot last bound, hashed
+	std::unordered_map<uint32_t, uint64_t> m_bound;
+};
@@ -0,0 +1,49 @@
+#pragma once
+#include "WinTypes.h"
+#include <string_view>
+#include <DirectXMath.h>
+#include "BufferFactory.h"
+
+// Everything SceneRenderer does to the device while submitting a frame. D3D11RenderDevice
+// forwards it to the immediate context; RecordingRenderDevice writes it into a log instead, so the
+// submission path runs without a GPU. Resources are passed as opaque pointers and may be null
+// on a headless device. Vertex buffer offsets are always zero.
+class RenderDevice
+{
+public:
+
+	virtual ~RenderDevice() = default;
+
+	virtual void ClearRenderTarget(const float color[4]) = 0;
+	// depth to 1, stencil to 0
+	virtual void ClearDepthStencil() = 0;
+	virtual void SetViewport(const D3D11_VIEWPORT& viewport) = 0;
+	virtual void SetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY topology) = 0;
+
+	virtual void SetInputLayout(ID3D11InputLayout* layout) = 0;
+	// Binds count streams from slot 0.
+	virtual void SetVertexBuffers(UINT count, GpuBuffer* const* buffers, const UINT* strides) = 0;
+	virtual void SetIndexBuffer(GpuBuffer* buffer, DXGI_FORMAT format) = 0;
+
+	virtual void SetVertexShader(ID3D11VertexShader* shader) = 0;
+	virtual void SetPixelShader(ID3D11PixelShader* shader) = 0;
+	virtual void SetVertexConstantBuffer(UINT slot, GpuBuffer* buffer) = 0;
+	// Binds byteCount bytes of buffer from offset, both multiples of 256. On D3D11 this takes an 11.1
+	// context with ConstantBufferOffsetting.
+	virtual void SetVertexConstantBufferRange(UINT slot, GpuBuffer* buffer, UINT offset, UINT byteCount) = 0;
+	virtual void SetPixelConstantBuffer(UINT slot, GpuBuffer* buffer) = 0;
+	virtual void SetPixelShaderResource(UINT slot, ID3D11ShaderResourceView* view) = 0;
+	virtual void SetPixelSampler(UINT slot, ID3D11SamplerState* sampler) = 0;
+	// nullptr for the default state
+	virtual void SetDepthStencilState(ID3D11DepthStencilState* state) = 0;
+
+	// Replaces the whole contents of a DEFAULT usage buffer, such as a constant buffer.
+	virtual void UpdateBuffer(GpuBuffer* buffer, const void* data, UINT byteCount) = 0;
+	// Writes part of a buffer from BufferFactory::CreateUploadBuffer, mapped with mode.
+	virtual void WriteBuffer(GpuBuffer* buffer, UINT offset, const void* data, UINT byteCount, BufferMap mode) = 0;
+	virtual void DrawIndexed(UINT indexCount, UINT startIndex, INT baseVertex) = 0;
+	// startInstance offsets the per-instance streams, the way baseVertex does the per-vertex ones.
+	virtual void DrawIndexedInstanced(UINT indexCount, UINT instanceCount, UINT startIndex, INT baseVertex, UINT startInstance) = 0;
+	// Draws text with its bottom right corner at position, in pixels. May change any bound state.
+	virtual void DrawString(std::wstring_view text, DirectX::XMFLOAT2 position) = 0;
+};
@@ -0,0 +1,219 @@
+#include "RenderQueue.h"
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+UINT RenderQueue::Id(const void* resource)
+{
+	constexpr UINT lastId = (1u << IdBits) - 1;
+
+	const auto [id, added] = m_ids.try_emplace(resource, UINT(std::min<size_t>(m_ids.size(), lastId)));
+
+	// a batch this size wants the ids to be wider
+	assert(m_ids.size() <= lastId + 1 && "more distinct resources in one batch than RenderQueue ids hold");
+
+	return id->second;
+}
+
+uint64_t RenderQueue::MakeKey(RenderPass pass, UINT shaderId, UINT vertexBufferId, UINT meshId, size_t lod, float depth) noexcept
+{
+	constexpr uint64_t idMask = (1u << IdBits) - 1;
+
+	// non-negative floats order the same as their bits; the top 20 keep the exponent and 11 bits of mantissa
+	const uint64_t depthBits = std::bit_cast<uint32_t>(std::max(depth, 0.f)) >> 12;
+
+	return uint64_t(pass) << 60
+		| (shaderId & idMask) << 48
+		| (vertexBufferId & idMask) << 36
+		| (meshId & idMask) << 24
+		| uint64_t(std::min<size_t>(lod, 15)) << 20
+		| depthBits;
+}
+
+namespace
+{
+	// Radix digits are 11 bits at most, so the counters of a pass stay in L1 and 32 bits take three
+	// passes instead of four.
+	constexpr int MaxDigitBits = 11;
+	constexpr size_t Buckets = size_t(1) << MaxDigitBits;
+
+	// The bits of value that mask selects, moved down next to each other.
+	uint64_t ExtractBits(uint64_t value, uint64_t mask) noexcept
+	{
+		uint64_t result = 0;
+
+		for (int to = 0; mask; to++, mask &= mask - 1)
+			result |= (value >> std::countr_zero(mask) & 1) << to;
+
+		return result;
+	}
+}
+
+void RenderQueue::Sort()
+{
+	const size_t count = m_packets.size();
+
+	if (count < 2)
+		return;
+
+	// bits every key shares cannot change the order, so only the others are sorted on
+	uint64_t varying = 0;
+	UINT items = 0;
+
+	for (const auto& packet : m_packets)
+	{
+		varying |= packet.key ^ m_packets[0].key;
+		items |= packet.item;
+	}
+
+	if (varying == 0)
+		return;
+
+	const int itemBits = std::bit_width(items);
+
+	if (std::popcount(varying) + itemBits <= 64)
+		SortCompacted(varying, itemBits);
+	else
+		SortPackets(varying);
+}
+
+void RenderQueue::SortCompacted(uint64_t varying, int itemBits)
+{
+	const size_t count = m_packets.size();
+	const int keyBits = std::popcount(varying);
+	const int keyBytes = (keyBits + 7) / 8;
+
+	// What each byte of a key adds to the compacted key, and each byte of a compacted key to the key:
+	// a lookup per byte instead of a shift per bit.
+	m_compactTables.resize(8 * 256);
+	m_expandTables.resize(size_t(keyBytes) * 256);
+
+	for (int byte = 0, to = 0; byte < 8; byte++)
+	{
+		const uint64_t mask = varying >> (8 * byte) & 0xFF;
+
+		for (uint64_t value = 0; value < 256; value++)
+			m_compactTables[byte * 256 + value] = ExtractBits(value, mask) << to;
+
+		to += std::popcount(mask);
+	}
+
+	for (int byte = 0; byte < keyBytes; byte++)
+	{
+		for (uint64_t value = 0; value < 256; value++)
+		{
+			uint64_t key = 0, compacted = value << (8 * byte);
+
+			for (uint64_t rest = varying; rest && compacted; rest &= rest - 1, compacted >>= 1)
+				key |= (compacted & 1) << std::countr_zero(rest);
+
+			m_expandTables[byte * 256 + value] = key;
+		}
+	}
+
+	// as few passes as the bits need, with the bits spread evenly over them
+	const int passes = (keyBits + MaxDigitBits - 1) / MaxDigitBits;
+	const int digitBits = (keyBits + passes - 1) / passes;
+	const uint64_t digitMask = (uint64_t(1) << digitBits) - 1;
+
+	m_histograms.assign(size_t(passes) * Buckets, 0);
+	m_sortKeys.resize(count);
+	m_sortScratch.resize(count);
+
+	// The varying bits packed together above the item, so a pass moves 8 bytes instead of 16. All the
+	// histograms are counted on the way.
+	for (size_t i = 0; i < count; i++)
+	{
+		const uint64_t key = m_packets[i].key;
+		uint64_t compacted = 0;
+
+		for (int byte = 0; byte < 8; byte++)
+			compacted |= m_compactTables[byte * 256 + (key >> (8 * byte) & 0xFF)];
+
+		m_sortKeys[i] = compacted << itemBits | m_packets[i].item;
+
+		for (int pass = 0; pass < passes; pass++)
+			m_histograms[pass * Buckets + (compacted >> (pass * digitBits) & digitMask)]++;
+	}
+
+	const uint64_t shared = m_packets[0].key & ~varying;
+	const uint64_t itemMask = (uint64_t(1) << itemBits) - 1;
+
+	for (int pass = 0; pass < passes; pass++)
+	{
+		UINT* histogram = m_histograms.data() + pass * Buckets;
+		const int shift = itemBits + pass * digitBits;
+
+		UINT offset = 0;
+		for (size_t bucket = 0; bucket <= digitMask; bucket++)
+		{
+			const UINT size = histogram[bucket];
+			histogram[bucket] = offset;
+			offset += size;
+		}
+
+		if (pass + 1 < passes)
+		{
+			for (const uint64_t sortKey : m_sortKeys)
+				m_sortScratch[histogram[sortKey >> shift & digitMask]++] = sortKey;
+
+			m_sortKeys.swap(m_sortScratch);
+			continue;
+		}
+
+		// the last pass puts the packets back together from the shared bits and the sorted ones
+		for (const uint64_t sortKey : m_sortKeys)
+		{
+			const uint64_t compacted = sortKey >> itemBits;
+			uint64_t key = shared;
+
+			for (int byte = 0; byte < keyBytes; byte++)
+				key |= m_expandTables[byte * 256 + (compacted >> (8 * byte) & 0xFF)];
+
+			m_packets[histogram[sortKey >> shift & digitMask]++] = { key, UINT(sortKey & itemMask) };
+		}
+	}
+}
+
+void RenderQueue::SortPackets(uint64_t varying)
+{
+	const size_t count = m_packets.size();
+
+	// from the lowest varying bit to the highest
+	const int low = std::countr_zero(varying);
+	const int bits = 64 - std::countl_zero(varying) - low;
+	const int passes = (bits + MaxDigitBits - 1) / MaxDigitBits;
+	const int digitBits = (bits + passes - 1) / passes;
+	const uint64_t digitMask = (uint64_t(1) << digitBits) - 1;
+
+	m_histograms.assign(size_t(passes) * Buckets, 0);
+
+	for (const auto& packet : m_packets)
+		for (int pass = 0; pass < passes; pass++)
+			m_histograms[pass * Buckets + (packet.key >> (low + pass * digitBits) & digitMask)]++;
+
+	m_scratch.resize(count);
+
+	for (int pass = 0; pass < passes; pass++)
+	{
+		UINT* histogram = m_histograms.data() + pass * Buckets;
+		const int shift = low + pass * digitBits;
+
+		// every key has the same digit here, so the pass would not move anything
+		if (histogram[m_packets[0].key >> shift & digitMask] == count)
+			continue;
+
+		UINT offset = 0;
+		for (size_t bucket = 0; bucket <= digitMask; bucket++)
+		{
+			const UINT size = histogram[bucket];
+			histogram[bucket] = offset;
+			offset += size;
+		}
+
+		for (const auto& packet : m_packets)
+			m_scratch[histogram[packet.key >> shift & digitMask]++] = packet;
+
+		m_packets.swap(m_scratch);
+	}
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include "WinTypes.h"
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+// Passes a RenderQueue draws in order, whatever their other key fields.
+enum class RenderPass : uint8_t
+{
+	Scene,
+	UI
+};
+
+// A draw waiting in a RenderQueue. item indexes whatever the submitter keeps about the draw.
+struct RenderPacket
+{
+	uint64_t key;
+	UINT item;
+};
+
+// Collects a frame's draws and orders them by a 64 bit key, most significant field first:
+//   pass     4 bits
+//   shader  12 bits   pixel shader
+//   buffer  12 bits   vertex buffer, so meshes sharing a GeometryBuffer sort together
+//   mesh    12 bits   so draws of one mesh line up for instancing
+//   lod      4 bits
+//   depth   20 bits   distance from the camera, near first
+// Shaders, buffers and meshes are numbered in the order the queue first sees them after a Clear, so
+// numbers never outlive the frame and a freed resource's address starts afresh when it is reused. A
+// batch has room for 4096 of them together; the ones after that share the last number, which only
+// costs binds and batching.
+class RenderQueue
+{
+public:
+
+	static constexpr UINT IdBits = 12;
+
+	// The number a shader, buffer or mesh is keyed by until the next Clear.
+	UINT Id(const void* resource);
+	static uint64_t MakeKey(RenderPass pass, UINT shaderId, UINT vertexBufferId, UINT meshId, size_t lod, float depth) noexcept;
+
+	void Submit(uint64_t key, UINT item) { m_packets.push_back({ key, item }); }
+	// Radix sorts the packets by key on the bits that differ between them, 11 at a time. Packets with
+	// equal keys stay in the order they were submitted.
+	void Sort();
+	// Drops the packets and the ids, keeping the memory.
+	void Clear() noexcept
+	{
+		m_packets.clear();
+		m_ids.clear();
+	}
+
+	std::span<const RenderPacket> Packets() const noexcept { return m_packets; }
+
+private:
+
+	// Sorts the varying bits packed above the item, when they fit in 64 bits together.
+	void SortCompacted(uint64_t varying, int itemBits);
+	// Sorts the packets themselves on the span of bits from the lowest varying one to the highest.
+	void SortPackets(uint64_t varying);
+
+	std::vector<RenderPacket> m_packets;
+	std::vector<RenderPacket> m_scratch;
+	std::vector<uint64_t> m_sortKeys;
+	std::vector<uint64_t> m_sortScratch;
+	std::vector<UINT> m_histograms;
+	std::vector<uint64_t> m_compactTables;
+	std::vector<uint64_t> m_expandTables;
+	std::unordered_map<const void*, UINT> m_ids;
+};
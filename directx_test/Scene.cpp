@@ -1,5 +1,4 @@
 #include "Scene.h"
-#include "Graphics.h"
 
 SceneObject* Scene::CreateObject()
 {
@@ -1,15 +1,13 @@
 #pragma once
-#include "NormWin.h"
+#include "WinTypes.h"
 #include <memory>
 #include "SceneObject.h"
 
-class Graphics;
-
 class Scene
 {
 public:
 
-	constexpr Scene(Graphics* gfx) : objects(), uiObjects(), pGfx(gfx) {}
+	Scene() = default;
 
 	constexpr const std::vector<std::unique_ptr<SceneObject>>& Objects() const noexcept { return objects; }
 	SceneObject* CreateObject();
@@ -22,6 +20,5 @@ private:
 
 	std::vector<std::unique_ptr<SceneObject>> objects;
 	std::vector<std::unique_ptr<SceneObject>> uiObjects;
-	Graphics* pGfx;
 };
 
@@ -1 +1,84 @@
 #include "SceneObject.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using namespace DirectX;
+
+SceneObject::~SceneObject()
+{
+	if (p_meshLibrary)
+		p_meshLibrary->Release(m_mesh);
+}
+
+void SceneObject::SetMesh(MeshLibrary& library, MeshHandle mesh)
+{
+	// take the new reference first so setting the same mesh again cannot free it
+	library.AddRef(mesh);
+
+	if (p_meshLibrary)
+		p_meshLibrary->Release(m_mesh);
+
+	p_meshLibrary = &library;
+	m_mesh = mesh;
+}
+
+size_t SceneObject::SelectLod(FXMVECTOR cameraPosition, float pixelScale) const noexcept
+{
+	const auto* mesh = GetMesh();
+
+	if (!mesh || mesh->LodCount() == 1)
+		return 0;
+
+	const auto& scale = m_transform.scale;
+	const float maxScale = std::max({ std::abs(scale.x), std::abs(scale.y), std::abs(scale.z) });
+	const auto& sphere = WorldSphere();
+
+	// distance to the nearest point of the bounding sphere, so objects around the camera stay at full detail
+	const float centerDistance = XMVectorGetX(XMVector3Length(XMVectorSubtract(XMLoadFloat3(&sphere.Center), cameraPosition)));
+	const float distance = centerDistance - sphere.Radius;
+
+	if (distance <= 0.f)
+		return 0;
+
+	const float pixelsPerUnit = pixelScale * maxScale / distance;
+
+	for (size_t lod = mesh->LodCount() - 1; lod > 0; lod--)
+	{
+		if (mesh->LodError(lod) * pixelsPerUnit <= m_lodPixelError)
+			return lod;
+	}
+
+	return 0;
+}
+
+const BoundingBox& SceneObject::WorldBox() const noexcept
+{
+	UpdateWorldBounds();
+	return m_worldBounds.box;
+}
+
+const BoundingSphere& SceneObject::WorldSphere() const noexcept
+{
+	UpdateWorldBounds();
+	return m_worldBounds.sphere;
+}
+
+void SceneObject::UpdateWorldBounds() const noexcept
+{
+	const auto* mesh = GetMesh();
+	const auto& source = mesh ? mesh->Bounds() : MeshBounds{};
+
+	// Transform is plain floats that updateables write directly, so a change shows up only as different bytes
+	if (m_worldBoundsValid && std::memcmp(&m_boundsTransform, &m_transform, sizeof(Transform)) == 0
+		&& std::memcmp(&m_boundsSource, &source, sizeof(MeshBounds)) == 0)
+		return;
+
+	const auto world = m_transform.World();
+	source.box.Transform(m_worldBounds.box, world);
+	source.sphere.Transform(m_worldBounds.sphere, world);
+
+	m_boundsTransform = m_transform;
+	m_boundsSource = source;
+	m_worldBoundsValid = true;
+}
@@ -1,9 +1,10 @@
 #pragma once
-#include "NormWin.h"
+#include "WinTypes.h"
 #include <vector>
 #include <memory>
 #include <concepts>
 #include "Mesh.h"
+#include "MeshLibrary.h"
 #include "MeshRenderer.h"
 #include "Updateable.h"
 #include "Transform.h"
@@ -15,11 +16,14 @@ class SceneObject
 {
 public:
 
-	SceneObject() : p_mesh(nullptr) {}
+	SceneObject() : p_meshLibrary(nullptr), m_mesh() {}
 	SceneObject(const SceneObject& other) = delete;
+	~SceneObject();
 
-	constexpr const Mesh* GetMesh() const noexcept { return p_mesh; }
-	constexpr void SetMesh(Mesh* newMesh) noexcept { p_mesh = newMesh; }
+	const Mesh* GetMesh() const noexcept { return p_meshLibrary ? p_meshLibrary->Get(m_mesh) : nullptr; }
+	constexpr MeshHandle GetMeshHandle() const noexcept { return m_mesh; }
+	// Holds a reference to the mesh until another one is set or the object is destroyed.
+	void SetMesh(MeshLibrary& library, MeshHandle mesh);
 
 	constexpr MeshRenderer& GetMeshRenderer() noexcept { return m_meshRenderer; }
 	constexpr const MeshRenderer& GetMeshRenderer() const noexcept { return m_meshRenderer; }
@@ -33,15 +37,39 @@ public:
 		p_updateable.reset(new T(this));
 	}
 
-	constexpr Updateable* GetUpdateable() { return p_updateable.get(); }
+	Updateable* GetUpdateable() noexcept { return p_updateable.get(); }
+
+	// How many pixels of simplification error are acceptable before a finer LOD is used.
+	constexpr float GetLodPixelError() const noexcept { return m_lodPixelError; }
+	constexpr void SetLodPixelError(float pixels) noexcept { m_lodPixelError = pixels; }
+
+	// Picks the coarsest LOD of the mesh whose error, projected at the object's distance, stays within
+	// the pixel budget. pixelScale is the viewport height in pixels covered by one unit at distance one,
+	// i.e. half the viewport height times the projection's y scale.
+	size_t SelectLod(DirectX::FXMVECTOR cameraPosition, float pixelScale) const noexcept;
+
+	// The mesh's bounds under the current transform, recomputed only after the transform or the mesh bounds
+	// changed. The box holds the transformed model box, so it is not tight under rotation.
+	const DirectX::BoundingBox& WorldBox() const noexcept;
+	const DirectX::BoundingSphere& WorldSphere() const noexcept;
 	
 
 
 private:
 
-	Mesh* p_mesh;
+	void UpdateWorldBounds() const noexcept;
+
+	MeshLibrary* p_meshLibrary;
+	MeshHandle m_mesh;
 	MeshRenderer m_meshRenderer;
 	Transform m_transform;
+	float m_lodPixelError = 1.f;
+
+	// what the world bounds were last computed from
+	mutable bool m_worldBoundsValid = false;
+	mutable Transform m_boundsTransform;
+	mutable MeshBounds m_boundsSource;
+	mutable MeshBounds m_worldBounds;
 	std::unique_ptr<Updateable> p_updateable = nullptr;
 };
 
@@ -0,0 +1,362 @@
+#include "SceneRenderer.h"
+#include <algorithm>
+#include <cmath>
+
+SceneRenderer::SceneRenderer(RenderDevice* device, const RenderResources& resources, int width, int height)
+	: p_device(device), m_resources(resources), camera(), uiCamera(),
+	instanceRing(resources.instanceCapacity * sizeof(DirectX::XMFLOAT4X4), sizeof(DirectX::XMFLOAT4X4)),
+	constantRing(resources.constantRingSize, ConstantAlignment)
+{
+	viewport.Width = (FLOAT)width;
+	viewport.Height = (FLOAT)height;
+	viewport.MinDepth = 0.0f;
+	viewport.MaxDepth = 1.0f;
+	viewport.TopLeftX = 0;
+	viewport.TopLeftY = 0;
+	p_device->SetViewport(viewport);
+
+	camera.SetRotation(0, 0, 0);
+	camera.SetPosition(0, 0, -5);
+	uiCamera.SetRotation(0, 0, 0);
+	uiCamera.SetPosition(0, 0, -5);
+
+	// Initialize the projection matrix
+	projection = DirectX::XMMatrixPerspectiveFovLH(DirectX::XM_PIDIV2, width / (FLOAT)height, 0.01f, 1000.0f);
+	uiProjection = DirectX::XMMatrixOrthographicLH(width / 100, height / 100, 0.01f, 100.0f);
+
+	m_fontPos = { 600.f, 600.f };
+}
+
+void SceneRenderer::ClearBuffer(float red, float green, float blue) noexcept
+{
+	const float color[] = {red, green, blue, 1.f};
+	p_device->ClearRenderTarget(color);
+}
+
+void SceneRenderer::Render(float t)
+{
+	frameStats = {};
+	// the text overlay rebinds the input assembler and shaders behind our back
+	boundVertexBuffer = boundAttributeBuffer = boundIndexBuffer = nullptr;
+	boundPositionsOnly = false;
+	boundVertexShader = nullptr;
+	pixelShaderBound = false;
+	passConstantsValid = false;
+
+	currentLightDir.x = std::sin(t);
+	currentLightDir.y = -1.f;
+	currentLightDir.z = std::cos(t);
+
+	ClearBuffer(0.5, 0.5, 0.5);
+	p_device->ClearDepthStencil();
+
+	p_device->SetVertexConstantBuffer(0, m_resources.frameConstants);
+	if (!m_resources.constantRing)
+		p_device->SetVertexConstantBuffer(1, m_resources.objectConstants);
+	p_device->SetPixelConstantBuffer(0, m_resources.pixelConstants);
+
+	// the light only changes once a frame
+	PixelConstantBuffer pcb{};
+	const auto al = .2f;
+	pcb.ambientlLight = { al, al, al, 1.f };
+	pcb.directionalLight = { 1.f, 1.f, 1.f, 1.f };
+	pcb.lightDirection = currentLightDir;
+	p_device->UpdateBuffer(m_resources.pixelConstants, &pcb, sizeof(pcb));
+	frameStats.bytesUploaded += sizeof(pcb);
+
+	p_device->SetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+	p_device->SetViewport(viewport);
+
+	p_device->SetPixelShaderResource(0, m_resources.texture);
+	p_device->SetPixelShaderResource(1, m_resources.skyTexture);
+	p_device->SetPixelSampler(0, m_resources.sampler);
+
+	uiView = DirectX::XMMatrixLookAtLH(uiCamera.Position(), uiCamera.LookAt(), uiCamera.UpVector());
+	view = DirectX::XMMatrixLookAtLH(camera.Position(), camera.LookAt(), camera.UpVector());
+
+	// skybox
+	if (skyMesh)
+	{
+		BindPositions(*skyMesh);
+		BindIndexBuffer(skyMesh->IndexBuffer(), skyMesh->IndexFormat());
+		UpdatePassConstants(RenderPass::Scene);
+		BindObjectConstants(DirectX::XMMatrixScaling(10, 10, 10) * DirectX::XMMatrixTranslationFromVector(camera.Position()));
+		BindVertexShader(m_resources.skyVertexShader);
+		BindPixelShader(skyPS);
+		p_device->SetDepthStencilState(m_resources.skyDepthState);
+		p_device->DrawIndexed(UINT(skyMesh->Indices().size()), skyMesh->StartIndex(), INT(skyMesh->BaseVertex()));
+	}
+
+	p_device->SetDepthStencilState(nullptr);
+}
+
+void SceneRenderer::DrawText()
+{
+	// text goes on top of whatever was drawn
+	Submit();
+	p_device->DrawString(L"Sample Text", m_fontPos);
+}
+
+void SceneRenderer::Draw(const SceneObject& obj, float t)
+{
+	const float pixelScale = viewport.Height * 0.5f * DirectX::XMVectorGetY(projection.r[1]);
+
+	const float depth = DirectX::XMVectorGetX(DirectX::XMVector3Length(DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&obj.WorldSphere().Center), camera.Position())));
+
+	Queue(obj, RenderPass::Scene, depth, obj.SelectLod(camera.Position(), pixelScale));
+}
+
+void SceneRenderer::DrawUI(const SceneObject& obj, float t)
+{
+	const float depth = DirectX::XMVectorGetX(DirectX::XMVector3Length(DirectX::XMVectorSubtract(DirectX::XMLoadFloat3(&obj.WorldSphere().Center), uiCamera.Position())));
+
+	Queue(obj, RenderPass::UI, depth, 0);
+}
+
+void SceneRenderer::Queue(const SceneObject& obj, RenderPass pass, float depth, size_t lod)
+{
+	const auto& mesh = *obj.GetMesh();
+	const auto key = RenderQueue::MakeKey(pass, queue.Id(obj.GetMeshRenderer().PixelShader()), queue.Id(mesh.VertexBuffer()), queue.Id(&mesh), lod, depth);
+
+	queue.Submit(key, UINT(queuedDraws.size()));
+	queuedDraws.push_back({ &obj, pass, lod });
+}
+
+void SceneRenderer::Submit()
+{
+	queue.Sort();
+
+	const auto packets = queue.Packets();
+	const bool instancing = m_resources.instancedVertexShader && m_resources.instanceBuffer && m_resources.instanceCapacity;
+
+	// the scene's packets all sort before the UI's
+	for (size_t first = 0, last; first < packets.size(); first = last)
+	{
+		const auto& draw = queuedDraws[packets[first].item];
+
+		// the run of draws that could be one batch
+		for (last = first + 1; last < packets.size(); last++)
+		{
+			const auto& next = queuedDraws[packets[last].item];
+
+			if (next.pass != draw.pass || next.object->GetMesh() != draw.object->GetMesh() || next.lod != draw.lod
+				|| next.object->GetMeshRenderer().PixelShader() != draw.object->GetMeshRenderer().PixelShader())
+				break;
+		}
+
+		const auto& v = draw.pass == RenderPass::UI ? uiView : view;
+		const auto& proj = draw.pass == RenderPass::UI ? uiProjection : projection;
+		UpdatePassConstants(draw.pass);
+
+		if (instancing && last - first > 1)
+		{
+			DrawInstanced(packets.subspan(first, last - first));
+			continue;
+		}
+
+		for (size_t i = first; i < last; i++)
+			DrawOld(*queuedDraws[packets[i].item].object, v, proj, 0.f, queuedDraws[packets[i].item].lod);
+	}
+
+	queue.Clear();
+	queuedDraws.clear();
+}
+
+void SceneRenderer::BindVertexBuffers(const Mesh& mesh, bool instanced)
+{
+	if (mesh.VertexBuffer() == boundVertexBuffer && mesh.AttributeBuffer() == boundAttributeBuffer && instanced == boundInstanced
+		&& !boundPositionsOnly)
+		return;
+
+	boundVertexBuffer = mesh.VertexBuffer();
+	boundAttributeBuffer = mesh.AttributeBuffer();
+	boundInstanced = instanced;
+	boundPositionsOnly = false;
+	frameStats.bufferBindings++;
+
+	if (mesh.GetVertexLayout() == VertexLayout::Split)
+	{
+		GpuBuffer* buffers[] = { mesh.VertexBuffer(), mesh.AttributeBuffer(), m_resources.instanceBuffer };
+		const UINT strides[] = { sizeof(DirectX::XMFLOAT3), sizeof(VertexAttributes), sizeof(DirectX::XMFLOAT4X4) };
+
+		p_device->SetInputLayout(instanced ? m_resources.instancedSplitVertexLayout : m_resources.splitVertexLayout);
+		p_device->SetVertexBuffers(instanced ? 3 : 2, buffers, strides);
+		return;
+	}
+
+	// slot 1 stays empty, so the instance stream is in slot 2 with either layout
+	GpuBuffer* buffers[] = { mesh.VertexBuffer(), nullptr, m_resources.instanceBuffer };
+	const UINT strides[] = { sizeof(SimpleVertex), 0, sizeof(DirectX::XMFLOAT4X4) };
+
+	p_device->SetInputLayout(instanced ? m_resources.instancedVertexLayout : m_resources.vertexLayout);
+	p_device->SetVertexBuffers(instanced ? 3 : 1, buffers, strides);
+}
+
+void SceneRenderer::BindPositions(const Mesh& mesh)
+{
+	if (!m_resources.positionVertexLayout)
+	{
+		BindVertexBuffers(mesh);
+		return;
+	}
+
+	boundVertexBuffer = mesh.VertexBuffer();
+	boundAttributeBuffer = nullptr;
+	boundInstanced = false;
+	boundPositionsOnly = true;
+	frameStats.bufferBindings++;
+
+	// a split mesh's positions are packed; an interleaved mesh's lead each vertex
+	GpuBuffer* const buffer = mesh.VertexBuffer();
+	const UINT stride = mesh.GetVertexLayout() == VertexLayout::Split ? sizeof(DirectX::XMFLOAT3) : sizeof(SimpleVertex);
+
+	p_device->SetInputLayout(m_resources.positionVertexLayout);
+	p_device->SetVertexBuffers(1, &buffer, &stride);
+}
+
+void SceneRenderer::BindIndexBuffer(GpuBuffer* buffer, DXGI_FORMAT format)
+{
+	if (buffer == boundIndexBuffer && format == boundIndexFormat)
+		return;
+
+	boundIndexBuffer = buffer;
+	boundIndexFormat = format;
+	frameStats.bufferBindings++;
+
+	p_device->SetIndexBuffer(buffer, format);
+}
+
+void SceneRenderer::BindVertexShader(ID3D11VertexShader* shader)
+{
+	if (shader == boundVertexShader)
+		return;
+
+	boundVertexShader = shader;
+	frameStats.shaderBindings++;
+
+	p_device->SetVertexShader(shader);
+}
+
+void SceneRenderer::BindPixelShader(ID3D11PixelShader* shader)
+{
+	if (pixelShaderBound && shader == boundPixelShader)
+		return;
+
+	boundPixelShader = shader;
+	pixelShaderBound = true;
+	frameStats.shaderBindings++;
+
+	p_device->SetPixelShader(shader);
+}
+
+void SceneRenderer::UpdatePassConstants(RenderPass pass)
+{
+	if (passConstantsValid && pass == constantsPass)
+		return;
+
+	constantsPass = pass;
+	passConstantsValid = true;
+
+	FrameConstantBuffer fcb{};
+	fcb.view = DirectX::XMMatrixTranspose(pass == RenderPass::UI ? uiView : view);
+	fcb.projection = DirectX::XMMatrixTranspose(pass == RenderPass::UI ? uiProjection : projection);
+	p_device->UpdateBuffer(m_resources.frameConstants, &fcb, sizeof(fcb));
+	frameStats.bytesUploaded += sizeof(fcb);
+}
+
+void SceneRenderer::BindObjectConstants(DirectX::FXMMATRIX world)
+{
+	ObjectConstantBuffer ocb{};
+	ocb.world = DirectX::XMMatrixTranspose(world);
+	frameStats.bytesUploaded += sizeof(ocb);
+
+	if (!m_resources.constantRing)
+	{
+		p_device->UpdateBuffer(m_resources.objectConstants, &ocb, sizeof(ocb));
+		return;
+	}
+
+	// each object takes a whole step of the ring, the least an offset binding can cover
+	const auto slot = constantRing.Allocate(ConstantAlignment);
+	p_device->WriteBuffer(m_resources.constantRing, slot.offset, &ocb, sizeof(ocb), slot.mode);
+	p_device->SetVertexConstantBufferRange(1, m_resources.constantRing, slot.offset, ConstantAlignment);
+}
+
+void SceneRenderer::DrawInstanced(std::span<const RenderPacket> packets)
+{
+	const auto& first = queuedDraws[packets.front().item];
+	const auto& mesh = *first.object->GetMesh();
+	const auto lod = first.lod;
+
+	BindVertexShader(m_resources.instancedVertexShader);
+	BindVertexBuffers(mesh, true);
+	BindIndexBuffer(mesh.IndexBuffer(lod), mesh.IndexFormat(lod));
+	// VSInstanced takes the world matrices from the instance stream, not from object constants
+	BindPixelShader(first.object->GetMeshRenderer().PixelShader());
+
+	const auto capacity = m_resources.instanceCapacity;
+
+	// batches bigger than the whole buffer go in pieces
+	for (size_t begin = 0; begin < packets.size();)
+	{
+		const auto count = UINT(std::min<size_t>(packets.size() - begin, capacity));
+
+		instanceWorlds.resize(count);
+		for (UINT i = 0; i < count; i++)
+			DirectX::XMStoreFloat4x4(&instanceWorlds[i], queuedDraws[packets[begin + i].item].object->GetTransform().World());
+
+		const auto bytes = UINT(count * sizeof(DirectX::XMFLOAT4X4));
+		const auto space = instanceRing.Allocate(bytes);
+
+		p_device->WriteBuffer(m_resources.instanceBuffer, space.offset, instanceWorlds.data(), bytes, space.mode);
+		p_device->DrawIndexedInstanced(mesh.IndexCount(lod), count, mesh.StartIndex(lod), INT(mesh.BaseVertex()), UINT(space.offset / sizeof(DirectX::XMFLOAT4X4)));
+
+		begin += count;
+		frameStats.bytesUploaded += bytes;
+
+		frameStats.instancedDraws++;
+		frameStats.instances += count;
+		frameStats.trianglesSubmitted += size_t(mesh.IndexCount(lod) / 3) * count;
+		frameStats.trianglesFullDetail += size_t(mesh.IndexCount(0) / 3) * count;
+	}
+}
+
+void SceneRenderer::DrawOld(const SceneObject& o, DirectX::XMMATRIX v, DirectX::XMMATRIX proj, float t, size_t lod)
+{
+	BindVertexShader(m_resources.vertexShader);
+	BindVertexBuffers(*o.GetMesh());
+	BindIndexBuffer(o.GetMesh()->IndexBuffer(lod), o.GetMesh()->IndexFormat(lod));
+
+	const auto sc = o.GetTransform().scale;
+	const auto world = o.GetTransform().World();
+
+	BindObjectConstants(world);
+
+	BindPixelShader(o.GetMeshRenderer().PixelShader());
+
+	frameStats.trianglesFullDetail += o.GetMesh()->IndexCount(0) / 3;
+
+	const auto& meshlets = o.GetMesh()->Meshlets();
+	const auto startIndex = o.GetMesh()->StartIndex(lod);
+	const auto baseVertex = INT(o.GetMesh()->BaseVertex());
+
+	if (lod != 0 || meshlets.empty())
+	{
+		p_device->DrawIndexed(o.GetMesh()->IndexCount(lod), startIndex, baseVertex);
+		frameStats.trianglesSubmitted += o.GetMesh()->IndexCount(lod) / 3;
+		return;
+	}
+
+	// cull clusters in model space; normal cones only hold under uniform scale
+	const auto worldView = world * v;
+	const auto cameraPosition = DirectX::XMVector3TransformCoord(DirectX::XMVectorZero(), DirectX::XMMatrixInverse(nullptr, worldView));
+	const bool uniformScale = sc.x == sc.y && sc.y == sc.z;
+
+	const auto stats = MeshletBuilder::Cull(meshlets, worldView * proj, cameraPosition, uniformScale, visibleRanges);
+
+	for (const auto& range : visibleRanges)
+		p_device->DrawIndexed(range.count, startIndex + range.start, baseVertex);
+
+	frameStats.trianglesSubmitted += stats.visibleTriangles;
+	frameStats.meshletsCulled += stats.meshlets - stats.visibleMeshlets;
+}
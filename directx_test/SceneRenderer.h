@@ -0,0 +1,189 @@
+#pragma once
+#include "WinTypes.h"
+#include <span>
+#include <vector>
+#include "Camera.h"
+#include "SceneObject.h"
+#include "Meshlet.h"
+#include "RenderDevice.h"
+#include "RenderQueue.h"
+#include "UploadRing.h"
+
+// The Light.fx vertex shader constants, split by how often they change: once per pass, and per object
+struct FrameConstantBuffer
+{
+	DirectX::XMMATRIX view;
+	DirectX::XMMATRIX projection;
+};
+
+struct ObjectConstantBuffer
+{
+	DirectX::XMMATRIX world;
+};
+
+struct PixelConstantBuffer
+{
+	DirectX::XMFLOAT4 ambientlLight;
+	DirectX::XMFLOAT4 directionalLight;
+	DirectX::XMFLOAT4 lightDirection;
+	//float sine = 0.f;
+};
+
+struct FrameStats
+{
+	size_t trianglesSubmitted = 0;
+	// what the same draws would have cost at LOD 0 without cluster culling
+	size_t trianglesFullDetail = 0;
+	size_t meshletsCulled = 0;
+	// vertex and index buffer binds; meshes in one GeometryBuffer share a single bind of each
+	size_t bufferBindings = 0;
+	// pixel and vertex shader binds, the sky's included
+	size_t shaderBindings = 0;
+	// DrawIndexedInstanced calls and the objects they drew
+	size_t instancedDraws = 0;
+	size_t instances = 0;
+	// constant and instance data handed to the device
+	size_t bytesUploaded = 0;
+};
+
+// The shaders, layouts and states frames are drawn with. Graphics creates them; on a headless
+// RenderDevice any of them may be null.
+struct RenderResources
+{
+	ID3D11VertexShader* vertexShader = nullptr;
+	ID3D11VertexShader* skyVertexShader = nullptr;
+	ID3D11InputLayout* vertexLayout = nullptr;
+	// positions in slot 0, VertexAttributes in slot 1
+	ID3D11InputLayout* splitVertexLayout = nullptr;
+	// POSITION alone in slot 0, which the sky is drawn with: the position stream of a split mesh, or
+	// the start of each interleaved vertex. Without it the sky is bound like any other mesh.
+	ID3D11InputLayout* positionVertexLayout = nullptr;
+	// Light.fx VSInstanced and the two layouts above with a world matrix per instance in slot 2,
+	// read from instanceBuffer, an upload buffer of instanceCapacity XMFLOAT4X4s. Without them
+	// every object is drawn on its own.
+	ID3D11VertexShader* instancedVertexShader = nullptr;
+	ID3D11InputLayout* instancedVertexLayout = nullptr;
+	ID3D11InputLayout* instancedSplitVertexLayout = nullptr;
+	GpuBuffer* instanceBuffer = nullptr;
+	UINT instanceCapacity = 0;
+	// FrameConstantBuffer in VS slot 0, ObjectConstantBuffer in VS slot 1 and PixelConstantBuffer in PS slot 0
+	GpuBuffer* frameConstants = nullptr;
+	GpuBuffer* objectConstants = nullptr;
+	GpuBuffer* pixelConstants = nullptr;
+	// An upload buffer of constantRingSize bytes that ObjectConstantBuffers are sub-allocated from and
+	// bound by offset, where the device can do that. Without it objectConstants is updated per object.
+	GpuBuffer* constantRing = nullptr;
+	UINT constantRingSize = 0;
+	ID3D11ShaderResourceView* texture = nullptr;
+	ID3D11ShaderResourceView* skyTexture = nullptr;
+	ID3D11SamplerState* sampler = nullptr;
+	ID3D11DepthStencilState* skyDepthState = nullptr;
+};
+
+// Submits frames: the skybox, scene and UI objects and the text overlay, through a RenderDevice
+// so the same path runs on D3D11 or headless. Owns the cameras.
+//
+// Draw and DrawUI only queue the object; Submit draws the queue sorted by pass, pixel shader, buffers,
+// mesh and distance, binding only what changed from one draw to the next. Objects that end up next to
+// each other with the same mesh, LOD and pixel shader are drawn as one instanced batch, without
+// cluster culling.
+class SceneRenderer
+{
+public:
+
+	SceneRenderer(RenderDevice* device, const RenderResources& resources, int width, int height);
+	SceneRenderer(const SceneRenderer&) = delete;
+	SceneRenderer& operator=(const SceneRenderer&) = delete;
+
+	// Starts a frame: clears, binds the frame-wide state and draws the skybox when there is one.
+	void Render(float t);
+	// Queues the object until Submit; it must not be destroyed before then.
+	void Draw(const SceneObject& obj, float t);
+	void DrawUI(const SceneObject& obj, float t);
+	// Draws everything queued since the last Submit.
+	void Submit();
+	void DrawText();
+	void ClearBuffer(float red, float green, float blue) noexcept;
+
+	// drawn around the camera at the start of every frame; the mesh must outlive the renderer or be unset
+	constexpr void SetSky(const Mesh* mesh, ID3D11PixelShader* pixelShader) noexcept { skyMesh = mesh; skyPS = pixelShader; }
+
+	constexpr Camera& GetCamera() noexcept {return camera;}
+	// counts for the frame started by the last Render call
+	constexpr const FrameStats& GetFrameStats() const noexcept {return frameStats;}
+
+private:
+
+	// Sets the input layout and vertex streams mesh draws with, unless they are bound already. Instanced
+	// draws take the instance buffer as a third stream.
+	void BindVertexBuffers(const Mesh& mesh, bool instanced = false);
+	// Binds only the positions of mesh, with positionVertexLayout when there is one.
+	void BindPositions(const Mesh& mesh);
+	void BindIndexBuffer(GpuBuffer* buffer, DXGI_FORMAT format);
+	void BindVertexShader(ID3D11VertexShader* shader);
+	void BindPixelShader(ID3D11PixelShader* shader);
+	// Uploads the view and projection of pass, unless they are uploaded already.
+	void UpdatePassConstants(RenderPass pass);
+	void BindObjectConstants(DirectX::FXMMATRIX world);
+	void Queue(const SceneObject& obj, RenderPass pass, float depth, size_t lod);
+	// Draws queued objects sharing a mesh, LOD and pixel shader, writing their world matrices to the instance buffer.
+	void DrawInstanced(std::span<const RenderPacket> packets);
+	void DrawOld(const SceneObject& o, DirectX::XMMATRIX v, DirectX::XMMATRIX proj, float t, size_t lod = 0);
+
+	RenderDevice* p_device;
+	RenderResources m_resources;
+
+	DirectX::XMMATRIX view;
+	DirectX::XMMATRIX uiView;
+	DirectX::XMMATRIX projection;
+	DirectX::XMMATRIX uiProjection;
+
+	Camera camera;
+	Camera uiCamera;
+
+	DirectX::XMFLOAT4 currentLightDir;
+	DirectX::XMFLOAT2 m_fontPos;
+	D3D11_VIEWPORT viewport;
+
+	const Mesh* skyMesh = nullptr;
+	ID3D11PixelShader* skyPS = nullptr;
+
+	FrameStats frameStats;
+
+	struct QueuedDraw
+	{
+		const SceneObject* object;
+		RenderPass pass;
+		size_t lod;
+	};
+
+	RenderQueue queue;
+	// what the queue's packets index
+	std::vector<QueuedDraw> queuedDraws;
+	// world matrices on their way to the instance buffer
+	std::vector<DirectX::XMFLOAT4X4> instanceWorlds;
+	UploadRing instanceRing;
+	// constant buffer offsets are bound in steps of 16 constants
+	static constexpr UINT ConstantAlignment = 256;
+	UploadRing constantRing;
+
+	// which pass's view and projection frameConstants holds
+	RenderPass constantsPass = RenderPass::Scene;
+	bool passConstantsValid = false;
+
+	// reused every draw for the ranges that survive cluster culling
+	std::vector<IndexRange> visibleRanges;
+
+	// what BindVertexBuffers and BindIndexBuffer last bound this frame
+	GpuBuffer* boundVertexBuffer = nullptr;
+	GpuBuffer* boundAttributeBuffer = nullptr;
+	bool boundInstanced = false;
+	// BindPositions left the attribute stream unbound
+	bool boundPositionsOnly = false;
+	GpuBuffer* boundIndexBuffer = nullptr;
+	DXGI_FORMAT boundIndexFormat = DXGI_FORMAT_UNKNOWN;
+	ID3D11VertexShader* boundVertexShader = nullptr;
+	ID3D11PixelShader* boundPixelShader = nullptr;
+	// false until the first pixel shader bind of the frame, since null is a shader too
+	bool pixelShaderBound = false;
+};
@@ -1,13 +1,12 @@
 #pragma once
 
-#include "NormWin.h"
 #include <DirectXMath.h>
 
 struct SimpleVertex
 {
-	SimpleVertex()
+	constexpr SimpleVertex()
 		: position(), color(1.f, 1.f, 1.f), normal(1.f, 0.f, 0.f), texCoord(0.f, 0.f) {}
-	SimpleVertex(DirectX::XMFLOAT3 position, DirectX::XMFLOAT3 color, DirectX::XMFLOAT3 normal, DirectX::XMFLOAT2 texCoord)
+	constexpr SimpleVertex(DirectX::XMFLOAT3 position, DirectX::XMFLOAT3 color, DirectX::XMFLOAT3 normal, DirectX::XMFLOAT2 texCoord)
 		: position(position), color(color), normal(normal), texCoord(texCoord)
 	{
 	}
@@ -16,4 +15,12 @@ struct SimpleVertex
 	DirectX::XMFLOAT3 color;
 	DirectX::XMFLOAT3 normal;
 	DirectX::XMFLOAT2 texCoord;
+};
+
+// Everything in a SimpleVertex but the position, for meshes that keep positions in a stream of their own.
+struct VertexAttributes
+{
+	DirectX::XMFLOAT3 color;
+	DirectX::XMFLOAT3 normal;
+	DirectX::XMFLOAT2 texCoord;
 };
\ No newline at end of file
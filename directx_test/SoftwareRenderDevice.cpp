@@ -0,0 +1,888 @@
+#include "SoftwareRenderDevice.h"
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include "Parallel.h"
+
+namespace
+{
+	// Only their addresses are used, as the shader and state handles the device hands out
+	// VS, SKYMAP_VS and VSInstanced
+	std::byte g_vertexShaders[3];
+	std::byte g_pixelShaders[size_t(PixelKernel::Count)];
+	std::byte g_lessEqualState;
+
+	using PixelFunction = DirectX::XMVECTOR(*)(const ShadedVertex&, const PixelContext&) noexcept;
+
+	// indexed by PixelKernel
+	constexpr PixelFunction g_pixelFunctions[] =
+	{
+		&SoftwareShaders::PS,
+		&SoftwareShaders::PSSolid,
+		&SoftwareShaders::PSTexture,
+		&SoftwareShaders::PSCustom,
+		&SoftwareShaders::SkymapPShader
+	};
+
+	// how many leading varyings each kernel reads, so the rest need not be interpolated
+	constexpr size_t g_varyingsRead[] = { 9, 6, 11, 9, 3 };
+
+	static_assert(std::size(g_pixelFunctions) == size_t(PixelKernel::Count), "every PixelKernel needs its function");
+	static_assert(std::size(g_varyingsRead) == size_t(PixelKernel::Count), "every PixelKernel needs its varying count");
+
+	ID3D11VertexShader* VertexShaderHandle(size_t index) noexcept
+	{
+		return reinterpret_cast<ID3D11VertexShader*>(&g_vertexShaders[index]);
+	}
+
+	ID3D11PixelShader* PixelShaderHandle(PixelKernel kernel) noexcept
+	{
+		return reinterpret_cast<ID3D11PixelShader*>(&g_pixelShaders[size_t(kernel)]);
+	}
+
+	PixelKernel KernelOf(ID3D11PixelShader* shader) noexcept
+	{
+		for (size_t k = 0; k < size_t(PixelKernel::Count); k++)
+		{
+			if (shader == PixelShaderHandle(PixelKernel(k)))
+				return PixelKernel(k);
+		}
+
+		return PixelKernel::Count;
+	}
+
+	uint32_t Pack(DirectX::FXMVECTOR color) noexcept
+	{
+		DirectX::XMFLOAT4 c;
+		DirectX::XMStoreFloat4(&c, DirectX::XMVectorSaturate(color));
+
+		const auto channel = [](float f) { return uint32_t(f * 255.f + 0.5f); };
+
+		// B8G8R8A8, blue in the lowest byte
+		return channel(c.w) << 24 | channel(c.x) << 16 | channel(c.y) << 8 | channel(c.z);
+	}
+
+	// the six planes bounding the view, and one keeping w away from zero: the skybox has z = w, so for it
+	// the near plane alone would let w reach zero
+	constexpr int ClipPlanes = 7;
+
+	// Distance of a clip space position inside the plane numbered plane
+	float ClipDistance(const DirectX::XMFLOAT4& p, int plane) noexcept
+	{
+		switch (plane)
+		{
+		case 0: return p.w + p.x;
+		case 1: return p.w - p.x;
+		case 2: return p.w + p.y;
+		case 3: return p.w - p.y;
+		case 4: return p.z;
+		case 5: return p.w - p.z;
+		default: return p.w - 1e-5f;
+		}
+	}
+
+	ShadedVertex Lerp(const ShadedVertex& a, const ShadedVertex& b, float t) noexcept
+	{
+		ShadedVertex v;
+		DirectX::XMStoreFloat4(&v.position, DirectX::XMVectorLerp(DirectX::XMLoadFloat4(&a.position), DirectX::XMLoadFloat4(&b.position), t));
+
+		for (size_t k = 0; k < ShadedVertex::VaryingCount; k++)
+			v.Varyings()[k] = a.Varyings()[k] + (b.Varyings()[k] - a.Varyings()[k]) * t;
+
+		return v;
+	}
+
+	DirectX::XMVECTOR Inside(DirectX::FXMVECTOR edge, bool topLeft) noexcept
+	{
+		return topLeft ? DirectX::XMVectorGreaterOrEqual(edge, DirectX::XMVectorZero()) : DirectX::XMVectorGreater(edge, DirectX::XMVectorZero());
+	}
+}
+
+SoftwareRenderDevice::SoftwareRenderDevice(UINT width, UINT height)
+	: m_width(width), m_height(height), m_pitch((width + 3) & ~3u),
+	m_tilesX((width + TileSize - 1) / TileSize), m_tilesY((height + TileSize - 1) / TileSize),
+	m_color(size_t(m_pitch) * height), m_depth(size_t(m_pitch) * height, 1.f), m_bins(size_t(m_tilesX) * m_tilesY)
+{
+	m_viewport = { 0.f, 0.f, FLOAT(width), FLOAT(height), 0.f, 1.f };
+
+	p_ownFrameConstants = CreateBuffer(sizeof(FrameConstantBuffer));
+	p_ownObjectConstants = CreateBuffer(sizeof(ObjectConstantBuffer));
+	p_ownPixelConstants = CreateBuffer(sizeof(PixelConstantBuffer));
+	p_ownConstantRing = CreateBuffer(ConstantRingSize);
+	p_ownInstances = CreateBuffer(InstanceCapacity * sizeof(DirectX::XMFLOAT4X4));
+}
+
+void SoftwareRenderDevice::ClearRenderTarget(const float color[4])
+{
+	// whatever was drawn before the clear still has to land first
+	if (!m_triangles.empty())
+		Flush();
+
+	m_clearColor = true;
+	m_clearValue = Pack(DirectX::XMVectorSet(color[0], color[1], color[2], color[3]));
+}
+
+void SoftwareRenderDevice::ClearDepthStencil()
+{
+	if (!m_triangles.empty())
+		Flush();
+
+	m_clearDepth = true;
+}
+
+void SoftwareRenderDevice::SetViewport(const D3D11_VIEWPORT& viewport)
+{
+	m_viewport = viewport;
+}
+
+void SoftwareRenderDevice::SetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY topology)
+{
+	m_triangleList = topology == D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+}
+
+void SoftwareRenderDevice::SetInputLayout(ID3D11InputLayout* layout)
+{
+	// the streams bound tell the layouts apart
+}
+
+void SoftwareRenderDevice::SetVertexBuffers(UINT count, GpuBuffer* const* buffers, const UINT* strides)
+{
+	m_streams = std::min<UINT>(count, UINT(m_vertexBuffers.size()));
+
+	for (UINT i = 0; i < m_streams; i++)
+	{
+		m_vertexBuffers[i] = buffers[i];
+		m_strides[i] = strides[i];
+	}
+}
+
+void SoftwareRenderDevice::SetIndexBuffer(GpuBuffer* buffer, DXGI_FORMAT format)
+{
+	p_indexBuffer = buffer;
+	m_indexFormat = format;
+}
+
+void SoftwareRenderDevice::SetVertexShader(ID3D11VertexShader* shader)
+{
+	p_vertexShader = shader;
+}
+
+void SoftwareRenderDevice::SetPixelShader(ID3D11PixelShader* shader)
+{
+	p_pixelShader = shader;
+}
+
+void SoftwareRenderDevice::SetVertexConstantBuffer(UINT slot, GpuBuffer* buffer)
+{
+	SetVertexConstantBufferRange(slot, buffer, 0, 0);
+}
+
+void SoftwareRenderDevice::SetVertexConstantBufferRange(UINT slot, GpuBuffer* buffer, UINT offset, UINT byteCount)
+{
+	if (slot >= m_vertexConstants.size())
+		return;
+
+	m_vertexConstants[slot] = buffer;
+	m_vertexConstantOffsets[slot] = offset;
+}
+
+void SoftwareRenderDevice::SetPixelConstantBuffer(UINT slot, GpuBuffer* buffer)
+{
+	if (slot == 0)
+		p_pixelConstants = buffer;
+}
+
+void SoftwareRenderDevice::SetPixelShaderResource(UINT slot, ID3D11ShaderResourceView* view)
+{
+	if (slot >= m_textures.size())
+		return;
+
+	const auto found = std::find_if(m_ownTextures.begin(), m_ownTextures.end(),
+		[view](const auto& texture) { return reinterpret_cast<ID3D11ShaderResourceView*>(texture.get()) == view; });
+
+	m_textures[slot] = found != m_ownTextures.end() ? found->get() : nullptr;
+}
+
+void SoftwareRenderDevice::SetPixelSampler(UINT slot, ID3D11SamplerState* sampler)
+{
+	// SoftwareTexture always samples like the one sampler Graphics creates
+}
+
+void SoftwareRenderDevice::SetDepthStencilState(ID3D11DepthStencilState* state)
+{
+	m_lessEqual = state == reinterpret_cast<ID3D11DepthStencilState*>(&g_lessEqualState);
+}
+
+void SoftwareRenderDevice::UpdateBuffer(GpuBuffer* buffer, const void* data, UINT byteCount)
+{
+	if (auto* bytes = FindBuffer(buffer))
+		std::memcpy(bytes->data(), data, std::min<size_t>(byteCount, bytes->size()));
+}
+
+void SoftwareRenderDevice::WriteBuffer(GpuBuffer* buffer, UINT offset, const void* data, UINT byteCount, BufferMap mode)
+{
+	auto* bytes = FindBuffer(buffer);
+
+	if (!bytes || size_t(offset) + byteCount > bytes->size())
+		throw std::runtime_error("buffer write out of range");
+
+	std::memcpy(bytes->data() + offset, data, byteCount);
+}
+
+void SoftwareRenderDevice::DrawIndexed(UINT indexCount, UINT startIndex, INT baseVertex)
+{
+	m_stats.drawCalls++;
+	Draw(indexCount, startIndex, baseVertex, nullptr);
+}
+
+void SoftwareRenderDevice::DrawIndexedInstanced(UINT indexCount, UINT instanceCount, UINT startIndex, INT baseVertex, UINT startInstance)
+{
+	m_stats.drawCalls++;
+
+	const auto* instances = m_streams > 2 ? FindBuffer(m_vertexBuffers[2]) : nullptr;
+	const size_t stride = m_strides[2];
+
+	if (!instances || stride < sizeof(DirectX::XMFLOAT4X4) || (size_t(startInstance) + instanceCount) * stride > instances->size())
+	{
+		m_stats.skippedDraws++;
+		return;
+	}
+
+	for (UINT i = 0; i < instanceCount; i++)
+	{
+		DirectX::XMFLOAT4X4 world;
+		std::memcpy(&world, instances->data() + (size_t(startInstance) + i) * stride, sizeof(world));
+
+		Draw(indexCount, startIndex, baseVertex, &world);
+	}
+}
+
+void SoftwareRenderDevice::Draw(UINT indexCount, UINT startIndex, INT baseVertex, const DirectX::XMFLOAT4X4* instanceWorld)
+{
+	const bool sky = p_vertexShader == VertexShaderHandle(1);
+	const bool knownShader = instanceWorld ? p_vertexShader == VertexShaderHandle(2) : p_vertexShader == VertexShaderHandle(0) || sky;
+	const auto kernel = p_pixelShader ? KernelOf(p_pixelShader) : PixelKernel::Count;
+	// slot 1 is left empty when an interleaved mesh is drawn instanced
+	const bool split = m_streams > 1 && m_vertexBuffers[1];
+
+	const auto* indexBytes = FindBuffer(p_indexBuffer);
+	const auto* positions = m_streams > 0 ? FindBuffer(m_vertexBuffers[0]) : nullptr;
+	const auto* attributes = split ? FindBuffer(m_vertexBuffers[1]) : positions;
+	const auto* frameConstants = FindBuffer(m_vertexConstants[0]);
+	// VSInstanced reads no object constants
+	const auto* objectConstants = instanceWorld ? nullptr : FindBuffer(m_vertexConstants[1]);
+	const size_t objectOffset = m_vertexConstantOffsets[1];
+
+	const size_t indexSize = m_indexFormat == DXGI_FORMAT_R16_UINT ? sizeof(USHORT) : sizeof(UINT);
+
+	if (!m_triangleList || !indexBytes || !positions || !attributes || !frameConstants || frameConstants->size() < sizeof(FrameConstantBuffer)
+		|| (!instanceWorld && (!objectConstants || objectOffset + sizeof(ObjectConstantBuffer) > objectConstants->size()))
+		|| !knownShader || (p_pixelShader && kernel == PixelKernel::Count)
+		|| (size_t(startIndex) + indexCount) * indexSize > indexBytes->size())
+	{
+		m_stats.skippedDraws++;
+		return;
+	}
+
+	const auto index = [&](size_t i) -> INT
+	{
+		if (indexSize == sizeof(USHORT))
+		{
+			USHORT value;
+			std::memcpy(&value, indexBytes->data() + (startIndex + i) * indexSize, sizeof(value));
+			return INT(value);
+		}
+
+		UINT value;
+		std::memcpy(&value, indexBytes->data() + (startIndex + i) * indexSize, sizeof(value));
+		return INT(value);
+	};
+
+	const size_t count = indexCount - indexCount % 3;
+
+	if (count == 0)
+		return;
+
+	INT first = INT_MAX, last = 0;
+	for (size_t i = 0; i < count; i++)
+	{
+		first = std::min(first, index(i));
+		last = std::max(last, index(i));
+	}
+
+	// stream 0 holds positions either way; attributes follow them or have a stream of their own
+	const size_t positionStride = m_strides[0];
+	const size_t attributeStride = split ? m_strides[1] : m_strides[0];
+	const size_t attributeOffset = split ? 0 : sizeof(DirectX::XMFLOAT3);
+	const INT lowest = baseVertex + first, highest = baseVertex + last;
+
+	if (lowest < 0 || size_t(highest) * positionStride + sizeof(DirectX::XMFLOAT3) > positions->size()
+		|| (!sky && size_t(highest) * attributeStride + attributeOffset + sizeof(VertexAttributes) > attributes->size()))
+	{
+		m_stats.skippedDraws++;
+		return;
+	}
+
+	FrameConstantBuffer frame;
+	std::memcpy(&frame, frameConstants->data(), sizeof(frame));
+
+	ObjectConstantBuffer object{};
+	if (!instanceWorld)
+		std::memcpy(&object, objectConstants->data() + objectOffset, sizeof(object));
+
+	const auto transforms = instanceWorld ? VertexTransforms(frame, *instanceWorld) : VertexTransforms(frame, object);
+
+	m_shaded.resize(size_t(last - first) + 1);
+
+	ParallelFor(m_shaded.size(), 4096, [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				const size_t vertex = size_t(lowest) + i;
+
+				DirectX::XMFLOAT3 position;
+				std::memcpy(&position, positions->data() + vertex * positionStride, sizeof(position));
+
+				if (sky)
+				{
+					m_shaded[i] = SoftwareShaders::SkymapVS(position, transforms);
+					continue;
+				}
+
+				VertexAttributes vertexAttributes;
+				std::memcpy(&vertexAttributes, attributes->data() + vertex * attributeStride + attributeOffset, sizeof(vertexAttributes));
+
+				m_shaded[i] = SoftwareShaders::VS(position, vertexAttributes, transforms);
+			}
+		});
+
+	DrawState draw{ kernel, m_lessEqual, {}, m_textures[0], m_textures[1] };
+
+	if (const auto* pixelConstants = FindBuffer(p_pixelConstants); pixelConstants && pixelConstants->size() >= sizeof(draw.constants))
+		std::memcpy(&draw.constants, pixelConstants->data(), sizeof(draw.constants));
+
+	const auto drawIndex = UINT(m_draws.size());
+	m_draws.push_back(draw);
+
+	// set up in parallel, then put back in draw order so depth ties resolve as on a GPU
+	std::mutex chunkMutex;
+	std::vector<std::pair<size_t, std::vector<RasterTriangle>>> chunks;
+	SoftwareStats setupStats;
+
+	ParallelFor(count / 3, 1024, [&](size_t begin, size_t end)
+		{
+			std::vector<RasterTriangle> triangles;
+			SoftwareStats stats;
+			triangles.reserve(end - begin);
+
+			for (size_t t = begin; t < end; t++)
+			{
+				const auto& v0 = m_shaded[index(3 * t) - first];
+				const auto& v1 = m_shaded[index(3 * t + 1) - first];
+				const auto& v2 = m_shaded[index(3 * t + 2) - first];
+
+				SetupTriangle(v0, v1, v2, drawIndex, triangles, stats);
+			}
+
+			std::lock_guard lock(chunkMutex);
+			chunks.emplace_back(begin, std::move(triangles));
+			setupStats.trianglesCulled += stats.trianglesCulled;
+			setupStats.trianglesClipped += stats.trianglesClipped;
+		});
+
+	std::sort(chunks.begin(), chunks.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+	for (auto& [begin, triangles] : chunks)
+	{
+		for (const auto& triangle : triangles)
+		{
+			const auto triangleIndex = UINT(m_triangles.size());
+			m_triangles.push_back(triangle);
+
+			for (int ty = triangle.minY / int(TileSize); ty <= triangle.maxY / int(TileSize); ty++)
+			{
+				for (int tx = triangle.minX / int(TileSize); tx <= triangle.maxX / int(TileSize); tx++)
+					m_bins[size_t(ty) * m_tilesX + tx].push_back(triangleIndex);
+			}
+		}
+
+		m_stats.trianglesBinned += triangles.size();
+	}
+
+	m_stats.verticesShaded += m_shaded.size();
+	m_stats.trianglesSubmitted += count / 3;
+	m_stats.trianglesCulled += setupStats.trianglesCulled;
+	m_stats.trianglesClipped += setupStats.trianglesClipped;
+}
+
+void SoftwareRenderDevice::DrawString(std::wstring_view text, DirectX::XMFLOAT2 position)
+{
+	// the font is a D3D11 SpriteFont; the software target goes without the overlay
+}
+
+GpuBuffer* SoftwareRenderDevice::CreateStaticBuffer(const void* data, UINT byteWidth, UINT bindFlags)
+{
+	auto* buffer = CreateBuffer(byteWidth);
+	std::memcpy(FindBuffer(buffer)->data(), data, byteWidth);
+
+	return buffer;
+}
+
+GpuBuffer* SoftwareRenderDevice::CreatePooledBuffer(UINT byteWidth, UINT bindFlags)
+{
+	return CreateBuffer(byteWidth);
+}
+
+GpuBuffer* SoftwareRenderDevice::CreateUploadBuffer(UINT byteWidth)
+{
+	return CreateBuffer(byteWidth);
+}
+
+void SoftwareRenderDevice::ReleaseBuffer(GpuBuffer* buffer)
+{
+	std::lock_guard lock(m_bufferMutex);
+	m_buffers.erase(buffer);
+}
+
+void* SoftwareRenderDevice::Map(GpuBuffer* buffer, BufferMap mode)
+{
+	auto* bytes = FindBuffer(buffer);
+
+	if (!bytes)
+		throw std::runtime_error("not a software buffer");
+
+	return bytes->data();
+}
+
+void SoftwareRenderDevice::Unmap(GpuBuffer* buffer)
+{
+}
+
+void SoftwareRenderDevice::CopyBufferRegion(GpuBuffer* destination, UINT destinationOffset, GpuBuffer* source, UINT sourceOffset, UINT byteCount)
+{
+	auto* to = FindBuffer(destination);
+	const auto* from = FindBuffer(source);
+
+	if (!to || !from || size_t(destinationOffset) + byteCount > to->size() || size_t(sourceOffset) + byteCount > from->size())
+		throw std::runtime_error("buffer copy out of range");
+
+	std::memcpy(to->data() + destinationOffset, from->data() + sourceOffset, byteCount);
+}
+
+RenderResources SoftwareRenderDevice::Resources() const noexcept
+{
+	RenderResources resources;
+	resources.vertexShader = VertexShaderHandle(0);
+	resources.skyVertexShader = VertexShaderHandle(1);
+	resources.instancedVertexShader = VertexShaderHandle(2);
+	resources.instanceBuffer = p_ownInstances;
+	resources.instanceCapacity = InstanceCapacity;
+	resources.frameConstants = p_ownFrameConstants;
+	resources.objectConstants = p_ownObjectConstants;
+	resources.pixelConstants = p_ownPixelConstants;
+	resources.constantRing = p_ownConstantRing;
+	resources.constantRingSize = ConstantRingSize;
+	resources.skyDepthState = reinterpret_cast<ID3D11DepthStencilState*>(&g_lessEqualState);
+
+	return resources;
+}
+
+ID3D11PixelShader* SoftwareRenderDevice::PixelShader(PixelKernel kernel) const noexcept
+{
+	return PixelShaderHandle(kernel);
+}
+
+ID3D11ShaderResourceView* SoftwareRenderDevice::CreateTexture(SoftwareTexture texture)
+{
+	m_ownTextures.push_back(std::make_unique<SoftwareTexture>(std::move(texture)));
+
+	// the texture's address is only a name for it; nothing dereferences it as a view
+	return reinterpret_cast<ID3D11ShaderResourceView*>(m_ownTextures.back().get());
+}
+
+void SoftwareRenderDevice::Flush()
+{
+	if (m_triangles.empty() && !m_clearColor && !m_clearDepth)
+		return;
+
+	const size_t tiles = m_bins.size();
+	std::atomic<size_t> next = 0;
+	std::mutex statsMutex;
+
+	// The ranges are ignored: tiles are handed out one at a time instead, since what a tile costs depends
+	// on what covers it.
+	ParallelFor(tiles, 1, [&](size_t, size_t)
+		{
+			SoftwareStats stats;
+
+			for (size_t tile; (tile = next++) < tiles;)
+				RasterizeTile(tile, stats);
+
+			std::lock_guard lock(statsMutex);
+			m_stats.binEntries += stats.binEntries;
+			m_stats.pixelsShaded += stats.pixelsShaded;
+		});
+
+	for (auto& bin : m_bins)
+		bin.clear();
+
+	m_triangles.clear();
+	m_draws.clear();
+	m_clearColor = m_clearDepth = false;
+}
+
+std::span<const uint32_t> SoftwareRenderDevice::Pixels()
+{
+	Flush();
+
+	return m_color;
+}
+
+bool SoftwareRenderDevice::WriteBitmap(const std::wstring& path)
+{
+	Flush();
+
+	const uint32_t rowBytes = m_width * sizeof(uint32_t);
+	// BITMAPFILEHEADER and BITMAPINFOHEADER
+	constexpr uint32_t headerBytes = 14 + 40;
+
+	std::ofstream file(std::filesystem::path(path), std::ios::binary);
+
+	if (!file)
+		return false;
+
+	// little endian, as the format and the render target both are
+	const auto put = [&file](uint32_t value, int bytes)
+	{
+		for (int i = 0; i < bytes; i++)
+			file.put(char(value >> (8 * i)));
+	};
+
+	put(0x4D42, 2);
+	put(headerBytes + rowBytes * m_height, 4);
+	put(0, 4);
+	put(headerBytes, 4);
+
+	put(40, 4);
+	put(m_width, 4);
+	// negative for rows from the top down, as the render target holds them
+	put(uint32_t(-int32_t(m_height)), 4);
+	// planes, bits per pixel, BI_RGB
+	put(1, 2);
+	put(32, 2);
+	put(0, 4);
+	put(rowBytes * m_height, 4);
+	put(0, 4);
+	put(0, 4);
+	put(0, 4);
+	put(0, 4);
+
+	for (UINT y = 0; y < m_height; y++)
+		file.write(reinterpret_cast<const char*>(m_color.data() + size_t(y) * m_pitch), rowBytes);
+
+	return bool(file);
+}
+
+void SoftwareRenderDevice::SetupTriangle(const ShadedVertex& v0, const ShadedVertex& v1, const ShadedVertex& v2, UINT draw, std::vector<RasterTriangle>& triangles, SoftwareStats& stats) const
+{
+	bool inside = true;
+
+	for (int plane = 0; plane < ClipPlanes; plane++)
+	{
+		const float d0 = ClipDistance(v0.position, plane), d1 = ClipDistance(v1.position, plane), d2 = ClipDistance(v2.position, plane);
+
+		if (d0 < 0.f && d1 < 0.f && d2 < 0.f)
+		{
+			stats.trianglesCulled++;
+			return;
+		}
+
+		inside = inside && d0 >= 0.f && d1 >= 0.f && d2 >= 0.f;
+	}
+
+	if (inside)
+	{
+		EmitTriangle(v0, v1, v2, draw, triangles, stats);
+		return;
+	}
+
+	stats.trianglesClipped++;
+
+	// Sutherland-Hodgman against each plane in turn; every plane adds at most one vertex
+	ShadedVertex buffers[2][3 + ClipPlanes] = { { v0, v1, v2 } };
+	size_t count = 3;
+	int current = 0;
+
+	for (int plane = 0; plane < ClipPlanes && count > 0; plane++)
+	{
+		const auto* in = buffers[current];
+		auto* out = buffers[1 - current];
+		size_t outCount = 0;
+
+		for (size_t i = 0; i < count; i++)
+		{
+			const auto& a = in[i];
+			const auto& b = in[(i + 1) % count];
+			const float da = ClipDistance(a.position, plane), db = ClipDistance(b.position, plane);
+
+			if (da >= 0.f)
+				out[outCount++] = a;
+
+			if ((da >= 0.f) != (db >= 0.f))
+				out[outCount++] = Lerp(a, b, da / (da - db));
+		}
+
+		count = outCount;
+		current = 1 - current;
+	}
+
+	if (count < 3)
+	{
+		stats.trianglesCulled++;
+		return;
+	}
+
+	for (size_t i = 1; i + 1 < count; i++)
+		EmitTriangle(buffers[current][0], buffers[current][i], buffers[current][i + 1], draw, triangles, stats);
+}
+
+void SoftwareRenderDevice::EmitTriangle(const ShadedVertex& v0, const ShadedVertex& v1, const ShadedVertex& v2, UINT draw, std::vector<RasterTriangle>& triangles, SoftwareStats& stats) const
+{
+	struct ScreenVertex
+	{
+		float x, y, z, q;
+	};
+
+	const auto toScreen = [this](const ShadedVertex& v)
+	{
+		const float q = 1.f / v.position.w;
+
+		// snapped to sixteenths of a pixel, like the subpixel grid of a GPU
+		ScreenVertex s;
+		s.x = std::round(((v.position.x * q) * 0.5f + 0.5f) * m_viewport.Width * 16.f) / 16.f + m_viewport.TopLeftX;
+		s.y = std::round((0.5f - (v.position.y * q) * 0.5f) * m_viewport.Height * 16.f) / 16.f + m_viewport.TopLeftY;
+		s.z = m_viewport.MinDepth + v.position.z * q * (m_viewport.MaxDepth - m_viewport.MinDepth);
+		s.q = q;
+
+		return s;
+	};
+
+	const ScreenVertex s[3] = { toScreen(v0), toScreen(v1), toScreen(v2) };
+	const ShadedVertex* v[3] = { &v0, &v1, &v2 };
+
+	// positive for triangles clockwise on screen, the front faces under the default rasterizer state
+	const float area = (s[1].x - s[0].x) * (s[2].y - s[0].y) - (s[2].x - s[0].x) * (s[1].y - s[0].y);
+
+	if (!(area > 0.f))
+	{
+		stats.trianglesCulled++;
+		return;
+	}
+
+	const float left = std::max(0.f, m_viewport.TopLeftX), top = std::max(0.f, m_viewport.TopLeftY);
+	const float right = std::min(float(m_width), m_viewport.TopLeftX + m_viewport.Width);
+	const float bottom = std::min(float(m_height), m_viewport.TopLeftY + m_viewport.Height);
+
+	// pixels whose centers may fall inside
+	RasterTriangle triangle;
+	triangle.minX = int(std::ceil(std::max(left, std::min({ s[0].x, s[1].x, s[2].x })) - 0.5f));
+	triangle.minY = int(std::ceil(std::max(top, std::min({ s[0].y, s[1].y, s[2].y })) - 0.5f));
+	triangle.maxX = int(std::floor(std::min(right, std::max({ s[0].x, s[1].x, s[2].x })) - 0.5f));
+	triangle.maxY = int(std::floor(std::min(bottom, std::max({ s[0].y, s[1].y, s[2].y })) - 0.5f));
+	triangle.minX = std::max(triangle.minX, 0);
+	triangle.minY = std::max(triangle.minY, 0);
+	triangle.maxX = std::min(triangle.maxX, int(m_width) - 1);
+	triangle.maxY = std::min(triangle.maxY, int(m_height) - 1);
+
+	if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY)
+	{
+		stats.trianglesCulled++;
+		return;
+	}
+
+	triangle.draw = draw;
+
+	// edge i faces vertex i and equals the triangle's area there
+	Plane barycentric[3];
+	const float inverseArea = 1.f / area;
+
+	for (int i = 0; i < 3; i++)
+	{
+		const auto& a = s[(i + 1) % 3];
+		const auto& b = s[(i + 2) % 3];
+		const float dx = b.x - a.x, dy = b.y - a.y;
+
+		triangle.edges[i] = { -dy, dx, dy * a.x - dx * a.y };
+		// a left edge goes up the screen, a top edge is level and goes right
+		triangle.topLeft[i] = dy < 0.f || (dy == 0.f && dx > 0.f);
+
+		barycentric[i] = { triangle.edges[i].a * inverseArea, triangle.edges[i].b * inverseArea, triangle.edges[i].c * inverseArea };
+	}
+
+	const auto interpolate = [&barycentric](float f0, float f1, float f2)
+	{
+		return Plane{
+			f0 * barycentric[0].a + f1 * barycentric[1].a + f2 * barycentric[2].a,
+			f0 * barycentric[0].b + f1 * barycentric[1].b + f2 * barycentric[2].b,
+			f0 * barycentric[0].c + f1 * barycentric[1].c + f2 * barycentric[2].c
+		};
+	};
+
+	triangle.depth = interpolate(s[0].z, s[1].z, s[2].z);
+	triangle.inverseW = interpolate(s[0].q, s[1].q, s[2].q);
+
+	for (size_t k = 0; k < ShadedVertex::VaryingCount; k++)
+		triangle.varyings[k] = interpolate(v[0]->Varyings()[k] * s[0].q, v[1]->Varyings()[k] * s[1].q, v[2]->Varyings()[k] * s[2].q);
+
+	triangles.push_back(triangle);
+}
+
+void SoftwareRenderDevice::RasterizeTile(size_t tile, SoftwareStats& stats)
+{
+	const int tileX = int(tile % m_tilesX) * int(TileSize), tileY = int(tile / m_tilesX) * int(TileSize);
+	const int tileRight = std::min(tileX + int(TileSize), int(m_width)) - 1;
+	const int tileBottom = std::min(tileY + int(TileSize), int(m_height)) - 1;
+
+	for (int y = tileY; y <= tileBottom; y++)
+	{
+		const size_t row = size_t(y) * m_pitch;
+
+		if (m_clearColor)
+			std::fill(m_color.begin() + row + tileX, m_color.begin() + row + tileRight + 1, m_clearValue);
+		if (m_clearDepth)
+			std::fill(m_depth.begin() + row + tileX, m_depth.begin() + row + tileRight + 1, 1.f);
+	}
+
+	// where in a group of four each pixel center is
+	const auto laneOffsets = DirectX::XMVectorSet(0.5f, 1.5f, 2.5f, 3.5f);
+	// texCoord's place among the varyings
+	constexpr size_t u = 9, v = 10;
+
+	for (const UINT index : m_bins[tile])
+	{
+		const auto& triangle = m_triangles[index];
+		const auto& draw = m_draws[triangle.draw];
+		stats.binEntries++;
+
+		// TileSize is a multiple of four, so groups never straddle two tiles
+		const int minX = std::max(triangle.minX, tileX) & ~3, maxX = std::min(triangle.maxX, tileRight);
+		const int minY = std::max(triangle.minY, tileY), maxY = std::min(triangle.maxY, tileBottom);
+
+		const DirectX::XMVECTOR edgeA[3] = {
+			DirectX::XMVectorReplicate(triangle.edges[0].a),
+			DirectX::XMVectorReplicate(triangle.edges[1].a),
+			DirectX::XMVectorReplicate(triangle.edges[2].a)
+		};
+		const auto depthA = DirectX::XMVectorReplicate(triangle.depth.a);
+
+		const bool shade = draw.kernel != PixelKernel::Count;
+		const auto function = shade ? g_pixelFunctions[size_t(draw.kernel)] : nullptr;
+		const size_t varyings = shade ? g_varyingsRead[size_t(draw.kernel)] : 0;
+		const bool sampleDiffuse = draw.kernel == PixelKernel::PSTexture && draw.diffuse;
+
+		for (int y = minY; y <= maxY; y++)
+		{
+			const float py = float(y) + 0.5f;
+			const DirectX::XMVECTOR edgeRow[3] = {
+				DirectX::XMVectorReplicate(triangle.edges[0].b * py + triangle.edges[0].c),
+				DirectX::XMVectorReplicate(triangle.edges[1].b * py + triangle.edges[1].c),
+				DirectX::XMVectorReplicate(triangle.edges[2].b * py + triangle.edges[2].c)
+			};
+			const auto depthRow = DirectX::XMVectorReplicate(triangle.depth.b * py + triangle.depth.c);
+
+			for (int x = minX; x <= maxX; x += 4)
+			{
+				const auto xs = DirectX::XMVectorAdd(DirectX::XMVectorReplicate(float(x)), laneOffsets);
+
+				auto mask = Inside(DirectX::XMVectorMultiplyAdd(edgeA[0], xs, edgeRow[0]), triangle.topLeft[0]);
+				mask = DirectX::XMVectorAndInt(mask, Inside(DirectX::XMVectorMultiplyAdd(edgeA[1], xs, edgeRow[1]), triangle.topLeft[1]));
+				mask = DirectX::XMVectorAndInt(mask, Inside(DirectX::XMVectorMultiplyAdd(edgeA[2], xs, edgeRow[2]), triangle.topLeft[2]));
+
+				DirectX::XMUINT4 lanes;
+				DirectX::XMStoreUInt4(&lanes, mask);
+
+				if (!(lanes.x | lanes.y | lanes.z | lanes.w))
+					continue;
+
+				float* depth = m_depth.data() + size_t(y) * m_pitch + x;
+				// clamped as a UNORM depth buffer would; the skybox sits at exactly 1 and rounding can push it past
+				const auto z = DirectX::XMVectorSaturate(DirectX::XMVectorMultiplyAdd(depthA, xs, depthRow));
+				const auto stored = DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(depth));
+
+				mask = DirectX::XMVectorAndInt(mask, draw.lessEqual ? DirectX::XMVectorLessOrEqual(z, stored) : DirectX::XMVectorLess(z, stored));
+				DirectX::XMStoreUInt4(&lanes, mask);
+
+				DirectX::XMFLOAT4 zs;
+				DirectX::XMStoreFloat4(&zs, z);
+
+				const uint32_t laneMask[4] = { lanes.x, lanes.y, lanes.z, lanes.w };
+				const float laneDepth[4] = { zs.x, zs.y, zs.z, zs.w };
+
+				for (int lane = 0; lane < 4 && x + lane < int(m_width); lane++)
+				{
+					if (!laneMask[lane])
+						continue;
+
+					depth[lane] = laneDepth[lane];
+
+					if (!shade)
+						continue;
+
+					const float px = float(x + lane) + 0.5f;
+					const float q = triangle.inverseW.At(px, py);
+					const float w = 1.f / q;
+
+					ShadedVertex input;
+					input.position = { px, py, laneDepth[lane], w };
+
+					for (size_t k = 0; k < varyings; k++)
+						input.Varyings()[k] = triangle.varyings[k].At(px, py) * w;
+
+					PixelContext context{ &draw.constants, draw.diffuse, draw.skymap, 0.f };
+
+					if (sampleDiffuse)
+					{
+						// d(n / q) = (dn - (n / q) dq) / q, the screen space gradient of a perspective-correct varying
+						const float dudx = (triangle.varyings[u].a - input.texCoord.x * triangle.inverseW.a) * w * draw.diffuse->Width();
+						const float dvdx = (triangle.varyings[v].a - input.texCoord.y * triangle.inverseW.a) * w * draw.diffuse->Height();
+						const float dudy = (triangle.varyings[u].b - input.texCoord.x * triangle.inverseW.b) * w * draw.diffuse->Width();
+						const float dvdy = (triangle.varyings[v].b - input.texCoord.y * triangle.inverseW.b) * w * draw.diffuse->Height();
+
+						context.diffuseLod = 0.5f * std::log2(std::max(dudx * dudx + dvdx * dvdx, dudy * dudy + dvdy * dvdy));
+					}
+
+					m_color[size_t(y) * m_pitch + x + lane] = Pack(function(input, context));
+					stats.pixelsShaded++;
+				}
+			}
+		}
+	}
+}
+
+std::vector<std::byte>* SoftwareRenderDevice::FindBuffer(GpuBuffer* buffer)
+{
+	if (!buffer)
+		return nullptr;
+
+	std::lock_guard lock(m_bufferMutex);
+	const auto found = m_buffers.find(buffer);
+
+	return found != m_buffers.end() ? found->second.get() : nullptr;
+}
+
+GpuBuffer* SoftwareRenderDevice::CreateBuffer(UINT byteWidth)
+{
+	auto bytes = std::make_unique<std::vector<std::byte>>(byteWidth);
+	// the vector's address is only a name for the buffer; nothing dereferences it as one
+	auto* handle = reinterpret_cast<GpuBuffer*>(bytes.get());
+
+	std::lock_guard lock(m_bufferMutex);
+	m_buffers.emplace(handle, std::move(bytes));
+
+	return handle;
+}
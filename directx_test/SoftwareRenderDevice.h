@@ -0,0 +1,220 @@
+#pragma once
+#include "WinTypes.h"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "RenderDevice.h"
+#include "BufferFactory.h"
+#include "SceneRenderer.h"
+#include "SoftwareShaders.h"
+#include "SoftwareTexture.h"
+
+// The Light.fx pixel shaders SoftwareRenderDevice runs, by entry point
+enum class PixelKernel
+{
+	PS,
+	PSSolid,
+	PSTexture,
+	PSCustom,
+	SkymapPShader,
+	Count
+};
+
+struct SoftwareStats
+{
+	size_t drawCalls = 0;
+	// draws reading buffers the device did not create or with shaders it does not know
+	size_t skippedDraws = 0;
+	size_t verticesShaded = 0;
+	size_t trianglesSubmitted = 0;
+	// backfacing, degenerate or entirely outside the view; pieces of clipped triangles count on their own
+	size_t trianglesCulled = 0;
+	// triangles that crossed a clip plane and were cut to the view
+	size_t trianglesClipped = 0;
+	size_t trianglesBinned = 0;
+	// triangle and tile pairs the rasterizer walked
+	size_t binEntries = 0;
+	size_t pixelsShaded = 0;
+};
+
+// A RenderDevice that rasterizes on the CPU, so a frame can be looked at, compared or timed on a machine
+// without a GPU. It is also the BufferFactory meshes upload into, the way Graphics is for D3D11.
+//
+// DrawIndexed shades vertices and sets up triangles straight away, snapshotting the pixel shader state,
+// then bins them into TileSize square tiles. Flush rasterizes the tiles in parallel, each on one thread
+// only, walking edge functions four pixels at a time with a depth test and perspective-correct varyings.
+//
+// Limits, all met by SceneRenderer: triangle lists, the two depth states Graphics creates, back-face
+// culling of clockwise-front triangles, and constants at VS b0 and b1 and PS b0 only. Instanced draws
+// run the pipeline once per instance. Buffers of every kind, static ones included, are byte vectors the
+// device owns. Text is not drawn.
+class SoftwareRenderDevice : public RenderDevice, public BufferFactory
+{
+public:
+
+	static constexpr UINT TileSize = 64;
+	// world matrices the instance buffer in Resources holds
+	static constexpr UINT InstanceCapacity = 4096;
+	// bytes of the constant ring in Resources
+	static constexpr UINT ConstantRingSize = 1 << 20;
+
+	SoftwareRenderDevice(UINT width, UINT height);
+	SoftwareRenderDevice(const SoftwareRenderDevice&) = delete;
+	SoftwareRenderDevice& operator=(const SoftwareRenderDevice&) = delete;
+
+	void ClearRenderTarget(const float color[4]) override;
+	void ClearDepthStencil() override;
+	void SetViewport(const D3D11_VIEWPORT& viewport) override;
+	void SetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY topology) override;
+
+	void SetInputLayout(ID3D11InputLayout* layout) override;
+	void SetVertexBuffers(UINT count, GpuBuffer* const* buffers, const UINT* strides) override;
+	void SetIndexBuffer(GpuBuffer* buffer, DXGI_FORMAT format) override;
+
+	void SetVertexShader(ID3D11VertexShader* shader) override;
+	void SetPixelShader(ID3D11PixelShader* shader) override;
+	void SetVertexConstantBuffer(UINT slot, GpuBuffer* buffer) override;
+	void SetVertexConstantBufferRange(UINT slot, GpuBuffer* buffer, UINT offset, UINT byteCount) override;
+	void SetPixelConstantBuffer(UINT slot, GpuBuffer* buffer) override;
+	void SetPixelShaderResource(UINT slot, ID3D11ShaderResourceView* view) override;
+	void SetPixelSampler(UINT slot, ID3D11SamplerState* sampler) override;
+	void SetDepthStencilState(ID3D11DepthStencilState* state) override;
+
+	void UpdateBuffer(GpuBuffer* buffer, const void* data, UINT byteCount) override;
+	void WriteBuffer(GpuBuffer* buffer, UINT offset, const void* data, UINT byteCount, BufferMap mode) override;
+	void DrawIndexed(UINT indexCount, UINT startIndex, INT baseVertex) override;
+	void DrawIndexedInstanced(UINT indexCount, UINT instanceCount, UINT startIndex, INT baseVertex, UINT startInstance) override;
+	void DrawString(std::wstring_view text, DirectX::XMFLOAT2 position) override;
+
+	[[nodiscard]] GpuBuffer* CreateStaticBuffer(const void* data, UINT byteWidth, UINT bindFlags) override;
+	[[nodiscard]] GpuBuffer* CreatePooledBuffer(UINT byteWidth, UINT bindFlags) override;
+	[[nodiscard]] GpuBuffer* CreateUploadBuffer(UINT byteWidth) override;
+	void ReleaseBuffer(GpuBuffer* buffer) override;
+	[[nodiscard]] void* Map(GpuBuffer* buffer, BufferMap mode) override;
+	void Unmap(GpuBuffer* buffer) override;
+	void CopyBufferRegion(GpuBuffer* destination, UINT destinationOffset, GpuBuffer* source, UINT sourceOffset, UINT byteCount) override;
+
+	// The constant buffers and the shader and state handles SceneRenderer draws with. The texture slots
+	// are left for the caller to fill from CreateTexture.
+	RenderResources Resources() const noexcept;
+	ID3D11PixelShader* PixelShader(PixelKernel kernel) const noexcept;
+	// Takes the texture over; the handle stays valid as long as the device.
+	ID3D11ShaderResourceView* CreateTexture(SoftwareTexture texture);
+
+	// Rasterizes everything drawn since the last flush.
+	void Flush();
+	// Flushes and returns the B8G8R8A8 render target, RowPitch() texels per row.
+	std::span<const uint32_t> Pixels();
+	// Flushes and saves the render target as a 32 bit bitmap.
+	bool WriteBitmap(const std::wstring& path);
+
+	constexpr UINT Width() const noexcept { return m_width; }
+	constexpr UINT Height() const noexcept { return m_height; }
+	constexpr UINT RowPitch() const noexcept { return m_pitch; }
+
+	constexpr const SoftwareStats& Stats() const noexcept { return m_stats; }
+	void ResetStats() noexcept { m_stats = {}; }
+
+private:
+
+	// a x + b y + c over pixel coordinates
+	struct Plane
+	{
+		float a = 0.f;
+		float b = 0.f;
+		float c = 0.f;
+
+		float At(float x, float y) const noexcept { return a * x + b * y + c; }
+	};
+
+	// Pixel shader state as it was when the triangles were drawn
+	struct DrawState
+	{
+		// Count when no pixel shader is bound and only depth is written
+		PixelKernel kernel;
+		bool lessEqual;
+		PixelConstantBuffer constants;
+		const SoftwareTexture* diffuse;
+		const SoftwareTexture* skymap;
+	};
+
+	struct RasterTriangle
+	{
+		// inside where all three are positive, or zero on a top or left edge
+		Plane edges[3];
+		bool topLeft[3];
+		Plane depth;
+		Plane inverseW;
+		// each varying divided by w, recovered per pixel by dividing by inverseW
+		Plane varyings[ShadedVertex::VaryingCount];
+		// pixel bounds, inclusive
+		int minX, minY, maxX, maxY;
+		UINT draw;
+	};
+
+	// Shades, sets up and bins a draw; instanceWorld is set for each instance of an instanced draw.
+	void Draw(UINT indexCount, UINT startIndex, INT baseVertex, const DirectX::XMFLOAT4X4* instanceWorld);
+	// Appends the screen space triangles a clip space triangle leaves after clipping and culling.
+	void SetupTriangle(const ShadedVertex& v0, const ShadedVertex& v1, const ShadedVertex& v2, UINT draw, std::vector<RasterTriangle>& triangles, SoftwareStats& stats) const;
+	void EmitTriangle(const ShadedVertex& v0, const ShadedVertex& v1, const ShadedVertex& v2, UINT draw, std::vector<RasterTriangle>& triangles, SoftwareStats& stats) const;
+	void RasterizeTile(size_t tile, SoftwareStats& stats);
+
+	std::vector<std::byte>* FindBuffer(GpuBuffer* buffer);
+	GpuBuffer* CreateBuffer(UINT byteWidth);
+
+	UINT m_width;
+	UINT m_height;
+	// width rounded up to the four pixels the rasterizer steps by
+	UINT m_pitch;
+	UINT m_tilesX;
+	UINT m_tilesY;
+
+	std::vector<uint32_t> m_color;
+	std::vector<float> m_depth;
+	// clears waiting to be done tile by tile in the next Flush
+	bool m_clearColor = false;
+	bool m_clearDepth = false;
+	uint32_t m_clearValue = 0;
+
+	// bound state
+	D3D11_VIEWPORT m_viewport;
+	bool m_triangleList = true;
+	// positions, attributes when split, instances
+	std::array<GpuBuffer*, 3> m_vertexBuffers = {};
+	std::array<UINT, 3> m_strides = {};
+	UINT m_streams = 0;
+	GpuBuffer* p_indexBuffer = nullptr;
+	DXGI_FORMAT m_indexFormat = DXGI_FORMAT_R32_UINT;
+	ID3D11VertexShader* p_vertexShader = nullptr;
+	ID3D11PixelShader* p_pixelShader = nullptr;
+	// VS slots 0 and 1, and where in the buffer each is bound from
+	std::array<GpuBuffer*, 2> m_vertexConstants = {};
+	std::array<UINT, 2> m_vertexConstantOffsets = {};
+	GpuBuffer* p_pixelConstants = nullptr;
+	std::array<const SoftwareTexture*, 2> m_textures = {};
+	bool m_lessEqual = false;
+
+	// work since the last Flush
+	std::vector<DrawState> m_draws;
+	std::vector<RasterTriangle> m_triangles;
+	// triangle indices per tile, in draw order
+	std::vector<std::vector<UINT>> m_bins;
+	// reused by every draw
+	std::vector<ShadedVertex> m_shaded;
+
+	std::mutex m_bufferMutex;
+	std::unordered_map<GpuBuffer*, std::unique_ptr<std::vector<std::byte>>> m_buffers;
+	GpuBuffer* p_ownFrameConstants;
+	GpuBuffer* p_ownObjectConstants;
+	GpuBuffer* p_ownPixelConstants;
+	GpuBuffer* p_ownConstantRing;
+	GpuBuffer* p_ownInstances;
+	std::vector<std::unique_ptr<SoftwareTexture>> m_ownTextures;
+
+	SoftwareStats m_stats;
+};
@@ -0,0 +1,89 @@
+#include "SoftwareShaders.h"
+#include <algorithm>
+#include <cmath>
+
+VertexTransforms::VertexTransforms(const FrameConstantBuffer& frame, const ObjectConstantBuffer& object) noexcept
+{
+	// SceneRenderer stores the matrices transposed for HLSL
+	world = DirectX::XMMatrixTranspose(object.world);
+	worldViewProjection = world * DirectX::XMMatrixTranspose(frame.view) * DirectX::XMMatrixTranspose(frame.projection);
+}
+
+VertexTransforms::VertexTransforms(const FrameConstantBuffer& frame, const DirectX::XMFLOAT4X4& instanceWorld) noexcept
+{
+	// instance matrices are not transposed
+	world = DirectX::XMLoadFloat4x4(&instanceWorld);
+	worldViewProjection = world * DirectX::XMMatrixTranspose(frame.view) * DirectX::XMMatrixTranspose(frame.projection);
+}
+
+ShadedVertex SoftwareShaders::VS(DirectX::XMFLOAT3 position, const VertexAttributes& attributes, const VertexTransforms& transforms) noexcept
+{
+	ShadedVertex output;
+	output.localPosition = position;
+
+	const auto pos = DirectX::XMVectorSet(position.x, position.y, position.z, 1.f);
+	DirectX::XMStoreFloat4(&output.position, DirectX::XMVector4Transform(pos, transforms.worldViewProjection));
+
+	const auto normal = DirectX::XMVectorSet(attributes.normal.x, attributes.normal.y, attributes.normal.z, 0.f);
+	DirectX::XMStoreFloat3(&output.normal, DirectX::XMVector3Normalize(DirectX::XMVector4Transform(normal, transforms.world)));
+
+	output.color = attributes.color;
+	output.texCoord = attributes.texCoord;
+
+	return output;
+}
+
+ShadedVertex SoftwareShaders::SkymapVS(DirectX::XMFLOAT3 position, const VertexTransforms& transforms) noexcept
+{
+	ShadedVertex output{};
+
+	DirectX::XMFLOAT4 pos;
+	DirectX::XMStoreFloat4(&pos, DirectX::XMVector4Transform(DirectX::XMVectorSet(position.x, position.y, position.z, 1.f), transforms.worldViewProjection));
+
+	// xyww, so that z will always be 1 (furthest from camera)
+	output.position = { pos.x, pos.y, pos.w, pos.w };
+	output.localPosition = position;
+
+	return output;
+}
+
+DirectX::XMVECTOR SoftwareShaders::PS(const ShadedVertex& input, const PixelContext& context) noexcept
+{
+	const auto& constants = *context.constants;
+
+	// Find angle between light and normal
+	const auto lightDir = DirectX::XMVector3Normalize(DirectX::XMLoadFloat4(&constants.lightDirection));
+	const float cosine = std::max(-DirectX::XMVectorGetX(DirectX::XMVector3Dot(DirectX::XMLoadFloat3(&input.normal), lightDir)), 0.f);
+
+	const auto light = DirectX::XMVectorMultiplyAdd(DirectX::XMVectorReplicate(cosine), DirectX::XMLoadFloat4(&constants.directionalLight), DirectX::XMLoadFloat4(&constants.ambientlLight));
+
+	return DirectX::XMVectorSetW(DirectX::XMVectorMultiply(light, DirectX::XMLoadFloat3(&input.color)), 1.f);
+}
+
+DirectX::XMVECTOR SoftwareShaders::PSSolid(const ShadedVertex& input, const PixelContext& context) noexcept
+{
+	return DirectX::XMVectorSetW(DirectX::XMLoadFloat3(&input.color), 1.f);
+}
+
+DirectX::XMVECTOR SoftwareShaders::PSTexture(const ShadedVertex& input, const PixelContext& context) noexcept
+{
+	if (!context.diffuse)
+		return DirectX::XMVectorZero();
+
+	return DirectX::XMVectorMultiply(context.diffuse->Sample(input.texCoord.x, input.texCoord.y, context.diffuseLod), PS(input, context));
+}
+
+DirectX::XMVECTOR SoftwareShaders::PSCustom(const ShadedVertex& input, const PixelContext& context) noexcept
+{
+	const float stripe = std::sin(input.localPosition.y * 50);
+
+	return DirectX::XMVectorMultiply(DirectX::XMVectorSet(stripe, stripe, stripe, 1.f), PS(input, context));
+}
+
+DirectX::XMVECTOR SoftwareShaders::SkymapPShader(const ShadedVertex& input, const PixelContext& context) noexcept
+{
+	if (!context.skymap)
+		return DirectX::XMVectorZero();
+
+	return context.skymap->SampleCube(DirectX::XMLoadFloat3(&input.localPosition));
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include "WinTypes.h"
+#include <DirectXMath.h>
+#include "SimpleVertex.h"
+#include "SceneRenderer.h"
+#include "SoftwareTexture.h"
+
+// VertexShaderOutput of Light.fx. The skymap shaders keep their cube direction in localPosition.
+struct ShadedVertex
+{
+	DirectX::XMFLOAT4 position;
+	DirectX::XMFLOAT3 localPosition;
+	DirectX::XMFLOAT3 color;
+	DirectX::XMFLOAT3 normal;
+	DirectX::XMFLOAT2 texCoord;
+
+	// everything after position is interpolated across triangles
+	static constexpr size_t VaryingCount = 11;
+
+	float* Varyings() noexcept { return &localPosition.x; }
+	const float* Varyings() const noexcept { return &localPosition.x; }
+};
+
+static_assert(sizeof(ShadedVertex) == sizeof(float) * (4 + ShadedVertex::VaryingCount), "ShadedVertex varyings must be contiguous floats");
+
+// The matrices of the vertex shader constants, untransposed and premultiplied once per draw.
+struct VertexTransforms
+{
+	VertexTransforms(const FrameConstantBuffer& frame, const ObjectConstantBuffer& object) noexcept;
+	// for VSInstanced, which takes the world matrix from the instance instead
+	VertexTransforms(const FrameConstantBuffer& frame, const DirectX::XMFLOAT4X4& instanceWorld) noexcept;
+
+	DirectX::XMMATRIX world;
+	DirectX::XMMATRIX worldViewProjection;
+};
+
+// What the pixel shaders read besides their input: PS slot 0 constants, t0 and t1, and the mip level
+// txDiffuse is sampled at, derived by the rasterizer from the texCoord gradients.
+struct PixelContext
+{
+	const PixelConstantBuffer* constants;
+	const SoftwareTexture* diffuse;
+	const SoftwareTexture* skymap;
+	float diffuseLod;
+};
+
+// The Light.fx entry points SceneRenderer draws with, written out in C++ for SoftwareRenderDevice.
+// Unbound textures sample as zero, as on D3D11.
+class SoftwareShaders
+{
+public:
+
+	static ShadedVertex VS(DirectX::XMFLOAT3 position, const VertexAttributes& attributes, const VertexTransforms& transforms) noexcept;
+	static ShadedVertex SkymapVS(DirectX::XMFLOAT3 position, const VertexTransforms& transforms) noexcept;
+
+	static DirectX::XMVECTOR PS(const ShadedVertex& input, const PixelContext& context) noexcept;
+	static DirectX::XMVECTOR PSSolid(const ShadedVertex& input, const PixelContext& context) noexcept;
+	static DirectX::XMVECTOR PSTexture(const ShadedVertex& input, const PixelContext& context) noexcept;
+	static DirectX::XMVECTOR PSCustom(const ShadedVertex& input, const PixelContext& context) noexcept;
+	static DirectX::XMVECTOR SkymapPShader(const ShadedVertex& input, const PixelContext& context) noexcept;
+};
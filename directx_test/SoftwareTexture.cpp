@@ -0,0 +1,232 @@
+#include "SoftwareTexture.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include "MappedFile.h"
+
+namespace
+{
+	// The part of DDS_HEADER the loader reads, as DWORD indices past the magic number
+	enum DdsField
+	{
+		DdsFlags = 1,
+		DdsHeight = 2,
+		DdsWidth = 3,
+		DdsMipCount = 6,
+		DdsPixelFlags = 19,
+		DdsBitCount = 21,
+		DdsRedMask = 22,
+		DdsGreenMask = 23,
+		DdsBlueMask = 24,
+		DdsAlphaMask = 25,
+		DdsCaps2 = 27
+	};
+
+	constexpr uint32_t DdsMagic = 0x20534444;
+	constexpr size_t DdsHeaderSize = 124;
+	constexpr uint32_t DdsdMipMapCount = 0x20000;
+	constexpr uint32_t DdpfRgb = 0x40;
+	constexpr uint32_t DdsCaps2CubeMap = 0x200;
+
+	float Channel(uint32_t texel, uint32_t mask) noexcept
+	{
+		if (mask == 0)
+			return 1.f;
+
+		const auto shift = std::countr_zero(mask);
+		return float((texel & mask) >> shift) / float(mask >> shift);
+	}
+
+	UINT Wrap(int i, UINT size) noexcept
+	{
+		const int n = int(size);
+		return UINT(((i % n) + n) % n);
+	}
+
+	UINT Clamp(int i, UINT size) noexcept
+	{
+		return UINT(std::clamp(i, 0, int(size) - 1));
+	}
+}
+
+SoftwareTexture::SoftwareTexture(UINT width, UINT height, UINT faces, std::vector<DirectX::XMFLOAT4> texels)
+	: m_width(width), m_height(height), m_faces(faces), m_texels(std::move(texels))
+{
+	if (width == 0 || height == 0 || (faces != 1 && faces != 6) || m_texels.size() != size_t(width) * height * faces)
+		throw std::runtime_error("bad software texture size");
+
+	m_levels.push_back({ width, height, 0 });
+
+	while (m_levels.back().width > 1 || m_levels.back().height > 1)
+	{
+		const Level source = m_levels.back();
+		const Level level{ std::max(1u, source.width / 2), std::max(1u, source.height / 2), m_texels.size() };
+		m_texels.resize(m_texels.size() + size_t(level.width) * level.height * faces);
+
+		for (UINT face = 0; face < faces; face++)
+		{
+			const auto* from = m_texels.data() + source.offset + size_t(face) * source.width * source.height;
+			auto* to = m_texels.data() + level.offset + size_t(face) * level.width * level.height;
+
+			// box filter; an odd last row or column is folded into its neighbour's average
+			for (UINT y = 0; y < level.height; y++)
+			{
+				const UINT y0 = std::min(2 * y, source.height - 1), y1 = std::min(2 * y + 1, source.height - 1);
+
+				for (UINT x = 0; x < level.width; x++)
+				{
+					const UINT x0 = std::min(2 * x, source.width - 1), x1 = std::min(2 * x + 1, source.width - 1);
+
+					auto sum = DirectX::XMVectorAdd(DirectX::XMLoadFloat4(&from[y0 * source.width + x0]), DirectX::XMLoadFloat4(&from[y0 * source.width + x1]));
+					sum = DirectX::XMVectorAdd(sum, DirectX::XMLoadFloat4(&from[y1 * source.width + x0]));
+					sum = DirectX::XMVectorAdd(sum, DirectX::XMLoadFloat4(&from[y1 * source.width + x1]));
+
+					DirectX::XMStoreFloat4(&to[y * level.width + x], DirectX::XMVectorScale(sum, 0.25f));
+				}
+			}
+		}
+
+		m_levels.push_back(level);
+	}
+}
+
+SoftwareTexture SoftwareTexture::LoadDds(const std::wstring& path)
+{
+	MappedFile file;
+
+	if (!file.Open(path) || file.Size() < 4 + DdsHeaderSize)
+		throw std::runtime_error("can't open texture");
+
+	uint32_t header[1 + DdsHeaderSize / 4];
+	std::memcpy(header, file.Data(), sizeof(header));
+	const uint32_t* dds = header + 1;
+
+	if (header[0] != DdsMagic)
+		throw std::runtime_error("not a DDS file");
+
+	const uint32_t bitCount = dds[DdsBitCount];
+
+	if (!(dds[DdsPixelFlags] & DdpfRgb) || (bitCount != 24 && bitCount != 32))
+		throw std::runtime_error("only uncompressed 24 and 32 bit DDS textures are supported");
+
+	const UINT width = dds[DdsWidth], height = dds[DdsHeight];
+	const UINT faces = (dds[DdsCaps2] & DdsCaps2CubeMap) ? 6 : 1;
+	const UINT fileLevels = (dds[DdsFlags] & DdsdMipMapCount) ? std::max(1u, dds[DdsMipCount]) : 1;
+	const size_t texelBytes = bitCount / 8;
+
+	// each face is stored with its whole mip chain
+	size_t faceBytes = 0;
+	for (UINT level = 0, w = width, h = height; level < fileLevels; level++, w = std::max(1u, w / 2), h = std::max(1u, h / 2))
+		faceBytes += size_t(w) * h * texelBytes;
+
+	if (width == 0 || height == 0 || file.Size() < 4 + DdsHeaderSize + faceBytes * faces)
+		throw std::runtime_error("truncated DDS file");
+
+	std::vector<DirectX::XMFLOAT4> texels(size_t(width) * height * faces);
+
+	for (UINT face = 0; face < faces; face++)
+	{
+		const uint8_t* bytes = file.Data() + 4 + DdsHeaderSize + face * faceBytes;
+
+		for (size_t i = 0; i < size_t(width) * height; i++)
+		{
+			uint32_t texel = 0;
+			std::memcpy(&texel, bytes + i * texelBytes, texelBytes);
+
+			texels[face * size_t(width) * height + i] = {
+				Channel(texel, dds[DdsRedMask]),
+				Channel(texel, dds[DdsGreenMask]),
+				Channel(texel, dds[DdsBlueMask]),
+				Channel(texel, dds[DdsAlphaMask])
+			};
+		}
+	}
+
+	return SoftwareTexture(width, height, faces, std::move(texels));
+}
+
+DirectX::XMVECTOR SoftwareTexture::Sample(float u, float v, float lod) const noexcept
+{
+	const float level = std::clamp(lod, 0.f, float(m_levels.size() - 1));
+	const auto fine = size_t(level);
+	const float blend = level - float(fine);
+
+	const auto sample = Bilinear(m_levels[fine], 0, u, v, true);
+
+	if (blend == 0.f)
+		return sample;
+
+	return DirectX::XMVectorLerp(sample, Bilinear(m_levels[fine + 1], 0, u, v, true), blend);
+}
+
+DirectX::XMVECTOR SoftwareTexture::SampleCube(DirectX::FXMVECTOR direction) const noexcept
+{
+	DirectX::XMFLOAT3 d;
+	DirectX::XMStoreFloat3(&d, direction);
+
+	const float ax = std::abs(d.x), ay = std::abs(d.y), az = std::abs(d.z);
+	UINT face;
+	float major, s, t;
+
+	// face order and orientation of D3D11 cube maps: +X, -X, +Y, -Y, +Z, -Z
+	if (ax >= ay && ax >= az)
+	{
+		face = d.x >= 0.f ? 0 : 1;
+		major = ax;
+		s = d.x >= 0.f ? -d.z : d.z;
+		t = -d.y;
+	}
+	else if (ay >= az)
+	{
+		face = d.y >= 0.f ? 2 : 3;
+		major = ay;
+		s = d.x;
+		t = d.y >= 0.f ? d.z : -d.z;
+	}
+	else
+	{
+		face = d.z >= 0.f ? 4 : 5;
+		major = az;
+		s = d.z >= 0.f ? d.x : -d.x;
+		t = -d.y;
+	}
+
+	if (major == 0.f || m_faces != 6)
+		return DirectX::XMVectorZero();
+
+	return Bilinear(m_levels[0], face, 0.5f * (s / major + 1.f), 0.5f * (t / major + 1.f), false);
+}
+
+DirectX::XMVECTOR SoftwareTexture::Bilinear(const Level& level, UINT face, float u, float v, bool wrap) const noexcept
+{
+	const float x = u * level.width - 0.5f, y = v * level.height - 0.5f;
+	const float fx = std::floor(x), fy = std::floor(y);
+	const float tx = x - fx, ty = y - fy;
+
+	UINT x0, x1, y0, y1;
+
+	if (wrap)
+	{
+		x0 = Wrap(int(fx), level.width);
+		x1 = Wrap(int(fx) + 1, level.width);
+		y0 = Wrap(int(fy), level.height);
+		y1 = Wrap(int(fy) + 1, level.height);
+	}
+	else
+	{
+		x0 = Clamp(int(fx), level.width);
+		x1 = Clamp(int(fx) + 1, level.width);
+		y0 = Clamp(int(fy), level.height);
+		y1 = Clamp(int(fy) + 1, level.height);
+	}
+
+	const auto* texels = m_texels.data() + level.offset + size_t(face) * level.width * level.height;
+
+	const auto top = DirectX::XMVectorLerp(DirectX::XMLoadFloat4(&texels[y0 * level.width + x0]), DirectX::XMLoadFloat4(&texels[y0 * level.width + x1]), tx);
+	const auto bottom = DirectX::XMVectorLerp(DirectX::XMLoadFloat4(&texels[y1 * level.width + x0]), DirectX::XMLoadFloat4(&texels[y1 * level.width + x1]), tx);
+
+	return DirectX::XMVectorLerp(top, bottom, ty);
+}
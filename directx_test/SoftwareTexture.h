@@ -0,0 +1,47 @@
+#pragma once
+#include "WinTypes.h"
+#include <string>
+#include <vector>
+#include <DirectXMath.h>
+
+// RGBA texture for SoftwareRenderDevice, either 2D or a cube of six square faces, with a full mip chain
+// generated on construction. Sampling follows the sampler Graphics creates: trilinear, wrapped for 2D.
+class SoftwareTexture
+{
+public:
+
+	// texels holds faces * width * height RGBA values, one face after another
+	SoftwareTexture(UINT width, UINT height, UINT faces, std::vector<DirectX::XMFLOAT4> texels);
+
+	// Loads an uncompressed 24 or 32 bit DDS, such as brick.dds, as a 2D texture or a cube map. Mips in the
+	// file are ignored and regenerated.
+	static SoftwareTexture LoadDds(const std::wstring& path);
+
+	constexpr UINT Width() const noexcept { return m_width; }
+	constexpr UINT Height() const noexcept { return m_height; }
+	constexpr bool IsCube() const noexcept { return m_faces == 6; }
+	UINT MipLevels() const noexcept { return UINT(m_levels.size()); }
+
+	// lod is the base 2 log of texels per pixel, as Texture2D.Sample derives it from the UV gradients
+	DirectX::XMVECTOR Sample(float u, float v, float lod) const noexcept;
+	// Looks up direction in the top level of a cube map; skybox faces are always magnified.
+	DirectX::XMVECTOR SampleCube(DirectX::FXMVECTOR direction) const noexcept;
+
+private:
+
+	struct Level
+	{
+		UINT width;
+		UINT height;
+		// offset of face 0 in m_texels; the other faces follow at width * height apart
+		size_t offset;
+	};
+
+	DirectX::XMVECTOR Bilinear(const Level& level, UINT face, float u, float v, bool wrap) const noexcept;
+
+	UINT m_width;
+	UINT m_height;
+	UINT m_faces;
+	std::vector<Level> m_levels;
+	std::vector<DirectX::XMFLOAT4> m_texels;
+};
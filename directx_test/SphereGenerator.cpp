@@ -0,0 +1,298 @@
+#include "SphereGenerator.h"
+#include "Parallel.h"
+#include "MeshBuilder.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace DirectX;
+
+namespace
+{
+	// rings are cheap individually, so hand each thread a batch of them
+	constexpr size_t ringsPerChunk = 16;
+
+	XMVECTOR LoadPosition(const std::vector<XMFLOAT3>& positions, int slices, int ring, int slice)
+	{
+		return XMLoadFloat3(&positions[ring * slices + (slice + slices) % slices]);
+	}
+}
+
+void SphereGenerator::Generate(int slices, int stacks, FXMVECTOR color, SphereNormals normals,
+	std::vector<SimpleVertex>& vertices, std::vector<UINT>& indices)
+{
+	slices = std::max(slices, 3);
+	stacks = std::max(stacks, 3);
+
+	vertices.resize(VertexCount(slices, stacks, normals));
+	indices.resize(IndexCount(slices, stacks));
+
+	Write(slices, stacks, color, normals, vertices.data(), indices.data());
+}
+
+void SphereGenerator::Generate(int slices, int stacks, FXMVECTOR color, SphereNormals normals, MeshBuilder& builder)
+{
+	slices = std::max(slices, 3);
+	stacks = std::max(stacks, 3);
+
+	const UINT baseVertex = UINT(builder.VertexCount());
+	builder.Reserve(VertexCount(slices, stacks, normals), IndexCount(slices, stacks));
+
+	const auto vertices = builder.WriteVertices(VertexCount(slices, stacks, normals));
+	const auto indices = builder.WriteIndices(IndexCount(slices, stacks));
+
+	Write(slices, stacks, color, normals, vertices.data(), indices.data());
+
+	if (baseVertex != 0)
+	{
+		for (auto& i : indices)
+			i += baseVertex;
+	}
+}
+
+void SphereGenerator::Write(int slices, int stacks, FXMVECTOR color, SphereNormals normals, SimpleVertex* vertices, UINT* indices)
+{
+	std::vector<XMFLOAT3> positions;
+	BuildRingPositions(slices, stacks, positions);
+
+	if (normals == SphereNormals::Smooth)
+		WriteSmooth(slices, stacks, positions, color, vertices, indices);
+	else
+		WriteFaceted(slices, stacks, positions, color, vertices, indices);
+}
+
+void SphereGenerator::BuildRingPositions(int slices, int stacks, std::vector<XMFLOAT3>& positions)
+{
+	// sin/cos of every slice angle, padded to a multiple of four so rings are processed in whole vectors
+	const int padded = (slices + 3) & ~3;
+	std::vector<XMFLOAT4A> cosTheta(padded / 4), sinTheta(padded / 4);
+
+	const auto step = XMVectorReplicate(XM_2PI / slices);
+
+	for (int j = 0; j < padded; j += 4)
+	{
+		XMVECTOR s, c;
+		XMVectorSinCos(&s, &c, XMVectorMultiply(XMVectorSet(float(j), float(j + 1), float(j + 2), float(j + 3)), step));
+		XMStoreFloat4A(&sinTheta[j / 4], s);
+		XMStoreFloat4A(&cosTheta[j / 4], c);
+	}
+
+	const int rings = stacks - 1;
+	positions.resize(size_t(rings) * slices);
+
+	ParallelFor(rings, ringsPerChunk, [&](size_t begin, size_t end)
+	{
+		for (size_t r = begin; r < end; r++)
+		{
+			const auto i = int(r) + 1;
+			const auto phi = XM_PI * i / stacks;
+
+			// the equator ring is pulled in to give the sphere its waist
+			const float dist = (i - 1 == (stacks - 1) / 2) ? 0.2f : 1.f;
+			const auto radius = XMVectorReplicate(std::sin(phi) * dist);
+			const float y = std::cos(phi);
+
+			XMFLOAT3* ring = positions.data() + r * slices;
+
+			for (int j = 0; j < slices; j += 4)
+			{
+				XMFLOAT4A x, z;
+				XMStoreFloat4A(&x, XMVectorMultiply(XMLoadFloat4A(&cosTheta[j / 4]), radius));
+				XMStoreFloat4A(&z, XMVectorMultiply(XMLoadFloat4A(&sinTheta[j / 4]), radius));
+
+				const float xs[4] = { x.x, x.y, x.z, x.w };
+				const float zs[4] = { z.x, z.y, z.z, z.w };
+				const int count = std::min(4, slices - j);
+
+				for (int k = 0; k < count; k++)
+					ring[j + k] = { xs[k], y, zs[k] };
+			}
+		}
+	});
+}
+
+void SphereGenerator::WriteSmooth(int slices, int stacks, const std::vector<XMFLOAT3>& positions, FXMVECTOR color,
+	SimpleVertex* vertices, UINT* indices)
+{
+	const int rings = stacks - 1;
+	const UINT top = 0;
+	const UINT bottom = UINT(rings * slices + 1);
+
+	const auto topPosition = XMVectorSet(0.f, 1.f, 0.f, 0.f);
+	const auto bottomPosition = XMVectorSet(0.f, -1.f, 0.f, 0.f);
+
+	SimpleVertex vertex{};
+	XMStoreFloat3(&vertex.color, color);
+
+	XMStoreFloat3(&vertex.position, topPosition);
+	XMStoreFloat3(&vertex.normal, topPosition);
+	vertices[top] = vertex;
+
+	XMStoreFloat3(&vertex.position, bottomPosition);
+	XMStoreFloat3(&vertex.normal, bottomPosition);
+	vertices[bottom] = vertex;
+
+	// vertex (r, j) lives at 1 + r * slices + j
+	ParallelFor(rings, ringsPerChunk, [&](size_t begin, size_t end)
+	{
+		SimpleVertex v{};
+		XMStoreFloat3(&v.color, color);
+
+		for (int r = int(begin); r < int(end); r++)
+		{
+			for (int j = 0; j < slices; j++)
+			{
+				const auto p = LoadPosition(positions, slices, r, j);
+				const auto up = XMVectorSubtract(r == 0 ? topPosition : LoadPosition(positions, slices, r - 1, j), p);
+				const auto down = XMVectorSubtract(r == rings - 1 ? bottomPosition : LoadPosition(positions, slices, r + 1, j), p);
+				const auto right = XMVectorSubtract(LoadPosition(positions, slices, r, j + 1), p);
+				const auto left = XMVectorSubtract(LoadPosition(positions, slices, r, j - 1), p);
+
+				auto normal = XMVector3Cross(up, right);
+				normal = XMVectorAdd(normal, XMVector3Cross(left, up));
+				normal = XMVectorAdd(normal, XMVector3Cross(down, left));
+				normal = XMVectorAdd(normal, XMVector3Cross(right, down));
+
+				XMStoreFloat3(&v.position, p);
+				XMStoreFloat3(&v.normal, XMVector3Normalize(normal));
+				vertices[1 + r * slices + j] = v;
+			}
+
+			const UINT ring = UINT(1 + r * slices);
+
+			if (r == 0)
+			{
+				UINT* cap = indices;
+
+				for (int j = 0; j < slices; j++)
+				{
+					*cap++ = top;
+					*cap++ = ring + (j + 1) % slices;
+					*cap++ = ring + j;
+				}
+			}
+
+			if (r == rings - 1)
+			{
+				UINT* cap = indices + size_t(3) * slices;
+
+				for (int j = 0; j < slices; j++)
+				{
+					*cap++ = bottom;
+					*cap++ = ring + j;
+					*cap++ = ring + (j + 1) % slices;
+				}
+
+				continue;
+			}
+
+			// caps take the first 6 * slices indices, then one band of quads per ring
+			UINT* out = indices + size_t(6) * slices * (r + 1);
+
+			for (int j = 0; j < slices; j++)
+			{
+				const UINT a = ring + j;
+				const UINT b = ring + (j + 1) % slices;
+
+				*out++ = a;
+				*out++ = b;
+				*out++ = b + slices;
+				*out++ = a;
+				*out++ = b + slices;
+				*out++ = a + slices;
+			}
+		}
+	});
+}
+
+void SphereGenerator::WriteFaceted(int slices, int stacks, const std::vector<XMFLOAT3>& positions, FXMVECTOR color,
+	SimpleVertex* vertices, UINT* indices)
+{
+	const int rings = stacks - 1;
+	const UINT bottom = UINT(slices + 4 * rings * slices);
+
+	const auto topPosition = XMVectorSet(0.f, 1.f, 0.f, 0.f);
+	const auto bottomPosition = XMVectorSet(0.f, -1.f, 0.f, 0.f);
+
+	// pole fans: one copy of the pole per slice
+	{
+		SimpleVertex v{};
+		XMStoreFloat3(&v.color, color);
+
+		for (int j = 0; j < slices; j++)
+		{
+			const auto first = LoadPosition(positions, slices, 0, j);
+			const auto last = LoadPosition(positions, slices, rings - 1, j);
+
+			XMStoreFloat3(&v.position, topPosition);
+			XMStoreFloat3(&v.normal, XMVector3Cross(XMVectorSubtract(topPosition, first),
+				XMVectorSubtract(LoadPosition(positions, slices, 0, j + 1), first)));
+			vertices[j] = v;
+
+			XMStoreFloat3(&v.position, bottomPosition);
+			XMStoreFloat3(&v.normal, XMVector3Cross(XMVectorSubtract(last, bottomPosition),
+				XMVectorSubtract(LoadPosition(positions, slices, rings - 1, j + 1), bottomPosition)));
+			vertices[bottom + j] = v;
+
+			UINT* out = indices + size_t(6) * j;
+			*out++ = j;
+			*out++ = 4 * ((j + 1) % slices) + slices + 1;
+			*out++ = 4 * j + slices;
+			*out++ = bottom + j;
+			*out++ = bottom - slices * 4 + j * 4 + 3;
+			*out++ = bottom - slices * 4 + ((j + 1) % slices) * 4 + 2;
+		}
+	}
+
+	// ring position (r, j) owns vertices slices + 4 * (r * slices + j) + 0..3, one per adjacent quad
+	ParallelFor(rings, ringsPerChunk, [&](size_t begin, size_t end)
+	{
+		SimpleVertex v{};
+		XMStoreFloat3(&v.color, color);
+
+		for (int r = int(begin); r < int(end); r++)
+		{
+			SimpleVertex* out = vertices + slices + size_t(4) * r * slices;
+
+			for (int j = 0; j < slices; j++)
+			{
+				const auto p = LoadPosition(positions, slices, r, j);
+				const auto up = XMVectorSubtract(r == 0 ? topPosition : LoadPosition(positions, slices, r - 1, j), p);
+				const auto down = XMVectorSubtract(r == rings - 1 ? bottomPosition : LoadPosition(positions, slices, r + 1, j), p);
+				const auto right = XMVectorSubtract(LoadPosition(positions, slices, r, j + 1), p);
+				const auto left = XMVectorSubtract(LoadPosition(positions, slices, r, j - 1), p);
+
+				XMStoreFloat3(&v.position, p);
+
+				XMStoreFloat3(&v.normal, XMVector3Cross(up, right));
+				*out++ = v;
+				XMStoreFloat3(&v.normal, XMVector3Cross(left, up));
+				*out++ = v;
+				XMStoreFloat3(&v.normal, XMVector3Cross(down, left));
+				*out++ = v;
+				XMStoreFloat3(&v.normal, XMVector3Cross(right, down));
+				*out++ = v;
+			}
+
+			if (r == rings - 1)
+				continue;
+
+			UINT* idx = indices + size_t(6) * slices + size_t(6) * slices * r;
+
+			for (int j = 0; j < slices; j++)
+			{
+				const int next = (j + 1) % slices;
+				const UINT a = slices + 4 * slices * r + 4 * j + 3;
+				const UINT b = slices + 4 * slices * r + 4 * next + 2;
+				const UINT c = slices + 4 * slices * (r + 1) + 4 * next + 1;
+				const UINT d = slices + 4 * slices * (r + 1) + 4 * j;
+
+				*idx++ = a;
+				*idx++ = b;
+				*idx++ = c;
+				*idx++ = a;
+				*idx++ = c;
+				*idx++ = d;
+			}
+		}
+	});
+}
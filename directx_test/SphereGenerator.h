@@ -0,0 +1,46 @@
+#pragma once
+#include "WinTypes.h"
+#include <vector>
+#include "SimpleVertex.h"
+
+class MeshBuilder;
+
+enum class SphereNormals
+{
+	// one vertex per ring position, normal averaged over the four adjacent quads
+	Smooth,
+	// four vertices per ring position, one per adjacent quad (the original MakeSphere layout)
+	Faceted
+};
+
+class SphereGenerator
+{
+public:
+
+	static constexpr size_t VertexCount(int slices, int stacks, SphereNormals normals) noexcept
+	{
+		const size_t rings = size_t(stacks - 1) * slices;
+
+		return normals == SphereNormals::Smooth ? rings + 2 : rings * 4 + 2 * size_t(slices);
+	}
+
+	static constexpr size_t IndexCount(int slices, int stacks) noexcept
+	{
+		return size_t(6) * slices * (stacks - 1);
+	}
+
+	// Fills vertices and indices, resizing both exactly once. slices and stacks are clamped to at least 3.
+	static void Generate(int slices, int stacks, DirectX::FXMVECTOR color, SphereNormals normals,
+		std::vector<SimpleVertex>& vertices, std::vector<UINT>& indices);
+	// Appends the sphere to builder, writing straight into the ranges it hands out.
+	static void Generate(int slices, int stacks, DirectX::FXMVECTOR color, SphereNormals normals, MeshBuilder& builder);
+
+private:
+
+	static void Write(int slices, int stacks, DirectX::FXMVECTOR color, SphereNormals normals, SimpleVertex* vertices, UINT* indices);
+	static void BuildRingPositions(int slices, int stacks, std::vector<DirectX::XMFLOAT3>& positions);
+	static void WriteSmooth(int slices, int stacks, const std::vector<DirectX::XMFLOAT3>& positions, DirectX::FXMVECTOR color,
+		SimpleVertex* vertices, UINT* indices);
+	static void WriteFaceted(int slices, int stacks, const std::vector<DirectX::XMFLOAT3>& positions, DirectX::FXMVECTOR color,
+		SimpleVertex* vertices, UINT* indices);
+};
@@ -1,9 +1,17 @@
 #pragma once
+#include <DirectXMath.h>
 
 struct Transform
 {
 	Transform() : position(), eulerRotation(), scale(1.f, 1.f, 1.f) {}
 
+	// scale, then rotation, then translation
+	DirectX::XMMATRIX XM_CALLCONV World() const noexcept
+	{
+		return DirectX::XMMatrixScaling(scale.x, scale.y, scale.z) * DirectX::XMMatrixRotationRollPitchYaw(eulerRotation.x, eulerRotation.y, eulerRotation.z) *
+			DirectX::XMMatrixTranslation(position.x, position.y, position.z);
+	}
+
 	DirectX::XMFLOAT3 position;
 	DirectX::XMFLOAT3 eulerRotation;
 	DirectX::XMFLOAT3 scale;
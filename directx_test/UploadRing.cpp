@@ -0,0 +1,13 @@
+#include "UploadRing.h"
+
+UploadAllocation UploadRing::Allocate(UINT byteCount) noexcept
+{
+	UINT offset = (m_cursor + m_alignment - 1) & ~(m_alignment - 1);
+
+	if (offset < m_cursor || offset + byteCount > m_capacity)
+		offset = 0;
+
+	m_cursor = offset + byteCount;
+
+	return { offset, offset == 0 ? BufferMap::Discard : BufferMap::NoOverwrite };
+}
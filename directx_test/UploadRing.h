@@ -0,0 +1,35 @@
+#pragma once
+#include "WinTypes.h"
+#include "BufferFactory.h"
+
+// Where an UploadRing put a write, and how the buffer has to be mapped for it.
+struct UploadAllocation
+{
+	UINT offset = 0;
+	BufferMap mode = BufferMap::Discard;
+};
+
+// Hands out the space of an upload buffer front to back, for data the GPU reads once. When the rest of
+// the buffer is too small the ring starts over at zero with a discard, which gives the GPU fresh memory
+// while it still reads the old; every other write lands past anything the GPU may be reading, so it
+// maps with no-overwrite.
+class UploadRing
+{
+public:
+
+	UploadRing() = default;
+	// alignment must be a power of two
+	constexpr UploadRing(UINT capacity, UINT alignment) noexcept : m_capacity(capacity), m_alignment(alignment), m_cursor(capacity) {}
+
+	// byteCount must not exceed the capacity.
+	UploadAllocation Allocate(UINT byteCount) noexcept;
+
+	constexpr UINT Capacity() const noexcept { return m_capacity; }
+
+private:
+
+	UINT m_capacity = 0;
+	UINT m_alignment = 1;
+	// starts at the end, so that the first write discards
+	UINT m_cursor = 0;
+};
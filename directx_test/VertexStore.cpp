@@ -0,0 +1,78 @@
+#include "VertexStore.h"
+
+void VertexStore::Upload(BufferFactory* factory, VertexLayout newLayout)
+{
+	layout = newLayout;
+	pooledBuffer = {};
+	sharedVertices = {};
+
+	if (layout == VertexLayout::Interleaved)
+	{
+		positions = {};
+		attributeBuffer.reset();
+		vertexBuffer = factory->CreateVertexBuffer(vertices);
+		bounds = MeshBounds::Compute(vertices);
+		return;
+	}
+
+	std::vector<VertexAttributes> attributes(vertices.size());
+	positions.resize(vertices.size());
+
+	for (size_t i = 0; i < vertices.size(); i++)
+	{
+		positions[i] = vertices[i].position;
+		attributes[i] = { vertices[i].color, vertices[i].normal, vertices[i].texCoord };
+	}
+
+	vertexBuffer = factory->CreateVertexBuffer(positions);
+	attributeBuffer = factory->CreateVertexBuffer(attributes);
+	bounds = MeshBounds::Compute(positions);
+}
+
+void VertexStore::Upload(BufferPool& pool)
+{
+	layout = VertexLayout::Interleaved;
+	positions = {};
+	vertexBuffer.reset();
+	attributeBuffer.reset();
+	sharedVertices = {};
+
+	const auto bytes = UINT(vertices.size() * sizeof(SimpleVertex));
+	pool.Fit(pooledBuffer, bytes, D3D11_BIND_VERTEX_BUFFER);
+
+	if (bytes > 0)
+		pool.Upload(pooledBuffer, 0, vertices.data(), bytes);
+
+	bounds = MeshBounds::Compute(vertices);
+}
+
+void VertexStore::Upload(GeometryBuffer& geometry, BufferFactory* factory)
+{
+	// freed first, so a store that changed size can take its old space back
+	sharedVertices = {};
+	sharedVertices = geometry.AllocateVertices(vertices);
+
+	if (!sharedVertices)
+	{
+		Upload(factory, VertexLayout::Interleaved);
+		return;
+	}
+
+	layout = VertexLayout::Interleaved;
+	positions = {};
+	vertexBuffer.reset();
+	attributeBuffer.reset();
+	pooledBuffer = {};
+	bounds = MeshBounds::Compute(vertices);
+}
+
+std::shared_ptr<VertexStore> VertexStore::CopyForEdit() const
+{
+	auto copy = std::make_shared<VertexStore>();
+	copy->vertices = vertices;
+	copy->positions = positions;
+	copy->layout = layout;
+	copy->bounds = bounds;
+
+	return copy;
+}
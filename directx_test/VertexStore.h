@@ -0,0 +1,52 @@
+#pragma once
+#include "WinTypes.h"
+#include <vector>
+#include <memory>
+#include "SimpleVertex.h"
+#include "MeshBounds.h"
+#include "BufferFactory.h"
+#include "BufferPool.h"
+#include "GeometryBuffer.h"
+
+enum class VertexLayout
+{
+	// one stream of whole SimpleVertex structs
+	Interleaved,
+	// positions in one stream and VertexAttributes in a second, so passes that only need positions
+	// read 12 bytes per vertex instead of 44
+	Split
+};
+
+// Vertices and the GPU buffers made from them. Meshes that draw the same vertices with different
+// indices hold one store between them; Mesh never edits a store another mesh also holds and
+// copies it on the next edit instead.
+struct VertexStore
+{
+	std::vector<SimpleVertex> vertices;
+	// the positions of vertices packed tightly, as of the last Upload; only kept for the Split layout
+	std::vector<DirectX::XMFLOAT3> positions;
+	VertexLayout layout = VertexLayout::Interleaved;
+	// whole vertices for Interleaved, positions for Split
+	UniqueBuffer vertexBuffer = nullptr;
+	// the second stream of the Split layout
+	UniqueBuffer attributeBuffer = nullptr;
+	// whole vertices for dynamic meshes, in place of vertexBuffer
+	PooledBuffer pooledBuffer;
+	// whole vertices for meshes in a GeometryBuffer, in place of vertexBuffer
+	GeometryRange sharedVertices;
+	MeshBounds bounds;
+
+	GpuBuffer* VertexBuffer() const noexcept
+	{
+		return vertexBuffer ? vertexBuffer.get() : pooledBuffer ? pooledBuffer.Get() : sharedVertices.Buffer();
+	}
+
+	// Recreates the buffers, the position stream and the bounds from vertices in the given layout.
+	void Upload(BufferFactory* factory, VertexLayout newLayout);
+	// Same into a pooled buffer, interleaved, reusing the current one while the size class still fits.
+	void Upload(BufferPool& pool);
+	// Same into geometry, interleaved, or into a buffer of its own from factory when geometry is full.
+	void Upload(GeometryBuffer& geometry, BufferFactory* factory);
+	// The vertices, positions and bounds without the buffers, for a store that is about to be edited.
+	std::shared_ptr<VertexStore> CopyForEdit() const;
+};
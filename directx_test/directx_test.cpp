@@ -1,26 +1,26 @@
 ﻿#include "NormWin.h"
 #include <sstream>
 #include <cmath>
-#include "mymath.h"
 #include "WindowsMessageMap.h"
 #include "Window.h"
-#include "SceneObject.h"
-#include "Scene.h"
-#include "CylinderMovement.h"
-#include "CubeMovementTop.h"
-#include "CubeMovementBottom.h"
-#include "Rotator.h"
+#include "DemoScene.h"
+#include "PackedVertex.h"
 
 int CALLBACK WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLine, int nCmdShow)
 {
 	Timer timer;
+	Timer statsTimer;
 	float t = 0.f;
 
 	Window wnd(1600, 900, L"nu window");
 
 	//wnd.mouse.EnableRaw();
 
-	Scene scene(wnd.Gfx());
+	// lends buffers to dynamic meshes, so it outlives the library
+	BufferPool bufferPool(wnd.Gfx());
+
+	// static meshes are sub-allocated from one vertex and one index buffer
+	GeometryBuffer geometry(wnd.Gfx());
 
 	std::unique_ptr<ID3D11PixelShader, DXDeleter<ID3D11PixelShader>> psLight;
 	psLight.reset(wnd.Gfx()->CompileAndCreatePixelShader(L"Light.fx", "PS", "ps_5_0"));
@@ -37,323 +37,24 @@ int CALLBACK WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLi
 	std::unique_ptr<ID3D11PixelShader, DXDeleter<ID3D11PixelShader>> psSky;
 	psSky.reset(wnd.Gfx()->CompileAndCreatePixelShader(L"Light.fx", "SkymapPShader", "ps_5_0"));
 
-	auto loadedMesh = std::make_unique<Mesh>(wnd.Gfx());
-	loadedMesh->LoadFromFile(L"Padlock.obj");
-
-	const auto sine = std::sin(DirectX::XM_PIDIV4);
-
-	auto cylinderMesh = std::make_unique<Mesh>(wnd.Gfx());
-	cylinderMesh->SetVertices({
-
-		// bottom 0-15
-
-		{{-0.5f,       -1.f, 0.f},         {1.f, 1.f, 1.f}, {0.f, -1.f, 0.f}, {0.f, 0.f}},
-		{{-sine / 2.f, -1.f, sine / 2.f},  {1.f, 1.f, 1.f}, {0.f, -1.f, 0.f}, {1.f, 0.f}},
-		{{0.f,         -1.f, 0.5f},        {1.f, 1.f, 1.f}, {0.f, -1.f, 0.f}, {0.f, 0.f}},
-		{{sine / 2.f,  -1.f, sine / 2.f},  {1.f, 1.f, 1.f}, {0.f, -1.f, 0.f}, {1.f, 0.f}},
-		{{0.5f,        -1.f, 0.f},         {1.f, 1.f, 1.f}, {0.f, -1.f, 0.f}, {0.f, 0.f}},
-		{{sine / 2.f,  -1.f, -sine / 2.f}, {1.f, 1.f, 1.f}, {0.f, -1.f, 0.f}, {1.f, 0.f}},
-		{{0.f,         -1.f, -0.5f},       {1.f, 1.f, 1.f}, {0.f, -1.f, 0.f}, {0.f, 0.f}},
-		{{-sine / 2.f, -1.f, -sine / 2.f}, {1.f, 1.f, 1.f}, {0.f, -1.f, 0.f}, {1.f, 0.f}},
-		{{-1.f,        -1.f, 0.f},         {1.f, 1.f, 1.f}, {0.f, -1.f, 0.f}, {0.f, 1.f}},
-		{{-sine,       -1.f, sine},        {1.f, 1.f, 1.f}, {0.f, -1.f, 0.f}, {1.f, 1.f}},
-		{{0.f,         -1.f, 1.f},         {1.f, 1.f, 1.f}, {0.f, -1.f, 0.f}, {0.f, 1.f}},
-		{{sine,        -1.f, sine},        {1.f, 1.f, 1.f}, {0.f, -1.f, 0.f}, {1.f, 1.f}},
-		{{1.f,         -1.f, 0.f},         {1.f, 1.f, 1.f}, {0.f, -1.f, 0.f}, {0.f, 1.f}},
-		{{sine,        -1.f, -sine},       {1.f, 1.f, 1.f}, {0.f, -1.f, 0.f}, {1.f, 1.f}},
-		{{0.f,         -1.f, -1.f},        {1.f, 1.f, 1.f}, {0.f, -1.f, 0.f}, {0.f, 1.f}},
-		{{-sine,       -1.f, -sine},       {1.f, 1.f, 1.f}, {0.f, -1.f, 0.f}, {1.f, 1.f}},
-
-		// top 16-31
-
-		{{-0.5f,       1.f, 0.f},         {1.f, 1.f, 1.f}, {0.f, 1.f, 0.f}, {0.f, 0.f}},
-		{{-sine / 2.f, 1.f, sine / 2.f},  {1.f, 1.f, 1.f}, {0.f, 1.f, 0.f}, {1.f, 0.f}},
-		{{0.f,         1.f, 0.5f},        {1.f, 1.f, 1.f}, {0.f, 1.f, 0.f}, {0.f, 0.f}},
-		{{sine / 2.f,  1.f, sine / 2.f},  {1.f, 1.f, 1.f}, {0.f, 1.f, 0.f}, {1.f, 0.f}},
-		{{0.5f,        1.f, 0.f},         {1.f, 1.f, 1.f}, {0.f, 1.f, 0.f}, {0.f, 0.f}},
-		{{sine / 2.f,  1.f, -sine / 2.f}, {1.f, 1.f, 1.f}, {0.f, 1.f, 0.f}, {1.f, 0.f}},
-		{{0.f,         1.f, -0.5f},       {1.f, 1.f, 1.f}, {0.f, 1.f, 0.f}, {0.f, 0.f}},
-		{{-sine / 2.f, 1.f, -sine / 2.f}, {1.f, 1.f, 1.f}, {0.f, 1.f, 0.f}, {1.f, 0.f}},
-		{{-1.f,        1.f, 0.f},         {1.f, 1.f, 1.f}, {0.f, 1.f, 0.f}, {0.f, 1.f}},
-		{{-sine,       1.f, sine},        {1.f, 1.f, 1.f}, {0.f, 1.f, 0.f}, {1.f, 1.f}},
-		{{0.f,         1.f, 1.f},         {1.f, 1.f, 1.f}, {0.f, 1.f, 0.f}, {0.f, 1.f}},
-		{{sine,        1.f, sine},        {1.f, 1.f, 1.f}, {0.f, 1.f, 0.f}, {1.f, 1.f}},
-		{{1.f,         1.f, 0.f},         {1.f, 1.f, 1.f}, {0.f, 1.f, 0.f}, {0.f, 1.f}},
-		{{sine,        1.f, -sine},       {1.f, 1.f, 1.f}, {0.f, 1.f, 0.f}, {1.f, 1.f}},
-		{{0.f,         1.f, -1.f},        {1.f, 1.f, 1.f}, {0.f, 1.f, 0.f}, {0.f, 1.f}},
-		{{-sine,       1.f, -sine},       {1.f, 1.f, 1.f}, {0.f, 1.f, 0.f}, {1.f, 1.f}},
-
-		// inner 32-63
-
-		{{-0.5f,       -1.f, 0.f},         {1.f, 1.f, 1.f}, {cosd(-157.5f), 0.f, sind(-157.5f)}, {0.f, 0.f}   },
-		{{-sine / 2.f, -1.f, sine / 2.f},  {1.f, 1.f, 1.f}, {cosd(-157.5f), 0.f, sind(-157.5f)}, {0.125f, 0.f}},
-		{{-0.5f,       1.f, 0.f},          {1.f, 1.f, 1.f}, {cosd(-157.5f), 0.f, sind(-157.5f)}, {0.f, 1.f}   },
-		{{-sine / 2.f, 1.f, sine / 2.f},   {1.f, 1.f, 1.f}, {cosd(-157.5f), 0.f, sind(-157.5f)}, {0.125f, 1.f}},
-		{{-sine / 2.f, -1.f, sine / 2.f},  {1.f, 1.f, 1.f}, {cosd(-112.5f), 0.f, sind(-112.5f)}, {0.125f, 0.f}},
-		{{0.f,         -1.f, 0.5f},        {1.f, 1.f, 1.f}, {cosd(-112.5f), 0.f, sind(-112.5f)}, {0.25f, 0.f} },
-		{{-sine / 2.f, 1.f, sine / 2.f},   {1.f, 1.f, 1.f}, {cosd(-112.5f), 0.f, sind(-112.5f)}, {0.125f, 1.f}},
-		{{0.f,         1.f, 0.5f},         {1.f, 1.f, 1.f}, {cosd(-112.5f), 0.f, sind(-112.5f)}, {0.25f, 1.f} },
-		{{0.f,         -1.f, 0.5f},        {1.f, 1.f, 1.f}, {cosd(-67.5f), 0.f, sind(-67.5f)},   {0.25f, 0.f} },
-		{{sine / 2.f,  -1.f, sine / 2.f},  {1.f, 1.f, 1.f}, {cosd(-67.5f), 0.f, sind(-67.5f)},   {0.375f, 0.f}},
-		{{0.f,         1.f, 0.5f},         {1.f, 1.f, 1.f}, {cosd(-67.5f), 0.f, sind(-67.5f)},   {0.25f, 1.f} },
-		{{sine / 2.f,  1.f, sine / 2.f},   {1.f, 1.f, 1.f}, {cosd(-67.5f), 0.f, sind(-67.5f)},   {0.375f, 1.f}},
-		{{sine / 2.f,  -1.f, sine / 2.f},  {1.f, 1.f, 1.f}, {cosd(-22.5f), 0.f, sind(-22.5f)},   {0.375f, 0.f}},
-		{{0.5f,        -1.f, 0.f},         {1.f, 1.f, 1.f}, {cosd(-22.5f), 0.f, sind(-22.5f)},   {0.5f, 0.f}  },
-		{{sine / 2.f,  1.f, sine / 2.f},   {1.f, 1.f, 1.f}, {cosd(-22.5f), 0.f, sind(-22.5f)},   {0.375f, 1.f}},
-		{{0.5f,        1.f, 0.f},          {1.f, 1.f, 1.f}, {cosd(-22.5f), 0.f, sind(-22.5f)},   {0.5f, 1.f}  },
-		{{0.5f,        -1.f, 0.f},         {1.f, 1.f, 1.f}, {cosd(22.5f), 0.f, sind(22.5f)},     {0.5f, 0.f}  },
-		{{sine / 2.f,  -1.f, -sine / 2.f}, {1.f, 1.f, 1.f}, {cosd(22.5f), 0.f, sind(22.5f)},     {0.625f, 0.f}},
-		{{0.5f,        1.f, 0.f},          {1.f, 1.f, 1.f}, {cosd(22.5f), 0.f, sind(22.5f)},     {0.5f, 1.f}  },
-		{{sine / 2.f,  1.f, -sine / 2.f},  {1.f, 1.f, 1.f}, {cosd(22.5f), 0.f, sind(22.5f)},     {0.625f, 1.f}},
-		{{sine / 2.f,  -1.f, -sine / 2.f}, {1.f, 1.f, 1.f}, {cosd(67.5f), 0.f, sind(67.5f)},     {0.625f, 0.f}},
-		{{0.f,         -1.f, -0.5f},       {1.f, 1.f, 1.f}, {cosd(67.5f), 0.f, sind(67.5f)},     {0.75f, 0.f} },
-		{{sine / 2.f,  1.f, -sine / 2.f},  {1.f, 1.f, 1.f}, {cosd(67.5f), 0.f, sind(67.5f)},     {0.625f, 1.f}},
-		{{0.f,         1.f, -0.5f},        {1.f, 1.f, 1.f}, {cosd(67.5f), 0.f, sind(67.5f)},     {0.75f, 1.f} },
-		{{0.f,         -1.f, -0.5f},       {1.f, 1.f, 1.f}, {cosd(112.5f), 0.f, sind(112.5f)},   {0.75f, 0.f} },
-		{{-sine / 2.f, -1.f, -sine / 2.f}, {1.f, 1.f, 1.f}, {cosd(112.5f), 0.f, sind(112.5f)},   {0.875f, 0.f}},
-		{{0.f,         1.f, -0.5f},        {1.f, 1.f, 1.f}, {cosd(112.5f), 0.f, sind(112.5f)},   {0.75f, 1.f} },
-		{{-sine / 2.f, 1.f, -sine / 2.f},  {1.f, 1.f, 1.f}, {cosd(112.5f), 0.f, sind(112.5f)},   {0.875f, 1.f}},
-		{{-sine / 2.f, -1.f, -sine / 2.f}, {1.f, 1.f, 1.f}, {cosd(157.5f), 0.f, sind(157.5f)},   {0.875f, 0.f}},
-		{{-0.5f,         -1.f, 0.f},       {1.f, 1.f, 1.f}, {cosd(157.5f), 0.f, sind(157.5f)},   {1.f, 0.f}   },
-		{{-sine / 2.f, 1.f, -sine / 2.f},  {1.f, 1.f, 1.f}, {cosd(157.5f), 0.f, sind(157.5f)},   {0.875f, 1.f}},
-		{{-0.5f,         1.f, 0.f},        {1.f, 1.f, 1.f}, {cosd(157.5f), 0.f, sind(157.5f)},   {1.f, 1.f}   },
-
-		// outer 64-95
-
-		{{-1.f,  -1.f, 0.f},   {1.f, 1.f, 1.f}, {cosd(157.5f), 0.f, sind(157.5f)},   {0.f, 0.f}   },
-		{{-sine, -1.f, sine},  {1.f, 1.f, 1.f}, {cosd(157.5f), 0.f, sind(157.5f)},   {0.125f, 0.f}},
-		{{-1.f,  1.f, 0.f},    {1.f, 1.f, 1.f}, {cosd(157.5f), 0.f, sind(157.5f)},   {0.f, 1.f}   },
-		{{-sine, 1.f, sine},   {1.f, 1.f, 1.f}, {cosd(157.5f), 0.f, sind(157.5f)},   {0.125f, 1.f}},
-		{{-sine, -1.f, sine},  {1.f, 1.f, 1.f}, {cosd(112.5f), 0.f, sind(112.5f)},   {0.125f, 0.f}},
-		{{0.f,   -1.f, 1.f},   {1.f, 1.f, 1.f}, {cosd(112.5f), 0.f, sind(112.5f)},   {0.25f, 0.f} },
-		{{-sine, 1.f, sine},   {1.f, 1.f, 1.f}, {cosd(112.5f), 0.f, sind(112.5f)},   {0.125f, 1.f}},
-		{{0.f,   1.f, 1.f},    {1.f, 1.f, 1.f}, {cosd(112.5f), 0.f, sind(112.5f)},   {0.25f, 1.f} },
-		{{0.f,   -1.f, 1.f},   {1.f, 1.f, 1.f}, {cosd(67.5f), 0.f, sind(67.5f)},     {0.25f, 0.f} },
-		{{sine,  -1.f, sine},  {1.f, 1.f, 1.f}, {cosd(67.5f), 0.f, sind(67.5f)},     {0.375f, 0.f}},
-		{{0.f,   1.f, 1.f},    {1.f, 1.f, 1.f}, {cosd(67.5f), 0.f, sind(67.5f)},     {0.25f, 1.f} },
-		{{sine,  1.f, sine},   {1.f, 1.f, 1.f}, {cosd(67.5f), 0.f, sind(67.5f)},     {0.375f, 1.f}},
-		{{sine,  -1.f, sine},  {1.f, 1.f, 1.f}, {cosd(22.5f), 0.f, sind(22.5f)},     {0.375f, 0.f}},
-		{{1.f,   -1.f, 0.f},   {1.f, 1.f, 1.f}, {cosd(22.5f), 0.f, sind(22.5f)},     {0.5f, 0.f}  },
-		{{sine,  1.f, sine},   {1.f, 1.f, 1.f}, {cosd(22.5f), 0.f, sind(22.5f)},     {0.375f, 1.f}},
-		{{1.f,   1.f, 0.f},    {1.f, 1.f, 1.f}, {cosd(22.5f), 0.f, sind(22.5f)},     {0.5f, 1.f}  },
-		{{1.f,   -1.f, 0.f},   {1.f, 1.f, 1.f}, {cosd(-22.5f), 0.f, sind(-22.5f)},   {0.5f, 0.f}  },
-		{{sine,  -1.f, -sine}, {1.f, 1.f, 1.f}, {cosd(-22.5f), 0.f, sind(-22.5f)},   {0.625f, 0.f}},
-		{{1.f,   1.f, 0.f},    {1.f, 1.f, 1.f}, {cosd(-22.5f), 0.f, sind(-22.5f)},   {0.5f, 1.f}  },
-		{{sine,  1.f, -sine},  {1.f, 1.f, 1.f}, {cosd(-22.5f), 0.f, sind(-22.5f)},   {0.625f, 1.f}},
-		{{sine,  -1.f, -sine}, {1.f, 1.f, 1.f}, {cosd(-67.5f), 0.f, sind(-67.5f)},   {0.625f, 0.f}},
-		{{0.f,   -1.f, -1.f},  {1.f, 1.f, 1.f}, {cosd(-67.5f), 0.f, sind(-67.5f)},   {0.75f, 0.f} },
-		{{sine,  1.f, -sine},  {1.f, 1.f, 1.f}, {cosd(-67.5f), 0.f, sind(-67.5f)},   {0.625f, 1.f}},
-		{{0.f,   1.f, -1.f},   {1.f, 1.f, 1.f}, {cosd(-67.5f), 0.f, sind(-67.5f)},   {0.75f, 1.f} },
-		{{0.f,   -1.f, -1.f},  {1.f, 1.f, 1.f}, {cosd(-112.5f), 0.f, sind(-112.5f)}, {0.75f, 0.f} },
-		{{-sine, -1.f, -sine}, {1.f, 1.f, 1.f}, {cosd(-112.5f), 0.f, sind(-112.5f)}, {0.875f, 0.f}},
-		{{0.f,   1.f, -1.f},   {1.f, 1.f, 1.f}, {cosd(-112.5f), 0.f, sind(-112.5f)}, {0.75f, 1.f} },
-		{{-sine, 1.f, -sine},  {1.f, 1.f, 1.f}, {cosd(-112.5f), 0.f, sind(-112.5f)}, {0.875f, 1.f}},
-		{{-sine, -1.f, -sine}, {1.f, 1.f, 1.f}, {cosd(-157.5f), 0.f, sind(-157.5f)}, {0.875f, 0.f}},
-		{{-1.f,   -1.f, 0.f},  {1.f, 1.f, 1.f}, {cosd(-157.5f), 0.f, sind(-157.5f)}, {1.f, 0.f}   },
-		{{-sine, 1.f, -sine},  {1.f, 1.f, 1.f}, {cosd(-157.5f), 0.f, sind(-157.5f)}, {0.875f, 1.f}},
-		{{-1.f,   1.f, 0.f},   {1.f, 1.f, 1.f}, {cosd(-157.5f), 0.f, sind(-157.5f)}, {1.f, 1.f}   },
-
-		{ {0.f, 0.f, 0.f},   {0.f, 0.f, 0.f}, {0.f, 0.f, 0.f}, {1.f, 1.f} }
-
-		});
-	cylinderMesh->SetIndices({
-
-		// bottom
-		 
-		0	,	9	,	8	,
-		0	,	1	,	9	,
-		1	,	10	,	9	,
-		1	,	2	,	10	,
-		2	,	11	,	10	,
-		2	,	3	,	11	,
-		3	,	12	,	11	,
-		3	,	4	,	12	,
-		4	,	13	,	12	,
-		4	,	5	,	13	,
-		5	,	14	,	13	,
-		5	,	6	,	14	,
-		6	,	15	,	14	,
-		6	,	7	,	15	,
-		7	,	8	,	15	,
-		7	,	0	,	8	,
-
-		// top
-
-		16	,	24	,	25	,
-		16	,	25	,	17	,
-		17	,	25	,	26	,
-		17	,	26	,	18	,
-		18	,	26	,	27	,
-		18	,	27	,	19	,
-		19	,	27	,	28	,
-		19	,	28	,	20	,
-		20	,	28	,	29	,
-		20	,	29	,	21	,
-		21	,	29	,	30	,
-		21	,	30	,	22	,
-		22	,	30	,	31	,
-		22	,	31	,	23	,
-		23	,	31	,	24	,
-		23	,	24	,	16	,
-
-		// inner
-
-		32	,	34	,	35	,
-		32	,	35	,	33	,
-		36	,	38	,	39	,
-		36	,	39	,	37	,
-		40	,	42	,	43	,
-		40	,	43	,	41	,
-		44	,	46	,	47	,
-		44	,	47	,	45	,
-		48	,	50	,	51	,
-		48	,	51	,	49	,
-		52	,	54	,	55	,
-		52	,	55	,	53	,
-		56	,	58	,	59	,
-		56	,	59	,	57	,
-		60	,	62	,	63	,
-		60	,	63	,	61	,
-
-		// outer
-
-		64	,	67	,	66	,
-		64	,	65	,	67	,
-		68	,	71	,	70	,
-		68	,	69	,	71	,
-		72	,	75	,	74	,
-		72	,	73	,	75	,
-		76	,	79	,	78	,
-		76	,	77	,	79	,
-		80	,	83	,	82	,
-		80	,	81	,	83	,
-		84	,	87	,	86	,
-		84	,	85	,	87	,
-		88	,	91	,	90	,
-		88	,	89	,	91	,
-		92	,	95	,	94	,
-		92	,	93	,	95	,
-
-
-		});
-
-	auto cubeMesh = std::make_unique<Mesh>(wnd.Gfx());
-	cubeMesh->SetVertices({
-		{ {-1.0f, 1.0f, -1.0f}, {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.f, 0.f} },
-		{ {1.0f, 1.0f, -1.0f},  {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {1.f, 0.f} },
-		{ {1.0f, 1.0f, 1.0f},   {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {1.f, 1.f} },
-		{ {-1.0f, 1.0f, 1.0f},  {1.0f, 0.0f, 0.0f}, {0.0f, 1.0f, 0.0f}, {0.f, 1.f} },
-		
-		{ {-1.0f, -1.0f, -1.0f},{0.0f, 1.0f, 0.0f}, {0.0f, -1.0f, 0.0f}, {0.f, 0.f} },
-		{ {1.0f, -1.0f, -1.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, -1.0f, 0.0f}, {1.f, 0.f} },
-		{ {1.0f, -1.0f, 1.0f},  {0.0f, 1.0f, 0.0f}, {0.0f, -1.0f, 0.0f}, {1.f, 1.f} },
-		{ {-1.0f, -1.0f, 1.0f}, {0.0f, 1.0f, 0.0f}, {0.0f, -1.0f, 0.0f}, {0.f, 1.f} },
-		
-		{ {-1.0f, -1.0f, 1.0f}, {0.0f, 0.0f, 1.0f}, {-1.0f, 0.0f, 0.0f}, {0.f, 0.f} },
-		{ {-1.0f, -1.0f, -1.0f},{0.0f, 0.0f, 1.0f}, {-1.0f, 0.0f, 0.0f}, {1.f, 0.f} },
-		{ {-1.0f, 1.0f, -1.0f}, {0.0f, 0.0f, 1.0f}, {-1.0f, 0.0f, 0.0f}, {1.f, 1.f} },
-		{ {-1.0f, 1.0f, 1.0f},  {0.0f, 0.0f, 1.0f}, {-1.0f, 0.0f, 0.0f}, {0.f, 1.f} },
-		
-		{ {1.0f, -1.0f, 1.0f},  {1.0f, 0.0f, 1.0f}, {1.0f, 0.0f, 0.0f}, {0.f, 0.f} },
-		{ {1.0f, -1.0f, -1.0f}, {1.0f, 0.0f, 1.0f}, {1.0f, 0.0f, 0.0f}, {1.f, 0.f} },
-		{ {1.0f, 1.0f, -1.0f},  {1.0f, 0.0f, 1.0f}, {1.0f, 0.0f, 0.0f}, {1.f, 1.f} },
-		{ {1.0f, 1.0f, 1.0f},   {1.0f, 0.0f, 1.0f}, {1.0f, 0.0f, 0.0f}, {0.f, 1.f} },
-		
-		{ {-1.0f, -1.0f, -1.0f},{1.0f, 1.0f, 0.0f}, {0.0f, 0.0f, -1.0f}, {0.f, 0.f} },
-		{ {1.0f, -1.0f, -1.0f}, {1.0f, 1.0f, 0.0f}, {0.0f, 0.0f, -1.0f}, {1.f, 0.f} },
-		{ {1.0f, 1.0f, -1.0f},  {1.0f, 1.0f, 0.0f}, {0.0f, 0.0f, -1.0f}, {1.f, 1.f} },
-		{ {-1.0f, 1.0f, -1.0f}, {1.0f, 1.0f, 0.0f}, {0.0f, 0.0f, -1.0f}, {0.f, 1.f} },
-		
-		{ {-1.0f, -1.0f, 1.0f}, {0.0f, 1.0f, 1.0f}, {0.0f, 0.0f, 1.0f}, {0.f, 0.f} },
-		{ {1.0f, -1.0f, 1.0f},  {0.0f, 1.0f, 1.0f}, {0.0f, 0.0f, 1.0f}, {1.f, 0.f} },
-		{ {1.0f, 1.0f, 1.0f},   {0.0f, 1.0f, 1.0f}, {0.0f, 0.0f, 1.0f}, {1.f, 1.f} },
-		{ {-1.0f, 1.0f, 1.0f},  {0.0f, 1.0f, 1.0f}, {0.0f, 0.0f, 1.0f}, {0.f, 1.f} }
-		});
-	cubeMesh->SetIndices({
-		3,1,0,
-		2,1,3,
-
-		6,4,5,
-		7,4,6,
-
-		11,9,8,
-		10,9,11,
-
-		14,12,13,
-		15,12,14,
-
-		19,17,16,
-		18,17,19,
-
-		22,20,21,
-		23,20,22
-
-		});
-
-	auto skyMesh = std::make_unique<Mesh>(*cubeMesh);
-	skyMesh->SetIndices({
-		0,1,3,
-		3,1,2,
-
-		5,4,6,
-		6,4,7,
-
-		8,9,11,
-		11,9,10,
-
-		13,12,14,
-		14,12,15,
-
-		16,17,19,
-		19,17,18,
-
-		21,20,22,
-		22,20,23
-
-		});
-
-	wnd.Gfx()->skyPS = psSky.get();
-	wnd.Gfx()->skyMesh = skyMesh.get();
-
-	auto sphereMesh = std::make_unique<Mesh>(wnd.Gfx());
-	int slices = 10, stacks = 10;
-	auto sphereColor = DirectX::Colors::PeachPuff;
-	sphereMesh->MakeSphere(slices, stacks, sphereColor);
-
-	auto obj = scene.CreateObject();
-	obj->SetMesh(cylinderMesh.get());
-	obj->GetMeshRenderer().SetPixelShader(psTexture.get());
-	obj->SetUpdateable<CylinderMovement>();
-
-	obj = scene.CreateObject();
-	obj->SetMesh(loadedMesh.get());
-	obj->GetMeshRenderer().SetPixelShader(psTexture.get());
-	obj->GetTransform().scale = { 30.f, 30.f, 30.f };
-	obj->GetTransform().eulerRotation.x = -DirectX::XM_PIDIV2;
-	obj->GetTransform().position = {4.f, 4.f, 4.f};
-
-	obj = scene.CreateObject();
-	obj->SetMesh(cubeMesh.get());
-	obj->GetMeshRenderer().SetPixelShader(psLight.get());
-	obj->GetTransform().scale = {0.3f, 0.3f, 0.3f};
-	obj->SetUpdateable<CubeMovementTop>();
-
-	obj = scene.CreateObject();
-	obj->SetMesh(cubeMesh.get());
-	obj->GetMeshRenderer().SetPixelShader(psLight.get());
-	obj->GetTransform().scale = { 0.3f, 0.3f, 0.3f };
-	obj->SetUpdateable<CubeMovementBottom>();
-
-	obj = scene.CreateObject();
-	obj->SetMesh(sphereMesh.get());
-	obj->GetMeshRenderer().SetPixelShader(psCustom.get());
-	obj->GetTransform().position = { -4.f, 4.f, 4.f };
-	//obj->SetUpdateable<Rotator>();
-
-	auto pObject = scene.CreateUIObject();
-	pObject->SetMesh(cubeMesh.get());
-	pObject->GetMeshRenderer().SetPixelShader(psSolidColor.get());
-	pObject->GetTransform().position = {5.f, -2.5f, 0.f};
+	DemoScene demo(wnd.Gfx(), bufferPool, geometry, { psLight.get(), psSolidColor.get(), psTexture.get(), psCustom.get() });
+	wnd.Gfx()->GetRenderer().SetSky(demo.Sky(), psSky.get());
+
+	wchar_t buf[256];
+	size_t fullVertexBytes = 0, packedVertexBytes = 0;
+	for (const Mesh* mesh : demo.Meshes())
+	{
+		const auto report = VertexPacker::Analyze(mesh->Vertices());
+		fullVertexBytes += report.fullBytes;
+		packedVertexBytes += report.packedBytes;
+
+		swprintf_s(buf, L"packed vertices: %zu -> %zu bytes, max error position %g normal %g uv %g\n",
+			report.fullBytes, report.packedBytes, report.positionError, report.normalError, report.texCoordError);
+		OutputDebugString(buf);
+	}
+
+	swprintf_s(buf, L"scene vertex memory: %zu -> %zu bytes\n", fullVertexBytes, packedVertexBytes);
+	OutputDebugString(buf);
 
 	bool ttt = false;
 
@@ -468,15 +169,11 @@ int CALLBACK WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLi
 					break;
 				}
 				case Event::WheelUp:
-					slices++;
-					stacks++;
-					sphereMesh->MakeSphere(slices, stacks, sphereColor);
+					demo.ChangeSphereDetail(1);
 
 					break;
 				case Event::WheelDown:
-					if (slices > 3) slices--;
-					if (stacks > 3) stacks--;
-					sphereMesh->MakeSphere(slices, stacks, sphereColor);
+					demo.ChangeSphereDetail(-1);
 
 					break;
 				default:
@@ -491,29 +188,29 @@ int CALLBACK WinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPSTR lpCmdLi
 			wnd.Gfx()->GetCamera().Rotate(rotateDown + rotateUp, rotateLeft + rotateRight, 0.f);
 			wnd.Gfx()->GetCamera().Translate(stepLeft + stepRight, 0, stepBack + stepForward);
 
-			wnd.Gfx()->Render(t);
+			demo.Frame(wnd.Gfx()->GetRenderer(), t, delta);
 
-			for (const auto& o : scene.Objects())
-			{
-				if (o->GetUpdateable() != nullptr)
-					o->GetUpdateable()->Update(delta);
-			
-				wnd.Gfx()->Draw(*o, t);
-			}
-			
-			for (const auto& o : scene.UIObjects())
-			{
-				if (o->GetUpdateable() != nullptr)
-					o->GetUpdateable()->Update(delta);
-			
-				wnd.Gfx()->DrawUI(*o, t);
-			}
-			
 			if (ttt)
 				wnd.Gfx()->DrawText();
 
 			wnd.Gfx()->EndFrame();
 
+			if (statsTimer.Peek() > 1.f)
+			{
+				statsTimer.Mark();
+
+				const auto& stats = wnd.Gfx()->GetFrameStats();
+				swprintf_s(buf, L"triangles per frame: %zu submitted, %zu at full detail, %zu meshlets culled, %zu buffer bindings, %zu shader bindings, %zu instances in %zu instanced draws, %zu bytes uploaded\n",
+					stats.trianglesSubmitted, stats.trianglesFullDetail, stats.meshletsCulled, stats.bufferBindings, stats.shaderBindings, stats.instances, stats.instancedDraws, stats.bytesUploaded);
+				OutputDebugString(buf);
+
+				const auto space = geometry.Stats();
+				swprintf_s(buf, L"geometry buffer: %u/%u vertices, %u/%u indices, fragmentation %.2f/%.2f\n",
+					space.vertices.used, space.vertices.capacity, space.indices.used, space.indices.capacity,
+					space.vertices.Fragmentation(), space.indices.Fragmentation());
+				OutputDebugString(buf);
+			}
+
 			t += delta;
 		}
 	}
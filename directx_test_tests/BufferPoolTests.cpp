@@ -0,0 +1,220 @@
+#include "TestFramework.h"
+#include "BufferPool.h"
+#include "HeadlessBufferFactory.h"
+#include "UploadRing.h"
+#include <cstring>
+#include <numeric>
+
+namespace
+{
+	std::vector<std::byte> Pattern(size_t count, int seed)
+	{
+		std::vector<std::byte> bytes(count);
+
+		for (size_t i = 0; i < count; i++)
+			bytes[i] = std::byte(i * 31 + seed);
+
+		return bytes;
+	}
+
+	bool Holds(HeadlessBufferFactory& factory, const PooledBuffer& buffer, UINT offset, const std::vector<std::byte>& bytes)
+	{
+		const auto contents = factory.Contents(buffer.Get());
+		return std::memcmp(contents.data() + offset, bytes.data(), bytes.size()) == 0;
+	}
+}
+
+TEST(BufferPool, AcquireRoundsUpToSizeClasses)
+{
+	CHECK(BufferPool::CapacityFor(1) == BufferPool::minimumCapacity);
+	CHECK(BufferPool::CapacityFor(4096) == 4096);
+	CHECK(BufferPool::CapacityFor(4097) == 8192);
+
+	HeadlessBufferFactory factory;
+	BufferPool pool(&factory);
+
+	const auto buffer = pool.Acquire(5000, D3D11_BIND_VERTEX_BUFFER);
+
+	CHECK(buffer);
+	CHECK(buffer.Capacity() == 8192);
+	CHECK(factory.Contents(buffer.Get()).size() == 8192);
+}
+
+TEST(BufferPool, ReturnedBuffersAreReused)
+{
+	HeadlessBufferFactory factory;
+	BufferPool pool(&factory);
+
+	GpuBuffer* first = nullptr;
+	{
+		const auto buffer = pool.Acquire(6000, D3D11_BIND_VERTEX_BUFFER);
+		first = buffer.Get();
+	}
+
+	CHECK(pool.IdleBytes() == 8192);
+
+	const auto again = pool.Acquire(7000, D3D11_BIND_VERTEX_BUFFER);
+	CHECK(again.Get() == first);
+	CHECK(pool.IdleBytes() == 0);
+
+	// same class, other bind flags
+	const auto index = pool.Acquire(7000, D3D11_BIND_INDEX_BUFFER);
+	CHECK(index.Get() != first);
+
+	CHECK(pool.Stats().buffersCreated == 2);
+	CHECK(pool.Stats().buffersReused == 1);
+}
+
+TEST(BufferPool, FitKeepsTheBufferWithinItsClass)
+{
+	HeadlessBufferFactory factory;
+	BufferPool pool(&factory);
+
+	PooledBuffer buffer;
+	pool.Fit(buffer, 5000, D3D11_BIND_VERTEX_BUFFER);
+	const auto* handle = buffer.Get();
+
+	pool.Fit(buffer, 8000, D3D11_BIND_VERTEX_BUFFER);
+	CHECK(buffer.Get() == handle);
+
+	pool.Fit(buffer, 9000, D3D11_BIND_VERTEX_BUFFER);
+	CHECK(buffer.Get() != handle);
+	CHECK(buffer.Capacity() == 16384);
+	// the old one went back to the pool
+	CHECK(pool.IdleBytes() == 8192);
+
+	pool.Fit(buffer, 0, D3D11_BIND_VERTEX_BUFFER);
+	CHECK(!buffer);
+	CHECK(pool.IdleBytes() == 8192 + 16384);
+}
+
+TEST(BufferPool, UploadsLandByteExact)
+{
+	HeadlessBufferFactory factory;
+	BufferPool pool(&factory, 4096);
+
+	const auto buffer = pool.Acquire(3 * 4096, D3D11_BIND_VERTEX_BUFFER);
+	const auto small = Pattern(100, 1);
+	const auto large = Pattern(10000, 2);
+
+	pool.Upload(buffer, 10, small.data(), UINT(small.size()));
+	// larger than the ring, so it goes in pieces
+	pool.Upload(buffer, 200, large.data(), UINT(large.size()));
+
+	CHECK(Holds(factory, buffer, 10, small));
+	CHECK(Holds(factory, buffer, 200, large));
+
+	// 100 bytes, then 4096 + 4096 + 1808
+	CHECK(pool.Stats().uploads == 4);
+	CHECK(pool.Stats().bytesUploaded == small.size() + large.size());
+	CHECK(factory.BytesUploaded() == small.size() + large.size());
+}
+
+TEST(BufferPool, FullRingIsDiscarded)
+{
+	HeadlessBufferFactory factory;
+	BufferPool pool(&factory, 4096);
+
+	const auto buffer = pool.Acquire(4096, D3D11_BIND_VERTEX_BUFFER);
+	const auto bytes = Pattern(1000, 3);
+
+	// the first upload discards, the next three fit behind it at 16-byte steps, the fifth wraps
+	for (int i = 0; i < 5; i++)
+		pool.Upload(buffer, UINT(i * 16), bytes.data(), UINT(bytes.size()));
+
+	CHECK(pool.Stats().discards == 2);
+	CHECK(factory.DiscardMaps() == 2);
+	CHECK(factory.NoOverwriteMaps() == 3);
+	CHECK(Holds(factory, buffer, 64, bytes));
+}
+
+TEST(BufferPool, TrimFreesLargestFirst)
+{
+	HeadlessBufferFactory factory;
+	auto pool = std::make_unique<BufferPool>(&factory);
+
+	{
+		const auto a = pool->Acquire(4096, D3D11_BIND_VERTEX_BUFFER);
+		const auto b = pool->Acquire(8192, D3D11_BIND_VERTEX_BUFFER);
+		const auto c = pool->Acquire(65536, D3D11_BIND_INDEX_BUFFER);
+	}
+
+	// the ring and three idle buffers
+	CHECK(factory.LiveFakeBuffers() == 4);
+
+	pool->Trim(12288);
+	CHECK(pool->IdleBytes() == 4096 + 8192);
+	CHECK(factory.LiveFakeBuffers() == 3);
+
+	pool->Trim(4096);
+	CHECK(pool->IdleBytes() == 4096);
+
+	pool.reset();
+	CHECK(factory.LiveFakeBuffers() == 0);
+}
+
+TEST(BufferPool, MovedLoansReturnOnce)
+{
+	HeadlessBufferFactory factory;
+	BufferPool pool(&factory);
+
+	{
+		auto buffer = pool.Acquire(100, D3D11_BIND_VERTEX_BUFFER);
+		PooledBuffer moved = std::move(buffer);
+		CHECK(!buffer);
+		CHECK(moved);
+	}
+
+	CHECK(pool.IdleBytes() == BufferPool::minimumCapacity);
+}
+
+TEST(BufferFactory, CompactIndicesPickTheNarrowestFormat)
+{
+	HeadlessBufferFactory factory;
+	DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+
+	std::vector<UINT> indices(300);
+	std::iota(indices.begin(), indices.end(), 0u);
+
+	const auto narrow = factory.CreateCompactIndexBuffer(indices, format);
+	CHECK(format == DXGI_FORMAT_R16_UINT);
+	CHECK(factory.BytesUploaded() == 300 * sizeof(USHORT));
+
+	indices.back() = 0x10000;
+	const auto wide = factory.CreateCompactIndexBuffer(indices, format);
+	CHECK(format == DXGI_FORMAT_R32_UINT);
+	CHECK(factory.BytesUploaded() == 300 * sizeof(USHORT) + 300 * sizeof(UINT));
+	CHECK(factory.BuffersCreated() == 2);
+}
+
+TEST(UploadRing, FirstWriteDiscardsAndLaterOnesAlign)
+{
+	UploadRing ring(1024, 256);
+
+	const auto first = ring.Allocate(100);
+	CHECK(first.offset == 0);
+	CHECK(first.mode == BufferMap::Discard);
+
+	const auto second = ring.Allocate(300);
+	CHECK(second.offset == 256);
+	CHECK(second.mode == BufferMap::NoOverwrite);
+
+	const auto third = ring.Allocate(256);
+	CHECK(third.offset == 768);
+	CHECK(third.mode == BufferMap::NoOverwrite);
+}
+
+TEST(UploadRing, WrapsWhenTheRestIsTooSmall)
+{
+	UploadRing ring(1024, 16);
+
+	CHECK(ring.Allocate(1000).offset == 0);
+
+	const auto wrapped = ring.Allocate(32);
+	CHECK(wrapped.offset == 0);
+	CHECK(wrapped.mode == BufferMap::Discard);
+
+	// a write of the whole ring always fits
+	CHECK(ring.Allocate(1024).mode == BufferMap::Discard);
+	CHECK(ring.Allocate(1).mode == BufferMap::Discard);
+}
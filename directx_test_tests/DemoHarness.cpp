@@ -0,0 +1,124 @@
+#include "DemoHarness.h"
+#include "TestFramework.h"
+#include <cmath>
+#include <fstream>
+#include <vector>
+
+namespace
+{
+	// WinMain's timer runs at twice real time
+	constexpr float frameTime = 2.f / 60.f;
+}
+
+std::filesystem::path testing::WriteDemoModel()
+{
+	const auto path = ScratchDirectory() / "Model.obj";
+	std::ofstream file(path);
+
+	constexpr int size = 64;
+
+	for (int z = 0; z <= size; z++)
+	{
+		for (int x = 0; x <= size; x++)
+		{
+			// a tenth of a unit across, about the size of the padlock before WinMain scales it by 30
+			const float u = float(x) / size, v = float(z) / size;
+			file << "v " << 0.1f * (u - 0.5f) << ' ' << 0.005f * std::sin(u * 12.f) * std::cos(v * 9.f) << ' ' << 0.1f * (v - 0.5f) << '\n';
+		}
+	}
+
+	for (int z = 0; z < size; z++)
+	{
+		for (int x = 0; x < size; x++)
+		{
+			// OBJ indices count from 1
+			const int a = z * (size + 1) + x + 1, b = a + 1, c = a + size + 1, d = c + 1;
+			file << "f " << a << ' ' << c << ' ' << b << '\n' << "f " << b << ' ' << c << ' ' << d << '\n';
+		}
+	}
+
+	return path;
+}
+
+testing::FakeRenderResources::FakeRenderResources(BufferFactory* factory)
+{
+	m_frameConstants = UniqueBuffer(factory->CreatePooledBuffer(sizeof(FrameConstantBuffer), D3D11_BIND_CONSTANT_BUFFER), BufferDeleter{ factory });
+	m_objectConstants = UniqueBuffer(factory->CreatePooledBuffer(sizeof(ObjectConstantBuffer), D3D11_BIND_CONSTANT_BUFFER), BufferDeleter{ factory });
+	m_pixelConstants = UniqueBuffer(factory->CreatePooledBuffer(sizeof(PixelConstantBuffer), D3D11_BIND_CONSTANT_BUFFER), BufferDeleter{ factory });
+	// the sizes Graphics creates them with
+	m_constantRing = UniqueBuffer(factory->CreateUploadBuffer(1 << 20), BufferDeleter{ factory });
+	m_instances = UniqueBuffer(factory->CreateUploadBuffer(4096 * sizeof(DirectX::XMFLOAT4X4)), BufferDeleter{ factory });
+
+	resources.vertexShader = FakeName<ID3D11VertexShader>(0);
+	resources.skyVertexShader = FakeName<ID3D11VertexShader>(1);
+	resources.instancedVertexShader = FakeName<ID3D11VertexShader>(2);
+	resources.vertexLayout = FakeName<ID3D11InputLayout>(3);
+	resources.splitVertexLayout = FakeName<ID3D11InputLayout>(4);
+	resources.positionVertexLayout = FakeName<ID3D11InputLayout>(5);
+	resources.instancedVertexLayout = FakeName<ID3D11InputLayout>(6);
+	resources.instancedSplitVertexLayout = FakeName<ID3D11InputLayout>(7);
+	resources.texture = FakeName<ID3D11ShaderResourceView>(8);
+	resources.skyTexture = FakeName<ID3D11ShaderResourceView>(9);
+	resources.sampler = FakeName<ID3D11SamplerState>(10);
+	resources.skyDepthState = FakeName<ID3D11DepthStencilState>(11);
+	resources.frameConstants = m_frameConstants.get();
+	resources.objectConstants = m_objectConstants.get();
+	resources.pixelConstants = m_pixelConstants.get();
+	resources.constantRing = m_constantRing.get();
+	resources.constantRingSize = 1 << 20;
+	resources.instanceBuffer = m_instances.get();
+	resources.instanceCapacity = 4096;
+
+	shaders = { FakeName<ID3D11PixelShader>(12), FakeName<ID3D11PixelShader>(13), FakeName<ID3D11PixelShader>(14), FakeName<ID3D11PixelShader>(15) };
+	skyShader = FakeName<ID3D11PixelShader>(16);
+}
+
+RenderResources testing::SoftwareDemoResources(SoftwareRenderDevice& device)
+{
+	auto resources = device.Resources();
+
+	const auto brick = std::filesystem::path(__FILE__).parent_path().parent_path() / "directx_test" / "brick.dds";
+	resources.texture = device.CreateTexture(SoftwareTexture::LoadDds(brick.wstring()));
+
+	constexpr UINT size = 32;
+	const DirectX::XMFLOAT4 tints[6] = { { 1.f, .6f, .5f, 1.f }, { .5f, 1.f, .6f, 1.f }, { .6f, .8f, 1.f, 1.f },
+		{ .3f, .3f, .4f, 1.f }, { 1.f, 1.f, .6f, 1.f }, { .8f, .5f, 1.f, 1.f } };
+	std::vector<DirectX::XMFLOAT4> texels;
+	texels.reserve(6 * size * size);
+
+	for (const auto& tint : tints)
+	{
+		for (UINT y = 0; y < size; y++)
+		{
+			for (UINT x = 0; x < size; x++)
+			{
+				const float shade = 0.4f + 0.6f * float(y) / size;
+				texels.push_back({ tint.x * shade, tint.y * shade, tint.z * shade, 1.f });
+			}
+		}
+	}
+
+	resources.skyTexture = device.CreateTexture(SoftwareTexture(size, size, 6, std::move(texels)));
+
+	return resources;
+}
+
+DemoShaders testing::SoftwareDemoShaders(const SoftwareRenderDevice& device)
+{
+	return { device.PixelShader(PixelKernel::PS), device.PixelShader(PixelKernel::PSSolid), device.PixelShader(PixelKernel::PSTexture),
+		device.PixelShader(PixelKernel::PSCustom) };
+}
+
+testing::DemoHarness::DemoHarness(RenderDevice* device, BufferFactory* factory, const RenderResources& resources,
+	const DemoShaders& shaders, ID3D11PixelShader* skyShader, int width, int height)
+	: renderer(device, resources, width, height), pool(factory), geometry(factory),
+	scene(factory, pool, geometry, shaders, WriteDemoModel().wstring())
+{
+	renderer.SetSky(scene.Sky(), skyShader);
+}
+
+void testing::DemoHarness::Frame()
+{
+	scene.Frame(renderer, m_time, frameTime);
+	m_time += frameTime;
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <filesystem>
+#include "BufferPool.h"
+#include "DemoScene.h"
+#include "GeometryBuffer.h"
+#include "HeadlessBufferFactory.h"
+#include "SceneRenderer.h"
+#include "SoftwareRenderDevice.h"
+
+namespace testing
+{
+	// A stand-in for Padlock.obj, which is not in the repository: a bumpy 64 x 64 grid without
+	// normals, written to the scratch directory of the running test.
+	std::filesystem::path WriteDemoModel();
+
+	// Distinct names for shaders, layouts and states on devices that never dereference them.
+	template<class T>
+	T* FakeName(int index) noexcept
+	{
+		static char names[64];
+		return reinterpret_cast<T*>(names + index);
+	}
+
+	// A HeadlessBufferFactory whose static buffers get names of their own as well, so a recording
+	// tells the cube's position stream from its attributes and the model's buffers from the cylinder's.
+	class NamedBufferFactory : public HeadlessBufferFactory
+	{
+	public:
+
+		[[nodiscard]] GpuBuffer* CreateStaticBuffer(const void* data, UINT byteWidth, UINT bindFlags) override
+		{
+			(void)HeadlessBufferFactory::CreateStaticBuffer(data, byteWidth, bindFlags);
+			return CreatePooledBuffer(byteWidth, bindFlags);
+		}
+	};
+
+	// What Graphics hands SceneRenderer, every shader, layout and state a fake name and the constant,
+	// ring and instance buffers made by factory at the sizes Graphics uses.
+	class FakeRenderResources
+	{
+	public:
+
+		explicit FakeRenderResources(BufferFactory* factory);
+
+		RenderResources resources;
+		DemoShaders shaders;
+		ID3D11PixelShader* skyShader = nullptr;
+
+	private:
+
+		UniqueBuffer m_frameConstants;
+		UniqueBuffer m_objectConstants;
+		UniqueBuffer m_pixelConstants;
+		UniqueBuffer m_constantRing;
+		UniqueBuffer m_instances;
+	};
+
+	// The device's own resources and Light.fx kernels, with brick.dds as the texture and a cube map of six
+	// tinted gradients as the sky.
+	RenderResources SoftwareDemoResources(SoftwareRenderDevice& device);
+	DemoShaders SoftwareDemoShaders(const SoftwareRenderDevice& device);
+
+	// WinMain's scene and renderer on device, by default at WinMain's 1600 x 900, with the sky set,
+	// advanced one 60 Hz frame at a time.
+	class DemoHarness
+	{
+	public:
+
+		DemoHarness(RenderDevice* device, BufferFactory* factory, const RenderResources& resources, const DemoShaders& shaders,
+			ID3D11PixelShader* skyShader, int width = 1600, int height = 900);
+
+		// Draws the next frame the way WinMain's loop does, without the text overlay.
+		void Frame();
+
+		SceneRenderer renderer;
+		BufferPool pool;
+		GeometryBuffer geometry;
+		DemoScene scene;
+
+	private:
+
+		float m_time = 0.f;
+	};
+}
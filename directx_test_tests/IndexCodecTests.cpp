@@ -0,0 +1,149 @@
+#include "TestFramework.h"
+#include "IndexCodec.h"
+#include "Timer.h"
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+
+namespace
+{
+	// a size x size grid of quads, row by row, which is close to what IndexOptimizer hands the codec
+	std::vector<UINT> Grid(UINT size)
+	{
+		std::vector<UINT> indices;
+		indices.reserve(size_t(size) * size * 6);
+
+		for (UINT y = 0; y < size; y++)
+		{
+			for (UINT x = 0; x < size; x++)
+			{
+				const UINT i = y * (size + 1) + x;
+				indices.insert(indices.end(), { i, i + 1, i + size + 2, i, i + size + 2, i + size + 1 });
+			}
+		}
+
+		return indices;
+	}
+
+	// triangles may come back rotated, so each one is compared in every rotation
+	bool SameTriangles(const std::vector<UINT>& expected, const std::vector<UINT>& actual)
+	{
+		if (expected.size() != actual.size())
+			return false;
+
+		for (size_t t = 0; t < expected.size(); t += 3)
+		{
+			const UINT* e = &expected[t];
+			const UINT* a = &actual[t];
+
+			if (!(e[0] == a[0] && e[1] == a[1] && e[2] == a[2]) && !(e[0] == a[1] && e[1] == a[2] && e[2] == a[0])
+				&& !(e[0] == a[2] && e[1] == a[0] && e[2] == a[1]))
+				return false;
+		}
+
+		return true;
+	}
+}
+
+TEST(IndexCodec, RoundTripsGrid)
+{
+	const auto indices = Grid(64);
+	const auto encoded = IndexCodec::Encode(indices);
+
+	std::vector<UINT> decoded;
+	REQUIRE(IndexCodec::Decode(encoded.data(), encoded.size(), decoded));
+	CHECK(SameTriangles(indices, decoded));
+
+	// under half of what 16-bit indices take, even though each row reaches back past the vertex FIFO
+	CHECK(encoded.size() < indices.size() / 3 * 3);
+}
+
+TEST(IndexCodec, RoundTripsShuffledTriangles)
+{
+	auto indices = Grid(64);
+
+	std::vector<size_t> order(indices.size() / 3);
+	for (size_t t = 0; t < order.size(); t++)
+		order[t] = t;
+	std::shuffle(order.begin(), order.end(), std::mt19937(7));
+
+	std::vector<UINT> shuffled;
+	for (const auto t : order)
+		shuffled.insert(shuffled.end(), { indices[t * 3], indices[t * 3 + 1], indices[t * 3 + 2] });
+
+	const auto encoded = IndexCodec::Encode(shuffled);
+
+	std::vector<UINT> decoded;
+	REQUIRE(IndexCodec::Decode(encoded.data(), encoded.size(), decoded));
+	CHECK(SameTriangles(shuffled, decoded));
+}
+
+TEST(IndexCodec, RoundTripsEmpty)
+{
+	const auto encoded = IndexCodec::Encode({});
+
+	std::vector<UINT> decoded{ 1, 2, 3 };
+	CHECK(IndexCodec::Decode(encoded.data(), encoded.size(), decoded));
+	CHECK(decoded.empty());
+}
+
+TEST(IndexCodec, EncodeRejectsPartialTriangles)
+{
+	for (const auto& indices : { std::vector<UINT>{ 0 }, std::vector<UINT>{ 0, 1, 2, 3 }, std::vector<UINT>{ 0, 1, 2, 2, 1 } })
+	{
+		bool threw = false;
+
+		try
+		{
+			(void)IndexCodec::Encode(indices);
+		}
+		catch (const std::runtime_error&)
+		{
+			threw = true;
+		}
+
+		CHECK(threw);
+	}
+}
+
+TEST(IndexCodec, RejectsTruncatedData)
+{
+	const auto encoded = IndexCodec::Encode(Grid(8));
+	std::vector<UINT> decoded;
+
+	for (size_t size = 0; size < encoded.size(); size++)
+		CHECK(!IndexCodec::Decode(encoded.data(), size, decoded));
+}
+
+TEST(IndexCodec, RejectsCountBeyondData)
+{
+	auto encoded = IndexCodec::Encode(Grid(1));
+
+	// claims a billion triangles in a couple of bytes; has to fail without trying to allocate 12 GB
+	const uint32_t count = 3000000000u;
+	std::memcpy(encoded.data() + 5, &count, sizeof(count));
+
+	std::vector<UINT> decoded;
+	CHECK(!IndexCodec::Decode(encoded.data(), encoded.size(), decoded));
+	CHECK(decoded.capacity() < 1000);
+}
+
+BENCHMARK(IndexCodec, Throughput)
+{
+	const auto indices = Grid(1024);
+	const double megabytes = indices.size() * sizeof(UINT) / 1e6;
+
+	Timer timer;
+	const auto encoded = IndexCodec::Encode(indices);
+	const float encodeTime = timer.Mark();
+
+	std::vector<UINT> decoded;
+	const bool ok = IndexCodec::Decode(encoded.data(), encoded.size(), decoded);
+	const float decodeTime = timer.Mark();
+
+	CHECK(ok);
+	testing::Report("%zu triangles, %.2f bytes per triangle (%.1f%% of 32-bit indices)",
+		indices.size() / 3, double(encoded.size()) / (indices.size() / 3), 100.0 * encoded.size() / (indices.size() * sizeof(UINT)));
+	testing::Report("encode %.0f MB/s, decode %.0f MB/s of 32-bit indices", megabytes / encodeTime, megabytes / decodeTime);
+}
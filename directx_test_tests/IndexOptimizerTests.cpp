@@ -0,0 +1,216 @@
+#include "TestFramework.h"
+#include "IndexOptimizer.h"
+#include "DemoHarness.h"
+#include "ObjParser.h"
+#include "Primitives.h"
+#include "SphereGenerator.h"
+#include <DirectXColors.h>
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+namespace
+{
+	// n triangles of a strip, as a list: every triangle after the first brings one new vertex
+	std::vector<UINT> Strip(UINT triangles)
+	{
+		std::vector<UINT> indices;
+
+		for (UINT i = 0; i < triangles; i++)
+		{
+			if (i % 2 == 0)
+				indices.insert(indices.end(), { i, i + 1, i + 2 });
+			else
+				indices.insert(indices.end(), { i + 1, i, i + 2 });
+		}
+
+		return indices;
+	}
+
+	// what Mesh::Optimize makes of the mesh, and which of its passes it kept
+	void ReportOptimized(const char* name, std::vector<SimpleVertex> vertices, std::vector<UINT> indices)
+	{
+		constexpr const char* orders[] = { "all", "cache+fetch", "fetch", "none" };
+		const auto result = IndexOptimizer::Optimize(vertices, indices);
+
+		testing::Report("%-18s %7zu triangles: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f, fetch misses %.3f -> %.3f, overfetch %.3f -> %.3f, kept %s",
+			name, result.cacheBefore.triangles, result.cacheBefore.Acmr(), result.cacheAfter.Acmr(), result.cacheBefore.Atvr(),
+			result.cacheAfter.Atvr(), result.fetchBefore.MissRate(), result.fetchAfter.MissRate(), result.fetchBefore.overfetch,
+			result.fetchAfter.overfetch, orders[int(result.kept)]);
+	}
+
+	// every triangle as its three corner positions, rotated to start at the smallest, in sorted order
+	std::vector<std::array<float, 9>> Triangles(const std::vector<SimpleVertex>& vertices, const std::vector<UINT>& indices)
+	{
+		std::vector<std::array<float, 9>> triangles;
+
+		for (size_t i = 0; i + 2 < indices.size(); i += 3)
+		{
+			std::array<std::array<float, 3>, 3> corners;
+
+			for (int c = 0; c < 3; c++)
+			{
+				const auto& p = vertices[indices[i + c]].position;
+				corners[c] = { p.x, p.y, p.z };
+			}
+
+			std::rotate(corners.begin(), std::min_element(corners.begin(), corners.end()), corners.end());
+
+			auto& triangle = triangles.emplace_back();
+			for (int c = 0; c < 3; c++)
+				std::copy(corners[c].begin(), corners[c].end(), triangle.begin() + 3 * c);
+		}
+
+		std::sort(triangles.begin(), triangles.end());
+
+		return triangles;
+	}
+}
+
+TEST(IndexOptimizer, SharedQuadTransformsEachVertexOnce)
+{
+	const std::vector<UINT> quad = { 0, 1, 2, 0, 2, 3 };
+	const auto stats = IndexOptimizer::AnalyzeVertexCache(quad, 4);
+
+	CHECK(stats.triangles == 2);
+	CHECK(stats.transforms == 4);
+	CHECK(stats.uniqueVertices == 4);
+	CHECK(stats.Acmr() == 2.f);
+	CHECK(stats.Atvr() == 1.f);
+}
+
+TEST(IndexOptimizer, StripMissesOncePerTriangle)
+{
+	const auto strip = Strip(10);
+	const auto stats = IndexOptimizer::AnalyzeVertexCache(strip, 12);
+
+	// the first triangle's three vertices, then one per triangle
+	CHECK(stats.transforms == 12);
+	CHECK_NEAR(stats.Acmr(), 1.2, 1e-6);
+	CHECK(stats.Atvr() == 1.f);
+
+	// the same triangles with no vertex shared are three misses each
+	std::vector<UINT> separate(30);
+	for (UINT i = 0; i < 30; i++)
+		separate[i] = i;
+
+	CHECK(IndexOptimizer::AnalyzeVertexCache(separate, 30).Acmr() == 3.f);
+}
+
+TEST(IndexOptimizer, FifoAndLruCachesDiffer)
+{
+	// a fan whose hub is evicted from a three entry FIFO but kept fresh by LRU
+	const std::vector<UINT> fan = { 0, 1, 2, 0, 3, 4, 0, 5, 6 };
+
+	CHECK(IndexOptimizer::AnalyzeVertexCache(fan, 7, 3, CacheModel::Fifo).transforms == 8);
+	CHECK(IndexOptimizer::AnalyzeVertexCache(fan, 7, 3, CacheModel::Lru).transforms == 7);
+	// a cache big enough for the whole fan shades each vertex once either way
+	CHECK(IndexOptimizer::AnalyzeVertexCache(fan, 7, 16, CacheModel::Fifo).transforms == 7);
+}
+
+TEST(IndexOptimizer, FetchCountsMemoryLines)
+{
+	// four 16 byte vertices to a 64 byte line
+	constexpr size_t vertexSize = 16;
+
+	// in order, each line is fetched once
+	std::vector<UINT> inOrder(64);
+	for (UINT i = 0; i < 64; i++)
+		inOrder[i] = i;
+
+	const auto streamed = IndexOptimizer::AnalyzeVertexFetch(inOrder, 64, vertexSize);
+	CHECK(streamed.lineRequests == 64);
+	CHECK(streamed.lineFetches == 16);
+	CHECK(streamed.bytesFetched == 1024);
+	CHECK(streamed.overfetch == 1.f);
+
+	// jumping between three lines with room for one in the cache fetches a line per vertex
+	std::vector<UINT> jumping;
+	for (UINT i = 0; i < 16; i++)
+		jumping.insert(jumping.end(), { i, i + 16, i + 32 });
+
+	const auto thrashed = IndexOptimizer::AnalyzeVertexFetch(jumping, 64, vertexSize, 64, 1);
+	CHECK(thrashed.lineFetches == 48);
+	CHECK(thrashed.MissRate() == 1.f);
+	CHECK(thrashed.overfetch == 3.f);
+
+	// with the default 256 lines, only the 12 lines touched are fetched
+	CHECK(IndexOptimizer::AnalyzeVertexFetch(jumping, 64, vertexSize).lineFetches == 12);
+
+	// a 48 byte vertex straddling two lines asks for both
+	CHECK(IndexOptimizer::AnalyzeVertexFetch({ 1, 1, 1 }, 2, 48).lineRequests == 2);
+}
+
+TEST(IndexOptimizer, OptimizeNeverMakesMeshesWorse)
+{
+	const auto check = [](std::vector<SimpleVertex> vertices, std::vector<UINT> indices)
+	{
+		const auto triangles = Triangles(vertices, indices);
+		const auto cache = IndexOptimizer::AnalyzeVertexCache(indices, vertices.size());
+		const auto fetch = IndexOptimizer::AnalyzeVertexFetch(indices, vertices.size(), sizeof(SimpleVertex));
+
+		const auto result = IndexOptimizer::Optimize(vertices, indices);
+
+		CHECK(IndexOptimizer::AnalyzeVertexCache(indices, vertices.size()).Acmr() <= cache.Acmr());
+		CHECK(IndexOptimizer::AnalyzeVertexFetch(indices, vertices.size(), sizeof(SimpleVertex)).overfetch <= fetch.overfetch);
+		CHECK(result.cacheAfter.transforms == IndexOptimizer::AnalyzeVertexCache(indices, vertices.size()).transforms);
+		// the same triangles, wound the same way, whatever order they are in now
+		CHECK(Triangles(vertices, indices) == triangles);
+	};
+
+	for (const int size : { 8, 64, 128 })
+	{
+		for (const auto normals : { SphereNormals::Smooth, SphereNormals::Faceted })
+		{
+			std::vector<SimpleVertex> vertices;
+			std::vector<UINT> indices;
+			SphereGenerator::Generate(size, size / 2, DirectX::Colors::White, normals, vertices, indices);
+			check(vertices, indices);
+		}
+	}
+
+	for (const auto& primitive : { Primitives::Cube(), Primitives::Tube(), Primitives::Cylinder(), Primitives::Cone(),
+		Primitives::Torus(), Primitives::Plane(), Primitives::Icosphere() })
+	{
+		check({ primitive.vertices.begin(), primitive.vertices.end() }, { primitive.indices.begin(), primitive.indices.end() });
+	}
+}
+
+TEST(IndexOptimizer, LinearGridKeepsItsFetchOrder)
+{
+	// the demo model's rows are already in order; reordering them for the cache costs fetch bandwidth
+	std::vector<SimpleVertex> vertices;
+	std::vector<UINT> indices;
+	ObjParser::Load(testing::WriteDemoModel().wstring(), vertices, indices);
+
+	const auto result = IndexOptimizer::Optimize(vertices, indices);
+
+	CHECK(result.kept != OptimizePasses::All);
+	CHECK(result.fetchAfter.overfetch <= result.fetchBefore.overfetch);
+	CHECK(result.cacheAfter.transforms <= result.cacheBefore.transforms);
+}
+
+// ACMR, ATVR and fetch of the generated spheres and the demo model, as generated and after Mesh::Optimize.
+BENCHMARK(IndexOptimizer, SpheresAndModel)
+{
+	for (const int size : { 16, 32, 64, 128, 256 })
+	{
+		for (const auto& [name, normals] : { std::pair("smooth", SphereNormals::Smooth), std::pair("faceted", SphereNormals::Faceted) })
+		{
+			std::vector<SimpleVertex> vertices;
+			std::vector<UINT> indices;
+			SphereGenerator::Generate(size, size, DirectX::Colors::White, normals, vertices, indices);
+
+			char label[32];
+			std::snprintf(label, sizeof(label), "sphere %d %s", size, name);
+			ReportOptimized(label, std::move(vertices), std::move(indices));
+		}
+	}
+
+	std::vector<SimpleVertex> vertices;
+	std::vector<UINT> indices;
+	ObjParser::Load(testing::WriteDemoModel().wstring(), vertices, indices);
+	ReportOptimized("demo model", std::move(vertices), std::move(indices));
+}
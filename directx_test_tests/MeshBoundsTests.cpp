@@ -0,0 +1,159 @@
+#include "TestFramework.h"
+#include "MeshBounds.h"
+#include "Mesh.h"
+#include "HeadlessBufferFactory.h"
+#include "Timer.h"
+#include <DirectXColors.h>
+#include <algorithm>
+#include <cfloat>
+#include <random>
+
+using namespace DirectX;
+
+namespace
+{
+	Mesh Sphere(BufferFactory* factory, int slices, int stacks, VertexLayout layout)
+	{
+		Mesh mesh(factory);
+		mesh.SetVertexLayout(layout);
+		mesh.MakeSphere(slices, stacks, Colors::White, SphereNormals::Smooth);
+		return mesh;
+	}
+
+	bool Contains(const MeshBounds& bounds, const XMFLOAT3& point)
+	{
+		// a little slack for the rounding of center and extents
+		const auto p = XMLoadFloat3(&point);
+		const auto& center = bounds.box.Center;
+		const auto& extents = bounds.box.Extents;
+		const bool inBox = std::abs(point.x - center.x) <= extents.x + 1e-5f && std::abs(point.y - center.y) <= extents.y + 1e-5f
+			&& std::abs(point.z - center.z) <= extents.z + 1e-5f;
+		const float distance = XMVectorGetX(XMVector3Length(XMVectorSubtract(p, XMLoadFloat3(&bounds.sphere.Center))));
+
+		return inBox && distance <= bounds.sphere.Radius * 1.0001f + 1e-5f;
+	}
+
+	// rays from a shell around the unit sphere toward random points near its middle
+	std::vector<std::pair<XMFLOAT3, XMFLOAT3>> Rays(size_t count)
+	{
+		std::mt19937 random(18);
+		std::uniform_real_distribution<float> unit(-1.f, 1.f);
+		std::vector<std::pair<XMFLOAT3, XMFLOAT3>> rays(count);
+
+		for (auto& [origin, direction] : rays)
+		{
+			const auto from = XMVectorScale(XMVector3Normalize(XMVectorSet(unit(random), unit(random), unit(random), 0.f)), 3.f);
+			const auto to = XMVectorScale(XMVectorSet(unit(random), unit(random), unit(random), 0.f), 0.1f);
+			XMStoreFloat3(&origin, from);
+			XMStoreFloat3(&direction, XMVector3Normalize(XMVectorSubtract(to, from)));
+		}
+
+		return rays;
+	}
+}
+
+TEST(MeshBounds, BothLayoutsEncloseEveryVertex)
+{
+	HeadlessBufferFactory factory;
+	const auto interleaved = Sphere(&factory, 64, 32, VertexLayout::Interleaved);
+	const auto split = Sphere(&factory, 64, 32, VertexLayout::Split);
+
+	REQUIRE(split.Positions().size() == split.Vertices().size());
+	CHECK(interleaved.Positions().empty());
+
+	const auto& a = interleaved.Bounds();
+	const auto& b = split.Bounds();
+
+	// the same positions in either layout give the same volumes
+	CHECK(XMVector3Equal(XMLoadFloat3(&a.box.Center), XMLoadFloat3(&b.box.Center)));
+	CHECK(XMVector3Equal(XMLoadFloat3(&a.box.Extents), XMLoadFloat3(&b.box.Extents)));
+	CHECK(a.sphere.Radius == b.sphere.Radius);
+
+	for (const auto& v : interleaved.Vertices())
+		CHECK(Contains(a, v.position));
+
+	// close to the unit sphere it was built as
+	CHECK_NEAR(a.sphere.Radius, 1.0, 0.05);
+}
+
+TEST(MeshBounds, EmptyAtTheOrigin)
+{
+	const auto bounds = MeshBounds::Compute(std::span<const XMFLOAT3>());
+
+	CHECK(bounds.sphere.Radius == 0.f);
+	CHECK(bounds.box.Extents.x == 0.f);
+}
+
+TEST(MeshBounds, RaycastAgreesAcrossLayouts)
+{
+	HeadlessBufferFactory factory;
+	const auto interleaved = Sphere(&factory, 64, 32, VertexLayout::Interleaved);
+	const auto split = Sphere(&factory, 64, 32, VertexLayout::Split);
+
+	size_t hits = 0;
+
+	for (const auto& [origin, direction] : Rays(64))
+	{
+		float a = 0.f, b = 0.f;
+		const bool hitA = interleaved.Raycast(XMLoadFloat3(&origin), XMLoadFloat3(&direction), a);
+		const bool hitB = split.Raycast(XMLoadFloat3(&origin), XMLoadFloat3(&direction), b);
+
+		CHECK(hitA == hitB);
+
+		if (hitA && hitB)
+		{
+			CHECK(a == b);
+			hits++;
+		}
+	}
+
+	// every ray aims inside the sphere
+	CHECK(hits == 64);
+}
+
+// Bounds and ray casts over the tight position stream against the same work over whole vertices.
+BENCHMARK(MeshBounds, SplitAgainstInterleaved)
+{
+	HeadlessBufferFactory factory;
+	const auto interleaved = Sphere(&factory, 1024, 1024, VertexLayout::Interleaved);
+	const auto split = Sphere(&factory, 1024, 1024, VertexLayout::Split);
+	const auto rays = Rays(16);
+
+	const auto best = [](auto&& work)
+	{
+		float time = FLT_MAX;
+
+		for (int run = 0; run < 3; run++)
+		{
+			Timer timer;
+			work();
+			time = std::min(time, timer.Peek());
+		}
+
+		return time;
+	};
+
+	const float boundsInterleaved = best([&] { testing::Consume(MeshBounds::Compute(interleaved.Vertices())); });
+	const float boundsSplit = best([&] { testing::Consume(MeshBounds::Compute(split.Positions())); });
+
+	const auto cast = [&](const Mesh& mesh)
+	{
+		float distance = 0.f;
+
+		for (const auto& [origin, direction] : rays)
+			mesh.Raycast(XMLoadFloat3(&origin), XMLoadFloat3(&direction), distance);
+
+		testing::Consume(distance);
+	};
+
+	const float raysInterleaved = best([&] { cast(interleaved); });
+	const float raysSplit = best([&] { cast(split); });
+
+	const size_t vertices = interleaved.Vertices().size();
+	const size_t triangles = interleaved.Indices().size() / 3;
+
+	testing::Report("bounds of %zu vertices: interleaved %.2f ms, split %.2f ms (x%.2f)",
+		vertices, boundsInterleaved * 1000.f, boundsSplit * 1000.f, boundsInterleaved / boundsSplit);
+	testing::Report("%zu rays over %zu triangles: interleaved %.2f ms, split %.2f ms (x%.2f)",
+		rays.size(), triangles, raysInterleaved * 1000.f, raysSplit * 1000.f, raysInterleaved / raysSplit);
+}
@@ -0,0 +1,175 @@
+#include "TestFramework.h"
+#include "MeshBuilder.h"
+#include "Mesh.h"
+#include "HeadlessBufferFactory.h"
+#include "SphereGenerator.h"
+#include "Timer.h"
+#include <DirectXColors.h>
+#include <algorithm>
+#include <cfloat>
+
+using namespace DirectX;
+
+namespace
+{
+	constexpr size_t GridVertices(int size) noexcept { return size_t(size + 1) * (size + 1); }
+	constexpr size_t GridIndices(int size) noexcept { return size_t(6) * size * size; }
+
+	SimpleVertex GridVertex(int size, int x, int y)
+	{
+		return { { float(x), float(y), 0.f }, { 1.f, 1.f, 1.f }, { 0.f, 0.f, 1.f }, { float(x) / size, float(y) / size } };
+	}
+
+	// one vertex and one quad at a time, the way a hand-written generator goes
+	void AddGrid(int size, MeshBuilder& builder)
+	{
+		const UINT base = UINT(builder.VertexCount());
+
+		for (int y = 0; y <= size; y++)
+		{
+			for (int x = 0; x <= size; x++)
+				builder.AddVertex(GridVertex(size, x, y));
+		}
+
+		for (int y = 0; y < size; y++)
+		{
+			for (int x = 0; x < size; x++)
+			{
+				const UINT a = base + UINT(y * (size + 1) + x);
+				builder.AddQuad(a, a + 1, a + UINT(size) + 2, a + UINT(size) + 1);
+			}
+		}
+	}
+
+	// the same grid written in place through the builder's cursors
+	void WriteGrid(int size, MeshBuilder& builder)
+	{
+		const UINT base = UINT(builder.VertexCount());
+		const auto vertices = builder.WriteVertices(GridVertices(size));
+		const auto indices = builder.WriteIndices(GridIndices(size));
+
+		for (int y = 0; y <= size; y++)
+		{
+			for (int x = 0; x <= size; x++)
+				vertices[size_t(y) * (size + 1) + x] = GridVertex(size, x, y);
+		}
+
+		UINT* index = indices.data();
+
+		for (int y = 0; y < size; y++)
+		{
+			for (int x = 0; x < size; x++)
+			{
+				const UINT a = base + UINT(y * (size + 1) + x), b = a + 1, c = a + UINT(size) + 2, d = a + UINT(size) + 1;
+				*index++ = a; *index++ = b; *index++ = c;
+				*index++ = a; *index++ = c; *index++ = d;
+			}
+		}
+	}
+
+	testing::AllocationCount Since(const testing::AllocationCount& start)
+	{
+		const auto now = testing::Allocations();
+		return { now.count - start.count, now.bytes - start.bytes };
+	}
+}
+
+TEST(MeshBuilder, ReservedAppendsAllocateNothing)
+{
+	MeshBuilder builder(GridVertices(32) * 2, GridIndices(32) * 2);
+
+	const auto start = testing::Allocations();
+	AddGrid(32, builder);
+	WriteGrid(32, builder);
+	const auto allocated = Since(start);
+
+	CHECK(allocated.count == 0);
+	CHECK(builder.Reallocations() == 0);
+	CHECK(builder.VertexCount() == GridVertices(32) * 2);
+	CHECK(builder.IndexCount() == GridIndices(32) * 2);
+}
+
+TEST(MeshBuilder, MissedReservationsAreCounted)
+{
+	MeshBuilder builder;
+	AddGrid(32, builder);
+
+	// geometric growth: a handful per vector, not one per element
+	CHECK(builder.Reallocations() > 0);
+	CHECK(builder.Reallocations() < 40);
+}
+
+TEST(MeshBuilder, AppendedRangesAreShiftedByTheirBase)
+{
+	MeshBuilder builder;
+	const SimpleVertex corners[3] = {};
+	const UINT triangle[3] = { 0, 1, 2 };
+
+	builder.AppendVertices(corners);
+	builder.AppendIndices(triangle);
+	const UINT base = builder.AppendVertices(corners);
+	builder.AppendIndices(triangle, base);
+
+	std::vector<SimpleVertex> vertices;
+	std::vector<UINT> indices;
+	builder.Finish(vertices, indices);
+
+	CHECK(base == 3);
+	CHECK((indices == std::vector<UINT>{ 0, 1, 2, 3, 4, 5 }));
+	CHECK(builder.VertexCount() == 0);
+}
+
+TEST(MeshBuilder, FinishMovesTheVerticesIntoTheMesh)
+{
+	HeadlessBufferFactory factory;
+	MeshBuilder builder;
+	SphereGenerator::Generate(64, 32, Colors::White, SphereNormals::Smooth, builder);
+
+	// an empty write points just past the vertices
+	const size_t count = builder.VertexCount();
+	const SimpleVertex* vertices = builder.WriteVertices(0).data() - count;
+
+	Mesh mesh(&factory);
+	builder.Finish(mesh);
+
+	CHECK(builder.Reallocations() == 0);
+	CHECK(mesh.Vertices().size() == count);
+	CHECK(mesh.Vertices().data() == vertices);
+}
+
+// Grid and sphere generators with and without a reservation: time, reallocations and heap allocations.
+BENCHMARK(MeshBuilder, Generators)
+{
+	constexpr int gridSize = 512;
+	constexpr int slices = 1024, stacks = 512;
+
+	const auto run = [](const char* name, auto&& build)
+	{
+		float best = FLT_MAX;
+		size_t reallocations = 0;
+		testing::AllocationCount allocated;
+
+		for (int i = 0; i < 5; i++)
+		{
+			MeshBuilder builder;
+			const auto start = testing::Allocations();
+			Timer timer;
+
+			build(builder);
+
+			best = std::min(best, timer.Peek());
+			allocated = Since(start);
+			reallocations = builder.Reallocations();
+			testing::Consume(builder);
+		}
+
+		testing::Report("%-36s %7.2f ms, %3zu reallocations, %3zu heap allocations (%.1f MB)",
+			name, best * 1000.f, reallocations, allocated.count, allocated.bytes / (1024.0 * 1024.0));
+	};
+
+	run("grid, one at a time, no reserve", [](MeshBuilder& b) { AddGrid(gridSize, b); });
+	run("grid, one at a time, reserved", [](MeshBuilder& b) { b.Reserve(GridVertices(gridSize), GridIndices(gridSize)); AddGrid(gridSize, b); });
+	run("grid, written in place", [](MeshBuilder& b) { b.Reserve(GridVertices(gridSize), GridIndices(gridSize)); WriteGrid(gridSize, b); });
+	// the sphere reserves for itself; its ring positions, sin/cos tables and worker threads account for the other allocations
+	run("sphere, written in place", [](MeshBuilder& b) { SphereGenerator::Generate(slices, stacks, Colors::White, SphereNormals::Smooth, b); });
+}
@@ -0,0 +1,185 @@
+#include "TestFramework.h"
+#include "MeshCache.h"
+#include "HeadlessBufferFactory.h"
+#include "Mesh.h"
+#include "Timer.h"
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <utility>
+
+namespace
+{
+	void WriteText(const std::filesystem::path& path, const char* text)
+	{
+		std::ofstream(path, std::ios::binary | std::ios::trunc) << text;
+	}
+
+	// a quad; the cache never looks at what the source contains, only at its size, time and hash
+	void WriteCache(const std::wstring& source, std::vector<SimpleVertex>& vertices, std::vector<UINT>& indices)
+	{
+		vertices.resize(4);
+		vertices[0].position = { -1.f, -2.f, 0.f };
+		vertices[1].position = { 1.f, -2.f, 0.f };
+		vertices[2].position = { 1.f, 2.f, 0.5f };
+		vertices[3].position = { -1.f, 2.f, 0.5f };
+		indices = { 0, 1, 2, 0, 2, 3 };
+
+		CHECK(MeshCache::Write(source, vertices, indices));
+	}
+
+	// a size x size bumpy grid with positions only, so a cold load also generates normals
+	void WriteGridObj(const std::filesystem::path& path, int size)
+	{
+		std::ofstream file(path);
+
+		for (int z = 0; z <= size; z++)
+		{
+			for (int x = 0; x <= size; x++)
+				file << "v " << x << ' ' << std::sin(x * 0.3f) * std::cos(z * 0.2f) << ' ' << z << '\n';
+		}
+
+		for (int z = 0; z < size; z++)
+		{
+			for (int x = 0; x < size; x++)
+			{
+				const int a = z * (size + 1) + x + 1, b = a + 1, c = a + size + 1, d = c + 1;
+				file << "f " << a << ' ' << c << ' ' << b << '\n' << "f " << b << ' ' << c << ' ' << d << '\n';
+			}
+		}
+	}
+}
+
+TEST(MeshCache, RoundTripsGeometryAndBounds)
+{
+	const auto source = (testing::ScratchDirectory() / "quad.obj").wstring();
+	WriteText(source, "quad");
+
+	std::vector<SimpleVertex> vertices;
+	std::vector<UINT> indices;
+	WriteCache(source, vertices, indices);
+
+	MeshCache cache(source);
+	REQUIRE(cache.Open());
+
+	CHECK(cache.Vertices().size() == 4);
+	CHECK(cache.Vertices()[2].position.z == 0.5f);
+
+	// the codec may rotate triangles, which keeps each one's set of corners
+	std::vector<UINT> cached;
+	REQUIRE(cache.ReadIndices(cached));
+	REQUIRE(cached.size() == indices.size());
+
+	for (size_t t = 0; t < cached.size(); t += 3)
+		CHECK(std::is_permutation(cached.begin() + t, cached.begin() + t + 3, indices.begin() + t));
+
+	const auto expected = MeshBounds::Compute(vertices);
+	CHECK(cache.Bounds().box.Extents.y == expected.box.Extents.y);
+	CHECK(cache.Bounds().sphere.Radius == expected.sphere.Radius);
+}
+
+TEST(MeshCache, TouchedSourceRefreshesStoredStamp)
+{
+	const auto source = (testing::ScratchDirectory() / "quad.obj").wstring();
+	WriteText(source, "quad");
+
+	std::vector<SimpleVertex> vertices;
+	std::vector<UINT> indices;
+	WriteCache(source, vertices, indices);
+
+	// same contents, new write time, as after a checkout
+	const auto touched = std::filesystem::last_write_time(source) + std::chrono::hours(1);
+	std::filesystem::last_write_time(source, touched);
+
+	{
+		MeshCache cache(source);
+		REQUIRE(cache.Open());
+		CHECK(cache.Header().sourceWriteTime == uint64_t(touched.time_since_epoch().count()));
+	}
+
+	// the stamp matches now, so a changed hash would go unnoticed; that is the point of skipping the hash
+	MeshCache cache(source);
+	CHECK(cache.Open());
+}
+
+TEST(MeshCache, ChangedSourceIsStale)
+{
+	const auto source = (testing::ScratchDirectory() / "quad.obj").wstring();
+	WriteText(source, "quad");
+
+	std::vector<SimpleVertex> vertices;
+	std::vector<UINT> indices;
+	WriteCache(source, vertices, indices);
+
+	const auto before = std::filesystem::last_write_time(source);
+	WriteText(source, "QUAD");
+	std::filesystem::last_write_time(source, before + std::chrono::seconds(1));
+
+	MeshCache cache(source);
+	CHECK(!cache.Open());
+
+	WriteText(source, "a longer quad");
+	CHECK(!cache.Open());
+}
+
+TEST(MeshCache, MissingOrTruncatedCacheIsStale)
+{
+	const auto directory = testing::ScratchDirectory();
+	const auto source = (directory / "quad.obj").wstring();
+	WriteText(source, "quad");
+
+	MeshCache missing(source);
+	CHECK(!missing.Open());
+
+	std::vector<SimpleVertex> vertices;
+	std::vector<UINT> indices;
+	WriteCache(source, vertices, indices);
+
+	const auto cacheFile = directory / "quad.obj.meshcache";
+	std::filesystem::resize_file(cacheFile, std::filesystem::file_size(cacheFile) - 4);
+
+	MeshCache truncated(source);
+	CHECK(!truncated.Open());
+}
+
+// Mesh::LoadFromFile on a generated OBJ with no cache beside it, which parses, welds, generates normals,
+// optimizes and writes the cache, against the same load once the cache is there.
+BENCHMARK(MeshCache, ColdAgainstWarm)
+{
+	constexpr int size = 256;
+	const auto source = testing::ScratchDirectory() / "grid.obj";
+	const auto cacheFile = std::filesystem::path(source.wstring() + L".meshcache");
+	WriteGridObj(source, size);
+
+	HeadlessBufferFactory factory;
+
+	const auto load = [&](bool cold, int runs)
+	{
+		float best = FLT_MAX;
+		size_t vertexCount = 0;
+
+		for (int i = 0; i < runs; i++)
+		{
+			if (cold)
+				std::filesystem::remove(cacheFile);
+
+			Mesh mesh(&factory);
+			Timer timer;
+			mesh.LoadFromFile(source.wstring());
+			best = std::min(best, timer.Peek());
+			vertexCount = mesh.Vertices().size();
+		}
+
+		return std::pair(best, vertexCount);
+	};
+
+	const auto [cold, coldVertices] = load(true, 3);
+	const auto [warm, warmVertices] = load(false, 10);
+
+	CHECK(coldVertices == warmVertices);
+	testing::Report("%dx%d grid, %zu vertices: source %.1f KB, cache %.1f KB", size, size, coldVertices,
+		std::filesystem::file_size(source) / 1024.0, std::filesystem::file_size(cacheFile) / 1024.0);
+	testing::Report("cold %.2f ms, warm %.2f ms, %.1fx faster", cold * 1000.f, warm * 1000.f, cold / warm);
+}
@@ -0,0 +1,183 @@
+#include "TestFramework.h"
+#include "HeadlessBufferFactory.h"
+#include "MeshLibrary.h"
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace
+{
+	// A flat size x size grid as an OBJ at height y, so grids of one size differ only in content.
+	std::wstring WriteGrid(const std::filesystem::path& directory, const char* name, int size, int y = 0)
+	{
+		const auto path = directory / name;
+		std::ofstream file(path);
+
+		for (int z = 0; z <= size; z++)
+			for (int x = 0; x <= size; x++)
+				file << "v " << x << ' ' << y << ' ' << z << '\n';
+
+		for (int z = 0; z < size; z++)
+		{
+			for (int x = 0; x < size; x++)
+			{
+				const int a = z * (size + 1) + x + 1, b = a + 1, c = a + size + 1, d = c + 1;
+				file << "f " << a << ' ' << c << ' ' << b << '\n' << "f " << b << ' ' << c << ' ' << d << '\n';
+			}
+		}
+
+		return path.wstring();
+	}
+
+	// a Prepare that counts the meshes it is run on, i.e. the ones really loaded
+	MeshLibrary::Prepare Count(int& loads)
+	{
+		return [&loads](Mesh&) { loads++; };
+	}
+}
+
+TEST(MeshLibrary, SamePathLoadsOnce)
+{
+	const auto directory = testing::ScratchDirectory();
+	const auto path = WriteGrid(directory, "grid.obj", 4);
+
+	HeadlessBufferFactory factory;
+	MeshLibrary meshes(&factory);
+	int loads = 0;
+
+	const auto first = meshes.Load(path, Count(loads));
+	REQUIRE(first);
+	CHECK(meshes.Get(first) != nullptr);
+
+	// the same file however it is spelled
+	const auto dotted = (directory / "." / "grid.obj").wstring();
+	CHECK(meshes.Load(path, Count(loads)) == first);
+	CHECK(meshes.Load(dotted, Count(loads)) == first);
+
+	CHECK(loads == 1);
+	CHECK(meshes.ResidentCount() == 1);
+}
+
+TEST(MeshLibrary, SameContentLoadsOnce)
+{
+	const auto directory = testing::ScratchDirectory();
+	const auto original = WriteGrid(directory, "grid.obj", 4);
+	const auto copy = WriteGrid(directory, "copy.obj", 4);
+	const auto other = WriteGrid(directory, "other.obj", 4, 1);
+
+	HeadlessBufferFactory factory;
+	MeshLibrary meshes(&factory);
+	int loads = 0;
+
+	const auto first = meshes.Load(original, Count(loads));
+	CHECK(meshes.Load(copy, Count(loads)) == first);
+	CHECK(loads == 1);
+
+	// a byte apart is another mesh
+	const auto different = meshes.Load(other, Count(loads));
+	CHECK(different != first);
+	CHECK(loads == 2);
+	CHECK(meshes.ResidentCount() == 2);
+
+	// both loads hold a reference, so the mesh stays until the second is released
+	meshes.SetMemoryBudget(0);
+	meshes.Release(first);
+	CHECK(meshes.Get(first) != nullptr);
+	meshes.Release(first);
+	CHECK(meshes.Get(first) == nullptr);
+	CHECK(meshes.Get(different) != nullptr);
+}
+
+TEST(MeshLibrary, StaleHandlesResolveToNothing)
+{
+	const auto directory = testing::ScratchDirectory();
+	const auto path = WriteGrid(directory, "grid.obj", 4);
+
+	HeadlessBufferFactory factory;
+	MeshLibrary meshes(&factory);
+
+	// meshes made in code go with their last reference
+	const auto created = meshes.Create();
+	REQUIRE(meshes.Get(created) != nullptr);
+	meshes.Release(created);
+	CHECK(meshes.Get(created) == nullptr);
+	CHECK(!meshes.IsValid(created));
+
+	// the slot is reused under a new generation, which the old handle does not match
+	const auto reused = meshes.Create();
+	CHECK(reused.index == created.index);
+	CHECK(reused.generation != created.generation);
+	CHECK(meshes.Get(created) == nullptr);
+	CHECK(meshes.Get(reused) != nullptr);
+
+	// loaded meshes go when they are evicted
+	const auto loaded = meshes.Load(path);
+	meshes.Release(loaded);
+	CHECK(meshes.Get(loaded) != nullptr);
+	meshes.SetMemoryBudget(0);
+	CHECK(meshes.Get(loaded) == nullptr);
+
+	// and loading the file again gets a handle the evicted one is not
+	meshes.SetMemoryBudget(SIZE_MAX);
+	const auto reloaded = meshes.Load(path);
+	CHECK(meshes.Get(reloaded) != nullptr);
+	CHECK(reloaded != loaded);
+	CHECK(meshes.Get(loaded) == nullptr);
+
+	// releasing a stale handle leaves the mesh now in its slot alone
+	meshes.Release(loaded);
+	meshes.Release(created);
+	CHECK(meshes.Get(reloaded) != nullptr);
+	CHECK(meshes.Get(reused) != nullptr);
+
+	CHECK(meshes.Get(MeshHandle{}) == nullptr);
+}
+
+TEST(MeshLibrary, EvictsLeastRecentlyReleasedOverBudget)
+{
+	const auto directory = testing::ScratchDirectory();
+	const std::wstring paths[] = { WriteGrid(directory, "a.obj", 8), WriteGrid(directory, "b.obj", 8, 1), WriteGrid(directory, "c.obj", 8, 2) };
+
+	HeadlessBufferFactory factory;
+	MeshLibrary meshes(&factory);
+	int loads = 0;
+
+	MeshHandle handles[3];
+	for (int i = 0; i < 3; i++)
+		handles[i] = meshes.Load(paths[i], Count(loads));
+
+	const size_t each = meshes.Get(handles[0])->GpuMemory();
+	REQUIRE(each > 0);
+	CHECK(meshes.MemoryUsed() == 3 * each);
+
+	// room for two, but meshes in use are never evicted
+	meshes.SetMemoryBudget(2 * each);
+	CHECK(meshes.ResidentCount() == 3);
+
+	// released b, then a: b goes first, and only as far as needed
+	meshes.Release(handles[1]);
+	CHECK(meshes.ResidentCount() == 2);
+	CHECK(meshes.Get(handles[1]) == nullptr);
+
+	meshes.Release(handles[0]);
+	CHECK(meshes.ResidentCount() == 2);
+	CHECK(meshes.MemoryUsed() <= meshes.MemoryBudget());
+
+	// a resident mesh loads again for free and is no longer up for eviction
+	handles[0] = meshes.Load(paths[0], Count(loads));
+	CHECK(loads == 3);
+	meshes.SetMemoryBudget(each);
+	CHECK(meshes.Get(handles[0]) != nullptr);
+	CHECK(meshes.Get(handles[2]) != nullptr);
+
+	// c released under a budget it does not fit goes at once
+	meshes.Release(handles[2]);
+	CHECK(meshes.Get(handles[2]) == nullptr);
+	CHECK(meshes.ResidentCount() == 1);
+	CHECK(meshes.MemoryUsed() == each);
+
+	// b was evicted, so it is parsed again
+	handles[1] = meshes.Load(paths[1], Count(loads));
+	CHECK(loads == 4);
+	CHECK(meshes.Get(handles[1]) != nullptr);
+}
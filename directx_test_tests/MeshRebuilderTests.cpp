@@ -0,0 +1,153 @@
+#include "TestFramework.h"
+#include "DemoHarness.h"
+#include "Mesh.h"
+#include "MeshRebuilder.h"
+#include <DirectXColors.h>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	// A generator writing count vertices, noting that it ran.
+	MeshRebuilder::Generator Vertices(size_t count, std::atomic<int>& runs)
+	{
+		return [count, &runs](std::vector<SimpleVertex>& vertices, std::vector<UINT>& indices)
+		{
+			runs++;
+			vertices.resize(count);
+			indices = { 0, 1, 2 };
+		};
+	}
+
+	// PublishRebuild until the worker has something to publish, checking before every try that the
+	// mesh still draws from the buffers it had.
+	bool PublishWhenDone(Mesh& mesh, GpuBuffer* vertexBuffer, GpuBuffer* indexBuffer, bool& kept)
+	{
+		kept = true;
+
+		for (int i = 0; i < 5000; i++)
+		{
+			kept = kept && mesh.VertexBuffer() == vertexBuffer && mesh.IndexBuffer() == indexBuffer;
+
+			if (mesh.PublishRebuild())
+				return true;
+
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+		return false;
+	}
+}
+
+TEST(MeshRebuilder, BurstBuildsOnlyTheNewest)
+{
+	MeshRebuilder rebuilder(nullptr);
+	std::promise<void> started, release;
+	const auto released = release.get_future().share();
+	std::atomic<int> first = 0, superseded = 0, newest = 0;
+
+	// keeps the worker busy while the burst comes in
+	rebuilder.Request([&](std::vector<SimpleVertex>& vertices, std::vector<UINT>& indices)
+	{
+		first++;
+		started.set_value();
+		released.wait();
+		vertices.resize(1);
+	});
+
+	started.get_future().wait();
+
+	for (int i = 0; i < 20; i++)
+		rebuilder.Request(Vertices(10, superseded));
+
+	rebuilder.Request(Vertices(30, newest));
+	CHECK(rebuilder.Busy());
+	release.set_value();
+
+	while (rebuilder.Busy())
+		std::this_thread::yield();
+
+	// the first build is finished but replaced by the newest before anyone took it
+	const auto result = rebuilder.TakeFinished();
+	REQUIRE(result.has_value());
+	CHECK(result->vertices.vertices.size() == 30);
+	CHECK(first == 1);
+	CHECK(superseded == 0);
+	CHECK(newest == 1);
+	CHECK(!rebuilder.TakeFinished().has_value());
+}
+
+TEST(MeshRebuilder, OldBuffersStayBoundUntilPublished)
+{
+	// static buffers with names of their own, so a swap shows
+	testing::NamedBufferFactory factory;
+	Mesh mesh(&factory);
+	mesh.MakeSphere(16, 8, DirectX::Colors::White, SphereNormals::Smooth);
+
+	const auto vertexBuffer = mesh.VertexBuffer(), indexBuffer = mesh.IndexBuffer();
+	const auto vertexCount = mesh.Vertices().size();
+	REQUIRE(vertexBuffer && indexBuffer);
+
+	mesh.MakeSphereAsync(64, 32, DirectX::Colors::White, SphereNormals::Smooth);
+
+	bool kept = false;
+	REQUIRE(PublishWhenDone(mesh, vertexBuffer, indexBuffer, kept));
+
+	CHECK(kept);
+	CHECK(mesh.VertexBuffer() != vertexBuffer);
+	CHECK(mesh.IndexBuffer() != indexBuffer);
+	CHECK(mesh.Vertices().size() != vertexCount);
+	CHECK(mesh.Vertices().size() == SphereGenerator::VertexCount(64, 32, SphereNormals::Smooth));
+	CHECK(!mesh.PublishRebuild());
+}
+
+TEST(MeshRebuilder, PooledBuffersStayBoundUntilPublished)
+{
+	HeadlessBufferFactory factory;
+	BufferPool pool(&factory);
+	Mesh mesh(&factory);
+	mesh.SetDynamic(&pool);
+	mesh.MakeSphere(16, 8, DirectX::Colors::White, SphereNormals::Smooth);
+
+	const auto vertexBuffer = mesh.VertexBuffer(), indexBuffer = mesh.IndexBuffer();
+	REQUIRE(vertexBuffer && indexBuffer);
+
+	// built without an upload; the pooled buffers are refilled on the thread that publishes
+	mesh.MakeSphereAsync(64, 32, DirectX::Colors::White, SphereNormals::Smooth);
+
+	bool kept = false;
+	REQUIRE(PublishWhenDone(mesh, vertexBuffer, indexBuffer, kept));
+
+	CHECK(kept);
+	CHECK(mesh.Vertices().size() == SphereGenerator::VertexCount(64, 32, SphereNormals::Smooth));
+	CHECK(mesh.Indices().size() == SphereGenerator::IndexCount(64, 32));
+}
+
+TEST(MeshRebuilder, ChangingBufferKindCancelsARebuild)
+{
+	HeadlessBufferFactory factory;
+	BufferPool pool(&factory);
+	GeometryBuffer geometry(&factory);
+
+	const auto cancel = [&](auto&& change)
+	{
+		Mesh mesh(&factory);
+		mesh.MakeSphere(16, 8, DirectX::Colors::White, SphereNormals::Smooth);
+		const auto vertexCount = mesh.Vertices().size();
+
+		std::atomic<int> runs = 0;
+		mesh.RebuildAsync(Vertices(30, runs));
+		change(mesh);
+
+		// whether or not the build got to run, its result is gone with the rebuilder
+		CHECK(!mesh.PublishRebuild());
+		CHECK(mesh.Vertices().size() == vertexCount);
+		CHECK(runs <= 1);
+	};
+
+	cancel([&](Mesh& mesh) { mesh.SetDynamic(&pool); });
+	cancel([&](Mesh& mesh) { mesh.SetGeometryBuffer(&geometry); });
+}
@@ -0,0 +1,273 @@
+#include "TestFramework.h"
+#include "DemoHarness.h"
+#include "MeshLibrary.h"
+#include "MeshSimplifier.h"
+#include "RecordingRenderDevice.h"
+#include <DirectXColors.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+	// A bumpy size x size grid of quads over the unit square. With a seam, the middle column is there
+	// twice, the right half of the grid drawing from copies whose texture coordinates start again at 0.
+	void Grid(int size, bool seam, std::vector<SimpleVertex>& vertices, std::vector<UINT>& indices)
+	{
+		const auto at = [size](int x, int y, float u)
+		{
+			const float px = float(x) / size, py = float(y) / size;
+			return SimpleVertex{ { px, py, 0.05f * std::sin(px * 12.f) * std::cos(py * 9.f) }, { 1.f, 1.f, 1.f }, { 0.f, 0.f, 1.f }, { u, py } };
+		};
+
+		const int middle = size / 2;
+
+		for (int y = 0; y <= size; y++)
+			for (int x = 0; x <= size; x++)
+				vertices.push_back(at(x, y, float(x) / size));
+
+		// the copies follow the grid, one per row
+		const UINT copies = UINT(vertices.size());
+		if (seam)
+			for (int y = 0; y <= size; y++)
+				vertices.push_back(at(middle, y, 0.f));
+
+		const auto index = [&](int x, int y, bool right)
+		{
+			return seam && right && x == middle ? copies + UINT(y) : UINT(y * (size + 1) + x);
+		};
+
+		for (int y = 0; y < size; y++)
+		{
+			for (int x = 0; x < size; x++)
+			{
+				const bool right = x >= middle;
+				const UINT a = index(x, y, right), b = index(x + 1, y, right), c = index(x, y + 1, right), d = index(x + 1, y + 1, right);
+				indices.insert(indices.end(), { a, b, d, a, d, c });
+			}
+		}
+	}
+
+	bool Referenced(const std::vector<UINT>& indices, UINT vertex)
+	{
+		return std::find(indices.begin(), indices.end(), vertex) != indices.end();
+	}
+
+	// a sphere in a library, with its LODs
+	MeshHandle SphereWithLods(MeshLibrary& meshes)
+	{
+		const auto handle = meshes.Create();
+		auto* mesh = meshes.Get(handle);
+		mesh->MakeSphere(64, 32, Colors::White, SphereNormals::Smooth);
+		mesh->GenerateLods();
+		return handle;
+	}
+}
+
+TEST(MeshSimplifier, ReachesTheTarget)
+{
+	std::vector<SimpleVertex> vertices;
+	std::vector<UINT> indices;
+	Grid(32, false, vertices, indices);
+	const auto full = indices.size();
+
+	const float error = MeshSimplifier::Simplify(vertices, indices, full / 4);
+
+	CHECK(indices.size() <= full / 4);
+	CHECK(indices.size() % 3 == 0);
+	CHECK(error > 0.f);
+	CHECK(std::all_of(indices.begin(), indices.end(), [&](UINT i) { return i < vertices.size(); }));
+
+	// a budget of no error at all keeps the bumps
+	std::vector<SimpleVertex> exactVertices;
+	std::vector<UINT> exact;
+	Grid(32, false, exactVertices, exact);
+	MeshSimplifier::Simplify(exactVertices, exact, 0, 0.f);
+	CHECK(exact.size() > full / 4);
+}
+
+TEST(MeshSimplifier, BordersAndSeamsStayLocked)
+{
+	constexpr int size = 32;
+	std::vector<SimpleVertex> vertices;
+	std::vector<UINT> indices;
+	Grid(size, true, vertices, indices);
+	const auto full = indices.size();
+
+	MeshSimplifier::Simplify(vertices, indices, 0);
+
+	// the inside did simplify
+	CHECK(indices.size() < full / 4);
+
+	bool borders = true;
+	for (int i = 0; i <= size; i++)
+	{
+		for (const UINT v : { UINT(i), UINT(size * (size + 1) + i), UINT(i * (size + 1)), UINT(i * (size + 1) + size) })
+			borders = borders && Referenced(indices, v);
+	}
+
+	CHECK(borders);
+
+	// both sides of the seam, each still used by its own half
+	bool seams = true;
+	for (int y = 0; y <= size; y++)
+	{
+		seams = seams && Referenced(indices, UINT(y * (size + 1) + size / 2))
+			&& Referenced(indices, UINT((size + 1) * (size + 1) + y));
+	}
+
+	CHECK(seams);
+}
+
+TEST(MeshSimplifier, ErrorGrowsAsTrianglesGo)
+{
+	std::vector<SimpleVertex> vertices;
+	std::vector<UINT> full;
+	SphereGenerator::Generate(64, 32, Colors::White, SphereNormals::Smooth, vertices, full);
+
+	float previous = 0.f;
+	bool growing = true;
+
+	for (const size_t divisor : { 2, 4, 8, 16, 32 })
+	{
+		auto indices = full;
+		const float error = MeshSimplifier::Simplify(vertices, indices, full.size() / divisor / 3 * 3);
+		growing = growing && error >= previous;
+		previous = error;
+	}
+
+	CHECK(growing);
+	CHECK(previous > 0.f);
+}
+
+TEST(MeshSimplifier, LodsShrinkAndGetWorse)
+{
+	// static buffers that are not null, so every level shows it got one
+	testing::NamedBufferFactory factory;
+	Mesh mesh(&factory);
+	mesh.MakeSphere(64, 32, Colors::White, SphereNormals::Smooth);
+	mesh.GenerateLods();
+
+	REQUIRE(mesh.LodCount() == 5);
+	CHECK(mesh.LodError(0) == 0.f);
+	CHECK(mesh.LodError(1) > 0.f);
+
+	for (size_t lod = 1; lod < mesh.LodCount(); lod++)
+	{
+		CHECK(mesh.IndexCount(lod) < mesh.IndexCount(lod - 1));
+		CHECK(mesh.IndexCount(lod) % 3 == 0);
+		CHECK(mesh.LodError(lod) >= mesh.LodError(lod - 1));
+		CHECK(mesh.IndexBuffer(lod) != nullptr);
+	}
+
+	// any change to the geometry drops them
+	mesh.MakeSphere(16, 8, Colors::White, SphereNormals::Smooth);
+	CHECK(mesh.LodCount() == 1);
+}
+
+TEST(SceneObject, SelectLodFollowsThePixelError)
+{
+	HeadlessBufferFactory factory;
+	MeshLibrary meshes(&factory);
+	SceneObject object;
+	object.SetMesh(meshes, SphereWithLods(meshes));
+
+	const auto* mesh = object.GetMesh();
+	REQUIRE(mesh->LodCount() > 2);
+
+	constexpr float pixelScale = 500.f;
+
+	// the camera distance from the sphere's surface along x
+	const auto select = [&](float distance)
+	{
+		const auto& sphere = object.WorldSphere();
+		const auto camera = XMVectorAdd(XMLoadFloat3(&sphere.Center), XMVectorSet(sphere.Radius + distance, 0.f, 0.f, 0.f));
+		return object.SelectLod(camera, pixelScale);
+	};
+
+	// inside the bounds, and right at them, everything is full detail
+	CHECK(object.SelectLod(XMLoadFloat3(&object.WorldSphere().Center), pixelScale) == 0);
+	CHECK(select(0.f) == 0);
+
+	// each level takes over once its error projects to at most one pixel
+	for (size_t lod = 1; lod < mesh->LodCount(); lod++)
+	{
+		const float threshold = mesh->LodError(lod) * pixelScale / object.GetLodPixelError();
+
+		if (lod + 1 < mesh->LodCount() && mesh->LodError(lod + 1) <= mesh->LodError(lod) * 1.02f)
+			continue;
+
+		CHECK(select(threshold * 1.01f) == lod);
+		CHECK(select(threshold * 0.99f) < lod);
+	}
+
+	CHECK(select(1e6f) == mesh->LodCount() - 1);
+
+	// twice the size needs twice the distance, twice the budget half
+	const float threshold = mesh->LodError(1) * pixelScale;
+	object.GetTransform().scale = { 2.f, 2.f, 2.f };
+	CHECK(select(threshold * 1.01f) == 0);
+	object.SetLodPixelError(2.f);
+	CHECK(select(threshold * 1.01f) >= 1);
+
+	// a mesh without LODs has nothing else to pick
+	const auto plain = meshes.Create();
+	meshes.Get(plain)->MakeSphere(64, 32, Colors::White, SphereNormals::Smooth);
+	object.SetMesh(meshes, plain);
+	CHECK(select(1e6f) == 0);
+}
+
+// The triangles a field of demo models 0.25 to 64 units away asks the device for, with LODs picked at the
+// default pixel error and with every object at full detail, as WinMain logs them per frame.
+BENCHMARK(SceneRenderer, LodTriangles)
+{
+	testing::NamedBufferFactory factory;
+	testing::FakeRenderResources fakes(&factory);
+	RecordingRenderDevice device;
+	SceneRenderer renderer(&device, fakes.resources, 1600, 900);
+
+	MeshLibrary meshes(&factory);
+	const auto model = meshes.Load(testing::WriteDemoModel().wstring(), [](Mesh& mesh) { mesh.GenerateLods(); });
+
+	for (size_t lod = 0; lod < meshes.Get(model)->LodCount(); lod++)
+		testing::Report("LOD %zu: %6u triangles, error %g", lod, meshes.Get(model)->IndexCount(lod) / 3, meshes.Get(model)->LodError(lod));
+
+	Scene scene;
+
+	for (float distance = 0.25f; distance <= 64.f; distance *= 2.f)
+	{
+		for (int i = 0; i < 8; i++)
+		{
+			auto* object = scene.CreateObject();
+			object->SetMesh(meshes, model);
+			object->GetMeshRenderer().SetPixelShader(fakes.shaders.texture);
+			// scaled the way DemoScene scales the model
+			object->GetTransform().scale = { 30.f, 30.f, 30.f };
+			object->GetTransform().position = { (float(i) - 3.5f) * distance * 0.2f, 0.f, distance };
+		}
+	}
+
+	const auto frame = [&](const char* name, float pixelError)
+	{
+		for (const auto& object : scene.Objects())
+			object->SetLodPixelError(pixelError);
+
+		device.Clear();
+		renderer.Render(0.f);
+
+		for (const auto& object : scene.Objects())
+			renderer.Draw(*object, 0.f);
+
+		renderer.Submit();
+
+		const auto& stats = renderer.GetFrameStats();
+		testing::Report("%-12s %zu objects: %7zu triangles drawn, %7zu at full detail, %3zu draw calls", name, scene.Objects().size(),
+			device.Stats().indicesDrawn / 3, stats.trianglesFullDetail, device.Stats().drawCalls);
+	};
+
+	frame("LODs", 1.f);
+	// no projected error is ever within a budget of nothing
+	frame("full detail", 0.f);
+}
@@ -0,0 +1,125 @@
+#include "TestFramework.h"
+#include "Mesh.h"
+#include "HeadlessBufferFactory.h"
+#include <DirectXColors.h>
+#include <cstring>
+
+namespace
+{
+	Mesh Sphere(BufferFactory* factory)
+	{
+		Mesh mesh(factory);
+		mesh.MakeSphere(64, 32, DirectX::Colors::White, SphereNormals::Smooth);
+		return mesh;
+	}
+
+	testing::AllocationCount Since(const testing::AllocationCount& start)
+	{
+		const auto now = testing::Allocations();
+		return { now.count - start.count, now.bytes - start.bytes };
+	}
+}
+
+TEST(Mesh, CopySharesVerticesAndUploadsOnlyIndices)
+{
+	HeadlessBufferFactory factory;
+	const auto original = Sphere(&factory);
+	const size_t vertexBytes = original.Vertices().size() * sizeof(SimpleVertex);
+	const size_t buffers = factory.BuffersCreated();
+	const size_t uploaded = factory.BytesUploaded();
+
+	const auto start = testing::Allocations();
+	const Mesh copy(original);
+	const auto allocated = Since(start);
+
+	CHECK(copy.SharesVertices());
+	CHECK(copy.Vertices().data() == original.Vertices().data());
+	CHECK(copy.Indices() == original.Indices());
+
+	// the index buffer and nothing else
+	CHECK(factory.BuffersCreated() == buffers + 1);
+	CHECK(factory.BytesUploaded() - uploaded < vertexBytes);
+	// the index vector and the narrowed upload copy; no vertices are duplicated
+	CHECK(allocated.count <= 3);
+	CHECK(allocated.bytes < vertexBytes);
+}
+
+TEST(Mesh, CopyAssignmentRebuildsTheIndexBuffer)
+{
+	HeadlessBufferFactory factory;
+	const auto original = Sphere(&factory);
+	Mesh target(&factory);
+	const size_t buffers = factory.BuffersCreated();
+
+	target = original;
+
+	CHECK(target.SharesVertices());
+	CHECK(target.Indices() == original.Indices());
+	CHECK(target.IndexFormat() == original.IndexFormat());
+	CHECK(factory.BuffersCreated() == buffers + 1);
+}
+
+TEST(Mesh, MovesAllocateNothing)
+{
+	HeadlessBufferFactory factory;
+	auto source = Sphere(&factory);
+	const auto* vertices = source.Vertices().data();
+	const size_t indexCount = source.Indices().size();
+	const size_t buffers = factory.BuffersCreated();
+
+	const auto start = testing::Allocations();
+	Mesh moved(std::move(source));
+	Mesh assigned(&factory);
+	assigned = std::move(moved);
+	const auto allocated = Since(start);
+
+	CHECK(allocated.count == 0);
+	CHECK(factory.BuffersCreated() == buffers);
+	CHECK(assigned.Vertices().data() == vertices);
+	CHECK(assigned.Indices().size() == indexCount);
+	CHECK(!assigned.SharesVertices());
+}
+
+TEST(Mesh, DerivedMeshesShareOneVertexStore)
+{
+	HeadlessBufferFactory factory;
+	const auto cube = Sphere(&factory);
+	const size_t buffers = factory.BuffersCreated();
+	const size_t uploaded = factory.BytesUploaded();
+
+	// the sky's setup: the same vertices, drawn with the winding reversed
+	std::vector<UINT> reversed(cube.Indices().rbegin(), cube.Indices().rend());
+
+	const auto start = testing::Allocations();
+	Mesh sky(&factory);
+	sky.ShareVertices(cube);
+	sky.SetIndices(reversed);
+	const auto allocated = Since(start);
+
+	CHECK(sky.SharesVertices());
+	CHECK(sky.Vertices().data() == cube.Vertices().data());
+	CHECK(factory.BuffersCreated() == buffers + 1);
+	CHECK(factory.BytesUploaded() - uploaded == reversed.size() * sizeof(USHORT));
+	CHECK(allocated.bytes < cube.Vertices().size() * sizeof(SimpleVertex));
+}
+
+TEST(Mesh, EditingASharedStoreCopiesItFirst)
+{
+	HeadlessBufferFactory factory;
+	const auto original = Sphere(&factory);
+	const auto before = original.Vertices();
+
+	Mesh edited(original);
+	const size_t buffers = factory.BuffersCreated();
+
+	auto vertex = before[0];
+	vertex.position.x += 1.f;
+	edited.UpdateVertices(0, { &vertex, 1 });
+
+	CHECK(!edited.SharesVertices());
+	CHECK(!original.SharesVertices());
+	CHECK(std::memcmp(original.Vertices().data(), before.data(), before.size() * sizeof(SimpleVertex)) == 0);
+	CHECK(edited.Vertices()[0].position.x == before[0].position.x + 1.f);
+	// a vertex buffer of its own for the copy
+	CHECK(factory.BuffersCreated() == buffers + 1);
+}
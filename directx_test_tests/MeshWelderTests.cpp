@@ -0,0 +1,124 @@
+#include "TestFramework.h"
+#include "MeshWelder.h"
+#include <utility>
+#include <vector>
+
+namespace
+{
+	// a cell size floats hold exactly, so the tests know where the grid lines fall
+	constexpr float cell = 1.f / 1024;
+
+	SimpleVertex At(float x, float y, float u = 0.f, float v = 0.f)
+	{
+		return { { x, y, 0.f }, { 1.f, 1.f, 1.f }, { 0.f, 0.f, 1.f }, { u, v } };
+	}
+
+	// A size x size grid of quads as an unindexed triangle soup, every corner repeated by each
+	// triangle touching it.
+	void Soup(int size, std::vector<SimpleVertex>& vertices, std::vector<UINT>& indices)
+	{
+		const auto corner = [size](int x, int y) { return At(float(x), float(y), float(x) / size, float(y) / size); };
+
+		for (int y = 0; y < size; y++)
+		{
+			for (int x = 0; x < size; x++)
+			{
+				for (const auto& [cx, cy] : { std::pair(x, y), std::pair(x + 1, y), std::pair(x + 1, y + 1),
+					std::pair(x, y), std::pair(x + 1, y + 1), std::pair(x, y + 1) })
+				{
+					indices.push_back(UINT(vertices.size()));
+					vertices.push_back(corner(cx, cy));
+				}
+			}
+		}
+	}
+
+	size_t Welded(std::vector<SimpleVertex> vertices, const WeldSettings& settings = {})
+	{
+		std::vector<UINT> indices(vertices.size());
+		for (size_t i = 0; i < indices.size(); i++)
+			indices[i] = UINT(i);
+
+		return MeshWelder::Weld(vertices, indices, settings).verticesAfter;
+	}
+}
+
+TEST(MeshWelder, ExactDuplicatesMerge)
+{
+	// a quad as two triangles that do not share their diagonal
+	std::vector<SimpleVertex> vertices = { At(0, 0), At(1, 0), At(1, 1), At(0, 0), At(1, 1), At(0, 1) };
+	std::vector<UINT> indices = { 0, 1, 2, 3, 4, 5 };
+
+	const auto stats = MeshWelder::Weld(vertices, indices);
+
+	CHECK(stats.verticesBefore == 6);
+	CHECK(stats.verticesAfter == 4);
+	CHECK(stats.BytesSaved() == 2 * sizeof(SimpleVertex));
+	// survivors keep the order they were first seen in
+	CHECK((indices == std::vector<UINT>{ 0, 1, 2, 0, 2, 3 }));
+	CHECK(vertices[3].position.y == 1.f);
+}
+
+TEST(MeshWelder, EpsilonDecidesWhatIsTheSamePosition)
+{
+	WeldSettings settings;
+	settings.positionEpsilon = cell;
+
+	// a quarter of a cell apart, inside one cell
+	CHECK(Welded({ At(100.25f * cell, 0), At(100.75f * cell, 0) }, settings) == 1);
+	// further apart than a cell can never share one
+	CHECK(Welded({ At(100.25f * cell, 0), At(101.5f * cell, 0) }, settings) == 2);
+	// closer than a cell but across a grid line stay apart, as the header warns
+	CHECK(Welded({ At(100.9f * cell, 0), At(101.1f * cell, 0) }, settings) == 2);
+
+	// zero means the bits have to match
+	settings.positionEpsilon = 0.f;
+	CHECK(Welded({ At(100.25f * cell, 0), At(100.75f * cell, 0) }, settings) == 2);
+	CHECK(Welded({ At(100.25f * cell, 0), At(100.25f * cell, 0) }, settings) == 1);
+}
+
+TEST(MeshWelder, DifferentAttributesStayApart)
+{
+	// a UV seam: one position with the texture wrapped from 1 back to 0
+	CHECK(Welded({ At(1, 1, 1.f, 0.5f), At(1, 1, 0.f, 0.5f) }) == 2);
+
+	// a hard edge: one position, two normals
+	auto lit = At(1, 1);
+	lit.normal = { 1.f, 0.f, 0.f };
+	CHECK(Welded({ At(1, 1), lit }) == 2);
+
+	auto tinted = At(1, 1);
+	tinted.color = { 1.f, 0.f, 0.f };
+	CHECK(Welded({ At(1, 1), tinted }) == 2);
+}
+
+TEST(MeshWelder, RemapKeepsEveryTriangle)
+{
+	// enough vertices to be split over several partitions and threads
+	constexpr int size = 100;
+	std::vector<SimpleVertex> vertices;
+	std::vector<UINT> indices;
+	Soup(size, vertices, indices);
+
+	const auto original = vertices;
+	const auto originalIndices = indices;
+	const auto stats = MeshWelder::Weld(vertices, indices);
+
+	CHECK(stats.verticesAfter == size_t(size + 1) * (size + 1));
+	REQUIRE(indices.size() == originalIndices.size());
+
+	// every corner of every triangle is still where it was, in the same winding
+	bool same = true;
+	for (size_t i = 0; i < indices.size(); i++)
+	{
+		REQUIRE(indices[i] < vertices.size());
+		const auto& before = original[originalIndices[i]].position;
+		const auto& after = vertices[indices[i]].position;
+		same = same && before.x == after.x && before.y == after.y && before.z == after.z;
+	}
+
+	CHECK(same);
+
+	// welding again finds nothing left to merge
+	CHECK(MeshWelder::Weld(vertices, indices).VerticesRemoved() == 0);
+}
@@ -0,0 +1,207 @@
+#include "TestFramework.h"
+#include "IndexOptimizer.h"
+#include "Meshlet.h"
+#include "SphereGenerator.h"
+#include <DirectXColors.h>
+#include <cmath>
+#include <unordered_set>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+	// a smooth sphere in the order Mesh::Optimize leaves it, which is what meshlets are built from
+	void Sphere(int slices, int stacks, std::vector<SimpleVertex>& vertices, std::vector<UINT>& indices)
+	{
+		SphereGenerator::Generate(slices, stacks, Colors::White, SphereNormals::Smooth, vertices, indices);
+		IndexOptimizer::Optimize(vertices, indices);
+	}
+
+	// n directions spread evenly over the unit sphere
+	std::vector<XMVECTOR> Directions(int n)
+	{
+		std::vector<XMVECTOR> directions;
+
+		for (int i = 0; i < n; i++)
+		{
+			const float y = 1.f - 2.f * (i + 0.5f) / n;
+			const float r = std::sqrt(1.f - y * y);
+			const float phi = 2.39996323f * i;
+			directions.push_back(XMVectorSet(r * std::cos(phi), y, r * std::sin(phi), 0.f));
+		}
+
+		return directions;
+	}
+
+	// a frustum around everything the tests build, so only cones cull
+	XMMATRIX Everything()
+	{
+		return XMMatrixOrthographicLH(100.f, 100.f, -100.f, 100.f);
+	}
+
+	XMVECTOR Corner(const std::vector<SimpleVertex>& vertices, const std::vector<UINT>& indices, size_t i)
+	{
+		return XMLoadFloat3(&vertices[indices[i]].position);
+	}
+}
+
+TEST(Meshlet, StayWithinTheLimits)
+{
+	std::vector<SimpleVertex> vertices;
+	std::vector<UINT> indices;
+	Sphere(64, 32, vertices, indices);
+
+	for (const auto& settings : { MeshletSettings{}, MeshletSettings{ 32, 16 }, MeshletSettings{ 3, 124 }, MeshletSettings{ 64, 1 } })
+	{
+		const auto meshlets = MeshletBuilder::Build(vertices, indices, settings);
+		REQUIRE(!meshlets.empty());
+
+		bool within = true, counted = true;
+
+		for (const auto& meshlet : meshlets)
+		{
+			std::unordered_set<UINT> used(indices.begin() + meshlet.indexOffset, indices.begin() + meshlet.indexOffset + meshlet.indexCount);
+
+			within = within && meshlet.vertexCount <= settings.maxVertices && meshlet.indexCount / 3 <= settings.maxTriangles
+				&& meshlet.indexCount > 0;
+			counted = counted && used.size() == meshlet.vertexCount;
+		}
+
+		CHECK(within);
+		CHECK(counted);
+	}
+}
+
+TEST(Meshlet, EveryTriangleInOneMeshlet)
+{
+	std::vector<SimpleVertex> vertices;
+	std::vector<UINT> indices;
+	Sphere(48, 24, vertices, indices);
+
+	const auto meshlets = MeshletBuilder::Build(vertices, indices);
+
+	// consecutive ranges from the first index to the last, so none is left out or taken twice
+	UINT next = 0;
+	bool contiguous = true;
+
+	for (const auto& meshlet : meshlets)
+	{
+		contiguous = contiguous && meshlet.indexOffset == next && meshlet.indexCount % 3 == 0;
+		next = meshlet.indexOffset + meshlet.indexCount;
+	}
+
+	CHECK(contiguous);
+	CHECK(next == indices.size());
+	CHECK(meshlets.size() >= indices.size() / 3 / MeshletSettings{}.maxTriangles);
+
+	CHECK(MeshletBuilder::Build(vertices, {}).empty());
+}
+
+TEST(Meshlet, SpheresHoldTheirVertices)
+{
+	std::vector<SimpleVertex> vertices;
+	std::vector<UINT> indices;
+	Sphere(64, 32, vertices, indices);
+
+	bool inside = true;
+
+	for (const auto& meshlet : MeshletBuilder::Build(vertices, indices))
+	{
+		const auto center = XMLoadFloat3(&meshlet.center);
+
+		for (UINT i = meshlet.indexOffset; i < meshlet.indexOffset + meshlet.indexCount; i++)
+			inside = inside && XMVectorGetX(XMVector3Length(XMVectorSubtract(Corner(vertices, indices, i), center))) <= meshlet.radius * 1.0001f;
+	}
+
+	CHECK(inside);
+}
+
+TEST(Meshlet, ConesNeverDropFrontFaces)
+{
+	std::vector<SimpleVertex> vertices;
+	std::vector<UINT> indices;
+	Sphere(64, 32, vertices, indices);
+
+	const auto meshlets = MeshletBuilder::Build(vertices, indices);
+	std::vector<IndexRange> ranges;
+	size_t culled = 0;
+	bool kept = true;
+
+	for (const float distance : { 1.5f, 3.f, 20.f })
+	{
+		for (const auto direction : Directions(64))
+		{
+			const auto camera = XMVectorScale(direction, distance);
+			const auto stats = MeshletBuilder::Cull(meshlets, Everything(), camera, true, ranges);
+			culled += stats.backfaceCulled;
+
+			// every meshlet left out faces away with all of its triangles
+			std::vector<bool> visible(indices.size() / 3);
+			for (const auto& range : ranges)
+				for (UINT i = range.start; i < range.start + range.count; i += 3)
+					visible[i / 3] = true;
+
+			for (size_t i = 0; i < indices.size(); i += 3)
+			{
+				if (visible[i / 3])
+					continue;
+
+				const auto p0 = Corner(vertices, indices, i);
+				const auto normal = XMVector3Cross(XMVectorSubtract(Corner(vertices, indices, i + 1), p0), XMVectorSubtract(Corner(vertices, indices, i + 2), p0));
+				kept = kept && XMVectorGetX(XMVector3Dot(normal, XMVectorSubtract(camera, p0))) <= 0.f;
+			}
+		}
+	}
+
+	CHECK(kept);
+	// and the cones do cull something
+	CHECK(culled > 0);
+}
+
+TEST(Meshlet, CullCountsVisibleTriangles)
+{
+	std::vector<SimpleVertex> vertices;
+	std::vector<UINT> indices;
+	Sphere(64, 32, vertices, indices);
+
+	const auto meshlets = MeshletBuilder::Build(vertices, indices);
+	std::vector<IndexRange> ranges;
+
+	const auto check = [&](FXMMATRIX worldViewProjection, FXMVECTOR camera, bool backfaceCulling)
+	{
+		const auto stats = MeshletBuilder::Cull(meshlets, worldViewProjection, camera, backfaceCulling, ranges);
+
+		size_t rangeTriangles = 0;
+		for (const auto& range : ranges)
+			rangeTriangles += range.count / 3;
+
+		CHECK(stats.meshlets == meshlets.size());
+		CHECK(stats.triangles == indices.size() / 3);
+		CHECK(stats.visibleMeshlets + stats.frustumCulled + stats.backfaceCulled == stats.meshlets);
+		CHECK(stats.visibleTriangles == rangeTriangles);
+		CHECK(stats.visibleTriangles <= stats.triangles);
+
+		return stats;
+	};
+
+	const auto camera = XMVectorSet(0.f, 0.f, -5.f, 0.f);
+
+	// nothing to cull
+	const auto all = check(Everything(), camera, false);
+	CHECK(all.visibleTriangles == all.triangles);
+	CHECK(ranges.size() == 1);
+
+	// the far side of the sphere faces away
+	const auto front = check(Everything(), camera, true);
+	CHECK(front.backfaceCulled > 0);
+	CHECK(front.visibleTriangles < front.triangles);
+
+	// looking away from the sphere sees none of it
+	const auto away = XMMatrixLookAtLH(camera, XMVectorSet(0.f, 0.f, -6.f, 0.f), XMVectorSet(0.f, 1.f, 0.f, 0.f))
+		* XMMatrixPerspectiveFovLH(XM_PIDIV4, 16.f / 9.f, 0.1f, 100.f);
+	const auto behind = check(away, camera, true);
+	CHECK(behind.visibleTriangles == 0);
+	CHECK(behind.frustumCulled == behind.meshlets);
+	CHECK(ranges.empty());
+}
@@ -0,0 +1,251 @@
+#include "TestFramework.h"
+#include "NormalGenerator.h"
+#include "Mesh.h"
+#include "HeadlessBufferFactory.h"
+#include "Parallel.h"
+#include "Timer.h"
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+using namespace DirectX;
+
+namespace
+{
+	// size x size quads over [0, size] in x and y, bumped in z, with u along x; wound to face +z where flat
+	void Grid(int size, float bump, std::vector<SimpleVertex>& vertices, std::vector<UINT>& indices)
+	{
+		vertices.clear();
+		indices.clear();
+
+		for (int y = 0; y <= size; y++)
+		{
+			for (int x = 0; x <= size; x++)
+			{
+				const float z = bump * std::sin(x * 0.05f) * std::cos(y * 0.07f);
+				vertices.emplace_back(XMFLOAT3{ float(x), float(y), z }, XMFLOAT3{ 1.f, 1.f, 1.f }, XMFLOAT3{ 0.f, 0.f, 0.f },
+					XMFLOAT2{ float(x) / size, float(y) / size });
+			}
+		}
+
+		for (int y = 0; y < size; y++)
+		{
+			for (int x = 0; x < size; x++)
+			{
+				const UINT a = UINT(y * (size + 1) + x), b = a + 1, c = a + UINT(size) + 2, d = a + UINT(size) + 1;
+				indices.insert(indices.end(), { a, b, c, a, c, d });
+			}
+		}
+	}
+
+	// the eight corners of [-1, 1]^3, every face wound outward
+	void Cube(std::vector<SimpleVertex>& vertices, std::vector<UINT>& indices)
+	{
+		vertices.clear();
+		indices.clear();
+
+		for (int i = 0; i < 8; i++)
+		{
+			const XMFLOAT3 position = { i & 1 ? 1.f : -1.f, i & 2 ? 1.f : -1.f, i & 4 ? 1.f : -1.f };
+			vertices.emplace_back(position, XMFLOAT3{ 1.f, 1.f, 1.f }, XMFLOAT3{ 0.f, 0.f, 0.f }, XMFLOAT2{ 0.f, 0.f });
+		}
+
+		const UINT quads[6][4] = { { 0, 1, 3, 2 }, { 4, 5, 7, 6 }, { 0, 1, 5, 4 }, { 2, 3, 7, 6 }, { 0, 2, 6, 4 }, { 1, 3, 7, 5 } };
+
+		for (const auto& q : quads)
+		{
+			const XMVECTOR a = XMLoadFloat3(&vertices[q[0]].position), b = XMLoadFloat3(&vertices[q[1]].position), c = XMLoadFloat3(&vertices[q[2]].position);
+			const bool outward = XMVectorGetX(XMVector3Dot(XMVector3Cross(b - a, c - a), a + c)) > 0.f;
+
+			if (outward)
+				indices.insert(indices.end(), { q[0], q[1], q[2], q[0], q[2], q[3] });
+			else
+				indices.insert(indices.end(), { q[0], q[2], q[1], q[0], q[3], q[2] });
+		}
+	}
+
+	bool Near(const XMFLOAT3& a, XMVECTOR b, float tolerance)
+	{
+		return XMVector3NearEqual(XMLoadFloat3(&a), b, XMVectorReplicate(tolerance));
+	}
+}
+
+TEST(NormalGenerator, FlatGridFacesUp)
+{
+	std::vector<SimpleVertex> vertices;
+	std::vector<UINT> indices;
+	Grid(16, 0.f, vertices, indices);
+
+	const auto stats = NormalGenerator::GenerateNormals(vertices, indices);
+
+	CHECK(stats.VerticesAdded() == 0);
+	CHECK(stats.degenerateTriangles == 0);
+
+	for (const auto& v : vertices)
+		CHECK(Near(v.normal, XMVectorSet(0.f, 0.f, 1.f, 0.f), 1e-5f));
+}
+
+TEST(NormalGenerator, SmoothCubeCornersPointDiagonally)
+{
+	std::vector<SimpleVertex> vertices;
+	std::vector<UINT> indices;
+	Cube(vertices, indices);
+
+	NormalGenerator::GenerateNormals(vertices, indices);
+
+	CHECK(vertices.size() == 8);
+
+	// each corner sees three faces at 90 degrees, so angle weighting comes out exactly diagonal
+	for (const auto& v : vertices)
+		CHECK(Near(v.normal, XMVector3Normalize(XMLoadFloat3(&v.position)), 1e-5f));
+}
+
+TEST(NormalGenerator, CreasesSplitCubeCorners)
+{
+	std::vector<SimpleVertex> vertices;
+	std::vector<UINT> indices;
+	Cube(vertices, indices);
+
+	NormalSettings settings;
+	settings.creaseAngle = XM_PI / 3.f;
+	const auto stats = NormalGenerator::GenerateNormals(vertices, indices, settings);
+
+	CHECK(stats.VerticesAdded() == 16);
+	CHECK(indices.size() == 36);
+
+	// every corner of every triangle gets its face's axis
+	for (size_t t = 0; t < indices.size(); t += 3)
+	{
+		const XMVECTOR a = XMLoadFloat3(&vertices[indices[t]].position);
+		const XMVECTOR b = XMLoadFloat3(&vertices[indices[t + 1]].position);
+		const XMVECTOR c = XMLoadFloat3(&vertices[indices[t + 2]].position);
+		const XMVECTOR face = XMVector3Normalize(XMVector3Cross(b - a, c - a));
+
+		for (size_t corner = 0; corner < 3; corner++)
+			CHECK(Near(vertices[indices[t + corner]].normal, face, 1e-5f));
+	}
+}
+
+TEST(NormalGenerator, ResultDoesNotDependOnThreadCount)
+{
+	std::vector<SimpleVertex> single, parallel;
+	std::vector<UINT> singleIndices, parallelIndices;
+	Grid(300, 20.f, single, singleIndices);
+	parallel = single;
+	parallelIndices = singleIndices;
+
+	NormalSettings settings;
+	settings.creaseAngle = XM_PI / 4.f;
+
+	SetParallelThreadLimit(1);
+	NormalGenerator::GenerateNormals(single, singleIndices, settings);
+	SetParallelThreadLimit(0);
+	NormalGenerator::GenerateNormals(parallel, parallelIndices, settings);
+
+	REQUIRE(single.size() == parallel.size());
+	CHECK(singleIndices == parallelIndices);
+	CHECK(std::memcmp(single.data(), parallel.data(), single.size() * sizeof(SimpleVertex)) == 0);
+}
+
+TEST(NormalGenerator, TangentsFollowUAndStayOrthogonal)
+{
+	std::vector<SimpleVertex> vertices;
+	std::vector<UINT> indices;
+	Grid(64, 4.f, vertices, indices);
+	NormalGenerator::GenerateNormals(vertices, indices);
+
+	std::vector<XMFLOAT4> tangents;
+	NormalGenerator::GenerateTangents(vertices, indices, tangents);
+
+	REQUIRE(tangents.size() == vertices.size());
+
+	for (size_t i = 0; i < vertices.size(); i++)
+	{
+		const XMVECTOR t = XMLoadFloat4(&tangents[i]);
+		const XMVECTOR n = XMLoadFloat3(&vertices[i].normal);
+
+		CHECK_NEAR(XMVectorGetX(XMVector3Length(t)), 1.0, 1e-4);
+		CHECK_NEAR(XMVectorGetX(XMVector3Dot(t, n)), 0.0, 1e-4);
+		// u runs along +x, v along +y, with the normal toward +z: right handed
+		CHECK(tangents[i].x > 0.5f);
+		CHECK(tangents[i].w == 1.f);
+	}
+}
+
+TEST(NormalGenerator, LoadingGeneratesMissingNormals)
+{
+	const auto path = testing::ScratchDirectory() / "quad.obj";
+	FILE* file = std::fopen(path.string().c_str(), "wb");
+	std::fputs("v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nf 1 2 3 4\n", file);
+	std::fclose(file);
+
+	HeadlessBufferFactory factory;
+
+	// the first load parses and writes the cache, the second reads it back
+	for (int pass = 0; pass < 2; pass++)
+	{
+		Mesh mesh(&factory);
+		mesh.LoadFromFile(path.wstring());
+
+		REQUIRE(mesh.Vertices().size() == 4);
+
+		for (const auto& v : mesh.Vertices())
+			CHECK(Near(v.normal, XMVectorSet(0.f, 0.f, 1.f, 0.f), 1e-5f));
+	}
+}
+
+// Normals and tangents for a million triangles at every thread count up to the hardware's.
+BENCHMARK(NormalGenerator, MillionTriangles)
+{
+	std::vector<SimpleVertex> source;
+	std::vector<UINT> sourceIndices;
+	// 708 x 708 quads
+	Grid(708, 30.f, source, sourceIndices);
+
+	const size_t triangles = sourceIndices.size() / 3;
+	const size_t hardware = std::max<size_t>(1, std::thread::hardware_concurrency());
+	float singleNormals = 0.f, singleTangents = 0.f;
+
+	// powers of two, then the hardware's own count
+	std::vector<size_t> threadCounts;
+
+	for (size_t threads = 1; threads < hardware; threads *= 2)
+		threadCounts.push_back(threads);
+
+	threadCounts.push_back(hardware);
+
+	for (const size_t threads : threadCounts)
+	{
+		SetParallelThreadLimit(threads);
+
+		float normalTime = FLT_MAX, tangentTime = FLT_MAX;
+
+		for (int run = 0; run < 3; run++)
+		{
+			auto vertices = source;
+			auto indices = sourceIndices;
+
+			Timer timer;
+			NormalGenerator::GenerateNormals(vertices, indices);
+			normalTime = std::min(normalTime, timer.Mark());
+
+			std::vector<XMFLOAT4> tangents;
+			NormalGenerator::GenerateTangents(vertices, indices, tangents);
+			tangentTime = std::min(tangentTime, timer.Mark());
+			testing::Consume(tangents);
+		}
+
+		if (threads == 1)
+		{
+			singleNormals = normalTime;
+			singleTangents = tangentTime;
+		}
+
+		testing::Report("%zu thread(s), %zu triangles: normals %.1f ms (%.1f Mtri/s, x%.2f), tangents %.1f ms (x%.2f)",
+			threads, triangles, normalTime * 1000.f, triangles / normalTime * 1e-6f, singleNormals / normalTime,
+			tangentTime * 1000.f, singleTangents / tangentTime);
+	}
+
+	SetParallelThreadLimit(0);
+}
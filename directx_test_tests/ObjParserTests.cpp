@@ -0,0 +1,137 @@
+#include "TestFramework.h"
+#include "ObjParser.h"
+#include "Timer.h"
+#include <cstring>
+#include <thread>
+
+#if defined(_WIN32) && __has_include(<WaveFrontReader.h>)
+#include <WaveFrontReader.h>
+#define HAVE_WAVEFRONT_READER
+#endif
+
+namespace
+{
+	void Parse(const char* text, std::vector<SimpleVertex>& vertices, std::vector<UINT>& indices)
+	{
+		ObjParser::Parse(text, std::strlen(text), vertices, indices);
+	}
+
+	// a size x size grid of quads with positions, texture coordinates and normals; about 140 bytes per quad
+	void WriteGrid(const std::filesystem::path& path, int size)
+	{
+		FILE* file = std::fopen(path.string().c_str(), "wb");
+
+		for (int y = 0; y <= size; y++)
+			for (int x = 0; x <= size; x++)
+				std::fprintf(file, "v %.6f %.6f %.6f\n", x * 0.01f, y * 0.01f, std::sin(x * 0.1f) * std::cos(y * 0.1f));
+
+		for (int y = 0; y <= size; y++)
+			for (int x = 0; x <= size; x++)
+				std::fprintf(file, "vt %.6f %.6f\n", float(x) / size, float(y) / size);
+
+		for (int y = 0; y <= size; y++)
+			for (int x = 0; x <= size; x++)
+				std::fprintf(file, "vn %.6f %.6f %.6f\n", 0.f, 0.f, 1.f);
+
+		for (int y = 0; y < size; y++)
+		{
+			for (int x = 0; x < size; x++)
+			{
+				const int i = y * (size + 1) + x + 1;
+				const int j = i + size + 1;
+				std::fprintf(file, "f %d/%d/%d %d/%d/%d %d/%d/%d %d/%d/%d\n", i, i, i, i + 1, i + 1, i + 1, j + 1, j + 1, j + 1, j, j, j);
+			}
+		}
+
+		std::fclose(file);
+	}
+}
+
+TEST(ObjParser, FansPolygonsAndSharesCorners)
+{
+	std::vector<SimpleVertex> vertices;
+	std::vector<UINT> indices;
+
+	Parse("v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nv 0 2 0\nf 1 2 3 4 5\nf 1 3 4\n", vertices, indices);
+
+	CHECK(vertices.size() == 5);
+	CHECK(indices == std::vector<UINT>({ 0, 1, 2, 0, 2, 3, 0, 3, 4, 0, 2, 3 }));
+}
+
+TEST(ObjParser, ResolvesNegativeIndices)
+{
+	std::vector<SimpleVertex> vertices;
+	std::vector<UINT> indices;
+
+	Parse("v 0 0 0\nv 1 0 0\nvt 0.25 0.25\nv 1 1 0\nf -3/-1 -2/-1 -1/-1\n", vertices, indices);
+
+	REQUIRE(vertices.size() == 3);
+	CHECK(vertices[2].position.y == 1.f);
+	// v is flipped like WaveFrontReader does
+	CHECK(vertices[0].texCoord.y == 0.75f);
+}
+
+TEST(ObjParser, KeepsCornersWithDifferentAttributesApart)
+{
+	std::vector<SimpleVertex> vertices;
+	std::vector<UINT> indices;
+
+	Parse("v 0 0 0\nv 1 0 0\nv 1 1 0\nvn 0 0 1\nvn 0 0 -1\nf 1//1 2//1 3//1\nf 1//2 3//2 2//2\n", vertices, indices);
+
+	CHECK(vertices.size() == 6);
+	CHECK(indices.size() == 6);
+}
+
+TEST(ObjParser, RejectsMissingElements)
+{
+	std::vector<SimpleVertex> vertices;
+	std::vector<UINT> indices;
+	bool threw = false;
+
+	try
+	{
+		Parse("v 0 0 0\nv 1 0 0\nf 1 2 3\n", vertices, indices);
+	}
+	catch (const std::exception&)
+	{
+		threw = true;
+	}
+
+	CHECK(threw);
+}
+
+BENCHMARK(ObjParser, Throughput)
+{
+	constexpr int size = 1000;
+	const auto path = testing::ScratchDirectory() / "grid.obj";
+	WriteGrid(path, size);
+
+	const double megabytes = std::filesystem::file_size(path) / 1e6;
+	std::vector<SimpleVertex> vertices;
+	std::vector<UINT> indices;
+
+	// the first load also pulls the file into the page cache
+	ObjParser::Load(path.wstring(), vertices, indices);
+
+	Timer timer;
+	ObjParser::Load(path.wstring(), vertices, indices);
+	const float time = timer.Mark();
+
+	CHECK(vertices.size() == size_t(size + 1) * (size + 1));
+	CHECK(indices.size() == size_t(size) * size * 6);
+	testing::Report("%.0f MB, %zu vertices: ObjParser %.0f ms, %.0f MB/s on %u threads",
+		megabytes, vertices.size(), time * 1000.f, megabytes / time, std::thread::hardware_concurrency());
+
+#ifdef HAVE_WAVEFRONT_READER
+	WaveFrontReader<UINT> reader;
+
+	timer.Mark();
+	reader.Load(path.wstring().c_str());
+	const float readerTime = timer.Mark();
+
+	testing::Report("WaveFrontReader %.0f ms, %.0f MB/s, ObjParser is %.1fx faster",
+		readerTime * 1000.f, megabytes / readerTime, readerTime / time);
+#else
+	testing::Report("WaveFrontReader is not available in this build, so there is nothing to compare against");
+#endif
+}
@@ -0,0 +1,196 @@
+#include "TestFramework.h"
+#include "OffsetAllocator.h"
+#include "Timer.h"
+#include <algorithm>
+#include <random>
+
+namespace
+{
+	// no two live allocations overlap and all of them lie inside the capacity
+	bool Disjoint(std::vector<OffsetAllocation> allocations, uint32_t capacity)
+	{
+		std::sort(allocations.begin(), allocations.end(), [](const auto& a, const auto& b) { return a.offset < b.offset; });
+
+		uint64_t end = 0;
+
+		for (const auto& a : allocations)
+		{
+			if (a.offset < end)
+				return false;
+
+			end = uint64_t(a.offset) + a.size;
+		}
+
+		return end <= capacity;
+	}
+}
+
+TEST(OffsetAllocator, AllocatesFrontToBackUntilFull)
+{
+	OffsetAllocator allocator(1000);
+
+	const auto a = allocator.Allocate(300);
+	const auto b = allocator.Allocate(300);
+	// the last 400 sit in a bin starting at 384, found by the search of the request's own bin
+	const auto c = allocator.Allocate(400);
+
+	CHECK(a && b && c);
+	CHECK(a.offset == 0);
+	CHECK(b.offset == 300);
+	CHECK(c.offset == 600);
+
+	CHECK(!allocator.Allocate(1));
+	CHECK(allocator.Stats().used == 1000);
+	CHECK(allocator.Stats().freeRegions == 0);
+}
+
+TEST(OffsetAllocator, EmptyRequestsFail)
+{
+	OffsetAllocator allocator(1000);
+
+	CHECK(!allocator.Allocate(0));
+	CHECK(!allocator.Allocate(1001));
+	CHECK(!OffsetAllocator(0).Allocate(1));
+
+	// freeing the empty allocation does nothing
+	allocator.Free({});
+	CHECK(allocator.Stats().used == 0);
+}
+
+TEST(OffsetAllocator, FreedNeighboursMerge)
+{
+	OffsetAllocator allocator(1000);
+
+	const auto a = allocator.Allocate(100);
+	const auto b = allocator.Allocate(100);
+	const auto c = allocator.Allocate(100);
+
+	allocator.Free(b);
+	CHECK(allocator.Stats().freeRegions == 2);
+
+	// merges with b on one side
+	allocator.Free(a);
+	CHECK(allocator.Stats().freeRegions == 2);
+	CHECK(allocator.Stats().largestFreeRegion == 700);
+
+	// and with both sides
+	allocator.Free(c);
+	const auto stats = allocator.Stats();
+	CHECK(stats.freeRegions == 1);
+	CHECK(stats.largestFreeRegion == 1000);
+	CHECK(stats.allocations == 0);
+	CHECK(stats.Fragmentation() == 0.f);
+
+	// the whole range is usable again
+	CHECK(allocator.Allocate(1000));
+}
+
+TEST(OffsetAllocator, ReportsFragmentation)
+{
+	OffsetAllocator allocator(1600);
+	std::vector<OffsetAllocation> allocations;
+
+	for (int i = 0; i < 100; i++)
+		allocations.push_back(allocator.Allocate(16));
+
+	for (size_t i = 0; i < allocations.size(); i += 2)
+		allocator.Free(allocations[i]);
+
+	const auto stats = allocator.Stats();
+	CHECK(stats.Free() == 800);
+	CHECK(stats.freeRegions == 50);
+	CHECK(stats.largestFreeRegion == 16);
+	CHECK_NEAR(stats.Fragmentation(), 1.0 - 16.0 / 800.0, 1e-6);
+
+	// 800 bytes are free, none of them in a piece of 17
+	CHECK(!allocator.Allocate(17));
+	CHECK(allocator.Allocate(16));
+}
+
+TEST(OffsetAllocator, PassesOverRegionsThatMightNotFit)
+{
+	OffsetAllocator allocator(10000);
+
+	const auto a = allocator.Allocate(100);
+	const auto gap = allocator.Allocate(37);
+	const auto b = allocator.Allocate(100);
+	REQUIRE(a && gap && b);
+	allocator.Free(gap);
+
+	// 37 shares a bin with sizes below it, so the 37-element gap is skipped for the tail
+	const auto c = allocator.Allocate(37);
+	CHECK(c.offset != gap.offset);
+
+	// an exact bin size is served from the gap's bin
+	const auto d = allocator.Allocate(32);
+	CHECK(d.offset == gap.offset);
+}
+
+TEST(OffsetAllocator, RandomWorkloadStaysConsistent)
+{
+	constexpr uint32_t capacity = 1 << 20;
+	OffsetAllocator allocator(capacity);
+	std::vector<OffsetAllocation> live;
+	std::mt19937 random(20);
+	std::uniform_int_distribution<uint32_t> size(1, 5000);
+
+	uint64_t used = 0;
+
+	for (int step = 0; step < 20000; step++)
+	{
+		if (live.empty() || random() % 3 != 0)
+		{
+			const auto allocation = allocator.Allocate(size(random));
+
+			if (allocation)
+			{
+				live.push_back(allocation);
+				used += allocation.size;
+			}
+		}
+		else
+		{
+			const size_t victim = random() % live.size();
+			used -= live[victim].size;
+			allocator.Free(live[victim]);
+			live[victim] = live.back();
+			live.pop_back();
+		}
+
+		if (step % 1000 == 0)
+			REQUIRE(Disjoint(live, capacity));
+	}
+
+	CHECK(Disjoint(live, capacity));
+	CHECK(allocator.Stats().used == used);
+	CHECK(allocator.Stats().allocations == live.size());
+
+	for (const auto& allocation : live)
+		allocator.Free(allocation);
+
+	CHECK(allocator.Stats().freeRegions == 1);
+	CHECK(allocator.Stats().largestFreeRegion == capacity);
+}
+
+BENCHMARK(OffsetAllocator, AllocateFree)
+{
+	constexpr int count = 1000000;
+	OffsetAllocator allocator(1u << 30);
+	std::vector<OffsetAllocation> live(4096);
+	std::mt19937 random(20);
+
+	Timer timer;
+
+	for (int i = 0; i < count; i++)
+	{
+		auto& slot = live[random() % live.size()];
+		allocator.Free(slot);
+		slot = allocator.Allocate(1 + random() % 65536);
+	}
+
+	const float seconds = timer.Peek();
+	const auto stats = allocator.Stats();
+
+	testing::Report("%.1f ns per free and allocate, %u free regions, fragmentation %.3f",
+		seconds * 1e9 / count, stats.freeRegions, stats.Fragmentation());
+}
@@ -0,0 +1,91 @@
+#include "TestFramework.h"
+#include "PackedVertex.h"
+#include <random>
+
+using namespace DirectX;
+
+namespace
+{
+	std::vector<SimpleVertex> RandomVertices(size_t count, float scale)
+	{
+		std::mt19937 random(6);
+		std::uniform_real_distribution<float> position(-scale, scale), unit(0.f, 1.f), signedUnit(-1.f, 1.f), uv(-4.f, 4.f);
+
+		std::vector<SimpleVertex> vertices(count);
+
+		for (auto& v : vertices)
+		{
+			v.position = { position(random), position(random), position(random) };
+			v.color = { unit(random), unit(random), unit(random) };
+			XMStoreFloat3(&v.normal, XMVector3Normalize(XMVectorSet(signedUnit(random), signedUnit(random), signedUnit(random), 0.f)));
+			v.texCoord = { uv(random), uv(random) };
+		}
+
+		return vertices;
+	}
+}
+
+TEST(PackedVertex, ErrorsStayWithinQuantizationBounds)
+{
+	constexpr float scale = 250.f;
+	const auto vertices = RandomVertices(100000, scale);
+	const auto report = VertexPacker::Analyze(vertices);
+
+	// half a UNORM16 step of the widest extent, with room for the float math around it
+	CHECK(report.positionError <= 2.f * scale / 65535.f * 0.5f * 1.01f);
+	// half a UNORM8 step
+	CHECK(report.colorError <= 0.5f / 255.f + 1e-6f);
+	// half float keeps 11 significant bits, so |uv| < 4 rounds to within 2^-10
+	CHECK(report.texCoordError <= 1.f / 1024.f);
+	// SNORM16 octahedral normals come back within a thousandth of a radian; the float acos measuring
+	// the angle is itself only good to a few ten-thousandths near zero
+	CHECK(report.normalError <= 0.001f);
+}
+
+TEST(PackedVertex, ReportsBothSizes)
+{
+	const auto report = VertexPacker::Analyze(RandomVertices(1000, 1.f));
+
+	CHECK(report.fullBytes == 1000 * 44);
+	CHECK(report.packedBytes == 1000 * 20);
+}
+
+TEST(PackedVertex, FlatAxisDecodesExactly)
+{
+	auto vertices = RandomVertices(1000, 10.f);
+
+	for (auto& v : vertices)
+		v.position.y = 3.5f;
+
+	const auto bounds = VertexPacker::ComputeBounds(vertices);
+	CHECK(bounds.extent.y == 0.f);
+
+	for (const auto& v : vertices)
+		CHECK(VertexPacker::Decode(VertexPacker::Encode(v, bounds), bounds).position.y == 3.5f);
+}
+
+TEST(PackedVertex, AxisNormalsRoundTripExactly)
+{
+	const XMFLOAT3 axes[] = { { 1.f, 0.f, 0.f }, { -1.f, 0.f, 0.f }, { 0.f, 1.f, 0.f }, { 0.f, -1.f, 0.f }, { 0.f, 0.f, 1.f }, { 0.f, 0.f, -1.f } };
+
+	for (const auto& axis : axes)
+	{
+		XMFLOAT3 decoded;
+		XMStoreFloat3(&decoded, VertexPacker::DecodeOctahedral(VertexPacker::EncodeOctahedral(XMLoadFloat3(&axis))));
+
+		CHECK_NEAR(decoded.x, axis.x, 1e-6);
+		CHECK_NEAR(decoded.y, axis.y, 1e-6);
+		CHECK_NEAR(decoded.z, axis.z, 1e-6);
+	}
+}
+
+TEST(PackedVertex, ZeroNormalDecodesToUnitVector)
+{
+	SimpleVertex v{};
+	v.normal = { 0.f, 0.f, 0.f };
+
+	const PackedBounds bounds{ { 0.f, 0.f, 0.f, 0.f }, { 1.f, 1.f, 1.f, 0.f } };
+	const auto decoded = VertexPacker::Decode(VertexPacker::Encode(v, bounds), bounds);
+
+	CHECK_NEAR(XMVectorGetX(XMVector3Length(XMLoadFloat3(&decoded.normal))), 1.0, 1e-5);
+}
@@ -0,0 +1,183 @@
+#include "TestFramework.h"
+#include "Primitives.h"
+#include <cmath>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+	struct Geometry
+	{
+		std::vector<SimpleVertex> vertices;
+		std::vector<UINT> indices;
+
+		PrimitiveData Data() const noexcept { return { vertices, indices }; }
+	};
+
+	template<PrimitiveShape Shape>
+	Geometry Generated(const Shape& shape)
+	{
+		Geometry geometry;
+		Primitives::Generate(shape, geometry.vertices, geometry.indices);
+		return geometry;
+	}
+
+	// A point inside the solid near a face, given the face's centroid: its outward normal points away from it.
+	using Inside = XMFLOAT3(*)(XMFLOAT3 centroid);
+
+	XMFLOAT3 Origin(XMFLOAT3) { return {}; }
+	// below the plane
+	XMFLOAT3 Below(XMFLOAT3 centroid) { return { centroid.x, -1.f, centroid.z }; }
+
+	// the nearest point of the circle of radius r in the xz plane, which runs through a ring's solid
+	template<int tenths>
+	XMFLOAT3 Ring(XMFLOAT3 centroid)
+	{
+		const float length = std::sqrt(centroid.x * centroid.x + centroid.z * centroid.z);
+		const float r = tenths / 10.f;
+		return { centroid.x / length * r, 0.f, centroid.z / length * r };
+	}
+
+	struct Shape
+	{
+		PrimitiveData data;
+		Inside inside;
+	};
+
+	// the baked tables and a few other resolutions of each shape
+	std::vector<Shape> Shapes(std::vector<Geometry>& storage)
+	{
+		storage = { Generated(CubeShape{}), Generated(CylinderShape{ 3 }), Generated(CylinderShape{ 5, 2.f, 0.5f, 0.25f }),
+			Generated(ConeShape{ 3 }), Generated(TorusShape{ 7, 5 }), Generated(PlaneShape{ 3, 2.f }), Generated(IcosphereShape{ 1 }),
+			Generated(IcosphereShape{ 7, 3.f }) };
+
+		return { { Primitives::Cube(), Origin }, { Primitives::Tube(), Ring<7> }, { Primitives::Cylinder(), Origin },
+			{ Primitives::Cone(), Origin }, { Primitives::Torus(), Ring<10> }, { Primitives::Plane(), Below },
+			{ Primitives::Icosphere(), Origin }, { storage[0].Data(), Origin }, { storage[1].Data(), Origin },
+			{ storage[2].Data(), Ring<12> }, { storage[3].Data(), Origin }, { storage[4].Data(), Ring<10> },
+			{ storage[5].Data(), Below }, { storage[6].Data(), Origin }, { storage[7].Data(), Origin } };
+	}
+
+	XMFLOAT3 Position(const PrimitiveData& data, size_t i)
+	{
+		return data.vertices[data.indices[i]].position;
+	}
+
+	bool Near(XMFLOAT3 a, XMFLOAT3 b) noexcept
+	{
+		return std::abs(a.x - b.x) <= 1e-5f && std::abs(a.y - b.y) <= 1e-5f && std::abs(a.z - b.z) <= 1e-5f;
+	}
+
+	bool Near(XMFLOAT2 a, XMFLOAT2 b) noexcept
+	{
+		return std::abs(a.x - b.x) <= 1e-5f && std::abs(a.y - b.y) <= 1e-5f;
+	}
+
+	// the same table within rounding, which differs between the constexpr and the library sines
+	bool Same(const PrimitiveData& baked, const PrimitiveData& generated)
+	{
+		if (baked.vertices.size() != generated.vertices.size() || baked.indices.size() != generated.indices.size())
+			return false;
+
+		for (size_t i = 0; i < baked.indices.size(); i++)
+			if (baked.indices[i] != generated.indices[i])
+				return false;
+
+		for (size_t i = 0; i < baked.vertices.size(); i++)
+		{
+			const auto& a = baked.vertices[i];
+			const auto& b = generated.vertices[i];
+
+			if (!Near(a.position, b.position) || !Near(a.color, b.color) || !Near(a.normal, b.normal) || !Near(a.texCoord, b.texCoord))
+				return false;
+		}
+
+		return true;
+	}
+}
+
+TEST(Primitives, IndicesStayInRange)
+{
+	std::vector<Geometry> storage;
+
+	for (const auto& shape : Shapes(storage))
+	{
+		bool inRange = true;
+		for (const UINT index : shape.data.indices)
+			inRange = inRange && index < shape.data.vertices.size();
+
+		CHECK(inRange);
+		CHECK(shape.data.indices.size() % 3 == 0);
+	}
+}
+
+TEST(Primitives, TrianglesFaceOutward)
+{
+	using namespace PrimitiveMath;
+	std::vector<Geometry> storage;
+
+	for (const auto& shape : Shapes(storage))
+	{
+		bool outward = true, agree = true;
+
+		for (size_t i = 0; i < shape.data.indices.size(); i += 3)
+		{
+			const auto a = Position(shape.data, i), b = Position(shape.data, i + 1), c = Position(shape.data, i + 2);
+			const auto normal = Cross(Subtract(b, a), Subtract(c, a));
+			const auto centroid = Scale(Add(Add(a, b), c), 1.f / 3.f);
+
+			// no slivers, and facing away from the inside
+			outward = outward && Dot(normal, normal) > 1e-12f && Dot(normal, Subtract(centroid, shape.inside(centroid))) > 0.f;
+
+			// the vertex normals lean the same way as the face
+			for (int k = 0; k < 3; k++)
+				agree = agree && Dot(normal, shape.data.vertices[shape.data.indices[i + k]].normal) > 0.f;
+		}
+
+		CHECK(outward);
+		CHECK(agree);
+	}
+
+	// the skybox cube is the cube turned inside out
+	bool inward = true;
+	const auto inside = Primitives::CubeInside();
+	for (size_t i = 0; i < inside.indices.size(); i += 3)
+	{
+		const auto a = Position(inside, i), b = Position(inside, i + 1), c = Position(inside, i + 2);
+		inward = inward && Dot(Cross(Subtract(b, a), Subtract(c, a)), Add(Add(a, b), c)) < 0.f;
+	}
+
+	CHECK(inward);
+	CHECK(inside.vertices.data() == Primitives::Cube().vertices.data());
+}
+
+TEST(Primitives, NormalsAreUnitLength)
+{
+	std::vector<Geometry> storage;
+
+	for (const auto& shape : Shapes(storage))
+	{
+		bool unit = true;
+		for (const auto& vertex : shape.data.vertices)
+			unit = unit && std::abs(PrimitiveMath::Dot(vertex.normal, vertex.normal) - 1.f) < 1e-4f;
+
+		CHECK(unit);
+	}
+}
+
+TEST(Primitives, TablesMatchTheGenerator)
+{
+	// the shapes Primitives.cpp bakes, generated again at run time
+	CHECK(Same(Primitives::Cube(), Generated(CubeShape{}).Data()));
+	CHECK(Same(Primitives::Tube(), Generated(CylinderShape{ 8, 1.f, 0.5f, 1.f }).Data()));
+	CHECK(Same(Primitives::Cylinder(), Generated(CylinderShape{}).Data()));
+	CHECK(Same(Primitives::Cone(), Generated(ConeShape{}).Data()));
+	CHECK(Same(Primitives::Torus(), Generated(TorusShape{}).Data()));
+	CHECK(Same(Primitives::Plane(), Generated(PlaneShape{ 8 }).Data()));
+	CHECK(Same(Primitives::Icosphere(), Generated(IcosphereShape{}).Data()));
+
+	// and tables at the sizes the header promises
+	CHECK(Primitives::Tube().vertices.size() == (CylinderShape{ 8, 1.f, 0.5f, 1.f }.VertexCount()));
+	CHECK(Primitives::Plane().indices.size() == 6 * 8 * 8);
+}
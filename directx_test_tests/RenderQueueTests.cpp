@@ -0,0 +1,218 @@
+#include "TestFramework.h"
+#include "RenderQueue.h"
+#include "Timer.h"
+#include <algorithm>
+#include <bit>
+#include <cfloat>
+#include <random>
+#include <utility>
+
+namespace
+{
+	// what a scene submits: both passes, a few shaders and buffers, more meshes, any LOD and depth
+	std::vector<uint64_t> SceneKeys(size_t count)
+	{
+		std::mt19937 random(23);
+		std::vector<uint64_t> keys(count);
+
+		for (auto& key : keys)
+		{
+			const auto pass = random() % 8 == 0 ? RenderPass::UI : RenderPass::Scene;
+			key = RenderQueue::MakeKey(pass, random() % 6, random() % 12, random() % 200, random() % 4,
+				std::uniform_real_distribution<float>(0.5f, 500.f)(random));
+		}
+
+		return keys;
+	}
+
+	std::vector<uint64_t> RandomKeys(size_t count)
+	{
+		std::mt19937_64 random(23);
+		std::vector<uint64_t> keys(count);
+
+		for (auto& key : keys)
+			key = random();
+
+		return keys;
+	}
+
+	bool SortedStably(std::span<const RenderPacket> packets, const std::vector<uint64_t>& keys)
+	{
+		for (size_t i = 0; i < packets.size(); i++)
+		{
+			if (packets[i].key != keys[packets[i].item])
+				return false;
+
+			if (i > 0 && (packets[i - 1].key > packets[i].key || (packets[i - 1].key == packets[i].key && packets[i - 1].item > packets[i].item)))
+				return false;
+		}
+
+		return true;
+	}
+
+	void SubmitAll(RenderQueue& queue, const std::vector<uint64_t>& keys)
+	{
+		queue.Clear();
+
+		for (size_t i = 0; i < keys.size(); i++)
+			queue.Submit(keys[i], UINT(i));
+	}
+}
+
+TEST(RenderQueue, KeysOrderByPassShaderBufferMeshLodDepth)
+{
+	const auto key = [](RenderPass pass, UINT shader, UINT buffer, UINT mesh, size_t lod, float depth)
+	{
+		return RenderQueue::MakeKey(pass, shader, buffer, mesh, lod, depth);
+	};
+
+	CHECK(key(RenderPass::Scene, 4095, 4095, 4095, 15, 1e30f) < key(RenderPass::UI, 0, 0, 0, 0, 0.f));
+	CHECK(key(RenderPass::Scene, 1, 0, 0, 0, 1e30f) < key(RenderPass::Scene, 2, 0, 0, 0, 0.f));
+	CHECK(key(RenderPass::Scene, 1, 1, 0, 0, 1e30f) < key(RenderPass::Scene, 1, 2, 0, 0, 0.f));
+	CHECK(key(RenderPass::Scene, 1, 1, 1, 3, 1e30f) < key(RenderPass::Scene, 1, 1, 2, 0, 0.f));
+	CHECK(key(RenderPass::Scene, 1, 1, 1, 1, 1e30f) < key(RenderPass::Scene, 1, 1, 1, 2, 0.f));
+	CHECK(key(RenderPass::Scene, 1, 1, 1, 1, 2.f) < key(RenderPass::Scene, 1, 1, 1, 1, 3.f));
+	// behind the camera sorts as zero
+	CHECK(key(RenderPass::Scene, 1, 1, 1, 1, -5.f) == key(RenderPass::Scene, 1, 1, 1, 1, 0.f));
+}
+
+TEST(RenderQueue, SortsStably)
+{
+	RenderQueue queue;
+
+	for (size_t count : { 0, 1, 2, 100, 5000 })
+	{
+		for (const auto& keys : { SceneKeys(count), RandomKeys(count) })
+		{
+			SubmitAll(queue, keys);
+			queue.Sort();
+
+			CHECK(queue.Packets().size() == count);
+			CHECK(SortedStably(queue.Packets(), keys));
+		}
+	}
+
+	// many equal keys keep the order they came in
+	std::vector<uint64_t> keys(3000);
+	for (size_t i = 0; i < keys.size(); i++)
+		keys[i] = RenderQueue::MakeKey(RenderPass::Scene, UINT(i % 3), 0, 0, 0, 1.f);
+
+	SubmitAll(queue, keys);
+	queue.Sort();
+	CHECK(SortedStably(queue.Packets(), keys));
+}
+
+TEST(RenderQueue, ItemsKeepTheirKeys)
+{
+	// items far apart take more bits beside the key than indices would
+	constexpr UINT spacing = 40000;
+	const auto keys = SceneKeys(5000);
+	RenderQueue queue;
+
+	for (size_t i = 0; i < keys.size(); i++)
+		queue.Submit(keys[i], UINT(i) * spacing);
+
+	queue.Sort();
+
+	const auto packets = queue.Packets();
+	bool kept = true, sorted = true;
+
+	for (size_t i = 0; i < packets.size(); i++)
+	{
+		kept = kept && packets[i].item % spacing == 0 && packets[i].key == keys[packets[i].item / spacing];
+		sorted = sorted && (i == 0 || packets[i - 1].key <= packets[i].key);
+	}
+
+	CHECK(packets.size() == keys.size());
+	CHECK(kept);
+	CHECK(sorted);
+}
+
+TEST(RenderQueue, IdsLastOneBatch)
+{
+	RenderQueue queue;
+	std::vector<int> resources(1 << RenderQueue::IdBits);
+
+	// every id the bits hold, each once
+	bool distinct = true;
+	for (size_t i = 0; i < resources.size(); i++)
+		distinct = distinct && queue.Id(&resources[i]) == i;
+
+	CHECK(distinct);
+	CHECK(queue.Id(&resources[1]) == 1);
+
+	// after a Clear the numbering starts over, so no address keeps an id from an earlier frame
+	queue.Clear();
+	CHECK(queue.Id(&resources.back()) == 0);
+	CHECK(queue.Id(&resources[1]) == 1);
+	CHECK(queue.Id(&resources.back()) == 0);
+}
+
+// The sort against what the host can do at all: one radix pass over as many 8 byte words, with 11 bit
+// digits, and std::sort.
+BENCHMARK(RenderQueue, Sort100k)
+{
+	constexpr size_t count = 100000;
+	constexpr int runs = 50;
+
+	RenderQueue queue;
+
+	const auto run = [&](const char* name, const std::vector<uint64_t>& keys)
+	{
+		uint64_t varying = 0;
+		for (const uint64_t key : keys)
+			varying |= key ^ keys[0];
+
+		float best = FLT_MAX, total = 0.f;
+
+		for (int i = 0; i < runs; i++)
+		{
+			SubmitAll(queue, keys);
+			Timer timer;
+
+			queue.Sort();
+
+			const float elapsed = timer.Peek();
+			best = std::min(best, elapsed);
+			total += elapsed;
+		}
+
+		testing::Report("%-12s %zu packets, %2d bits vary: %.3f ms, best %.3f ms", name, count, std::popcount(varying),
+			total / runs * 1000.f, best * 1000.f);
+	};
+
+	run("scene keys", SceneKeys(count));
+	run("random keys", RandomKeys(count));
+
+	const auto words = RandomKeys(count);
+	std::vector<uint64_t> scattered(count), sorted;
+	std::vector<UINT> histogram(2048);
+	float bestPass = FLT_MAX, bestSort = FLT_MAX;
+
+	for (int i = 0; i < runs; i++)
+	{
+		Timer timer;
+
+		std::fill(histogram.begin(), histogram.end(), 0);
+		for (const uint64_t word : words)
+			histogram[word & 2047]++;
+
+		UINT offset = 0;
+		for (auto& bucket : histogram)
+			offset += std::exchange(bucket, offset);
+
+		for (const uint64_t word : words)
+			scattered[histogram[word & 2047]++] = word;
+
+		bestPass = std::min(bestPass, timer.Peek());
+		testing::Consume(scattered);
+
+		sorted = words;
+		timer.Mark();
+		std::sort(sorted.begin(), sorted.end());
+		bestSort = std::min(bestSort, timer.Peek());
+	}
+
+	testing::Report("%-12s %zu words: best %.3f ms", "one pass", count, bestPass * 1000.f);
+	testing::Report("%-12s %zu words: best %.3f ms", "std::sort", count, bestSort * 1000.f);
+}
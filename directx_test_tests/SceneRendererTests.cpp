@@ -0,0 +1,305 @@
+#include "TestFramework.h"
+#include "DemoHarness.h"
+#include "MeshLibrary.h"
+#include "Primitives.h"
+#include "RecordingRenderDevice.h"
+#include "Timer.h"
+#include <algorithm>
+#include <cfloat>
+
+namespace
+{
+	size_t CountOps(const RecordingRenderDevice& device, RenderOp op)
+	{
+		const auto commands = device.Commands();
+		return std::count_if(commands.begin(), commands.end(), [op](const RenderCommand& c) { return c.op == op; });
+	}
+
+	struct ReplayCounts
+	{
+		size_t pixelShaders = 0;
+		size_t vertexBuffers = 0;
+		size_t indexBuffers = 0;
+		size_t drawCalls = 0;
+		size_t bufferUpdates = 0;
+		size_t bytesUploaded = 0;
+		// drawing and submitting the objects, not making them
+		float seconds = 0.f;
+
+		size_t Binds() const noexcept { return pixelShaders + vertexBuffers + indexBuffers; }
+	};
+
+	// A frame of objects objects made in turn from two meshes and three pixel shaders, so that no two
+	// made one after the other share either. Submitted once per object, they are drawn in the order
+	// they were made, the way the main loop drew them before the queue; submitted once, sorted. Without
+	// the constant ring, world matrices go through the small object buffer the way they do on devices
+	// that cannot bind constant buffer ranges.
+	ReplayCounts ReplayObjects(int objects, bool sorted, bool instancing, bool constantRing = true)
+	{
+		testing::NamedBufferFactory factory;
+		testing::FakeRenderResources fakes(&factory);
+		auto resources = fakes.resources;
+
+		if (!instancing)
+			resources.instancedVertexShader = nullptr;
+
+		if (!constantRing)
+			resources.constantRing = nullptr;
+
+		RecordingRenderDevice device;
+		SceneRenderer renderer(&device, resources, 1600, 900);
+
+		MeshLibrary meshes(&factory);
+		const MeshHandle handles[] = { meshes.Create(), meshes.Create() };
+		meshes.Get(handles[0])->SetVertices(Primitives::Cube().vertices);
+		meshes.Get(handles[0])->SetIndices(Primitives::Cube().indices);
+		meshes.Get(handles[1])->SetVertices(Primitives::Tube().vertices);
+		meshes.Get(handles[1])->SetIndices(Primitives::Tube().indices);
+
+		ID3D11PixelShader* const shaders[] = { fakes.shaders.light, fakes.shaders.texture, fakes.shaders.custom };
+		Scene scene;
+
+		for (int i = 0; i < objects; i++)
+		{
+			auto* object = scene.CreateObject();
+			object->SetMesh(meshes, handles[i % 2]);
+			object->GetMeshRenderer().SetPixelShader(shaders[i % 3]);
+			object->GetTransform().position = { float(i % 40) - 20.f, float(i / 40 % 25) - 12.f, 10.f + float(i / 1000) };
+		}
+
+		device.Clear();
+		Timer timer;
+		renderer.Render(0.f);
+
+		for (const auto& object : scene.Objects())
+		{
+			renderer.Draw(*object, 0.f);
+
+			if (!sorted)
+				renderer.Submit();
+		}
+
+		renderer.Submit();
+
+		ReplayCounts counts;
+		counts.seconds = timer.Peek();
+		counts.pixelShaders = CountOps(device, RenderOp::SetPixelShader);
+		counts.vertexBuffers = CountOps(device, RenderOp::SetVertexBuffers);
+		counts.indexBuffers = CountOps(device, RenderOp::SetIndexBuffer);
+		counts.drawCalls = device.Stats().drawCalls;
+		counts.bufferUpdates = device.Stats().bufferUpdates;
+		counts.bytesUploaded = device.Stats().bytesUploaded;
+
+		return counts;
+	}
+}
+
+TEST(SceneRenderer, DemoFrameIsRecorded)
+{
+	testing::NamedBufferFactory factory;
+	testing::FakeRenderResources fakes(&factory);
+	RecordingRenderDevice device;
+	testing::DemoHarness demo(&device, &factory, fakes.resources, fakes.shaders, fakes.skyShader);
+
+	device.Clear();
+	demo.Frame();
+
+	const auto& stats = device.Stats();
+	const auto& frame = demo.renderer.GetFrameStats();
+
+	// the sky and the UI cube on their own, the rest either alone or in instanced batches
+	CHECK(stats.drawCalls >= 3);
+	CHECK(stats.drawCalls == CountOps(device, RenderOp::DrawIndexed) + CountOps(device, RenderOp::DrawIndexedInstanced));
+	// the two circling cubes share a mesh and a shader
+	CHECK(stats.instancesDrawn == 2);
+	CHECK(stats.instancesDrawn == frame.instances);
+	CHECK(stats.bytesUploaded == frame.bytesUploaded);
+	CHECK(CountOps(device, RenderOp::ClearRenderTarget) == 1);
+
+	// the sky draws from the positions-only layout with its own shaders
+	const auto commands = device.Commands();
+	CHECK(std::any_of(commands.begin(), commands.end(), [&](const RenderCommand& c)
+		{ return c.op == RenderOp::SetInputLayout && c.object == fakes.resources.positionVertexLayout; }));
+	CHECK(std::any_of(commands.begin(), commands.end(), [&](const RenderCommand& c)
+		{ return c.op == RenderOp::SetPixelShader && c.object == fakes.skyShader; }));
+
+	// every pixel shader the scene uses is bound
+	for (auto* shader : { fakes.shaders.light, fakes.shaders.solidColor, fakes.shaders.texture, fakes.shaders.custom })
+	{
+		CHECK(std::any_of(commands.begin(), commands.end(), [&](const RenderCommand& c)
+			{ return c.op == RenderOp::SetPixelShader && c.object == shader; }));
+	}
+}
+
+TEST(SceneRenderer, DemoFramesAreAlike)
+{
+	testing::NamedBufferFactory factory;
+	testing::FakeRenderResources fakes(&factory);
+	RecordingRenderDevice device;
+	testing::DemoHarness demo(&device, &factory, fakes.resources, fakes.shaders, fakes.skyShader);
+
+	demo.Frame();
+	device.Clear();
+	demo.Frame();
+	const auto second = device.Stats();
+
+	for (int i = 0; i < 10; i++)
+	{
+		device.Clear();
+		demo.Frame();
+	}
+
+	// the objects move, but what is drawn and bound stays the same from frame to frame
+	CHECK(device.Stats().commands == second.commands);
+	CHECK(device.Stats().drawCalls == second.drawCalls);
+	CHECK(device.Stats().stateChanges == second.stateChanges);
+	CHECK(device.Stats().bytesUploaded == second.bytesUploaded);
+}
+
+TEST(SceneRenderer, SortingSkipsRebinds)
+{
+	const auto unsorted = ReplayObjects(600, false, false);
+	const auto sorted = ReplayObjects(600, true, false);
+
+	// every draw in the order the objects were made changes the shader and the mesh
+	CHECK(unsorted.drawCalls == 600);
+	CHECK(unsorted.pixelShaders >= 600);
+	CHECK(unsorted.vertexBuffers >= 600);
+	CHECK(unsorted.indexBuffers >= 600);
+
+	// sorted, each of the three shaders is bound once, and each mesh once per shader
+	CHECK(sorted.drawCalls == 600);
+	CHECK(sorted.pixelShaders == 3);
+	CHECK(sorted.vertexBuffers == 6);
+	CHECK(sorted.indexBuffers == 6);
+
+	// and instanced, a draw per shader and mesh
+	CHECK(ReplayObjects(600, true, true).drawCalls == 6);
+}
+
+TEST(SceneRenderer, InstancingBatchesDraws)
+{
+	const auto single = ReplayObjects(600, true, false);
+	const auto instanced = ReplayObjects(600, true, true);
+
+	// one draw per shader and mesh, and the matrices of a batch written together instead of once per object
+	CHECK(single.drawCalls == 600);
+	CHECK(instanced.drawCalls == 6);
+	CHECK(single.bufferUpdates >= 600);
+	CHECK(instanced.bufferUpdates * 20 < single.bufferUpdates);
+	CHECK(instanced.Binds() == single.Binds());
+}
+
+TEST(SceneRenderer, UploadsAWorldMatrixPerObject)
+{
+	constexpr int objects = 600;
+	// the light and the view and projection of the one pass, once a frame
+	constexpr size_t frameBytes = sizeof(PixelConstantBuffer) + sizeof(FrameConstantBuffer);
+
+	for (const bool constantRing : { true, false })
+	{
+		const auto counts = ReplayObjects(objects, true, false, constantRing);
+
+		CHECK(counts.bytesUploaded == objects * sizeof(ObjectConstantBuffer) + frameBytes);
+		CHECK(counts.bufferUpdates == objects + 2);
+	}
+
+	// instanced, the matrices go in the instance buffer and the object constants are not written at all
+	CHECK(ReplayObjects(objects, true, true).bytesUploaded == objects * sizeof(DirectX::XMFLOAT4X4) + frameBytes);
+}
+
+// Binds per frame for the objects of ReplayObjects, in the order they were made and sorted.
+BENCHMARK(SceneRenderer, BindCounts)
+{
+	constexpr int objects = 1000;
+
+	const auto report = [](const char* name, const ReplayCounts& counts)
+	{
+		testing::Report("%-28s %4zu pixel shader, %4zu vertex buffer, %4zu index buffer binds, %4zu in all, %4zu draw calls",
+			name, counts.pixelShaders, counts.vertexBuffers, counts.indexBuffers, counts.Binds(), counts.drawCalls);
+	};
+
+	report("in the order made", ReplayObjects(objects, false, false));
+	report("sorted", ReplayObjects(objects, true, false));
+	report("sorted and instanced", ReplayObjects(objects, true, true));
+}
+
+// WinMain's scene submitted through SceneRenderer to a RecordingRenderDevice: the CPU cost of a frame
+// with no driver underneath, and what the frame asks of the device.
+BENCHMARK(SceneRenderer, DemoSceneRecording)
+{
+	constexpr int frames = 1000;
+
+	testing::NamedBufferFactory factory;
+	testing::FakeRenderResources fakes(&factory);
+	RecordingRenderDevice device;
+	testing::DemoHarness demo(&device, &factory, fakes.resources, fakes.shaders, fakes.skyShader);
+
+	// the first frames grow the log and the queue
+	for (int i = 0; i < 10; i++)
+	{
+		device.Clear();
+		demo.Frame();
+	}
+
+	float total = 0.f, best = FLT_MAX;
+
+	for (int i = 0; i < frames; i++)
+	{
+		device.Clear();
+		Timer timer;
+
+		demo.Frame();
+
+		const float elapsed = timer.Peek();
+		total += elapsed;
+		best = std::min(best, elapsed);
+	}
+
+	const auto& stats = device.Stats();
+	testing::Report("%d frames: %.1f us per frame, best %.1f us", frames, total / frames * 1e6f, best * 1e6f);
+	testing::Report("per frame: %zu commands, %zu draw calls (%zu instances), %zu state changes (%zu redundant), %zu buffer updates, %zu bytes uploaded",
+		stats.commands, stats.drawCalls, stats.instancesDrawn, stats.stateChanges, stats.redundantStateChanges, stats.bufferUpdates, stats.bytesUploaded);
+}
+
+// The objects of ReplayObjects at the count the instancing was measured with, drawn one by one and in
+// instanced batches.
+BENCHMARK(SceneRenderer, Instancing20k)
+{
+	constexpr int objects = 20000;
+
+	const auto report = [](const char* name, const ReplayCounts& counts)
+	{
+		testing::Report("%-10s %d objects: %5zu draw calls, %5zu buffer updates, %.2f ms", name, objects,
+			counts.drawCalls, counts.bufferUpdates, counts.seconds * 1000.f);
+	};
+
+	report("single", ReplayObjects(objects, true, false));
+	report("instanced", ReplayObjects(objects, true, true));
+}
+
+
+// What a frame of ReplayObjects hands to the device, against what the same frame uploaded when every
+// object wrote view, projection and light along with its world matrix.
+BENCHMARK(SceneRenderer, UploadedBytes20k)
+{
+	constexpr int objects = 20000;
+	constexpr size_t combinedBytes = sizeof(FrameConstantBuffer) + sizeof(ObjectConstantBuffer) + sizeof(PixelConstantBuffer);
+
+	const auto report = [](const char* name, size_t bytes, size_t updates)
+	{
+		testing::Report("%-22s %d objects: %8zu bytes, %5.1f per object, %5zu buffer updates", name, objects,
+			bytes, double(bytes) / objects, updates);
+	};
+
+	report("constants per object", objects * combinedBytes, 2 * size_t(objects));
+
+	const auto ring = ReplayObjects(objects, true, false);
+	report("constant ring", ring.bytesUploaded, ring.bufferUpdates);
+
+	const auto buffer = ReplayObjects(objects, true, false, false);
+	report("object buffer", buffer.bytesUploaded, buffer.bufferUpdates);
+
+	const auto instanced = ReplayObjects(objects, true, true);
+	report("instanced", instanced.bytesUploaded, instanced.bufferUpdates);
+}
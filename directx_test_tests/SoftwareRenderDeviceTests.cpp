@@ -0,0 +1,210 @@
+#include "TestFramework.h"
+#include "DemoHarness.h"
+#include "Parallel.h"
+#include "RecordingRenderDevice.h"
+#include "Timer.h"
+#include <algorithm>
+#include <cfloat>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace
+{
+	constexpr int referenceWidth = 320;
+	constexpr int referenceHeight = 180;
+	// far enough in for the cubes and the cylinder to have moved off their starting points
+	constexpr int referenceFrames = 30;
+
+	std::filesystem::path ReferenceImage()
+	{
+		return std::filesystem::path(__FILE__).parent_path() / "reference" / "DemoScene.bmp";
+	}
+
+	// The B8G8R8A8 texels of a top-down 32 bit bitmap as SoftwareRenderDevice::WriteBitmap writes them,
+	// or nothing if the file is not one of width x height.
+	std::vector<uint32_t> ReadBitmap(const std::filesystem::path& path, int width, int height)
+	{
+		constexpr size_t headerBytes = 14 + 40;
+		std::ifstream file(path, std::ios::binary);
+		std::vector<char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+		if (bytes.size() != headerBytes + size_t(width) * height * sizeof(uint32_t))
+			return {};
+
+		std::vector<uint32_t> texels(size_t(width) * height);
+		std::memcpy(texels.data(), bytes.data() + headerBytes, texels.size() * sizeof(uint32_t));
+
+		return texels;
+	}
+
+	// copied out row by row, without the padding up to the device's row pitch
+	std::vector<uint32_t> Rows(SoftwareRenderDevice& device)
+	{
+		const auto pixels = device.Pixels();
+		std::vector<uint32_t> rows;
+
+		for (UINT y = 0; y < device.Height(); y++)
+			rows.insert(rows.end(), pixels.begin() + size_t(y) * device.RowPitch(), pixels.begin() + size_t(y) * device.RowPitch() + device.Width());
+
+		return rows;
+	}
+
+	int ChannelDifference(uint32_t a, uint32_t b) noexcept
+	{
+		int largest = 0;
+
+		for (int shift = 0; shift < 32; shift += 8)
+			largest = std::max(largest, std::abs(int(a >> shift & 0xFF) - int(b >> shift & 0xFF)));
+
+		return largest;
+	}
+}
+
+TEST(SoftwareRenderDevice, DrawsTheWholeDemoScene)
+{
+	SoftwareRenderDevice device(referenceWidth, referenceHeight);
+	const auto resources = testing::SoftwareDemoResources(device);
+	testing::DemoHarness demo(&device, &device, resources, testing::SoftwareDemoShaders(device),
+		device.PixelShader(PixelKernel::SkymapPShader), referenceWidth, referenceHeight);
+
+	demo.Frame();
+	device.Flush();
+
+	const auto& stats = device.Stats();
+
+	// the same frame recorded, to count the draws SceneRenderer issues
+	testing::NamedBufferFactory factory;
+	testing::FakeRenderResources fakes(&factory);
+	RecordingRenderDevice recording;
+	testing::DemoHarness recorded(&recording, &factory, fakes.resources, fakes.shaders, fakes.skyShader, referenceWidth, referenceHeight);
+	recorded.Frame();
+
+	// the split cube and the sky sharing its buffers included
+	CHECK(stats.skippedDraws == 0);
+	CHECK(stats.drawCalls == recording.Stats().drawCalls);
+	CHECK(stats.pixelsShaded >= size_t(referenceWidth) * referenceHeight);
+
+	// the sky covers whatever the objects leave, so nothing keeps SceneRenderer's gray clear color
+	const auto rows = Rows(device);
+	CHECK(std::count(rows.begin(), rows.end(), 0xFF808080u) == 0);
+}
+
+// The circling cubes share a mesh and a shader and are drawn as one instanced batch; drawn one by one
+// instead, the frame must come out texel for texel the same.
+TEST(SoftwareRenderDevice, InstancingDrawsTheSamePixels)
+{
+	const auto render = [](bool instancing, size_t& instancedDraws)
+	{
+		SoftwareRenderDevice device(referenceWidth, referenceHeight);
+		auto resources = testing::SoftwareDemoResources(device);
+
+		if (!instancing)
+			resources.instancedVertexShader = nullptr;
+
+		testing::DemoHarness demo(&device, &device, resources, testing::SoftwareDemoShaders(device),
+			device.PixelShader(PixelKernel::SkymapPShader), referenceWidth, referenceHeight);
+
+		for (int i = 0; i < referenceFrames; i++)
+			demo.Frame();
+
+		device.Flush();
+		instancedDraws = demo.renderer.GetFrameStats().instancedDraws;
+
+		return Rows(device);
+	};
+
+	size_t instancedDraws = 0, singleDraws = 0;
+	const auto instanced = render(true, instancedDraws);
+	const auto single = render(false, singleDraws);
+
+	CHECK(instancedDraws > 0);
+	CHECK(singleDraws == 0);
+	CHECK(instanced == single);
+}
+
+// Renders the demo scene small and compares it with a bitmap kept beside the tests. Rounding differs
+// between compilers and DirectXMath builds, so texels may be a little off and a few along edges may be
+// entirely different. Without a reference the test writes one, to be looked at and checked in.
+TEST(SoftwareRenderDevice, DemoSceneMatchesReference)
+{
+	SoftwareRenderDevice device(referenceWidth, referenceHeight);
+	const auto resources = testing::SoftwareDemoResources(device);
+	testing::DemoHarness demo(&device, &device, resources, testing::SoftwareDemoShaders(device),
+		device.PixelShader(PixelKernel::SkymapPShader), referenceWidth, referenceHeight);
+
+	for (int i = 0; i < referenceFrames; i++)
+		demo.Frame();
+
+	const auto rendered = Rows(device);
+	const auto reference = ReadBitmap(ReferenceImage(), referenceWidth, referenceHeight);
+
+	if (reference.empty())
+	{
+		std::filesystem::create_directories(ReferenceImage().parent_path());
+		device.WriteBitmap(ReferenceImage().wstring());
+		testing::Report("no reference image, wrote %s", ReferenceImage().string().c_str());
+		CHECK(!reference.empty());
+		return;
+	}
+
+	size_t off = 0;
+	int largest = 0;
+
+	for (size_t i = 0; i < rendered.size(); i++)
+	{
+		const int difference = ChannelDifference(rendered[i], reference[i]);
+		off += difference > 8;
+		largest = std::max(largest, difference);
+	}
+
+	// at most one texel in 200
+	CHECK(off * 200 <= rendered.size());
+
+	if (off * 200 > rendered.size())
+	{
+		const auto actual = testing::ScratchDirectory() / "DemoScene.bmp";
+		device.WriteBitmap(actual.wstring());
+		testing::Report("%zu texels off by more than 8, at most %d; rendered %s", off, largest, actual.string().c_str());
+	}
+}
+
+// WinMain's scene rasterized at WinMain's size, over however many threads ParallelFor uses.
+BENCHMARK(SoftwareRenderDevice, DemoScene1600x900)
+{
+	constexpr int width = 1600, height = 900;
+	constexpr int frames = 20;
+
+	SoftwareRenderDevice device(width, height);
+	const auto resources = testing::SoftwareDemoResources(device);
+	testing::DemoHarness demo(&device, &device, resources, testing::SoftwareDemoShaders(device),
+		device.PixelShader(PixelKernel::SkymapPShader), width, height);
+
+	for (int i = 0; i < 3; i++)
+	{
+		demo.Frame();
+		device.Flush();
+	}
+
+	device.ResetStats();
+	float total = 0.f, best = FLT_MAX;
+
+	for (int i = 0; i < frames; i++)
+	{
+		Timer timer;
+
+		demo.Frame();
+		device.Flush();
+
+		const float elapsed = timer.Peek();
+		total += elapsed;
+		best = std::min(best, elapsed);
+	}
+
+	const auto& stats = device.Stats();
+	testing::Report("%dx%d on %zu threads: %.1f FPS, %.2f ms per frame, best %.2f ms", width, height, ParallelThreadCount(),
+		frames / total, total / frames * 1000.f, best * 1000.f);
+	testing::Report("per frame: %zu draw calls, %zu triangles binned, %zu clipped, %zu pixels shaded",
+		stats.drawCalls / frames, stats.trianglesBinned / frames, stats.trianglesClipped / frames, stats.pixelsShaded / frames);
+}
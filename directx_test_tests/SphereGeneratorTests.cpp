@@ -0,0 +1,224 @@
+#include "TestFramework.h"
+#include "SphereGenerator.h"
+#include "Timer.h"
+#include <DirectXColors.h>
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+using namespace DirectX;
+
+namespace
+{
+	// Mesh::MakeSphere as it was before SphereGenerator: positions computed one at a time, four vertices
+	// per position pushed back one by one, kept as the reference the generator is measured against.
+	struct LegacySphere
+	{
+		std::vector<SimpleVertex> vertices;
+		std::vector<UINT> indices;
+
+		void AddTriangle(UINT i0, UINT i1, UINT i2)
+		{
+			indices.push_back(i0);
+			indices.push_back(i1);
+			indices.push_back(i2);
+		}
+
+		void AddQuad(UINT i0, UINT i1, UINT i2, UINT i3)
+		{
+			AddTriangle(i0, i1, i2);
+			AddTriangle(i0, i2, i3);
+		}
+
+		// the four vertices of a ring position, one per adjacent quad
+		void AddCorners(SimpleVertex vertex, FXMVECTOR up, FXMVECTOR right, FXMVECTOR down, GXMVECTOR left)
+		{
+			XMStoreFloat3(&vertex.normal, XMVector3Cross(up, right));
+			vertices.push_back(vertex);
+			XMStoreFloat3(&vertex.normal, XMVector3Cross(left, up));
+			vertices.push_back(vertex);
+			XMStoreFloat3(&vertex.normal, XMVector3Cross(down, left));
+			vertices.push_back(vertex);
+			XMStoreFloat3(&vertex.normal, XMVector3Cross(right, down));
+			vertices.push_back(vertex);
+		}
+
+		LegacySphere(int slices, int stacks, FXMVECTOR color)
+		{
+			std::vector<XMVECTOR> positions;
+			positions.reserve(size_t(stacks - 1) * slices);
+
+			for (int i = 1; i < stacks; i++)
+			{
+				const auto phi = XM_PI * i / stacks;
+
+				for (int j = 0; j < slices; j++)
+				{
+					// the pinched middle ring the demo sphere has always had
+					const float dist = i - 1 == (stacks - 1) / 2 ? 0.2f : 1.f;
+					const auto theta = XM_2PI * j / slices;
+					const auto sinphi = std::sin(phi);
+
+					positions.push_back(XMVectorSet(sinphi * std::cos(theta) * dist, std::cos(phi), sinphi * std::sin(theta) * dist, 0.f));
+				}
+			}
+
+			const auto top = XMVectorSet(0.f, 1.f, 0.f, 0.f);
+			const auto bottom = XMVectorSet(0.f, -1.f, 0.f, 0.f);
+			const auto at = [&](int ring, int slice) { return positions[size_t(ring) * slices + (slice + slices) % slices]; };
+
+			SimpleVertex vertex{};
+			XMStoreFloat3(&vertex.color, color);
+			XMStoreFloat3(&vertex.position, top);
+
+			for (int j = 0; j < slices; j++)
+			{
+				XMStoreFloat3(&vertex.normal, XMVector3Cross(XMVectorSubtract(top, at(0, j)), XMVectorSubtract(at(0, j + 1), at(0, j))));
+				vertices.push_back(vertex);
+			}
+
+			for (int i = 0; i < stacks - 1; i++)
+			{
+				for (int j = 0; j < slices; j++)
+				{
+					const auto position = at(i, j);
+					XMStoreFloat3(&vertex.position, position);
+
+					const auto up = XMVectorSubtract(i == 0 ? top : at(i - 1, j), position);
+					const auto down = XMVectorSubtract(i == stacks - 2 ? bottom : at(i + 1, j), position);
+					AddCorners(vertex, up, XMVectorSubtract(at(i, j + 1), position), down, XMVectorSubtract(at(i, j - 1), position));
+				}
+			}
+
+			XMStoreFloat3(&vertex.position, bottom);
+
+			for (int j = 0; j < slices; j++)
+			{
+				XMStoreFloat3(&vertex.normal, XMVector3Cross(XMVectorSubtract(at(stacks - 2, j), bottom),
+					XMVectorSubtract(at(stacks - 2, j + 1), bottom)));
+				vertices.push_back(vertex);
+			}
+
+			for (int i = 0; i < slices; i++)
+			{
+				AddTriangle(i, 4 * ((i + 1) % slices) + slices + 1, 4 * i + slices);
+
+				const UINT b = UINT(vertices.size() - slices);
+				AddTriangle(b + i, b - slices * 4 + i * 4 + 3, b - slices * 4 + ((i + 1) % slices) * 4 + 2);
+			}
+
+			for (int i = 0; i < stacks - 2; i++)
+			{
+				for (int j = 0; j < slices; j++)
+				{
+					AddQuad(slices + 4 * slices * i + 4 * j + 3, slices + 4 * slices * i + 4 * ((j + 1) % slices) + 2,
+						slices + 4 * slices * (i + 1) + 4 * ((j + 1) % slices) + 1, slices + 4 * slices * (i + 1) + 4 * j);
+				}
+			}
+		}
+	};
+
+	bool Near(const XMFLOAT3& a, const XMFLOAT3& b, float tolerance) noexcept
+	{
+		return std::abs(a.x - b.x) <= tolerance && std::abs(a.y - b.y) <= tolerance && std::abs(a.z - b.z) <= tolerance;
+	}
+
+	size_t Bytes(size_t vertexCount, size_t indexCount) noexcept
+	{
+		return vertexCount * sizeof(SimpleVertex) + indexCount * sizeof(UINT);
+	}
+}
+
+TEST(SphereGenerator, FacetedMatchesLegacy)
+{
+	for (const auto& [slices, stacks] : { std::pair(12, 8), std::pair(7, 3), std::pair(33, 16) })
+	{
+		const LegacySphere legacy(slices, stacks, Colors::White);
+		std::vector<SimpleVertex> vertices;
+		std::vector<UINT> indices;
+		SphereGenerator::Generate(slices, stacks, Colors::White, SphereNormals::Faceted, vertices, indices);
+
+		REQUIRE(vertices.size() == legacy.vertices.size());
+		CHECK(indices == legacy.indices);
+
+		// sines from XMVectorSinCos instead of std::sin
+		bool same = true;
+		for (size_t i = 0; i < vertices.size(); i++)
+		{
+			same = same && Near(vertices[i].position, legacy.vertices[i].position, 1e-5f)
+				&& Near(vertices[i].normal, legacy.vertices[i].normal, 1e-4f);
+		}
+
+		CHECK(same);
+	}
+}
+
+TEST(SphereGenerator, SmoothSharesEveryPosition)
+{
+	std::vector<SimpleVertex> vertices;
+	std::vector<UINT> indices;
+	SphereGenerator::Generate(24, 12, Colors::White, SphereNormals::Smooth, vertices, indices);
+
+	// one vertex per ring position and one per pole, against four per position and one per slice at the poles
+	CHECK(vertices.size() == size_t(11) * 24 + 2);
+	CHECK(SphereGenerator::VertexCount(24, 12, SphereNormals::Faceted) == size_t(11) * 24 * 4 + 2 * 24);
+	CHECK(indices.size() == SphereGenerator::IndexCount(24, 12));
+	CHECK(std::all_of(indices.begin(), indices.end(), [&](UINT i) { return i < vertices.size(); }));
+
+	bool unit = true;
+	for (const auto& vertex : vertices)
+		unit = unit && std::abs(XMVectorGetX(XMVector3Length(XMLoadFloat3(&vertex.normal))) - 1.f) < 1e-4f;
+
+	CHECK(unit);
+}
+
+// The generator in both normal modes against the old MakeSphere, at square resolutions.
+BENCHMARK(SphereGenerator, AgainstLegacy)
+{
+	const auto report = [](const char* name, int size, size_t vertexCount, size_t indexCount, float best)
+	{
+		testing::Report("%4dx%-4d %-8s %8zu vertices, %7.1f MB, %8.2f ms", size, size, name, vertexCount,
+			Bytes(vertexCount, indexCount) / (1024.0 * 1024.0), best * 1000.f);
+	};
+
+	for (const int size : { 64, 128, 256, 512, 1024 })
+	{
+		// fewer runs where one takes a while
+		const int runs = size >= 512 ? 2 : 5;
+		float best = FLT_MAX;
+		size_t vertexCount = 0, indexCount = 0;
+
+		for (int i = 0; i < runs; i++)
+		{
+			Timer timer;
+			const LegacySphere legacy(size, size, Colors::White);
+			best = std::min(best, timer.Peek());
+			vertexCount = legacy.vertices.size();
+			indexCount = legacy.indices.size();
+			testing::Consume(legacy);
+		}
+
+		report("legacy", size, vertexCount, indexCount, best);
+
+		for (const auto& [name, normals] : { std::pair("faceted", SphereNormals::Faceted), std::pair("smooth", SphereNormals::Smooth) })
+		{
+			best = FLT_MAX;
+
+			for (int i = 0; i < runs; i++)
+			{
+				std::vector<SimpleVertex> vertices;
+				std::vector<UINT> indices;
+				Timer timer;
+				SphereGenerator::Generate(size, size, Colors::White, normals, vertices, indices);
+				best = std::min(best, timer.Peek());
+				vertexCount = vertices.size();
+				indexCount = indices.size();
+				testing::Consume(vertices);
+			}
+
+			report(name, size, vertexCount, indexCount, best);
+		}
+	}
+}
@@ -0,0 +1,145 @@
+#include "TestFramework.h"
+#include <atomic>
+#include <cstdarg>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace
+{
+	struct Entry
+	{
+		const char* suite;
+		const char* name;
+		testing::TestFunction function;
+		bool benchmark;
+	};
+
+	std::vector<Entry>& Entries()
+	{
+		static std::vector<Entry> entries;
+		return entries;
+	}
+
+	const Entry* current = nullptr;
+	bool currentFailed = false;
+
+	std::atomic<size_t> allocationCount = 0;
+	std::atomic<size_t> allocationBytes = 0;
+}
+
+// every plain new in the program comes through here; the array forms forward to it
+void* operator new(size_t size)
+{
+	allocationCount++;
+	allocationBytes += size;
+
+	if (void* memory = std::malloc(size ? size : 1))
+		return memory;
+
+	throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+	std::free(memory);
+}
+
+testing::Registration::Registration(const char* suite, const char* name, TestFunction function, bool benchmark) noexcept
+{
+	Entries().push_back({ suite, name, function, benchmark });
+}
+
+void testing::Fail(const char* file, int line, const char* expression) noexcept
+{
+	std::printf("%s(%d): %s.%s failed: %s\n", file, line, current->suite, current->name, expression);
+	currentFailed = true;
+}
+
+bool testing::Failed() noexcept
+{
+	return currentFailed;
+}
+
+void testing::Report(const char* format, ...) noexcept
+{
+	std::printf("%s.%s: ", current->suite, current->name);
+
+	va_list args;
+	va_start(args, format);
+	std::vprintf(format, args);
+	va_end(args);
+
+	std::printf("\n");
+	std::fflush(stdout);
+}
+
+testing::AllocationCount testing::Allocations() noexcept
+{
+	return { allocationCount, allocationBytes };
+}
+
+std::filesystem::path testing::ScratchDirectory()
+{
+	const auto directory = std::filesystem::temp_directory_path() / "directx_test_tests" / (std::string(current->suite) + "." + current->name);
+
+	std::filesystem::remove_all(directory);
+	std::filesystem::create_directories(directory);
+
+	return directory;
+}
+
+// directx_test_tests              runs every test
+// directx_test_tests --bench      runs every benchmark
+// either can be followed by a filter that has to appear in Suite.Name
+int main(int argc, char** argv)
+{
+	bool benchmarks = false;
+	const char* filter = "";
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (std::strcmp(argv[i], "--bench") == 0)
+			benchmarks = true;
+		else
+			filter = argv[i];
+	}
+
+	int run = 0, failed = 0;
+
+	for (const auto& entry : Entries())
+	{
+		const std::string fullName = std::string(entry.suite) + "." + entry.name;
+
+		if (entry.benchmark != benchmarks || fullName.find(filter) == std::string::npos)
+			continue;
+
+		current = &entry;
+		currentFailed = false;
+
+		try
+		{
+			entry.function();
+		}
+		catch (const std::exception& e)
+		{
+			std::printf("%s threw: %s\n", fullName.c_str(), e.what());
+			currentFailed = true;
+		}
+
+		run++;
+		failed += currentFailed;
+	}
+
+	std::printf("%d %s, %d failed\n", run, benchmarks ? "benchmarks" : "tests", failed);
+
+	return failed == 0 ? 0 : 1;
+}
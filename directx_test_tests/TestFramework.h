@@ -0,0 +1,58 @@
+#pragma once
+#include <cstddef>
+#include <cstdio>
+#include <cmath>
+#include <filesystem>
+
+// Just enough of a test runner for this project. TEST bodies run by default and report failed CHECKs;
+// BENCHMARK bodies only run with --bench and print their own numbers through Report.
+namespace testing
+{
+	using TestFunction = void(*)();
+
+	struct Registration
+	{
+		Registration(const char* suite, const char* name, TestFunction function, bool benchmark) noexcept;
+	};
+
+	void Fail(const char* file, int line, const char* expression) noexcept;
+	bool Failed() noexcept;
+
+	// printf into the benchmark log, prefixed with the running benchmark's name
+	void Report(const char* format, ...) noexcept;
+
+	// an empty directory of the test's own for files it needs on disk
+	std::filesystem::path ScratchDirectory();
+
+	// Heap allocations made through operator new so far, for tests that count them. Other threads
+	// count too, so measure stretches where only the test's own thread runs.
+	struct AllocationCount
+	{
+		size_t count = 0;
+		size_t bytes = 0;
+	};
+
+	AllocationCount Allocations() noexcept;
+
+	// keeps the optimizer from dropping a result that is only computed to be timed
+	template<class T>
+	void Consume(const T& value) noexcept
+	{
+		[[maybe_unused]] static const void* volatile sink;
+		sink = &value;
+	}
+}
+
+#define TEST_REGISTER(suite, name, benchmark) \
+	static void suite##_##name(); \
+	static const testing::Registration suite##_##name##_registration(#suite, #name, &suite##_##name, benchmark); \
+	static void suite##_##name()
+
+#define TEST(suite, name) TEST_REGISTER(suite, name, false)
+#define BENCHMARK(suite, name) TEST_REGISTER(suite, name, true)
+
+#define CHECK(expression) ((expression) ? void() : testing::Fail(__FILE__, __LINE__, #expression))
+#define CHECK_NEAR(a, b, tolerance) CHECK(std::abs(double(a) - double(b)) <= double(tolerance))
+
+// stops the current test when the rest of it would be meaningless
+#define REQUIRE(expression) do { if (!(expression)) { testing::Fail(__FILE__, __LINE__, #expression); return; } } while (false)